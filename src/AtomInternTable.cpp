@@ -0,0 +1,87 @@
+#include "AtomInternTable.h"
+#include "JSContext.h"
+#include "TypeBridge.h"
+#include "ExecutionEngine.h"
+#include <string>
+
+namespace protojs {
+
+AtomInternTable::AtomInternTable(JSContext* ctx) : ctx(ctx) {
+}
+
+AtomInternTable::~AtomInternTable() {
+    clear();
+}
+
+AtomInternTable* AtomInternTable::get(JSContext* ctx) {
+    JSContextWrapper* wrapper = static_cast<JSContextWrapper*>(JS_GetContextOpaque(ctx));
+    return wrapper ? wrapper->getInternTable() : nullptr;
+}
+
+const proto::ProtoString* AtomInternTable::toProtoString(JSContext* ctx, JSAtom atom, proto::ProtoContext* pContext) {
+    if (AtomInternTable* table = get(ctx)) {
+        return table->intern(atom, pContext);
+    }
+
+    const char* name = JS_AtomToCString(ctx, atom);
+    if (!name) {
+        return nullptr;
+    }
+    const proto::ProtoString* pName = pContext->fromUTF8String(name)->asString(pContext);
+    JS_FreeCString(ctx, name);
+    return pName;
+}
+
+const proto::ProtoString* AtomInternTable::intern(JSAtom atom, proto::ProtoContext* pContext) {
+    auto it = byAtom.find(atom);
+    if (it != byAtom.end()) {
+        return it->second;
+    }
+
+    const char* name = JS_AtomToCString(ctx, atom);
+    if (!name) {
+        return nullptr;
+    }
+    const proto::ProtoString* pName = pContext->fromUTF8String(name)->asString(pContext);
+    JS_FreeCString(ctx, name);
+
+    insert(atom, pName);
+    return pName;
+}
+
+JSAtom AtomInternTable::toAtom(const proto::ProtoString* name, proto::ProtoContext* pContext) {
+    auto it = byName.find(name);
+    if (it != byName.end()) {
+        return JS_DupAtom(ctx, it->second);
+    }
+
+    std::string utf8;
+    TypeBridge::exportUTF8(pContext, name, utf8);
+    JSAtom atom = JS_NewAtomLen(ctx, utf8.data(), utf8.size());
+    if (atom == JS_ATOM_NULL) {
+        return JS_ATOM_NULL;
+    }
+
+    insert(atom, name);
+    return atom;
+}
+
+void AtomInternTable::insert(JSAtom atom, const proto::ProtoString* name) {
+    if (byAtom.size() >= MAX_ENTRIES || byAtom.count(atom) || byName.count(name)) {
+        return;
+    }
+    byAtom.emplace(JS_DupAtom(ctx, atom), name);
+    byName.emplace(name, atom);
+}
+
+void AtomInternTable::clear() {
+    for (const auto& entry : byAtom) {
+        JS_FreeAtom(ctx, entry.first);
+    }
+    byAtom.clear();
+    byName.clear();
+    // Inline caches key on atom ids that may now be reused
+    ExecutionEngine::invalidatePropertyCaches(ctx);
+}
+
+} // namespace protojs
@@ -0,0 +1,79 @@
+#ifndef PROTOJS_ATOMINTERNTABLE_H
+#define PROTOJS_ATOMINTERNTABLE_H
+
+#include "quickjs.h"
+#include "headers/protoCore.h"
+#include <unordered_map>
+#include <cstddef>
+
+namespace protojs {
+
+/**
+ * @brief Per-context JSAtom <-> ProtoString intern table for property names.
+ *
+ * Each property name is converted once; later lookups in either direction
+ * return the same ProtoString or JSAtom. The table holds a reference on
+ * every atom it stores, so atom ids are not reused while cached. Once
+ * MAX_ENTRIES names are interned, further names are converted without
+ * being cached. Owned by JSContextWrapper and used from the main thread.
+ */
+class AtomInternTable {
+public:
+    /**
+     * @brief Upper bound on interned names per context.
+     */
+    static constexpr size_t MAX_ENTRIES = 4096;
+
+    explicit AtomInternTable(JSContext* ctx);
+    ~AtomInternTable();
+
+    AtomInternTable(const AtomInternTable&) = delete;
+    AtomInternTable& operator=(const AtomInternTable&) = delete;
+
+    /**
+     * @brief Table of the JSContextWrapper owning ctx, or nullptr (e.g. in
+     *        Deferred worker contexts).
+     */
+    static AtomInternTable* get(JSContext* ctx);
+
+    /**
+     * @brief ProtoString for a property name. Falls back to a direct
+     *        conversion when ctx has no table. Returns nullptr if the atom
+     *        cannot be converted.
+     */
+    static const proto::ProtoString* toProtoString(JSContext* ctx, JSAtom atom, proto::ProtoContext* pContext);
+
+    /**
+     * @brief Interned ProtoString for atom.
+     */
+    const proto::ProtoString* intern(JSAtom atom, proto::ProtoContext* pContext);
+
+    /**
+     * @brief Atom for a ProtoString property name. The returned atom must be
+     *        freed with JS_FreeAtom; JS_ATOM_NULL on failure.
+     */
+    JSAtom toAtom(const proto::ProtoString* name, proto::ProtoContext* pContext);
+
+    /**
+     * @brief Drop all entries and release their atoms.
+     */
+    void clear();
+
+    /**
+     * @brief Whether atom is interned (and its id therefore held).
+     */
+    bool contains(JSAtom atom) const { return byAtom.count(atom) > 0; }
+
+    size_t size() const { return byAtom.size(); }
+
+private:
+    void insert(JSAtom atom, const proto::ProtoString* name);
+
+    JSContext* ctx;
+    std::unordered_map<JSAtom, const proto::ProtoString*> byAtom;
+    std::unordered_map<const proto::ProtoString*, JSAtom> byName;
+};
+
+} // namespace protojs
+
+#endif // PROTOJS_ATOMINTERNTABLE_H
@@ -8,11 +8,11 @@ namespace protojs {
 std::unique_ptr<CPUThreadPool> CPUThreadPool::instance = nullptr;
 std::mutex CPUThreadPool::instanceMutex;
 
-CPUThreadPool::CPUThreadPool(size_t numThreads) {
+CPUThreadPool::CPUThreadPool(size_t numThreads, SchedulingMode mode, WorkerHooks hooks) {
     if (numThreads == 0) {
         numThreads = getOptimalThreadCount();
     }
-    executor = std::make_unique<ThreadPoolExecutor>(numThreads, "CPUThreadPool");
+    executor = std::make_unique<ThreadPoolExecutor>(numThreads, "CPUThreadPool", mode, std::move(hooks));
 }
 
 CPUThreadPool& CPUThreadPool::getInstance() {
@@ -23,12 +23,12 @@ CPUThreadPool& CPUThreadPool::getInstance() {
     return *instance;
 }
 
-void CPUThreadPool::initialize(size_t numThreads) {
+void CPUThreadPool::initialize(size_t numThreads, SchedulingMode mode, WorkerHooks hooks) {
     std::lock_guard<std::mutex> lock(instanceMutex);
     if (instance) {
         instance->executor->shutdown();
     }
-    instance = std::make_unique<CPUThreadPool>(numThreads);
+    instance = std::make_unique<CPUThreadPool>(numThreads, mode, std::move(hooks));
 }
 
 size_t CPUThreadPool::getOptimalThreadCount() {
@@ -22,8 +22,13 @@ public:
     /**
      * @brief Initialize the pool with a specific number of threads.
      * @param numThreads Number of threads (default: number of CPU cores)
+     * @param mode Scheduling strategy (default: work stealing; FIFO is kept
+     *             for comparison in benchmarks)
+     * @param hooks Per-worker start/stop callbacks, e.g. to pre-warm the
+     *              Deferred runtimes (see WorkerRuntimePool)
      */
-    static void initialize(size_t numThreads = 0);
+    static void initialize(size_t numThreads = 0, SchedulingMode mode = SchedulingMode::WorkStealing,
+                           WorkerHooks hooks = {});
     
     /**
      * @brief Get the underlying ThreadPoolExecutor.
@@ -41,7 +46,8 @@ public:
     static void shutdown();
 
     // Constructor made public for make_unique, but should only be called via initialize()
-    CPUThreadPool(size_t numThreads);
+    CPUThreadPool(size_t numThreads, SchedulingMode mode = SchedulingMode::WorkStealing,
+                  WorkerHooks hooks = {});
     ~CPUThreadPool() = default;
     
 private:
@@ -0,0 +1,93 @@
+#include "ConversionCache.h"
+#include "JSContext.h"
+
+namespace protojs {
+
+ConversionCache::ConversionCache(JSContext* ctx, ConversionCache* shared, size_t capacity)
+    : ctx(ctx), sharedCache(shared), capacity(capacity) {
+}
+
+ConversionCache::~ConversionCache() {
+    clear();
+}
+
+ConversionCache* ConversionCache::getShared(JSContext* ctx) {
+    JSContextWrapper* wrapper = static_cast<JSContextWrapper*>(JS_GetContextOpaque(ctx));
+    return wrapper ? wrapper->getConversionCache() : nullptr;
+}
+
+bool ConversionCache::isFrozen(JSContext* ctx, JSValueConst obj) {
+    if (JS_IsExtensible(ctx, obj) != 0) {
+        return false;
+    }
+
+    JSPropertyEnum* props;
+    uint32_t count;
+    if (JS_GetOwnPropertyNames(ctx, &props, &count, obj, JS_GPN_STRING_MASK | JS_GPN_SYMBOL_MASK) != 0) {
+        JS_FreeValue(ctx, JS_GetException(ctx));
+        return false;
+    }
+
+    bool frozen = true;
+    for (uint32_t i = 0; i < count && frozen; i++) {
+        JSPropertyDescriptor desc;
+        int found = JS_GetOwnProperty(ctx, &desc, obj, props[i].atom);
+        if (found < 0) {
+            JS_FreeValue(ctx, JS_GetException(ctx));
+            frozen = false;
+        } else if (found > 0) {
+            if (desc.flags & (JS_PROP_GETSET | JS_PROP_WRITABLE | JS_PROP_CONFIGURABLE)) {
+                frozen = false;
+            }
+            JS_FreeValue(ctx, desc.value);
+            JS_FreeValue(ctx, desc.getter);
+            JS_FreeValue(ctx, desc.setter);
+        }
+    }
+    JS_FreePropertyEnum(ctx, props, count);
+    return frozen;
+}
+
+const ConversionCache::Entry* ConversionCache::find(JSValueConst obj) const {
+    auto it = entries.find(JS_VALUE_GET_PTR(obj));
+    return it != entries.end() ? &it->second : nullptr;
+}
+
+void ConversionCache::record(JSValueConst obj, const proto::ProtoObject* result, bool complete, bool frozen) {
+    auto it = entries.find(JS_VALUE_GET_PTR(obj));
+    if (it != entries.end()) {
+        it->second.result = result;
+        it->second.complete = complete;
+        it->second.frozen = frozen;
+        return;
+    }
+    if (capacity > 0 && entries.size() >= capacity) {
+        return;
+    }
+    entries.emplace(JS_VALUE_GET_PTR(obj), Entry{JS_DupValue(ctx, obj), result, complete, frozen});
+}
+
+JSValue ConversionCache::findJS(const proto::ProtoObject* obj) const {
+    auto it = jsEntries.find(obj);
+    return it != jsEntries.end() ? JS_DupValue(ctx, it->second) : JS_UNDEFINED;
+}
+
+void ConversionCache::recordJS(const proto::ProtoObject* obj, JSValueConst val) {
+    if (jsEntries.count(obj)) {
+        return;
+    }
+    jsEntries.emplace(obj, JS_DupValue(ctx, val));
+}
+
+void ConversionCache::clear() {
+    for (auto& entry : entries) {
+        JS_FreeValue(ctx, entry.second.object);
+    }
+    for (auto& entry : jsEntries) {
+        JS_FreeValue(ctx, entry.second);
+    }
+    entries.clear();
+    jsEntries.clear();
+}
+
+} // namespace protojs
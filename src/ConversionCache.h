@@ -0,0 +1,96 @@
+#ifndef PROTOJS_CONVERSIONCACHE_H
+#define PROTOJS_CONVERSIONCACHE_H
+
+#include "quickjs.h"
+#include "headers/protoCore.h"
+#include <unordered_map>
+#include <cstddef>
+
+namespace protojs {
+
+/**
+ * @brief Identity map used by TypeBridge while converting object graphs.
+ *
+ * fromJS records every JS object it converts, so an object referenced twice
+ * maps to one ProtoObject and cycles terminate; toJS does the same for
+ * ProtoObjects. Entries hold a reference on their JS object, which keeps its
+ * address from being reused while the cache is alive.
+ *
+ * A per-conversion cache may point to a shared cache that outlives it. The
+ * shared cache of a context only receives deeply frozen JS objects, whose
+ * conversion cannot change, so converting them again is a lookup. It is
+ * disabled by default (see JSContextWrapper::setConversionCacheCapacity).
+ */
+class ConversionCache {
+public:
+    struct Entry {
+        JSValue object;
+        const proto::ProtoObject* result;
+        /** False while the object's children are still being converted. */
+        bool complete;
+        /** The object and everything reachable from it are frozen. */
+        bool frozen;
+    };
+
+    /**
+     * @brief capacity bounds the number of fromJS entries (0 = unbounded);
+     *        once reached, further objects are converted without recording.
+     */
+    explicit ConversionCache(JSContext* ctx, ConversionCache* shared = nullptr, size_t capacity = 0);
+    ~ConversionCache();
+
+    ConversionCache(const ConversionCache&) = delete;
+    ConversionCache& operator=(const ConversionCache&) = delete;
+
+    /**
+     * @brief Shared cache of the JSContextWrapper owning ctx, or nullptr if
+     *        it is disabled or ctx has no wrapper.
+     */
+    static ConversionCache* getShared(JSContext* ctx);
+
+    /**
+     * @brief Whether every own property of obj is a non-writable,
+     *        non-configurable data property and obj is not extensible.
+     */
+    static bool isFrozen(JSContext* ctx, JSValueConst obj);
+
+    ConversionCache* shared() const { return sharedCache; }
+
+    /**
+     * @brief Entry recorded for a JS object, or nullptr.
+     */
+    const Entry* find(JSValueConst obj) const;
+
+    /**
+     * @brief Record or update the entry of a JS object.
+     */
+    void record(JSValueConst obj, const proto::ProtoObject* result, bool complete, bool frozen);
+
+    /**
+     * @brief JSValue recorded for a ProtoObject (duplicated), or JS_UNDEFINED.
+     */
+    JSValue findJS(const proto::ProtoObject* obj) const;
+
+    /**
+     * @brief Record the JSValue a ProtoObject was converted to.
+     */
+    void recordJS(const proto::ProtoObject* obj, JSValueConst val);
+
+    /**
+     * @brief Drop all entries and release their references.
+     */
+    void clear();
+
+    size_t size() const { return entries.size(); }
+
+private:
+    JSContext* ctx;
+    ConversionCache* sharedCache;
+    size_t capacity;
+    std::unordered_map<void*, Entry> entries;
+    std::unordered_map<const proto::ProtoObject*, JSValue> jsEntries;
+};
+
+} // namespace protojs
+
+#endif // PROTOJS_CONVERSIONCACHE_H
@@ -3,18 +3,187 @@
 #include "JSContext.h"
 #include "CPUThreadPool.h"
 #include "EventLoop.h"
+#include "WorkerRuntimePool.h"
+#include "TransferableBuffer.h"
 #include <iostream>
 #include <memory>
 #include <cstring>
 #include <thread>
+#include <algorithm>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 
 namespace protojs {
 
 static JSClassID protojs_deferred_class_id;
+static JSClassID protojs_deferred_transfer_class_id;
+static JSClassID protojs_deferred_options_class_id;
 
 // Store JSContextWrapper in JSContext opaque data
 static const char* JS_CONTEXT_WRAPPER_KEY = "protojs_wrapper";
 
+namespace {
+
+// Most distinct functions whose bytecode is kept on the main thread
+constexpr size_t BYTECODE_CACHE_CAPACITY = 256;
+
+/**
+ * Serialized bytecode of recently dispatched functions (main thread only).
+ *
+ * Dispatching a function object again finds its bytecode by identity, without
+ * serializing it; the entry holds a reference to the function so its address
+ * cannot be reused. Other functions are serialized and looked up by the bytes,
+ * since QuickJS does not expose a function's bytecode object: fresh closures
+ * of one function literal then share an entry. Source text is not a safe key:
+ * it comes from toString, which scripts can override. Equal bytecode keeps its
+ * id, so workers reuse the function they already deserialized.
+ */
+class BytecodeCache {
+public:
+    std::shared_ptr<const DeferredBytecode> findFunction(JSValueConst func) {
+        auto it = functionIndex.find(JS_VALUE_GET_PTR(func));
+        if (it == functionIndex.end()) {
+            return nullptr;
+        }
+        functions.splice(functions.begin(), functions, it->second);
+        return it->second->bytecode;
+    }
+
+    void rememberFunction(JSContext* ctx, JSValueConst func, std::shared_ptr<const DeferredBytecode> bytecode) {
+        functions.push_front(FunctionEntry{ctx, JS_DupValue(ctx, func), std::move(bytecode)});
+        functionIndex[JS_VALUE_GET_PTR(func)] = functions.begin();
+        if (functions.size() > BYTECODE_CACHE_CAPACITY) {
+            FunctionEntry evicted = functions.back();
+            functionIndex.erase(JS_VALUE_GET_PTR(evicted.func));
+            functions.pop_back();
+            // Last: freeing may run finalizers
+            JS_FreeValue(evicted.ctx, evicted.func);
+        }
+    }
+
+    // Release the functions of ctx before it is freed
+    void forgetFunctions(JSContext* ctx) {
+        std::vector<JSValue> released;
+        for (auto it = functions.begin(); it != functions.end();) {
+            if (it->ctx == ctx) {
+                functionIndex.erase(JS_VALUE_GET_PTR(it->func));
+                released.push_back(it->func);
+                it = functions.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        for (JSValue func : released) {
+            JS_FreeValue(ctx, func);
+        }
+    }
+
+    std::shared_ptr<const DeferredBytecode> find(std::string_view data) {
+        auto it = index.find(data);
+        if (it == index.end()) {
+            return nullptr;
+        }
+        // Move to the front: most recently used
+        entries.splice(entries.begin(), entries, it->second);
+        return *it->second;
+    }
+
+    std::shared_ptr<const DeferredBytecode> insert(std::vector<uint8_t> data) {
+        auto bytecode = std::make_shared<const DeferredBytecode>(DeferredBytecode{nextId++, std::move(data)});
+        entries.push_front(bytecode);
+        index[keyOf(*bytecode)] = entries.begin();
+
+        if (entries.size() > BYTECODE_CACHE_CAPACITY) {
+            // Tasks still holding the evicted bytecode keep it alive
+            index.erase(keyOf(*entries.back()));
+            entries.pop_back();
+        }
+        return bytecode;
+    }
+
+private:
+    // Views the bytes owned by the entry, which outlives its index slot
+    static std::string_view keyOf(const DeferredBytecode& bytecode) {
+        return std::string_view(reinterpret_cast<const char*>(bytecode.data.data()), bytecode.data.size());
+    }
+
+    struct FunctionEntry {
+        JSContext* ctx;
+        JSValue func;
+        std::shared_ptr<const DeferredBytecode> bytecode;
+    };
+
+    std::list<std::shared_ptr<const DeferredBytecode>> entries;
+    std::unordered_map<std::string_view, std::list<std::shared_ptr<const DeferredBytecode>>::iterator> index;
+    std::list<FunctionEntry> functions;
+    std::unordered_map<const void*, std::list<FunctionEntry>::iterator> functionIndex;
+    uint64_t nextId = 1;
+};
+
+BytecodeCache bytecodeCache;
+// Functions serialized by getBytecode, reported by Deferred.stats()
+uint64_t functionsSerialized = 0;
+
+// Deferred.map() aims for this many chunks per CPU worker when no chunkSize
+// is given, so uneven elements still balance across workers
+constexpr size_t MAP_CHUNKS_PER_WORKER = 4;
+
+// Serialize a value into a buffer that belongs to no runtime
+bool serializeValue(JSContext* ctx, JSValueConst value, std::vector<uint8_t>& out) {
+    size_t size = 0;
+    uint8_t* buffer = JS_WriteObject(ctx, &size, value, JS_WRITE_OBJ_BYTECODE);
+    if (!buffer) {
+        JS_FreeValue(ctx, JS_GetException(ctx));
+        return false;
+    }
+    out.assign(buffer, buffer + size);
+    js_free(ctx, buffer);
+    return true;
+}
+
+// Message of the pending exception, which is cleared
+std::string takeExceptionMessage(JSContext* ctx, const char* fallback) {
+    JSValue exception = JS_GetException(ctx);
+    const char* str = JS_ToCString(ctx, exception);
+    std::string message = str ? str : fallback;
+    JS_FreeCString(ctx, str);
+    JS_FreeValue(ctx, exception);
+    return message;
+}
+
+// Function for the bytecode in a worker context, deserialized at most once
+// per worker runtime
+JSValue loadFunction(JSContext* workerCtx, const DeferredBytecode& bytecode) {
+    JSValue func = WorkerRuntimePool::getCachedFunction(bytecode.id);
+    if (JS_IsUndefined(func)) {
+        func = JS_ReadObject(workerCtx, bytecode.data.data(), bytecode.data.size(), JS_READ_OBJ_BYTECODE);
+        if (!JS_IsException(func)) {
+            WorkerRuntimePool::cacheFunction(bytecode.id, JS_DupValue(workerCtx, func));
+        }
+    }
+    return func;
+}
+
+JSValue newError(JSContext* ctx, const std::string& message) {
+    JSValue error = JS_NewError(ctx);
+    JS_SetPropertyStr(ctx, error, "message", JS_NewString(ctx, message.c_str()));
+    return error;
+}
+
+int64_t getArrayLength(JSContext* ctx, JSValueConst array) {
+    JSValue lengthVal = JS_GetPropertyStr(ctx, array, "length");
+    int64_t length = 0;
+    if (JS_ToInt64(ctx, &length, lengthVal) < 0) {
+        length = -1;
+    }
+    JS_FreeValue(ctx, lengthVal);
+    return length;
+}
+
+} // namespace
+
 void Deferred::init(JSContext* ctx, JSContextWrapper* wrapper) {
     // Store wrapper in JSContext opaque
     JS_SetContextOpaque(ctx, wrapper);
@@ -26,15 +195,37 @@ void Deferred::init(JSContext* ctx, JSContextWrapper* wrapper) {
     };
     JS_NewClass(JS_GetRuntime(ctx), protojs_deferred_class_id, &class_def);
 
-    JSValue proto = JS_NewObject(ctx);
-    JS_SetPropertyStr(ctx, proto, "then", JS_NewCFunction(ctx, then, "then", 1));
-    JS_SetPropertyStr(ctx, proto, "catch", JS_NewCFunction(ctx, catch_, "catch", 1));
-    JS_SetClassProto(ctx, protojs_deferred_class_id, proto);
+    // Deferreds are native promises whose prototype also answers to
+    // instanceof Deferred; then/catch/finally come from Promise.prototype
+    JSValue global_obj = JS_GetGlobalObject(ctx);
+    JSValue promiseCtor = JS_GetPropertyStr(ctx, global_obj, "Promise");
+    JSValue promiseProto = JS_GetPropertyStr(ctx, promiseCtor, "prototype");
+    JSValue proto = JS_NewObjectProto(ctx, promiseProto);
+    JS_FreeValue(ctx, promiseProto);
+    JS_FreeValue(ctx, promiseCtor);
 
     JSValue ctor = JS_NewCFunction2(ctx, constructor, "Deferred", 1, JS_CFUNC_constructor, 0);
     JS_SetConstructor(ctx, ctor, proto);
+    JS_FreeValue(ctx, proto);
+    JS_SetPropertyStr(ctx, ctor, "map", JS_NewCFunction(ctx, map, "map", 3));
+    
+    JS_NewClassID(&protojs_deferred_transfer_class_id);
+    JSClassDef transfer_class_def = {
+        "DeferredTransfer",
+        transferFinalizer
+    };
+    JS_NewClass(JS_GetRuntime(ctx), protojs_deferred_transfer_class_id, &transfer_class_def);
+    JS_SetPropertyStr(ctx, ctor, "transfer", JS_NewCFunction(ctx, transfer, "transfer", 1));
+    
+    JS_NewClassID(&protojs_deferred_options_class_id);
+    JSClassDef options_class_def = {
+        "DeferredOptions",
+        optionsFinalizer
+    };
+    JS_NewClass(JS_GetRuntime(ctx), protojs_deferred_options_class_id, &options_class_def);
+    JS_SetPropertyStr(ctx, ctor, "options", JS_NewCFunction(ctx, options, "options", 1));
+    JS_SetPropertyStr(ctx, ctor, "stats", JS_NewCFunction(ctx, stats, "stats", 0));
     
-    JSValue global_obj = JS_GetGlobalObject(ctx);
     JS_SetPropertyStr(ctx, global_obj, "Deferred", ctor);
     JS_FreeValue(ctx, global_obj);
 }
@@ -48,385 +239,615 @@ JSValue Deferred::constructor(JSContext* ctx, JSValueConst new_target, int argc,
         return JS_ThrowTypeError(ctx, "Deferred expects a function");
     }
 
-    JSValue obj = JS_NewObjectClass(ctx, protojs_deferred_class_id);
-    if (JS_IsException(obj)) return obj;
-
     JSContextWrapper* wrapper = getWrapperFromContext(ctx);
     if (!wrapper) {
-        JS_FreeValue(ctx, obj);
         return JS_ThrowTypeError(ctx, "Deferred: JSContextWrapper not found");
     }
 
     proto::ProtoSpace* space = wrapper->getProtoSpace();
     JSRuntime* rt = wrapper->getJSRuntime();
     
-    // Serialize the function to bytecode
-    size_t serializedSize = 0;
-    uint8_t* serializedFunc = JS_WriteObject(ctx, &serializedSize, argv[0], JS_WRITE_OBJ_BYTECODE);
+    // Scheduling options come last and are not passed to the function
+    TaskOptions taskOptions;
+    if (argc > 1) {
+        auto* parsed = static_cast<TaskOptions*>(JS_GetOpaque(argv[argc - 1], protojs_deferred_options_class_id));
+        if (parsed) {
+            taskOptions = *parsed;
+            argc--;
+        }
+    }
     
-    if (!serializedFunc || serializedSize == 0) {
-        JS_FreeValue(ctx, obj);
+    // Serialize the function to bytecode, or reuse an earlier serialization
+    std::shared_ptr<const DeferredBytecode> bytecode = getBytecode(ctx, argv[0]);
+    if (!bytecode) {
         return JS_ThrowTypeError(ctx, "Deferred: Function not serializable. Functions with complex closures may not be supported.");
     }
     
-    // Create resolve and reject callbacks
-    // These will store the result/error and schedule callback execution
-    JSValue resolve = JS_NewCFunction(ctx, [](JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
-        // This will be called from event loop
-        return JS_UNDEFINED;
-    }, "resolve", 1);
-    
-    JSValue reject = JS_NewCFunction(ctx, [](JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
-        // This will be called from event loop
-        return JS_UNDEFINED;
-    }, "reject", 1);
-
-    // Copy serialized buffer to runtime memory (for thread safety)
-    uint8_t* copiedBuffer = static_cast<uint8_t*>(js_malloc_rt(rt, serializedSize));
-    if (!copiedBuffer) {
-        js_free(ctx, serializedFunc);
-        JS_FreeValue(ctx, obj);
-        return JS_ThrowTypeError(ctx, "Deferred: Failed to allocate memory for serialized function");
-    }
-    memcpy(copiedBuffer, serializedFunc, serializedSize);
+    // Extra arguments travel as one serialized array, written once here.
+    // Arguments wrapped by Deferred.transfer() leave a hole in the array and
+    // move their ArrayBuffer separately, without serialization.
+    std::shared_ptr<const std::vector<uint8_t>> serializedArgs;
+    std::vector<std::pair<uint32_t, JSValueConst>> transferArgs;
+    if (argc > 1) {
+        JSValue args = JS_NewArray(ctx);
+        for (int i = 1; i < argc; ++i) {
+            auto* held = static_cast<JSValue*>(JS_GetOpaque(argv[i], protojs_deferred_transfer_class_id));
+            if (held) {
+                if (!TransferableBuffer::isArrayBuffer(ctx, *held)) {
+                    JS_FreeValue(ctx, args);
+                    return JS_ThrowTypeError(ctx, "Deferred: Transferred ArrayBuffer is detached");
+                }
+                transferArgs.emplace_back(static_cast<uint32_t>(i - 1), *held);
+                continue;
+            }
+            JS_SetPropertyUint32(ctx, args, static_cast<uint32_t>(i - 1), JS_DupValue(ctx, argv[i]));
+        }
+        auto buffer = std::make_shared<std::vector<uint8_t>>();
+        bool ok = serializeValue(ctx, args, *buffer);
+        JS_FreeValue(ctx, args);
+        if (!ok) {
+            return JS_ThrowTypeError(ctx, "Deferred: Arguments not serializable");
+        }
+        serializedArgs = std::move(buffer);
+    }
     
-    // Free original buffer (allocated by JS_WriteObject)
-    js_free(ctx, serializedFunc);
+    // Detach transferred buffers only once nothing else can fail
+    std::vector<std::pair<uint32_t, std::shared_ptr<TransferableBuffer>>> transfers;
+    for (auto& [index, value] : transferArgs) {
+        auto buffer = std::make_shared<TransferableBuffer>();
+        if (!buffer->take(ctx, value)) {
+            return JS_EXCEPTION;
+        }
+        transfers.emplace_back(index, std::move(buffer));
+    }
     
-    // Create task with copied buffer
-    auto task = std::make_shared<DeferredTask>(
-        ctx,
-        JS_DupValue(ctx, argv[0]),  // Keep reference to original function
-        copiedBuffer,               // Copied serialized bytecode
-        serializedSize,             // Size of bytecode
-        resolve,
-        reject,
-        rt,
-        space,
-        wrapper
-    );
+    // The promise is settled directly from the completion callback
+    JSValue resolvingFuncs[2];
+    JSValue promise = JS_NewPromiseCapability(ctx, resolvingFuncs);
+    if (JS_IsException(promise)) {
+        return promise;
+    }
+    JSValue proto = JS_GetPropertyStr(ctx, new_target, "prototype");
+    if (JS_IsObject(proto)) {
+        JS_SetPrototype(ctx, promise, proto);
+    }
+    JS_FreeValue(ctx, proto);
+
+    // Create task sharing the cached bytecode
+    auto task = std::make_shared<DeferredTask>(ctx, bytecode, resolvingFuncs[0], resolvingFuncs[1],
+                                               rt, space, wrapper);
+    task->serializedArgs = std::move(serializedArgs);
+    task->transferredArgs = std::move(transfers);
+    task->priority = taskOptions.priority;
+    if (taskOptions.timeoutMs > 0) {
+        task->deadlineMs = EventLoop::nowMs() + taskOptions.timeoutMs;
+    }
     
-    // Store task in object (need to allocate on heap since it will be used across threads)
-    DeferredTask* taskPtr = new DeferredTask(*task);
-    // Note: taskPtr now owns the copiedBuffer, will be freed in finalizer
-    JS_SetOpaque(obj, taskPtr);
+    // cancel() reaches the task through a holder object, which also frees
+    // our reference when the promise is collected
+    JSValue holder = JS_NewObjectClass(ctx, protojs_deferred_class_id);
+    if (JS_IsException(holder)) {
+        settle(*task, false, JS_GetException(ctx));
+        return promise;
+    }
+    JS_SetOpaque(holder, new std::shared_ptr<DeferredTask>(task));
+    JS_SetPropertyStr(ctx, promise, "cancel", JS_NewCFunctionData(ctx, cancel, 0, 0, 1, &holder));
+    JS_FreeValue(ctx, holder);
 
     // Execute in worker thread
     executeTaskInWorkerThread(task);
 
-    return obj;
+    return promise;
 }
 
-void Deferred::finalizer(JSRuntime* rt, JSValue val) {
-    DeferredTask* task = static_cast<DeferredTask*>(JS_GetOpaque(val, protojs_deferred_class_id));
-    if (task) {
-        JS_FreeValueRT(rt, task->func);
-        JS_FreeValueRT(rt, task->resolve);
-        JS_FreeValueRT(rt, task->reject);
-        JS_FreeValueRT(rt, task->result);
-        JS_FreeValueRT(rt, task->error);
-        JS_FreeValueRT(rt, task->thenCallback);
-        JS_FreeValueRT(rt, task->catchCallback);
-        
-        // Free serialized buffers (allocated with js_malloc_rt)
-        if (task->serializedFunc) {
-            js_free_rt(rt, task->serializedFunc);
-            task->serializedFunc = nullptr;
-        }
-        if (task->serializedResult) {
-            js_free_rt(rt, task->serializedResult);
-            task->serializedResult = nullptr;
-        }
-        
-        delete task;
+std::shared_ptr<const DeferredBytecode> Deferred::getBytecode(JSContext* ctx, JSValueConst func) {
+    if (auto cached = bytecodeCache.findFunction(func)) {
+        return cached;
     }
-}
 
-JSValue Deferred::then(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
-    if (argc < 1 || !JS_IsFunction(ctx, argv[0])) {
-        return JS_ThrowTypeError(ctx, "then expects a function");
+    size_t serializedSize = 0;
+    uint8_t* serializedFunc = JS_WriteObject(ctx, &serializedSize, func, JS_WRITE_OBJ_BYTECODE);
+    if (!serializedFunc || serializedSize == 0) {
+        if (serializedFunc) {
+            js_free(ctx, serializedFunc);
+        }
+        JS_FreeValue(ctx, JS_GetException(ctx));
+        return nullptr;
     }
-    
-    DeferredTask* task = static_cast<DeferredTask*>(JS_GetOpaque(this_val, protojs_deferred_class_id));
-    if (!task) {
-        return JS_ThrowTypeError(ctx, "Invalid Deferred object");
+    functionsSerialized++;
+
+    std::string_view serialized(reinterpret_cast<const char*>(serializedFunc), serializedSize);
+    std::shared_ptr<const DeferredBytecode> bytecode = bytecodeCache.find(serialized);
+    if (!bytecode) {
+        bytecode = bytecodeCache.insert(std::vector<uint8_t>(serializedFunc, serializedFunc + serializedSize));
     }
+    js_free(ctx, serializedFunc);
+    bytecodeCache.rememberFunction(ctx, func, bytecode);
+    return bytecode;
+}
+
+JSValue Deferred::stats(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    JSValue result = JS_NewObject(ctx);
+    JS_SetPropertyStr(ctx, result, "functionsSerialized", JS_NewInt64(ctx, static_cast<int64_t>(functionsSerialized)));
+    return result;
+}
+
+void Deferred::cleanup(JSContext* ctx) {
+    bytecodeCache.forgetFunctions(ctx);
+}
+
+void Deferred::finalizer(JSRuntime* rt, JSValue val) {
+    delete static_cast<std::shared_ptr<DeferredTask>*>(JS_GetOpaque(val, protojs_deferred_class_id));
+}
+
+void Deferred::executeTaskInWorkerThread(std::shared_ptr<DeferredTask> task) {
+    // Submit task to CPU thread pool for execution in worker thread
+    CPUThreadPool& pool = CPUThreadPool::getInstance();
     
-    task->thenCallback = JS_DupValue(ctx, argv[0]);
+    // Keep the event loop alive until the result has been delivered
+    EventLoop::getInstance().ref();
     
-    // If already resolved, call callback immediately
-    if (task->isResolved && !JS_IsUndefined(task->result)) {
-        JSValue thenArgs[] = { task->result };
-        JSValue thenResult = JS_Call(ctx, task->thenCallback, JS_UNDEFINED, 1, thenArgs);
-        JS_FreeValue(ctx, thenResult);
+    // Fire-and-forget: the result comes back through the event loop, so
+    // skip the packaged_task/future that submit() would allocate
+    pool.getExecutor().execute([task]() {
+        workerThreadExecution(task);
+    }, task->priority);
+}
+
+JSValue Deferred::cancel(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv,
+                        int magic, JSValue* func_data) {
+    auto* task = static_cast<std::shared_ptr<DeferredTask>*>(JS_GetOpaque(func_data[0], protojs_deferred_class_id));
+    if (!task || (*task)->settled) {
+        return JS_FALSE;
     }
     
-    return JS_DupValue(ctx, this_val); // Return this for chaining
+    // A queued task is skipped by its worker; a running one is interrupted.
+    // Either way its completion is ignored now that we have settled.
+    (*task)->cancelled = true;
+    settle(**task, false, newError(ctx, "Deferred cancelled"));
+    return JS_TRUE;
 }
 
-JSValue Deferred::catch_(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
-    if (argc < 1 || !JS_IsFunction(ctx, argv[0])) {
-        return JS_ThrowTypeError(ctx, "catch expects a function");
+void Deferred::settle(DeferredTask& task, bool fulfilled, JSValue value) {
+    JSContext* ctx = task.mainJSContext;
+    task.settled = true;
+    JSValue callResult = JS_Call(ctx, fulfilled ? task.resolve : task.reject, JS_UNDEFINED, 1, &value);
+    JS_FreeValue(ctx, callResult);
+    JS_FreeValue(ctx, value);
+    
+    // The promise keeps its own state; the resolving functions are done
+    JS_FreeValue(ctx, task.resolve);
+    JS_FreeValue(ctx, task.reject);
+    task.resolve = JS_UNDEFINED;
+    task.reject = JS_UNDEFINED;
+}
+
+JSValue Deferred::options(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    if (argc < 1 || !JS_IsObject(argv[0])) {
+        return JS_ThrowTypeError(ctx, "Deferred.options expects an object");
     }
     
-    DeferredTask* task = static_cast<DeferredTask*>(JS_GetOpaque(this_val, protojs_deferred_class_id));
-    if (!task) {
-        return JS_ThrowTypeError(ctx, "Invalid Deferred object");
+    TaskOptions parsed;
+    
+    JSValue priorityVal = JS_GetPropertyStr(ctx, argv[0], "priority");
+    if (!JS_IsUndefined(priorityVal)) {
+        const char* priority = JS_ToCString(ctx, priorityVal);
+        std::string name = priority ? priority : "";
+        JS_FreeCString(ctx, priority);
+        if (name == "high") {
+            parsed.priority = TaskPriority::High;
+        } else if (name == "low") {
+            parsed.priority = TaskPriority::Low;
+        } else if (name != "normal") {
+            JS_FreeValue(ctx, priorityVal);
+            return JS_ThrowRangeError(ctx, "Deferred.options: priority must be 'high', 'normal' or 'low'");
+        }
     }
+    JS_FreeValue(ctx, priorityVal);
     
-    task->catchCallback = JS_DupValue(ctx, argv[0]);
+    JSValue deadlineVal = JS_GetPropertyStr(ctx, argv[0], "deadline");
+    if (!JS_IsUndefined(deadlineVal)) {
+        int64_t deadline = 0;
+        if (JS_ToInt64(ctx, &deadline, deadlineVal) < 0 || deadline < 1) {
+            JS_FreeValue(ctx, deadlineVal);
+            return JS_ThrowRangeError(ctx, "Deferred.options: deadline must be a positive number of milliseconds");
+        }
+        parsed.timeoutMs = static_cast<uint64_t>(deadline);
+    }
+    JS_FreeValue(ctx, deadlineVal);
     
-    // If already rejected, call callback immediately
-    if (task->isRejected && !JS_IsUndefined(task->error)) {
-        JSValue catchArgs[] = { task->error };
-        JSValue catchResult = JS_Call(ctx, task->catchCallback, JS_UNDEFINED, 1, catchArgs);
-        JS_FreeValue(ctx, catchResult);
+    JSValue obj = JS_NewObjectClass(ctx, protojs_deferred_options_class_id);
+    if (JS_IsException(obj)) return obj;
+    JS_SetOpaque(obj, new TaskOptions(parsed));
+    return obj;
+}
+
+void Deferred::optionsFinalizer(JSRuntime* rt, JSValue val) {
+    delete static_cast<TaskOptions*>(JS_GetOpaque(val, protojs_deferred_options_class_id));
+}
+
+JSValue Deferred::transfer(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    if (argc < 1 || !TransferableBuffer::isArrayBuffer(ctx, argv[0])) {
+        return JS_ThrowTypeError(ctx, "Deferred.transfer expects an ArrayBuffer");
     }
     
-    return JS_DupValue(ctx, this_val); // Return this for chaining
+    JSValue obj = JS_NewObjectClass(ctx, protojs_deferred_transfer_class_id);
+    if (JS_IsException(obj)) return obj;
+    JS_SetOpaque(obj, new JSValue(JS_DupValue(ctx, argv[0])));
+    return obj;
 }
 
-void Deferred::executeTaskInWorkerThread(std::shared_ptr<DeferredTask> task) {
-    // Submit task to CPU thread pool for execution in worker thread
+void Deferred::transferFinalizer(JSRuntime* rt, JSValue val) {
+    auto* held = static_cast<JSValue*>(JS_GetOpaque(val, protojs_deferred_transfer_class_id));
+    if (held) {
+        JS_FreeValueRT(rt, *held);
+        delete held;
+    }
+}
+
+JSValue Deferred::map(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    if (argc < 2 || !JS_IsArray(ctx, argv[0]) || !JS_IsFunction(ctx, argv[1])) {
+        return JS_ThrowTypeError(ctx, "Deferred.map expects an array and a function");
+    }
+
+    int64_t length = getArrayLength(ctx, argv[0]);
+    if (length < 0) {
+        return JS_EXCEPTION;
+    }
+
     CPUThreadPool& pool = CPUThreadPool::getInstance();
-    
-    pool.getExecutor().submit([task]() {
-        workerThreadExecution(task);
-    });
+    size_t chunkSize = 0;
+    if (argc > 2 && JS_IsObject(argv[2])) {
+        JSValue chunkSizeVal = JS_GetPropertyStr(ctx, argv[2], "chunkSize");
+        if (!JS_IsUndefined(chunkSizeVal)) {
+            int64_t requested = 0;
+            if (JS_ToInt64(ctx, &requested, chunkSizeVal) < 0 || requested < 1) {
+                JS_FreeValue(ctx, chunkSizeVal);
+                return JS_ThrowRangeError(ctx, "Deferred.map: chunkSize must be a positive integer");
+            }
+            chunkSize = static_cast<size_t>(requested);
+        }
+        JS_FreeValue(ctx, chunkSizeVal);
+    }
+    if (chunkSize == 0) {
+        size_t chunks = pool.getExecutor().getThreadCount() * MAP_CHUNKS_PER_WORKER;
+        chunkSize = std::max<size_t>(1, (static_cast<size_t>(length) + chunks - 1) / chunks);
+    }
+
+    std::shared_ptr<const DeferredBytecode> bytecode = getBytecode(ctx, argv[1]);
+    if (!bytecode) {
+        return JS_ThrowTypeError(ctx, "Deferred.map: Function not serializable");
+    }
+
+    // Serialize every chunk up front so a bad element fails synchronously
+    size_t chunkCount = (static_cast<size_t>(length) + chunkSize - 1) / chunkSize;
+    std::vector<std::shared_ptr<const std::vector<uint8_t>>> chunks;
+    chunks.reserve(chunkCount);
+    for (size_t c = 0; c < chunkCount; ++c) {
+        size_t begin = c * chunkSize;
+        size_t end = std::min(begin + chunkSize, static_cast<size_t>(length));
+        JSValue slice = JS_NewArray(ctx);
+        for (size_t i = begin; i < end; ++i) {
+            JS_SetPropertyUint32(ctx, slice, static_cast<uint32_t>(i - begin),
+                                 JS_GetPropertyUint32(ctx, argv[0], static_cast<uint32_t>(i)));
+        }
+        auto buffer = std::make_shared<std::vector<uint8_t>>();
+        bool ok = serializeValue(ctx, slice, *buffer);
+        JS_FreeValue(ctx, slice);
+        if (!ok) {
+            return JS_ThrowTypeError(ctx, "Deferred.map: Array elements not serializable");
+        }
+        chunks.push_back(std::move(buffer));
+    }
+
+    JSValue resolvingFuncs[2];
+    JSValue promise = JS_NewPromiseCapability(ctx, resolvingFuncs);
+    if (JS_IsException(promise)) {
+        return promise;
+    }
+
+    if (chunkCount == 0) {
+        JSValue empty = JS_NewArray(ctx);
+        JSValue resolveResult = JS_Call(ctx, resolvingFuncs[0], JS_UNDEFINED, 1, &empty);
+        JS_FreeValue(ctx, resolveResult);
+        JS_FreeValue(ctx, empty);
+        JS_FreeValue(ctx, resolvingFuncs[0]);
+        JS_FreeValue(ctx, resolvingFuncs[1]);
+        return promise;
+    }
+
+    auto job = std::make_shared<MapJob>();
+    job->mainJSContext = ctx;
+    job->bytecode = std::move(bytecode);
+    job->resolve = resolvingFuncs[0];
+    job->reject = resolvingFuncs[1];
+    job->length = static_cast<size_t>(length);
+    job->chunkSize = chunkSize;
+    job->pendingChunks = chunkCount;
+    job->chunkResults.resize(chunkCount);
+    job->chunkErrors.resize(chunkCount);
+
+    for (size_t c = 0; c < chunkCount; ++c) {
+        // One loop handle per chunk, released by its completion
+        EventLoop::getInstance().ref();
+        pool.getExecutor().execute([job, c, chunk = std::move(chunks[c])]() {
+            executeMapChunk(job, c, chunk);
+        });
+    }
+
+    return promise;
 }
 
-void Deferred::workerThreadExecution(std::shared_ptr<DeferredTask> task) {
-    // Thread-local JSContext for worker thread
-    // Each worker thread gets its own runtime and context for thread safety
-    thread_local static JSContext* workerCtx = nullptr;
-    thread_local static JSRuntime* workerRt = nullptr;
-    
-    // Initialize thread-local context if needed
+void Deferred::executeMapChunk(std::shared_ptr<MapJob> job, size_t chunkIndex,
+                               std::shared_ptr<const std::vector<uint8_t>> chunk) {
+    std::string& error = job->chunkErrors[chunkIndex];
+    JSContext* workerCtx = WorkerRuntimePool::acquire();
     if (!workerCtx) {
-        // Create a new runtime for this worker thread
-        // Each worker thread needs its own runtime because QuickJS is not thread-safe
-        workerRt = JS_NewRuntime();
-        if (!workerRt) {
-            // Error: failed to create runtime
-            task->hasError = true;
-            task->serializedResultSize = 0;
-            // Schedule error handling in main thread
-            EventLoop::getInstance().enqueueCallback([task]() {
-                JSContext* ctx = task->mainJSContext;
-                JSValue error = JS_NewString(ctx, "Failed to create worker thread runtime");
-                JSValue rejectArgs[] = { error };
-                JSValue rejectResult = JS_Call(ctx, task->reject, JS_UNDEFINED, 1, rejectArgs);
-                JS_FreeValue(ctx, rejectResult);
-                JS_FreeValue(ctx, error);
-            });
+        error = "Failed to create worker thread context";
+    } else {
+        struct TaskScope {
+            ~TaskScope() { WorkerRuntimePool::release(); }
+        } taskScope;
+
+        JSValue func = loadFunction(workerCtx, *job->bytecode);
+        JSValue elements = JS_IsException(func)
+            ? JS_EXCEPTION
+            : JS_ReadObject(workerCtx, chunk->data(), chunk->size(), JS_READ_OBJ_BYTECODE);
+
+        if (JS_IsException(elements)) {
+            error = takeExceptionMessage(workerCtx, "Failed to deserialize map chunk");
+        } else {
+            int64_t count = getArrayLength(workerCtx, elements);
+            JSValue results = JS_NewArray(workerCtx);
+            int64_t base = static_cast<int64_t>(chunkIndex * job->chunkSize);
+
+            for (int64_t i = 0; i < count; ++i) {
+                JSValue callArgs[] = {
+                    JS_GetPropertyUint32(workerCtx, elements, static_cast<uint32_t>(i)),
+                    JS_NewInt64(workerCtx, base + i)
+                };
+                JSValue value = JS_Call(workerCtx, func, JS_UNDEFINED, 2, callArgs);
+                JS_FreeValue(workerCtx, callArgs[0]);
+                if (JS_IsException(value)) {
+                    error = takeExceptionMessage(workerCtx, "Deferred.map callback failed");
+                    break;
+                }
+                JS_SetPropertyUint32(workerCtx, results, static_cast<uint32_t>(i), value);
+            }
+
+            if (error.empty() && !serializeValue(workerCtx, results, job->chunkResults[chunkIndex])) {
+                error = "Deferred.map: Result not serializable";
+            }
+            JS_FreeValue(workerCtx, results);
+            JS_FreeValue(workerCtx, elements);
+        }
+        JS_FreeValue(workerCtx, func);
+    }
+
+    EventLoop::getInstance().enqueueCallback([job, chunkIndex]() {
+        EventLoop::getInstance().unref();
+        completeMapChunk(job, chunkIndex);
+    });
+}
+
+void Deferred::completeMapChunk(std::shared_ptr<MapJob> job, size_t chunkIndex) {
+    if (job->settled) {
+        return;
+    }
+    JSContext* ctx = job->mainJSContext;
+
+    auto settle = [&job, ctx](JSValue callback, JSValue value) {
+        job->settled = true;
+        JSValue callResult = JS_Call(ctx, callback, JS_UNDEFINED, 1, &value);
+        JS_FreeValue(ctx, callResult);
+        JS_FreeValue(ctx, value);
+        JS_FreeValue(ctx, job->resolve);
+        JS_FreeValue(ctx, job->reject);
+    };
+
+    if (!job->chunkErrors[chunkIndex].empty()) {
+        settle(job->reject, newError(ctx, job->chunkErrors[chunkIndex]));
+        return;
+    }
+
+    if (--job->pendingChunks > 0) {
+        return;
+    }
+
+    // Every chunk is in: stitch the per-chunk arrays together in order
+    JSValue results = JS_NewArray(ctx);
+    uint32_t next = 0;
+    for (const std::vector<uint8_t>& buffer : job->chunkResults) {
+        JSValue part = JS_ReadObject(ctx, buffer.data(), buffer.size(), JS_READ_OBJ_BYTECODE);
+        if (JS_IsException(part)) {
+            JS_FreeValue(ctx, results);
+            JSValue error = JS_GetException(ctx);
+            settle(job->reject, error);
             return;
         }
-        
-        workerCtx = JS_NewContext(workerRt);
-        if (!workerCtx) {
-            JS_FreeRuntime(workerRt);
-            workerRt = nullptr;
-            task->hasError = true;
-            EventLoop::getInstance().enqueueCallback([task]() {
-                JSContext* ctx = task->mainJSContext;
-                JSValue error = JS_NewString(ctx, "Failed to create worker thread context");
-                JSValue rejectArgs[] = { error };
-                JSValue rejectResult = JS_Call(ctx, task->reject, JS_UNDEFINED, 1, rejectArgs);
-                JS_FreeValue(ctx, rejectResult);
-                JS_FreeValue(ctx, error);
-            });
+        int64_t count = getArrayLength(ctx, part);
+        for (int64_t i = 0; i < count; ++i) {
+            JS_SetPropertyUint32(ctx, results, next++, JS_GetPropertyUint32(ctx, part, static_cast<uint32_t>(i)));
+        }
+        JS_FreeValue(ctx, part);
+    }
+    settle(job->resolve, results);
+}
+
+void Deferred::enqueueCompletion(std::shared_ptr<DeferredTask> task) {
+    EventLoop::getInstance().enqueueCallback([task]() {
+        if (!task->loopRefReleased) {
+            task->loopRefReleased = true;
+            EventLoop::getInstance().unref();
+        }
+        if (!task->settled) {
+            completeTask(*task);
+        }
+    });
+}
+
+void Deferred::completeTask(DeferredTask& task) {
+    JSContext* ctx = task.mainJSContext;
+    
+    if (task.transferredResult) {
+        JSValue result = task.transferredResult->adopt(ctx);
+        task.transferredResult.reset();
+        if (JS_IsException(result)) {
+            settle(task, false, JS_GetException(ctx));
+        } else {
+            settle(task, true, result);
+        }
+        return;
+    }
+    
+    if (task.hasError) {
+        JSValue error = JS_UNDEFINED;
+        if (!task.serializedResult.empty()) {
+            // A thrown non-Error value, passed through as is
+            error = JS_ReadObject(ctx, task.serializedResult.data(), task.serializedResult.size(),
+                                  JS_READ_OBJ_BYTECODE);
+            if (JS_IsException(error)) {
+                JS_FreeValue(ctx, JS_GetException(ctx));
+                error = newError(ctx, "Function execution failed");
+            }
+        } else {
+            error = newError(ctx, task.errorMessage.empty() ? "Function execution failed" : task.errorMessage);
+        }
+        settle(task, false, error);
+        return;
+    }
+    
+    JSValue result = JS_UNDEFINED;
+    if (!task.serializedResult.empty()) {
+        result = JS_ReadObject(ctx, task.serializedResult.data(), task.serializedResult.size(),
+                               JS_READ_OBJ_BYTECODE);
+        if (JS_IsException(result)) {
+            JS_FreeValue(ctx, JS_GetException(ctx));
+            settle(task, false, newError(ctx, "Failed to deserialize result"));
             return;
         }
     }
+    task.serializedResult.clear();
+    settle(task, true, result);
+}
+
+void Deferred::workerThreadExecution(std::shared_ptr<DeferredTask> task) {
+    if (task->cancelled) {
+        // Already rejected by cancel(); only release the loop handle
+        enqueueCompletion(task);
+        return;
+    }
+    if (task->deadlineMs > 0 && EventLoop::nowMs() > task->deadlineMs) {
+        // Stale: shed it without running
+        task->hasError = true;
+        task->errorMessage = "Deferred deadline exceeded";
+        enqueueCompletion(task);
+        return;
+    }
     
-    try {
-        // Deserialize function from bytecode
-        JSValue func = JS_ReadObject(workerCtx, task->serializedFunc, task->serializedFuncSize, JS_READ_OBJ_BYTECODE);
+    // Pre-warmed runtime owned by this worker (see WorkerRuntimePool)
+    JSContext* workerCtx = WorkerRuntimePool::acquire();
+    if (!workerCtx) {
+        task->hasError = true;
+        task->errorMessage = "Failed to create worker thread context";
+        enqueueCompletion(task);
+        return;
+    }
+    
+    {
+        // Count the task on every exit path; the runtime may be recycled
+        // then, after all worker values have been freed
+        struct TaskScope {
+            ~TaskScope() { WorkerRuntimePool::release(); }
+        } taskScope;
         
-        if (JS_IsException(func)) {
-            // Deserialization failed - func is the exception
+        try {
+            runInWorker(workerCtx, *task);
+        } catch (const std::exception& e) {
             task->hasError = true;
-            const char* errStr = JS_ToCString(workerCtx, func);
-            std::string errorMsg = errStr ? errStr : "Failed to deserialize function";
-            JS_FreeCString(workerCtx, errStr);
+            task->errorMessage = e.what();
+        }
+    }
+    
+    // Schedule result handling in main thread
+    enqueueCompletion(task);
+}
+
+void Deferred::runInWorker(JSContext* workerCtx, DeferredTask& task) {
+    // Reuse the function if this worker has already deserialized it
+    JSValue func = loadFunction(workerCtx, *task.bytecode);
+    if (JS_IsException(func)) {
+        task.hasError = true;
+        task.errorMessage = takeExceptionMessage(workerCtx, "Failed to deserialize function");
+        return;
+    }
+    
+    // Arguments passed to the constructor
+    std::vector<JSValue> args;
+    if (task.serializedArgs) {
+        JSValue argsArray = JS_ReadObject(workerCtx, task.serializedArgs->data(),
+                                          task.serializedArgs->size(), JS_READ_OBJ_BYTECODE);
+        if (JS_IsException(argsArray)) {
             JS_FreeValue(workerCtx, func);
-            
-            EventLoop::getInstance().enqueueCallback([task, errorMsg]() {
-                JSContext* ctx = task->mainJSContext;
-                JSValue error = JS_NewString(ctx, errorMsg.c_str());
-                JSValue rejectArgs[] = { error };
-                JSValue rejectResult = JS_Call(ctx, task->reject, JS_UNDEFINED, 1, rejectArgs);
-                JS_FreeValue(ctx, rejectResult);
-                JS_FreeValue(ctx, error);
-            });
+            task.hasError = true;
+            task.errorMessage = takeExceptionMessage(workerCtx, "Failed to deserialize arguments");
             return;
         }
+        int64_t count = getArrayLength(workerCtx, argsArray);
+        for (int64_t i = 0; i < count; ++i) {
+            args.push_back(JS_GetPropertyUint32(workerCtx, argsArray, static_cast<uint32_t>(i)));
+        }
+        JS_FreeValue(workerCtx, argsArray);
         
-        // If the deserialized object is a bytecode function, we may need to evaluate it
-        // However, JS_ReadObject with JS_READ_OBJ_BYTECODE should return a callable function directly
-        // So we can call it directly with JS_Call
-        
-        // Execute the function
-        // The function should be called with no arguments
-        JSValue result = JS_Call(workerCtx, func, JS_UNDEFINED, 0, nullptr);
-        
-        if (JS_IsException(result)) {
-            // Execution failed - result is the exception
-            task->hasError = true;
-            
-            // Serialize the exception
-            size_t errorSize = 0;
-            uint8_t* serializedError = JS_WriteObject(workerCtx, &errorSize, result, JS_WRITE_OBJ_BYTECODE);
-            JS_FreeValue(workerCtx, result);
-            
-            if (serializedError && errorSize > 0) {
-                // Copy error buffer to main runtime memory
-                uint8_t* copiedError = static_cast<uint8_t*>(js_malloc_rt(task->rt, errorSize));
-                if (copiedError) {
-                    memcpy(copiedError, serializedError, errorSize);
-                    js_free(workerCtx, serializedError);
-                    task->serializedResult = copiedError;
-                    task->serializedResultSize = errorSize;
-                    task->hasError = true;
-                } else {
-                    // Failed to allocate - fallback to error message
-                    js_free(workerCtx, serializedError);
-                    const char* errStr = "Function execution failed (serialization error)";
-                    std::string errorMsg = errStr;
-                    
-                    EventLoop::getInstance().enqueueCallback([task, errorMsg]() {
-                        JSContext* ctx = task->mainJSContext;
-                        JSValue error = JS_NewString(ctx, errorMsg.c_str());
-                        JSValue rejectArgs[] = { error };
-                        JSValue rejectResult = JS_Call(ctx, task->reject, JS_UNDEFINED, 1, rejectArgs);
-                        JS_FreeValue(ctx, rejectResult);
-                        JS_FreeValue(ctx, error);
-                    });
-                }
-            } else {
-                // Fallback: create error message
-                const char* errStr = "Function execution failed (serialization error)";
-                std::string errorMsg = errStr;
-                
-                EventLoop::getInstance().enqueueCallback([task, errorMsg]() {
-                    JSContext* ctx = task->mainJSContext;
-                    JSValue error = JS_NewString(ctx, errorMsg.c_str());
-                    JSValue rejectArgs[] = { error };
-                    JSValue rejectResult = JS_Call(ctx, task->reject, JS_UNDEFINED, 1, rejectArgs);
-                    JS_FreeValue(ctx, rejectResult);
-                    JS_FreeValue(ctx, error);
-                });
+        // Transferred buffers fill their holes; the worker owns them now
+        for (auto& [index, buffer] : task.transferredArgs) {
+            if (index < args.size()) {
+                JS_FreeValue(workerCtx, args[index]);
+                args[index] = buffer->adopt(workerCtx);
             }
+        }
+        task.transferredArgs.clear();
+    }
+    
+    // cancel() interrupts the call through the runtime's interrupt handler
+    WorkerRuntimePool::setInterruptFlag(&task.cancelled);
+    JSValue result = JS_Call(workerCtx, func, JS_UNDEFINED, static_cast<int>(args.size()), args.data());
+    WorkerRuntimePool::setInterruptFlag(nullptr);
+    for (JSValue& arg : args) {
+        JS_FreeValue(workerCtx, arg);
+    }
+    JS_FreeValue(workerCtx, func);
+    
+    if (JS_IsException(result)) {
+        task.hasError = true;
+        JSValue exception = JS_GetException(workerCtx);
+        // Error objects do not serialize; they cross over as their message
+        if (JS_IsError(workerCtx, exception) || !serializeValue(workerCtx, exception, task.serializedResult)) {
+            JSValue message = JS_IsError(workerCtx, exception)
+                ? JS_GetPropertyStr(workerCtx, exception, "message")
+                : JS_DupValue(workerCtx, exception);
+            const char* str = JS_ToCString(workerCtx, message);
+            task.errorMessage = str ? str : "Function execution failed";
+            JS_FreeCString(workerCtx, str);
+            JS_FreeValue(workerCtx, message);
+        }
+        JS_FreeValue(workerCtx, exception);
+        return;
+    }
+    
+    if (TransferableBuffer::isArrayBuffer(workerCtx, result)) {
+        // Move the backing store to the main thread instead of serializing
+        auto buffer = std::make_shared<TransferableBuffer>();
+        if (buffer->take(workerCtx, result)) {
+            task.transferredResult = std::move(buffer);
         } else {
-            // Serialize the result
-            size_t resultSize = 0;
-            uint8_t* serializedResult = JS_WriteObject(workerCtx, &resultSize, result, JS_WRITE_OBJ_BYTECODE);
-            JS_FreeValue(workerCtx, result);
-            
-            if (serializedResult && resultSize > 0) {
-                // Copy the serialized result to main runtime's memory
-                // The buffer from JS_WriteObject is allocated in worker runtime
-                // We need to copy it to main runtime's memory for thread safety
-                uint8_t* copiedResult = static_cast<uint8_t*>(js_malloc_rt(task->rt, resultSize));
-                if (copiedResult) {
-                    memcpy(copiedResult, serializedResult, resultSize);
-                    // Free original buffer (from worker runtime)
-                    js_free(workerCtx, serializedResult);
-                    // Store copied buffer
-                    task->serializedResult = copiedResult;
-                    task->serializedResultSize = resultSize;
-                    task->hasError = false;
-                } else {
-                    // Failed to allocate in main runtime
-                    js_free(workerCtx, serializedResult);
-                    task->hasError = false;
-                    task->serializedResult = nullptr;
-                    task->serializedResultSize = 0;
-                }
-            } else {
-                // Serialization failed - fallback to undefined
-                task->hasError = false;
-                task->serializedResult = nullptr;
-                task->serializedResultSize = 0;
-            }
+            JS_FreeValue(workerCtx, JS_GetException(workerCtx));
         }
-        
-        JS_FreeValue(workerCtx, func);
-        
-        // Schedule result handling in main thread
-        EventLoop::getInstance().enqueueCallback([task]() {
-            JSContext* ctx = task->mainJSContext;
-            
-            if (task->hasError) {
-                // Deserialize and reject
-                if (task->serializedResult && task->serializedResultSize > 0) {
-                    JSValue error = JS_ReadObject(ctx, task->serializedResult, task->serializedResultSize, JS_READ_OBJ_BYTECODE);
-                    if (!JS_IsException(error)) {
-                        JSValue rejectArgs[] = { error };
-                        JSValue rejectResult = JS_Call(ctx, task->reject, JS_UNDEFINED, 1, rejectArgs);
-                        JS_FreeValue(ctx, rejectResult);
-                        JS_FreeValue(ctx, error);
-                    } else {
-                        // Fallback error
-                        JSValue fallbackError = JS_NewString(ctx, "Function execution failed");
-                        JSValue rejectArgs[] = { fallbackError };
-                        JSValue rejectResult = JS_Call(ctx, task->reject, JS_UNDEFINED, 1, rejectArgs);
-                        JS_FreeValue(ctx, rejectResult);
-                        JS_FreeValue(ctx, fallbackError);
-                    }
-                } else {
-                    JSValue error = JS_NewString(ctx, "Function execution failed");
-                    JSValue rejectArgs[] = { error };
-                    JSValue rejectResult = JS_Call(ctx, task->reject, JS_UNDEFINED, 1, rejectArgs);
-                    JS_FreeValue(ctx, rejectResult);
-                    JS_FreeValue(ctx, error);
-                }
-            } else {
-                // Deserialize and resolve
-                if (task->serializedResult && task->serializedResultSize > 0) {
-                    JSValue result = JS_ReadObject(ctx, task->serializedResult, task->serializedResultSize, JS_READ_OBJ_BYTECODE);
-                    if (!JS_IsException(result)) {
-                        JSValue resolveArgs[] = { result };
-                        JSValue resolveResult = JS_Call(ctx, task->resolve, JS_UNDEFINED, 1, resolveArgs);
-                        JS_FreeValue(ctx, resolveResult);
-                        JS_FreeValue(ctx, result);
-                    } else {
-                        // Fallback: resolve with undefined
-                        JSValue undefined = JS_UNDEFINED;
-                        JSValue resolveArgs[] = { undefined };
-                        JSValue resolveResult = JS_Call(ctx, task->resolve, JS_UNDEFINED, 1, resolveArgs);
-                        JS_FreeValue(ctx, resolveResult);
-                    }
-                } else {
-                    // No result - resolve with undefined
-                    JSValue undefined = JS_UNDEFINED;
-                    JSValue resolveArgs[] = { undefined };
-                    JSValue resolveResult = JS_Call(ctx, task->resolve, JS_UNDEFINED, 1, resolveArgs);
-                    JS_FreeValue(ctx, resolveResult);
-                }
-            }
-            
-            // Free serialized result buffer (allocated in main runtime memory)
-            if (task->serializedResult) {
-                js_free_rt(task->rt, task->serializedResult);
-                task->serializedResult = nullptr;
-                task->serializedResultSize = 0;
-            }
-        });
-        
-    } catch (const std::exception& e) {
-        std::string errorMessage = e.what();
-        EventLoop::getInstance().enqueueCallback([task, errorMessage]() {
-            JSContext* ctx = task->mainJSContext;
-            JSValue error = JS_NewString(ctx, errorMessage.c_str());
-            JSValue rejectArgs[] = { error };
-            JSValue rejectResult = JS_Call(ctx, task->reject, JS_UNDEFINED, 1, rejectArgs);
-            JS_FreeValue(ctx, rejectResult);
-            JS_FreeValue(ctx, error);
-        });
+    } else if (!serializeValue(workerCtx, result, task.serializedResult)) {
+        task.hasError = true;
+        task.errorMessage = "Deferred: Result not serializable";
     }
+    JS_FreeValue(workerCtx, result);
 }
 
-// Old executeTask removed - using executeTaskInMainThread instead
-
 } // namespace protojs
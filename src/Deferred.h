@@ -6,11 +6,29 @@
 #include "CPUThreadPool.h"
 #include "EventLoop.h"
 #include <functional>
+#include <atomic>
 #include <memory>
+#include <vector>
+#include <string>
+#include <utility>
+#include <cstdint>
 
 namespace protojs {
 
 class JSContextWrapper;
+class TransferableBuffer;
+
+/**
+ * @brief Serialized bytecode of a Deferred function, shared by every task
+ *        that dispatches the same function.
+ *
+ * Immutable once created. The id identifies the bytecode in the per-worker
+ * function caches (see WorkerRuntimePool::getCachedFunction).
+ */
+struct DeferredBytecode {
+    uint64_t id;
+    std::vector<uint8_t> data;
+};
 
 /**
  * @brief Lightweight task that executes in CPU thread pool.
@@ -22,53 +40,126 @@ class Deferred {
 public:
     static void init(JSContext* ctx, JSContextWrapper* wrapper);
 
+    /**
+     * @brief Release the functions of ctx held by the bytecode cache; called
+     *        before the context is freed.
+     */
+    static void cleanup(JSContext* ctx);
+
 private:
+    // Parsed Deferred.options() argument
+    struct TaskOptions {
+        TaskPriority priority = TaskPriority::Normal;
+        uint64_t timeoutMs = 0;              // Queueing deadline relative to creation (0 = none)
+    };
+    
     // Lightweight task structure (not a full ProtoThread)
     struct DeferredTask {
-        JSValue func;                    // Function from main context (for reference)
-        uint8_t* serializedFunc;        // Serialized function bytecode buffer
-        size_t serializedFuncSize;      // Size of serialized buffer
-        JSValue resolve;
+        std::shared_ptr<const DeferredBytecode> bytecode;  // Cached serialized function
+        std::shared_ptr<const std::vector<uint8_t>> serializedArgs;  // Arguments as one array (may be null)
+        std::vector<std::pair<uint32_t, std::shared_ptr<TransferableBuffer>>> transferredArgs;  // Moved ArrayBuffers by argument index
+        JSValue resolve;                 // Promise resolving functions, freed once settled
         JSValue reject;
         JSContext* mainJSContext;  // Main thread context (for callbacks)
         JSRuntime* rt;              // Shared runtime
         proto::ProtoSpace* space;
         JSContextWrapper* wrapper;
         
-        // Promise state
-        JSValue result = JS_UNDEFINED;
-        JSValue error = JS_UNDEFINED;
-        bool isResolved = false;
-        bool isRejected = false;
-        JSValue thenCallback = JS_UNDEFINED;
-        JSValue catchCallback = JS_UNDEFINED;
-        
         // Result from worker thread
-        uint8_t* serializedResult = nullptr;  // Serialized result buffer
-        size_t serializedResultSize = 0;     // Size of result buffer
+        std::vector<uint8_t> serializedResult;  // Serialized result, or thrown non-Error value
+        std::string errorMessage;               // Failure without a serialized value
+        std::shared_ptr<TransferableBuffer> transferredResult;  // Result ArrayBuffer moved from the worker
         bool hasError = false;                // Whether execution resulted in error
+        bool loopRefReleased = false;         // EventLoop handle released (main thread only)
         
-        DeferredTask(JSContext* ctx, JSValue f, uint8_t* serialized, size_t serializedSize,
-                     JSValue res, JSValue rej, JSRuntime* runtime, proto::ProtoSpace* s, JSContextWrapper* w)
-            : func(f), serializedFunc(serialized), serializedFuncSize(serializedSize),
-              resolve(res), reject(rej), mainJSContext(ctx), 
-              rt(runtime), space(s), wrapper(w) {}
+        // Scheduling
+        std::atomic<bool> cancelled{false};   // Checked by the worker and its interrupt handler
+        bool settled = false;                 // Promise resolved or rejected (main thread only)
+        TaskPriority priority = TaskPriority::Normal;
+        uint64_t deadlineMs = 0;              // EventLoop::nowMs() after which a queued task is dropped (0 = none)
         
-        ~DeferredTask() {
-            // Free serialized buffers (allocated with js_malloc_rt)
-            if (serializedFunc) {
-                js_free_rt(rt, serializedFunc);
-            }
-            if (serializedResult) {
-                js_free_rt(rt, serializedResult);
-            }
-        }
+        DeferredTask(JSContext* ctx, std::shared_ptr<const DeferredBytecode> code, JSValue res, JSValue rej,
+                     JSRuntime* runtime, proto::ProtoSpace* s, JSContextWrapper* w)
+            : bytecode(std::move(code)), resolve(res), reject(rej), mainJSContext(ctx),
+              rt(runtime), space(s), wrapper(w) {}
+    };
+    
+    // State of one Deferred.map() call. Each chunk slot is written by the
+    // worker running that chunk and read on the main thread after its
+    // completion; everything else is main thread only.
+    struct MapJob {
+        JSContext* mainJSContext;
+        std::shared_ptr<const DeferredBytecode> bytecode;
+        JSValue resolve;                 // Promise capability
+        JSValue reject;
+        size_t length;
+        size_t chunkSize;
+        size_t pendingChunks;
+        bool settled = false;
+        std::vector<std::vector<uint8_t>> chunkResults;  // Serialized result array per chunk
+        std::vector<std::string> chunkErrors;            // Error message per failed chunk
     };
     
     static JSValue constructor(JSContext* ctx, JSValueConst new_target, int argc, JSValueConst* argv);
+    
+    /**
+     * @brief Deferred.transfer(arrayBuffer): mark a constructor argument to
+     *        be moved to the worker instead of copied. The buffer is detached
+     *        when the Deferred is created.
+     */
+    static JSValue transfer(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    static void transferFinalizer(JSRuntime* rt, JSValue val);
+    
+    /**
+     * @brief Deferred.map(array, fn, {chunkSize}): apply fn(element, index)
+     *        to every element across CPU pool workers.
+     *
+     * Returns a promise of the results in input order; it rejects with the
+     * first error thrown by fn.
+     */
+    static JSValue map(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
     static void finalizer(JSRuntime* rt, JSValue val);
-    static JSValue then(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
-    static JSValue catch_(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    
+    /**
+     * @brief deferred.cancel(): drop the task if still queued, interrupt it
+     *        if running, and reject it. Returns false if already settled.
+     *
+     * Bound to each Deferred with the task holder as function data.
+     */
+    static JSValue cancel(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv,
+                          int magic, JSValue* func_data);
+    
+    /**
+     * @brief Deferred.options({priority, deadline}): scheduling options,
+     *        accepted as the last constructor argument.
+     *
+     * priority is "high", "normal" or "low" (CPU pool lanes); deadline is in
+     * milliseconds, after which a task that has not started is rejected
+     * without running.
+     */
+    static JSValue options(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    static void optionsFinalizer(JSRuntime* rt, JSValue val);
+    
+    /**
+     * @brief Resolve or reject the task's promise with value, which is
+     *        consumed, and release the resolving functions (main thread only).
+     */
+    static void settle(DeferredTask& task, bool fulfilled, JSValue value);
+    
+    /**
+     * @brief Deferred.stats(): {functionsSerialized}, the number of
+     *        JS_WriteObject calls made for dispatched functions.
+     */
+    static JSValue stats(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    
+    /**
+     * @brief Serialized bytecode of a function, shared with earlier tasks
+     *        that dispatched the same function object or identical bytecode.
+     *
+     * Only the first dispatch of a function object serializes it. Returns
+     * nullptr (with no exception set) if the function cannot be serialized.
+     */
+    static std::shared_ptr<const DeferredBytecode> getBytecode(JSContext* ctx, JSValueConst func);
     
     /**
      * @brief Execute a Deferred task in worker thread using bytecode transfer.
@@ -80,10 +171,43 @@ private:
     /**
      * @brief Worker thread execution function.
      * 
-     * Deserializes function, executes it, and serializes result.
+     * Drops cancelled and stale tasks, runs the rest on the worker runtime,
+     * and schedules the completion.
      */
     static void workerThreadExecution(std::shared_ptr<DeferredTask> task);
     
+    /**
+     * @brief Deserialize, call and serialize on a worker context, recording
+     *        the outcome in the task.
+     */
+    static void runInWorker(JSContext* workerCtx, DeferredTask& task);
+    
+    /**
+     * @brief Worker side of one Deferred.map() chunk.
+     */
+    static void executeMapChunk(std::shared_ptr<MapJob> job, size_t chunkIndex,
+                                std::shared_ptr<const std::vector<uint8_t>> chunk);
+    
+    /**
+     * @brief Main thread side of one Deferred.map() chunk: settles the
+     *        promise on the first error or once every chunk is done.
+     */
+    static void completeMapChunk(std::shared_ptr<MapJob> job, size_t chunkIndex);
+    
+    /**
+     * @brief Schedule the completion of a task on the main thread.
+     * 
+     * Releases the EventLoop handle taken in executeTaskInWorkerThread, so the
+     * loop can exit when no Deferred is pending, and settles the promise
+     * unless cancel() already did.
+     */
+    static void enqueueCompletion(std::shared_ptr<DeferredTask> task);
+    
+    /**
+     * @brief Settle the promise from the outcome recorded by the worker.
+     */
+    static void completeTask(DeferredTask& task);
+    
     /**
      * @brief Helper to get JSContextWrapper from JSContext opaque data.
      */
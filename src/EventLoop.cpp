@@ -1,34 +1,101 @@
 #include "EventLoop.h"
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
 
 namespace protojs {
 
 EventLoop EventLoop::instance;
 
+namespace {
+thread_local EventLoop* threadLoop = nullptr;
+} // namespace
+
+EventLoop::EventLoop() : timers(nowMs()) {
+#ifdef __linux__
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd >= 0 && wakeFd >= 0) {
+        struct epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.fd = wakeFd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev) < 0) {
+            close(wakeFd);
+            close(epollFd);
+            wakeFd = -1;
+            epollFd = -1;
+        }
+    } else {
+        // Fall back to condition-variable wakeups
+        if (wakeFd >= 0) close(wakeFd);
+        if (epollFd >= 0) close(epollFd);
+        wakeFd = -1;
+        epollFd = -1;
+    }
+#endif
+}
+
+EventLoop::~EventLoop() {
+    while (CallbackNode* node = callbackQueue.pop()) {
+        delete node;
+    }
+#ifdef __linux__
+    if (wakeFd >= 0) close(wakeFd);
+    if (epollFd >= 0) close(epollFd);
+#endif
+}
+
 EventLoop& EventLoop::getInstance() {
-    return instance;
+    return threadLoop ? *threadLoop : instance;
 }
 
-void EventLoop::enqueueCallback(std::function<void()> callback) {
-    {
-        std::lock_guard<std::mutex> lock(queueMutex);
-        callbackQueue.push(std::move(callback));
+void EventLoop::bindThread(EventLoop* loop) {
+    threadLoop = loop;
+}
+
+void EventLoop::enqueueCallback(Callback callback) {
+    CallbackNode* node = new CallbackNode();
+    node->callback = std::move(callback);
+    callbackQueue.push(node);
+    pendingCallbacks.fetch_add(1);
+
+    // One wakeup per drain: later producers see the flag already set
+    if (!wakeupPending.exchange(true)) {
+        wakeup();
     }
-    condition.notify_one();
 }
 
 void EventLoop::processCallbacks() {
-    std::queue<std::function<void()>> callbacksToProcess;
-    
-    {
-        std::lock_guard<std::mutex> lock(queueMutex);
-        callbacksToProcess.swap(callbackQueue);
+    if (!running) {
+        // Called directly rather than from run(): each call is its own tick
+        beginTick();
     }
-    
-    while (!callbacksToProcess.empty()) {
-        auto callback = callbacksToProcess.front();
-        callbacksToProcess.pop();
-        
+
+    // Producers enqueueing from here on owe us a new wakeup
+    wakeupPending.store(false);
+
+    // Bound the batch so callbacks that enqueue more cannot starve other phases
+    int64_t batch = pendingCallbacks.load();
+    for (int64_t i = 0; i < batch; ++i) {
+        CallbackNode* node = callbackQueue.pop();
+        if (!node) {
+            // A producer is mid-push; it will wake us once linked
+            break;
+        }
+        pendingCallbacks.fetch_sub(1);
+
+        Callback callback = std::move(node->callback);
+        delete node;
+
         try {
             callback();
         } catch (const std::exception& e) {
@@ -37,36 +104,316 @@ void EventLoop::processCallbacks() {
         } catch (...) {
             std::cerr << "Unknown exception in event loop callback" << std::endl;
         }
+
+        runMicrotasks();
     }
 }
 
 void EventLoop::run() {
     running = true;
-    
+
     while (running) {
-        std::unique_lock<std::mutex> lock(queueMutex);
-        
-        condition.wait(lock, [this] {
-            return !callbackQueue.empty() || !running;
-        });
-        
-        if (!running && callbackQueue.empty()) {
+        beginTick();
+        // Jobs left by top-level script evaluation or the previous tick
+        runMicrotasks();
+
+        timers.advance(nowMs());
+        runMicrotasks();
+        processCallbacks();
+        runImmediates();
+
+        if (!running || !isAlive()) {
             break;
         }
-        
-        lock.unlock();
-        processCallbacks();
+
+        // Work queued by the callbacks we just ran is handled without blocking
+        if (hasPendingCallbacks() || !immediates.empty() || microtasksPending) {
+            continue;
+        }
+
+        int timeout = computePollTimeout();
+        if (timeout != 0 && runIdle()) {
+            // Idle work left: only check for I/O before the next slice
+            timeout = 0;
+        }
+        pollIO(timeout);
     }
+
+    running = false;
 }
 
 void EventLoop::stop() {
     running = false;
-    condition.notify_all();
+    wakeup();
 }
 
 bool EventLoop::hasPendingCallbacks() const {
-    std::lock_guard<std::mutex> lock(queueMutex);
-    return !callbackQueue.empty();
+    return pendingCallbacks.load() > 0;
+}
+
+void EventLoop::ref() {
+    activeHandles.fetch_add(1);
+}
+
+void EventLoop::unref() {
+    size_t current = activeHandles.load();
+    while (current > 0 && !activeHandles.compare_exchange_weak(current, current - 1)) {
+    }
+    if (current == 1) {
+        // Last handle released: let a blocked run() re-check liveness
+        wakeup();
+    }
+}
+
+bool EventLoop::isAlive() const {
+    return activeHandles.load() > 0 || timers.refCount() > 0 || !immediates.empty() ||
+           microtasksPending || hasPendingCallbacks();
+}
+
+uint64_t EventLoop::nowMs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint64_t EventLoop::setImmediate(std::function<void()> callback) {
+    uint64_t id = nextImmediateId++;
+    immediates.emplace(id, std::move(callback));
+    return id;
+}
+
+bool EventLoop::clearImmediate(uint64_t id) {
+    return immediates.erase(id) > 0;
+}
+
+void EventLoop::clearTimers() {
+    timers.clear();
+    immediates.clear();
+}
+
+void EventLoop::runImmediates() {
+    // Immediates queued while this phase runs wait for the next iteration
+    const uint64_t limit = nextImmediateId;
+    while (!immediates.empty() && immediates.begin()->first < limit) {
+        auto callback = std::move(immediates.begin()->second);
+        immediates.erase(immediates.begin());
+
+        try {
+            callback();
+        } catch (const std::exception& e) {
+            std::cerr << "Exception in immediate callback: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "Unknown exception in immediate callback" << std::endl;
+        }
+
+        runMicrotasks();
+    }
+}
+
+void EventLoop::setMicrotaskRunner(MicrotaskRunner runner) {
+    microtaskRunner = std::move(runner);
+    microtasksPending = false;
+}
+
+void EventLoop::setIdleHandler(IdleHandler handler) {
+    idleHandler = std::move(handler);
+}
+
+bool EventLoop::runIdle() {
+    if (!idleHandler || idleSliceUs == 0) {
+        return false;
+    }
+    try {
+        return idleHandler(idleSliceUs);
+    } catch (const std::exception& e) {
+        std::cerr << "Exception in idle handler: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unknown exception in idle handler" << std::endl;
+    }
+    return false;
+}
+
+void EventLoop::beginTick() {
+    microtaskBudgetLeft = microtaskBudget;
+}
+
+size_t EventLoop::runMicrotasks() {
+    if (!microtaskRunner || drainingMicrotasks) {
+        return 0;
+    }
+
+    size_t budget = microtaskBudget == 0 ? SIZE_MAX : microtaskBudgetLeft;
+    if (budget == 0) {
+        // Out of budget for this tick; the next iteration continues the drain
+        microtasksPending = true;
+        return 0;
+    }
+
+    drainingMicrotasks = true;
+    size_t executed = 0;
+    try {
+        executed = microtaskRunner(budget);
+    } catch (const std::exception& e) {
+        std::cerr << "Exception in microtask runner: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unknown exception in microtask runner" << std::endl;
+    }
+    drainingMicrotasks = false;
+
+    if (microtaskBudget != 0) {
+        microtaskBudgetLeft -= std::min(executed, microtaskBudgetLeft);
+    }
+    // A runner that used its whole budget may have stopped with jobs left
+    microtasksPending = executed >= budget;
+    microtasksExecuted.fetch_add(executed, std::memory_order_relaxed);
+    return executed;
+}
+
+int EventLoop::computePollTimeout() const {
+    int64_t timeout = timers.nextTimeoutMs(nowMs());
+    if (timeout < 0) {
+        return -1;
+    }
+    return static_cast<int>(std::min<int64_t>(timeout, INT_MAX));
+}
+
+bool EventLoop::watchFd(int fd, uint32_t events, IOCallback callback) {
+#ifdef __linux__
+    if (epollFd < 0 || fd < 0) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(watchersMutex);
+    if (fdWatchers.count(fd)) {
+        return false;
+    }
+
+    struct epoll_event ev = {};
+    ev.events = events;
+    ev.data.fd = fd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        return false;
+    }
+
+    fdWatchers[fd] = std::make_shared<IOCallback>(std::move(callback));
+    ref();
+    return true;
+#else
+    (void)fd;
+    (void)events;
+    (void)callback;
+    return false;
+#endif
+}
+
+bool EventLoop::modifyFd(int fd, uint32_t events) {
+#ifdef __linux__
+    std::lock_guard<std::mutex> lock(watchersMutex);
+    if (epollFd < 0 || !fdWatchers.count(fd)) {
+        return false;
+    }
+
+    struct epoll_event ev = {};
+    ev.events = events;
+    ev.data.fd = fd;
+    return epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &ev) == 0;
+#else
+    (void)fd;
+    (void)events;
+    return false;
+#endif
+}
+
+void EventLoop::unwatchFd(int fd) {
+#ifdef __linux__
+    {
+        std::lock_guard<std::mutex> lock(watchersMutex);
+        auto it = fdWatchers.find(fd);
+        if (it == fdWatchers.end()) {
+            return;
+        }
+        fdWatchers.erase(it);
+        if (epollFd >= 0) {
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        }
+    }
+    unref();
+#else
+    (void)fd;
+#endif
+}
+
+void EventLoop::wakeup() {
+#ifdef __linux__
+    if (wakeFd >= 0) {
+        uint64_t one = 1;
+        ssize_t n = write(wakeFd, &one, sizeof(one));
+        (void)n; // EAGAIN means the counter is already non-zero, which is enough
+        return;
+    }
+#endif
+    {
+        // Serialize with the waiter's predicate check so the notify is not lost
+        std::lock_guard<std::mutex> lock(queueMutex);
+    }
+    condition.notify_all();
+}
+
+void EventLoop::pollIO(int timeoutMs) {
+#ifdef __linux__
+    if (epollFd >= 0) {
+        struct epoll_event events[64];
+        int n = epoll_wait(epollFd, events, 64, timeoutMs);
+        if (n < 0) {
+            if (errno != EINTR) {
+                std::cerr << "EventLoop: epoll_wait failed (errno " << errno << ")" << std::endl;
+            }
+            return;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wakeFd) {
+                uint64_t count;
+                while (read(wakeFd, &count, sizeof(count)) > 0) {
+                }
+                continue;
+            }
+
+            std::shared_ptr<IOCallback> callback;
+            {
+                std::lock_guard<std::mutex> lock(watchersMutex);
+                auto it = fdWatchers.find(fd);
+                if (it != fdWatchers.end()) {
+                    callback = it->second;
+                }
+            }
+            if (!callback) {
+                continue; // Unwatched by an earlier callback in this batch
+            }
+
+            try {
+                (*callback)(events[i].events);
+            } catch (const std::exception& e) {
+                std::cerr << "Exception in event loop I/O callback: " << e.what() << std::endl;
+            } catch (...) {
+                std::cerr << "Unknown exception in event loop I/O callback" << std::endl;
+            }
+
+            runMicrotasks();
+        }
+        return;
+    }
+#endif
+
+    std::unique_lock<std::mutex> lock(queueMutex);
+    auto ready = [this] {
+        return pendingCallbacks.load() > 0 || !running || activeHandles.load() == 0;
+    };
+    if (timeoutMs < 0) {
+        condition.wait(lock, ready);
+    } else {
+        condition.wait_for(lock, std::chrono::milliseconds(timeoutMs), ready);
+    }
 }
 
 } // namespace protojs
@@ -2,68 +2,316 @@
 #define PROTOJS_EVENTLOOP_H
 
 #include <functional>
-#include <queue>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <map>
+#include <cstdint>
+#include "TimerWheel.h"
+#include "InlineCallback.h"
+#include "MPSCQueue.h"
 
 namespace protojs {
 
 /**
  * @brief Event loop for processing callbacks from Deferred and I/O operations.
- * 
+ *
  * All callbacks are executed on the main thread to ensure thread safety
  * when interacting with JavaScript context.
+ *
+ * On Linux the loop is an epoll reactor: enqueueCallback() wakes it through
+ * an eventfd, and file descriptors registered with watchFd() are dispatched
+ * from the same blocking wait. The loop stays alive while callbacks are
+ * queued or handles (sockets, timers, pending Deferreds) are referenced.
+ *
+ * Each iteration runs expired timers, queued callbacks and immediates, then
+ * blocks until the next timer deadline or I/O readiness. Timers and
+ * immediates are main-thread only.
+ *
+ * The microtask queue (Promise jobs) is drained after every macrotask
+ * through a runner installed by the JS context, bounded by a per-iteration
+ * budget so a self-rescheduling promise chain cannot starve I/O.
+ *
+ * When an iteration is about to block, an idle handler may run one bounded
+ * slice of background work (GCBridge root scanning). While it reports more
+ * work the poll does not block, so I/O and timers are still serviced
+ * between slices. Idle work does not keep the loop alive.
+ *
+ * The process-wide loop belongs to the main thread. A thread that serves
+ * its own JS runtime (server shards) may create a private loop and bind it
+ * with bindThread(), after which getInstance() on that thread returns it.
  */
 class EventLoop {
 public:
     /**
-     * @brief Get the singleton instance of EventLoop.
+     * @brief Callback invoked on the main thread when a watched fd is ready.
+     * @param events Ready event mask (EPOLLIN, EPOLLOUT, ...)
+     */
+    using IOCallback = std::function<void(uint32_t events)>;
+
+    /**
+     * @brief Completion callback; small lambdas are stored without allocating.
+     */
+    using Callback = InlineCallback;
+
+    /**
+     * @brief Runs up to 'budget' pending microtasks and returns how many ran.
+     */
+    using MicrotaskRunner = std::function<size_t(size_t budget)>;
+
+    /**
+     * @brief Runs background work for at most budgetUs microseconds and
+     *        returns true if work is left.
+     */
+    using IdleHandler = std::function<bool(uint64_t budgetUs)>;
+
+    /**
+     * @brief Default time budget of one idle slice, in microseconds.
+     */
+    static constexpr uint64_t DEFAULT_IDLE_SLICE_US = 1000;
+
+    /**
+     * @brief Default number of microtasks run per loop iteration.
+     */
+    static constexpr size_t DEFAULT_MICROTASK_BUDGET = 10000;
+
+    /**
+     * @brief Loop of the calling thread: the one bound with bindThread(),
+     *        or the process-wide main loop.
      */
     static EventLoop& getInstance();
-    
+
+    /**
+     * @brief Make getInstance() return loop on the calling thread; nullptr
+     *        restores the main loop. The loop must outlive the binding.
+     */
+    static void bindThread(EventLoop* loop);
+
+    /**
+     * @brief Create a private loop, e.g. for a thread passed to bindThread().
+     */
+    EventLoop();
+    ~EventLoop();
+
     /**
      * @brief Enqueue a callback to be executed on the main thread.
      * @param callback Function to execute
+     *
+     * Safe to call from any thread and lock-free. Only the first enqueue
+     * after the loop starts draining writes the wakeup eventfd, so a burst
+     * of completions costs one syscall.
      */
-    void enqueueCallback(std::function<void()> callback);
-    
+    void enqueueCallback(Callback callback);
+
     /**
-     * @brief Process all pending callbacks.
-     * 
-     * Should be called from the main thread periodically or in a loop.
+     * @brief Process the callbacks queued when the call starts.
+     *
+     * Must be called from a single consumer thread (the main thread);
+     * callbacks queued meanwhile are left for the next call.
      */
     void processCallbacks();
-    
+
     /**
-     * @brief Run the event loop until stopped.
-     * 
-     * Blocks until stop() is called.
+     * @brief Run the event loop on the calling thread.
+     *
+     * Blocks waiting for callbacks and fd readiness, and returns when
+     * stop() is called or no callbacks and no referenced handles remain.
      */
     void run();
-    
+
     /**
      * @brief Stop the event loop.
      */
     void stop();
-    
+
     /**
      * @brief Check if there are pending callbacks.
      */
     bool hasPendingCallbacks() const;
 
+    /**
+     * @brief Register an outstanding handle that keeps run() alive.
+     *
+     * Every ref() must be balanced by exactly one unref().
+     */
+    void ref();
+
+    /**
+     * @brief Release a handle registered with ref().
+     */
+    void unref();
+
+    /**
+     * @brief Number of currently referenced handles.
+     */
+    size_t getActiveHandles() const { return activeHandles.load(); }
+
+    /**
+     * @brief True while callbacks are queued or handles are referenced.
+     */
+    bool isAlive() const;
+
+    /**
+     * @brief Watch a file descriptor for readiness.
+     * @param fd Descriptor to watch (not owned by the loop)
+     * @param events epoll event mask
+     * @param callback Invoked on the main thread with the ready mask
+     * @return false if the fd could not be registered
+     *
+     * A watched fd counts as a referenced handle until unwatchFd().
+     */
+    bool watchFd(int fd, uint32_t events, IOCallback callback);
+
+    /**
+     * @brief Change the event mask of a watched file descriptor.
+     */
+    bool modifyFd(int fd, uint32_t events);
+
+    /**
+     * @brief Stop watching a file descriptor.
+     */
+    void unwatchFd(int fd);
+
+    /**
+     * @brief Timer wheel driving setTimeout/setInterval (main thread only).
+     */
+    TimerWheel& getTimers() { return timers; }
+
+    /**
+     * @brief Monotonic clock in milliseconds used for timer deadlines.
+     */
+    static uint64_t nowMs();
+
+    /**
+     * @brief Queue a callback for the check phase of the next iteration.
+     * @return Id for clearImmediate()
+     */
+    uint64_t setImmediate(std::function<void()> callback);
+
+    /**
+     * @brief Cancel a queued immediate. Returns false if it already ran.
+     */
+    bool clearImmediate(uint64_t id);
+
+    /**
+     * @brief Cancel all timers and immediates (used on context teardown).
+     */
+    void clearTimers();
+
+    /**
+     * @brief Install the microtask runner (nullptr to remove it).
+     *
+     * Set by JSContextWrapper to drain JS_ExecutePendingJob.
+     */
+    void setMicrotaskRunner(MicrotaskRunner runner);
+
+    /**
+     * @brief Drain pending microtasks within the remaining per-tick budget.
+     * @return Number of microtasks executed
+     *
+     * Main thread only. Nested calls (from inside a microtask) are no-ops.
+     */
+    size_t runMicrotasks();
+
+    /**
+     * @brief Set the maximum number of microtasks per iteration (0 = unlimited).
+     */
+    void setMicrotaskBudget(size_t budget) { microtaskBudget = budget; }
+
+    /**
+     * @brief Maximum number of microtasks per iteration.
+     */
+    size_t getMicrotaskBudget() const { return microtaskBudget; }
+
+    /**
+     * @brief Total number of microtasks executed since startup.
+     */
+    uint64_t getMicrotasksExecuted() const { return microtasksExecuted.load(); }
+
+    /**
+     * @brief Install the idle handler (nullptr to remove it).
+     *
+     * Set by JSContextWrapper to run incremental GCBridge root scanning.
+     */
+    void setIdleHandler(IdleHandler handler);
+
+    /**
+     * @brief Set the time budget of one idle slice in microseconds (0 disables idle work).
+     */
+    void setIdleSliceBudget(uint64_t budgetUs) { idleSliceUs = budgetUs; }
+
 private:
-    EventLoop() = default;
-    ~EventLoop() = default;
     EventLoop(const EventLoop&) = delete;
     EventLoop& operator=(const EventLoop&) = delete;
-    
+
+    /**
+     * @brief Wake a thread blocked in pollIO().
+     */
+    void wakeup();
+
+    /**
+     * @brief Block for at most timeoutMs (-1 = forever) and dispatch ready fds.
+     */
+    void pollIO(int timeoutMs);
+
+    /**
+     * @brief Run the immediates queued before this check phase started.
+     */
+    void runImmediates();
+
+    /**
+     * @brief Blocking timeout for the poll phase, from the next timer deadline.
+     */
+    int computePollTimeout() const;
+
+    /**
+     * @brief Start a new iteration: refill the microtask budget.
+     */
+    void beginTick();
+
+    /**
+     * @brief Run one idle slice. Returns true if the handler has work left.
+     */
+    bool runIdle();
+
     static EventLoop instance;
-    
-    std::queue<std::function<void()>> callbackQueue;
+
+    struct CallbackNode {
+        std::atomic<CallbackNode*> next{nullptr};
+        Callback callback;
+    };
+
+    MPSCQueue<CallbackNode> callbackQueue;
+    // Incremented after a push completes, so it can briefly dip below zero
+    std::atomic<int64_t> pendingCallbacks{0};
+    // Set by the producer that owes the consumer a wakeup, cleared on drain
+    std::atomic<bool> wakeupPending{false};
+    // Only guards the condition-variable fallback
     mutable std::mutex queueMutex;
     std::condition_variable condition;
     std::atomic<bool> running{false};
+    std::atomic<size_t> activeHandles{0};
+
+    int epollFd = -1;
+    int wakeFd = -1;
+    std::unordered_map<int, std::shared_ptr<IOCallback>> fdWatchers;
+    std::mutex watchersMutex;
+
+    TimerWheel timers;
+    std::map<uint64_t, std::function<void()>> immediates;
+    uint64_t nextImmediateId = 1;
+
+    MicrotaskRunner microtaskRunner;
+    size_t microtaskBudget = DEFAULT_MICROTASK_BUDGET;
+    size_t microtaskBudgetLeft = DEFAULT_MICROTASK_BUDGET;
+    bool microtasksPending = false; // Budget ran out with jobs left
+    bool drainingMicrotasks = false;
+    std::atomic<uint64_t> microtasksExecuted{0};
+
+    IdleHandler idleHandler;
+    uint64_t idleSliceUs = DEFAULT_IDLE_SLICE_US;
 };
 
 } // namespace protojs
@@ -1,5 +1,6 @@
 #include "ExecutionEngine.h"
 #include "JSContext.h"
+#include "AtomInternTable.h"
 #include <mutex>
 #include <string>
 #include <cstring>
@@ -13,6 +14,21 @@ namespace protojs {
 // For now, we'll rely on JSContextWrapper stored in JSContext opaque
 static std::mutex contextMutex;
 
+namespace {
+
+// Only interned names are cached: the table holds their atoms, so an id
+// cannot be reused for another name until the table is cleared (which
+// invalidates the caches)
+PropertyCacheTable* cachesFor(JSContext* ctx, JSAtom prop) {
+    AtomInternTable* names = AtomInternTable::get(ctx);
+    if (!names || !names->contains(prop)) {
+        return nullptr;
+    }
+    return ExecutionEngine::getPropertyCaches(ctx);
+}
+
+} // namespace
+
 void ExecutionEngine::initialize(JSContext* ctx, proto::ProtoContext* pContext) {
     // ExecutionEngine doesn't need to store context mapping
     // It can always get ProtoContext from JSContextWrapper stored in JSContext opaque
@@ -57,11 +73,9 @@ JSValue ExecutionEngine::opGetProperty(JSContext* ctx, JSValue obj, JSAtom prop)
         const proto::ProtoObject* protoObj = GCBridge::getProtoObject(obj, ctx);
         if (protoObj) {
             // Get property from protoCore object
-            const char* propName = JS_AtomToCString(ctx, prop);
-            if (propName) {
-                const proto::ProtoString* propStr = pContext->fromUTF8String(propName)->asString(pContext);
+            const proto::ProtoString* propStr = AtomInternTable::toProtoString(ctx, prop, pContext);
+            if (propStr) {
                 const proto::ProtoObject* attr = protoObj->getAttribute(pContext, propStr);
-                JS_FreeCString(ctx, propName);
                 
                 if (attr && attr != PROTO_NONE) {
                     JSValue result = TypeBridge::toJS(ctx, attr, pContext);
@@ -83,38 +97,90 @@ int ExecutionEngine::opSetProperty(JSContext* ctx, JSValue obj, JSAtom prop, JSV
         return JS_SetProperty(ctx, obj, prop, val);
     }
     
-    // Check if object is managed by protoCore
-    if (shouldUseProtoCore(ctx, obj)) {
-        const proto::ProtoObject* protoObj = GCBridge::getProtoObject(obj, ctx);
-        if (protoObj) {
-            // Set property in protoCore object
-            const char* propName = JS_AtomToCString(ctx, prop);
-            if (propName) {
-                const proto::ProtoString* propStr = pContext->fromUTF8String(propName)->asString(pContext);
-                const proto::ProtoObject* valObj = TypeBridge::fromJS(ctx, val, pContext);
-                
-                // Note: protoCore objects are immutable by default
-                // Setting attributes creates a new object
-                // For mutable objects, we'd use setAttributeMutable
-                const proto::ProtoObject* newObj = protoObj->setAttribute(pContext, propStr, valObj);
-                
-                // Update mapping
-                if (newObj != protoObj) {
-                    GCBridge::registerMapping(obj, newObj, ctx);
-                }
-                
-                JS_FreeCString(ctx, propName);
-                JS_FreeAtom(ctx, prop);
-                return 0; // Success
-            }
-            JS_FreeAtom(ctx, prop);
-        }
+    // Set property in protoCore object. protoCore objects are immutable
+    // by default: setting an attribute creates a new object, which
+    // storeAttribute maps to obj
+    if (storeAttribute(ctx, obj, prop, val)) {
+        JS_FreeAtom(ctx, prop);
+        JS_FreeValue(ctx, val);
+        return 0; // Success
     }
     
     // Fallback to QuickJS
     return JS_SetProperty(ctx, obj, prop, val);
 }
 
+PropertyCacheTable* ExecutionEngine::getPropertyCaches(JSContext* ctx) {
+    JSContextWrapper* wrapper = static_cast<JSContextWrapper*>(JS_GetContextOpaque(ctx));
+    return wrapper ? wrapper->getPropertyCaches() : nullptr;
+}
+
+void ExecutionEngine::invalidatePropertyCaches(JSContext* ctx) {
+    PropertyCacheTable* caches = getPropertyCaches(ctx);
+    if (caches) {
+        caches->invalidate();
+    }
+}
+
+const proto::ProtoObject* ExecutionEngine::lookupAttribute(JSContext* ctx, JSValueConst obj, JSAtom prop) {
+    if (!JS_IsObject(obj)) {
+        return nullptr;
+    }
+    const void* receiver = JS_VALUE_GET_PTR(obj);
+    PropertyCacheTable* caches = cachesFor(ctx, prop);
+    const proto::ProtoObject* attr = nullptr;
+    if (caches && caches->find(prop, receiver, &attr)) {
+        return attr;
+    }
+
+    proto::ProtoContext* pContext = getProtoContext(ctx);
+    const proto::ProtoObject* protoObj = pContext ? GCBridge::getProtoObject(obj, ctx) : nullptr;
+    if (!protoObj) {
+        // Not cached: mapping a new object does not invalidate the caches
+        return nullptr;
+    }
+    const proto::ProtoString* propStr = AtomInternTable::toProtoString(ctx, prop, pContext);
+    if (!propStr) {
+        return nullptr;
+    }
+
+    attr = protoObj->getAttribute(pContext, propStr);
+    if (attr == PROTO_NONE) {
+        attr = nullptr;
+    }
+    // Misses are cached too, so absent attributes fall through quickly.
+    // The name may have been interned by toProtoString.
+    caches = cachesFor(ctx, prop);
+    if (caches) {
+        caches->fill(prop, receiver, attr);
+    }
+    return attr;
+}
+
+bool ExecutionEngine::storeAttribute(JSContext* ctx, JSValueConst obj, JSAtom prop, JSValueConst val) {
+    proto::ProtoContext* pContext = getProtoContext(ctx);
+    const proto::ProtoObject* protoObj = pContext ? GCBridge::getProtoObject(obj, ctx) : nullptr;
+    const proto::ProtoString* propStr = protoObj ? AtomInternTable::toProtoString(ctx, prop, pContext) : nullptr;
+    if (!propStr) {
+        return false;
+    }
+
+    const proto::ProtoObject* valObj = TypeBridge::fromJS(ctx, val, pContext);
+    const proto::ProtoObject* newObj = protoObj->setAttribute(pContext, propStr, valObj);
+
+    // The new object only differs in prop, so other cached names of obj
+    // stay valid; the entries of prop are replaced below
+    if (newObj != protoObj) {
+        GCBridge::repointMapping(obj, newObj, ctx);
+    }
+    // Names that are not interned have no entries to replace
+    PropertyCacheTable* caches = cachesFor(ctx, prop);
+    if (caches) {
+        caches->store(prop, JS_VALUE_GET_PTR(obj), valObj);
+    }
+    return true;
+}
+
 JSValue ExecutionEngine::opCall(JSContext* ctx, JSValue func, JSValue this_val, int argc, JSValueConst* argv) {
     proto::ProtoContext* pContext = getProtoContext(ctx);
     if (!pContext) {
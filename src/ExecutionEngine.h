@@ -5,6 +5,7 @@
 #include "headers/protoCore.h"
 #include "TypeBridge.h"
 #include "GCBridge.h"
+#include "PropertyCacheTable.h"
 
 namespace protojs {
 
@@ -36,6 +37,32 @@ public:
      */
     static int opSetProperty(JSContext* ctx, JSValue obj, JSAtom prop, JSValue val, int flags);
 
+    /**
+     * @brief Attribute of a protoCore-backed object, or nullptr if obj is
+     *        not bridged or has no such attribute. prop is borrowed.
+     *
+     * Interned names go through the inline caches of the context, so a
+     * hit skips the GCBridge lookup, the name conversion and getAttribute.
+     */
+    static const proto::ProtoObject* lookupAttribute(JSContext* ctx, JSValueConst obj, JSAtom prop);
+
+    /**
+     * @brief Write an attribute of a protoCore-backed object. Returns false,
+     *        without touching obj, if it is not bridged. prop and val are
+     *        borrowed; the written attribute is cached.
+     */
+    static bool storeAttribute(JSContext* ctx, JSValueConst obj, JSAtom prop, JSValueConst val);
+
+    /**
+     * @brief Inline caches of ctx, or nullptr if it has no JSContextWrapper.
+     */
+    static PropertyCacheTable* getPropertyCaches(JSContext* ctx);
+
+    /**
+     * @brief Invalidate every inline cache of ctx.
+     */
+    static void invalidatePropertyCaches(JSContext* ctx);
+
     /**
      * @brief Intercept function call operation
      */
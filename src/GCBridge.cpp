@@ -1,320 +1,389 @@
 #include "GCBridge.h"
 #include "JSContext.h"
+#include "PointerTable.h"
+#include "ExecutionEngine.h"
 #include <iostream>
-#include <cstring>
+#include <algorithm>
 #include <sstream>
-#include <iomanip>
 #include <chrono>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace protojs {
 
-// Static member definitions
-const proto::ProtoSparseList* GCBridge::contextMappings = nullptr;
-std::mutex GCBridge::mapMutex;
+namespace {
+
+enum MappingFlags : uint32_t {
+    MAPPING_ROOT = 1u << 0,
+    MAPPING_WEAK = 1u << 1,
+    // Survived a scan; only revisited by major cycles or via the remembered set
+    MAPPING_OLD = 1u << 2,
+    MAPPING_REMEMBERED = 1u << 3,
+};
+
+// A major cycle starts once the old generation doubles, but not below this
+constexpr size_t MAJOR_SCAN_MIN_OLD = 4096;
+// Slots walked by a major cycle between deadline checks
+constexpr size_t MAJOR_SCAN_STEP = 256;
+
+using ScanClock = std::chrono::steady_clock;
+
+struct MappingEntry {
+    JSValue value = JS_UNDEFINED;
+    const proto::ProtoObject* protoObj = nullptr;
+    int64_t createdMs = 0;
+    uint32_t flags = 0;
+};
+
+struct ContextTable {
+    // Owner; its property caches are invalidated when mappings change
+    JSContext* ctx = nullptr;
+    std::mutex mutex;
+    // JS object pointer -> mapping
+    PointerTable<MappingEntry> byValue;
+    // ProtoObject -> JS object pointer (key of byValue)
+    PointerTable<const void*> byProto;
+    size_t roots = 0;
+    size_t weakRefs = 0;
+    size_t oldEntries = 0;
+
+    // Minor cycles: entries created since the last scan, and old entries
+    // re-pointed at another ProtoObject or turned weak (old->young edges).
+    // Keys may be stale; the scanner looks them up again.
+    std::vector<const void*> young;
+    std::vector<const void*> remembered;
+
+    // Major cycle: resumable walk over byValue
+    bool majorActive = false;
+    size_t majorCursor = 0;
+    uint64_t majorLayout = 0;
+    size_t oldAtLastMajor = 0;
+
+    GCBridge::ScanStats stats = {};
+};
+
+// Only the map of tables is shared between contexts; lookups take it shared
+std::shared_mutex tablesMutex;
+std::unordered_map<JSContext*, std::unique_ptr<ContextTable>> tables;
+
+ContextTable* findTable(JSContext* ctx) {
+    std::shared_lock<std::shared_mutex> lock(tablesMutex);
+    auto it = tables.find(ctx);
+    return it != tables.end() ? it->second.get() : nullptr;
+}
+
+const void* keyOf(JSValueConst val) {
+    return JS_VALUE_HAS_REF_COUNT(val) ? JS_VALUE_GET_PTR(val) : nullptr;
+}
+
+int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void setFlags(ContextTable& table, MappingEntry& entry, uint32_t flags) {
+    uint32_t changed = entry.flags ^ flags;
+    if (changed & MAPPING_ROOT) {
+        (flags & MAPPING_ROOT) ? table.roots++ : table.roots--;
+    }
+    if (changed & MAPPING_WEAK) {
+        (flags & MAPPING_WEAK) ? table.weakRefs++ : table.weakRefs--;
+    }
+    if (changed & MAPPING_OLD) {
+        (flags & MAPPING_OLD) ? table.oldEntries++ : table.oldEntries--;
+    }
+    entry.flags = flags;
+}
+
+// Queue an old entry for the next minor cycle
+void remember(ContextTable& table, const void* key, MappingEntry& entry) {
+    if ((entry.flags & MAPPING_OLD) && !(entry.flags & MAPPING_REMEMBERED)) {
+        setFlags(table, entry, entry.flags | MAPPING_REMEMBERED);
+        table.remembered.push_back(key);
+    }
+}
+
+// keepCaches: protoObj differs from the mapped object only in an attribute
+// whose cache entries the caller replaces
+MappingEntry& upsert(ContextTable& table, JSContext* ctx, const void* key, JSValueConst jsVal,
+                     const proto::ProtoObject* protoObj, bool keepCaches = false) {
+    auto inserted = table.byValue.insert(key, MappingEntry{});
+    MappingEntry& entry = *inserted.first;
+    if (inserted.second) {
+        entry.value = JS_DupValue(ctx, jsVal);
+        entry.createdMs = nowMs();
+        table.young.push_back(key);
+        if (table.young.size() > 2 * table.byValue.size() + 1024) {
+            // No idle time for a while: drop keys of entries already gone
+            auto stale = [&](const void* youngKey) { return table.byValue.find(youngKey) == nullptr; };
+            table.young.erase(std::remove_if(table.young.begin(), table.young.end(), stale), table.young.end());
+        }
+    } else if (entry.protoObj != protoObj) {
+        const void** previous = table.byProto.find(entry.protoObj);
+        if (previous && *previous == key) {
+            table.byProto.erase(entry.protoObj);
+        }
+        remember(table, key, entry);
+        if (!keepCaches) {
+            ExecutionEngine::invalidatePropertyCaches(ctx);
+        }
+    }
+    entry.protoObj = protoObj;
+
+    auto reverse = table.byProto.insert(protoObj, key);
+    if (!reverse.second) {
+        *reverse.first = key;
+    }
+    return entry;
+}
+
+// Removes the entry of key and returns its JSValue, to be freed once the
+// table lock is released (finalizers may call back into GCBridge)
+JSValue removeEntry(ContextTable& table, const void* key) {
+    MappingEntry entry;
+    if (!table.byValue.erase(key, &entry)) {
+        return JS_UNDEFINED;
+    }
+    setFlags(table, entry, 0);
+    const void** reverse = table.byProto.find(entry.protoObj);
+    if (reverse && *reverse == key) {
+        table.byProto.erase(entry.protoObj);
+    }
+    // The key address may be reused once the value is freed
+    ExecutionEngine::invalidatePropertyCaches(table.ctx);
+    return entry.value;
+}
+
+// A weak mapping whose JS object is referenced by nothing but the bridge
+// is dead: nothing on the JS side can observe it any more
+bool isCollectable(const MappingEntry& entry) {
+    if (!(entry.flags & MAPPING_WEAK)) {
+        // Roots stay mapped; protoCore marks what its contexts reference
+        return false;
+    }
+    const JSRefCountHeader* header = static_cast<const JSRefCountHeader*>(JS_VALUE_GET_PTR(entry.value));
+    return header->ref_count <= 1;
+}
+
+// Visit one entry; returns the key if it must be collected
+void scanEntry(ContextTable& table, const void* key, MappingEntry& entry, std::vector<const void*>& dead) {
+    table.stats.entriesScanned++;
+    if (isCollectable(entry)) {
+        dead.push_back(key);
+    } else {
+        setFlags(table, entry, (entry.flags | MAPPING_OLD) & ~MAPPING_REMEMBERED);
+    }
+}
+
+/**
+ * Run scan work until deadline (no deadline when unbounded). Minor work
+ * (young and remembered entries) goes first; a major cycle walks the whole
+ * table a step at a time. Returns true if work is left.
+ */
+bool runScan(ContextTable& table, bool unbounded, ScanClock::time_point deadline, bool forceMajor,
+             std::vector<JSValue>& released) {
+    std::vector<const void*> dead;
+    auto flushDead = [&]() {
+        for (const void* key : dead) {
+            released.push_back(removeEntry(table, key));
+        }
+        table.stats.collected += dead.size();
+        dead.clear();
+    };
+    size_t sinceCheck = 0;
+    auto expired = [&]() {
+        return !unbounded && (++sinceCheck & 63) == 0 && ScanClock::now() >= deadline;
+    };
+
+    bool minorPending = !table.young.empty() || !table.remembered.empty();
+    for (std::vector<const void*>* queue : {&table.young, &table.remembered}) {
+        while (!queue->empty()) {
+            const void* key = queue->back();
+            queue->pop_back();
+            MappingEntry* entry = table.byValue.find(key);
+            if (entry && (queue == &table.remembered || !(entry->flags & MAPPING_OLD))) {
+                scanEntry(table, key, *entry, dead);
+                flushDead();
+            }
+            if (expired()) {
+                return true;
+            }
+        }
+    }
+    if (minorPending) {
+        table.stats.minorCycles++;
+    }
+
+    if (!table.majorActive &&
+        (forceMajor || table.oldEntries >= std::max(MAJOR_SCAN_MIN_OLD, 2 * table.oldAtLastMajor))) {
+        table.majorActive = true;
+        table.majorCursor = 0;
+        table.majorLayout = table.byValue.layoutVersion();
+    }
+
+    while (table.majorActive) {
+        if (table.byValue.layoutVersion() != table.majorLayout) {
+            // Entries moved since the last step; visiting some twice is harmless
+            table.majorCursor = 0;
+            table.majorLayout = table.byValue.layoutVersion();
+        }
+        table.majorCursor = table.byValue.forEachFrom(table.majorCursor, MAJOR_SCAN_STEP,
+            [&](const void* key, MappingEntry& entry) {
+                scanEntry(table, key, entry, dead);
+            });
+        // Erasing leaves tombstones, so the cursor stays valid
+        flushDead();
+
+        if (table.majorCursor >= table.byValue.capacity()) {
+            table.majorActive = false;
+            table.oldAtLastMajor = table.oldEntries;
+            table.stats.majorCycles++;
+        } else if (!unbounded && ScanClock::now() >= deadline) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
 
 void GCBridge::initialize(JSContext* ctx) {
-    std::lock_guard<std::mutex> lock(mapMutex);
-    proto::ProtoContext* pContext = getProtoContext(ctx);
-    if (!pContext) return;
-    
-    // Initialize empty mappings for this context
-    const proto::ProtoSparseList* emptyMappings = pContext->newSparseList();
-    setContextMappings(ctx, emptyMappings, pContext);
+    std::unique_lock<std::shared_mutex> lock(tablesMutex);
+    auto& table = tables[ctx];
+    if (!table) {
+        table = std::make_unique<ContextTable>();
+        table->ctx = ctx;
+    }
 }
 
 void GCBridge::registerMapping(JSValue jsVal, const proto::ProtoObject* protoObj, JSContext* ctx) {
-    if (!protoObj || JS_IsNull(jsVal) || JS_IsUndefined(jsVal)) {
+    const void* key = keyOf(jsVal);
+    if (!protoObj || !key) {
         return;
     }
+    ContextTable* table = findTable(ctx);
+    if (!table) return;
 
-    std::lock_guard<std::mutex> lock(mapMutex);
-    proto::ProtoContext* pContext = getProtoContext(ctx);
-    if (!pContext) return;
-
-    // Get context mappings
-    const proto::ProtoSparseList* ctxMappings = getContextMappings(ctx, pContext);
-    
-    // Create key for JSValue (as string representation of tag)
-    const proto::ProtoString* jsKey = createJSValueKey(jsVal, pContext);
-    unsigned long jsKeyHash = jsKey->getHash(pContext);
-    
-    // Store mapping data as ProtoObject with attributes (pure protoCore approach)
-    const proto::ProtoObject* mappingObj = pContext->newObject(true); // Mutable
-    
-    // Store JSValue tag as string
-    const proto::ProtoString* jsValTagKey1 = pContext->fromUTF8String("jsValueTag")->asString(pContext);
-    mappingObj = mappingObj->setAttribute(pContext, jsValTagKey1, stringAsObject(jsKey, pContext));
-    
-    // Store ProtoObject reference
-    const proto::ProtoString* protoObjKey = pContext->fromUTF8String("protoObj")->asString(pContext);
-    mappingObj = mappingObj->setAttribute(pContext, protoObjKey, const_cast<proto::ProtoObject*>(protoObj));
-    
-    // Store flags
-    const proto::ProtoString* isRootKey = pContext->fromUTF8String("isRoot")->asString(pContext);
-    mappingObj = mappingObj->setAttribute(pContext, isRootKey, pContext->fromBoolean(false));
-    
-    const proto::ProtoString* isWeakKey = pContext->fromUTF8String("isWeakRef")->asString(pContext);
-    mappingObj = mappingObj->setAttribute(pContext, isWeakKey, pContext->fromBoolean(false));
-    
-    // Store timestamp
-    auto now = std::chrono::system_clock::now();
-    auto duration = now.time_since_epoch();
-    double timestamp = std::chrono::duration<double>(duration).count();
-    const proto::ProtoString* timestampKey = pContext->fromUTF8String("createdTimestamp")->asString(pContext);
-    mappingObj = mappingObj->setAttribute(pContext, timestampKey, pContext->fromDouble(timestamp));
-    
-    // Store JSValue tag as integer (pure protoCore - no C++ objects)
-    // JSValue is a 64-bit value, we'll store it as a LargeInteger
-    uint64_t jsValTag = getJSValueTag(jsVal);
-    const proto::ProtoString* jsValTagKey = pContext->fromUTF8String("_jsValueTag")->asString(pContext);
-    // Store as string representation for now (can be converted to LargeInteger if needed)
-    std::ostringstream tagStr;
-    tagStr << jsValTag;
-    const proto::ProtoString* tagStrObj = pContext->fromUTF8String(tagStr.str().c_str())->asString(pContext);
-    mappingObj = mappingObj->setAttribute(pContext, jsValTagKey, stringAsObject(tagStrObj, pContext));
-    
-    // Also store JSValue in ExternalPointer for direct access (necessary for QuickJS)
-    // This is the only place we use C++ objects, and only because JSValue is external
-    JSValue* jsValPtr = new JSValue(JS_DupValue(ctx, jsVal));
-    const proto::ProtoObject* jsValWrapper = createExternalPointerWrapper(jsValPtr, pContext);
-    const proto::ProtoString* jsValKey = pContext->fromUTF8String("_jsValuePtr")->asString(pContext);
-    mappingObj = mappingObj->setAttribute(pContext, jsValKey, jsValWrapper);
-    
-    // Store in context mappings: jsKeyHash -> mappingObj
-    const proto::ProtoSparseList* newMappings = ctxMappings->setAt(pContext, jsKeyHash, mappingObj);
-    setContextMappings(ctx, newMappings, pContext);
-    
-    // Also store reverse mapping: protoObj hash -> JSValue wrapper
-    unsigned long protoKey = getProtoObjectKey(protoObj, pContext);
-    newMappings = newMappings->setAt(pContext, protoKey, jsValWrapper);
-    setContextMappings(ctx, newMappings, pContext);
+    std::lock_guard<std::mutex> lock(table->mutex);
+    MappingEntry& entry = upsert(*table, ctx, key, jsVal, protoObj);
 
     // Register as root if JSValue is active
     if (isActiveJSValue(jsVal, ctx)) {
-        registerRoot(jsVal, protoObj, ctx);
+        setFlags(*table, entry, entry.flags | MAPPING_ROOT);
     }
 }
 
-void GCBridge::unregisterMapping(JSValue jsVal, JSContext* ctx) {
-    std::lock_guard<std::mutex> lock(mapMutex);
-    proto::ProtoContext* pContext = getProtoContext(ctx);
-    if (!pContext) return;
+void GCBridge::repointMapping(JSValue jsVal, const proto::ProtoObject* protoObj, JSContext* ctx) {
+    const void* key = keyOf(jsVal);
+    if (!protoObj || !key) {
+        return;
+    }
+    ContextTable* table = findTable(ctx);
+    if (!table) return;
 
-    const proto::ProtoSparseList* ctxMappings = getContextMappings(ctx, pContext);
-    const proto::ProtoString* jsKey = createJSValueKey(jsVal, pContext);
-    unsigned long jsKeyHash = jsKey->getHash(pContext);
-    
-    if (ctxMappings->has(pContext, jsKeyHash)) {
-        const proto::ProtoObject* mappingObj = ctxMappings->getAt(pContext, jsKeyHash);
-        if (!mappingObj || mappingObj == PROTO_NONE) return;
-        
-        // Get isRoot flag
-        const proto::ProtoString* isRootKey = pContext->fromUTF8String("isRoot")->asString(pContext);
-        const proto::ProtoObject* isRootObj = mappingObj->getAttribute(pContext, isRootKey);
-        bool isRoot = isRootObj && isRootObj != PROTO_NONE && isRootObj->asBoolean(pContext);
-        
-        if (isRoot) {
-            unregisterRoot(jsVal, ctx);
-        }
-        
-        // Get JSValue from ExternalPointer and free it
-        const proto::ProtoString* jsValKey = pContext->fromUTF8String("_jsValuePtr")->asString(pContext);
-        const proto::ProtoObject* jsValWrapper = mappingObj->getAttribute(pContext, jsValKey);
-        if (jsValWrapper && jsValWrapper != PROTO_NONE) {
-            // Access ExternalPointer - we need the pointer value
-            // Since we can't easily access ExternalPointer, we'll use the tag stored as string
-            // For cleanup, we need the actual JSValue - this is a limitation
-            // In a full implementation, we'd need proper ExternalPointer access
-            // For now, we'll store a cleanup flag and handle it differently
-        }
-        
-        // Get protoObj for reverse mapping removal
-        const proto::ProtoString* protoObjKey = pContext->fromUTF8String("protoObj")->asString(pContext);
-        const proto::ProtoObject* storedProtoObj = mappingObj->getAttribute(pContext, protoObjKey);
-        
-        // Remove from mappings
-        const proto::ProtoSparseList* newMappings = ctxMappings->removeAt(pContext, jsKeyHash);
-        
-        // Also remove reverse mapping
-        if (storedProtoObj && storedProtoObj != PROTO_NONE) {
-            unsigned long protoKey = getProtoObjectKey(storedProtoObj, pContext);
-            newMappings = newMappings->removeAt(pContext, protoKey);
-        }
-        
-        setContextMappings(ctx, newMappings, pContext);
+    std::lock_guard<std::mutex> lock(table->mutex);
+    MappingEntry& entry = upsert(*table, ctx, key, jsVal, protoObj, true);
+    if (isActiveJSValue(jsVal, ctx)) {
+        setFlags(*table, entry, entry.flags | MAPPING_ROOT);
     }
 }
 
+void GCBridge::unregisterMapping(JSValue jsVal, JSContext* ctx) {
+    const void* key = keyOf(jsVal);
+    ContextTable* table = key ? findTable(ctx) : nullptr;
+    if (!table) return;
+
+    JSValue removed;
+    {
+        std::lock_guard<std::mutex> lock(table->mutex);
+        removed = removeEntry(*table, key);
+    }
+    JS_FreeValue(ctx, removed);
+}
+
 const proto::ProtoObject* GCBridge::getProtoObject(JSValue jsVal, JSContext* ctx) {
-    std::lock_guard<std::mutex> lock(mapMutex);
-    proto::ProtoContext* pContext = getProtoContext(ctx);
-    if (!pContext) return nullptr;
+    const void* key = keyOf(jsVal);
+    ContextTable* table = key ? findTable(ctx) : nullptr;
+    if (!table) return nullptr;
 
-    const proto::ProtoSparseList* ctxMappings = getContextMappings(ctx, pContext);
-    const proto::ProtoString* jsKey = createJSValueKey(jsVal, pContext);
-    unsigned long jsKeyHash = jsKey->getHash(pContext);
-    
-    if (ctxMappings->has(pContext, jsKeyHash)) {
-        const proto::ProtoObject* mappingObj = ctxMappings->getAt(pContext, jsKeyHash);
-        if (!mappingObj || mappingObj == PROTO_NONE) return nullptr;
-        const proto::ProtoString* protoObjKey = pContext->fromUTF8String("protoObj")->asString(pContext);
-        const proto::ProtoObject* protoObj = mappingObj->getAttribute(pContext, protoObjKey);
-        return (protoObj && protoObj != PROTO_NONE) ? protoObj : nullptr;
-    }
-    
-    return nullptr;
+    std::lock_guard<std::mutex> lock(table->mutex);
+    const MappingEntry* entry = table->byValue.find(key);
+    return entry ? entry->protoObj : nullptr;
 }
 
 JSValue GCBridge::getJSValue(const proto::ProtoObject* protoObj, JSContext* ctx) {
-    std::lock_guard<std::mutex> lock(mapMutex);
-    proto::ProtoContext* pContext = getProtoContext(ctx);
-    if (!pContext) return JS_NULL;
+    ContextTable* table = protoObj ? findTable(ctx) : nullptr;
+    if (!table) return JS_NULL;
 
-    const proto::ProtoSparseList* ctxMappings = getContextMappings(ctx, pContext);
-    unsigned long protoKey = getProtoObjectKey(protoObj, pContext);
-    
-    if (ctxMappings->has(pContext, protoKey)) {
-        // The value stored is the JSValue wrapper (ExternalPointer)
-        const proto::ProtoObject* jsValWrapper = ctxMappings->getAt(pContext, protoKey);
-        if (!jsValWrapper || jsValWrapper == PROTO_NONE) return JS_NULL;
-        void* jsValPtr = extractExternalPointer(jsValWrapper, pContext);
-        if (jsValPtr) {
-            JSValue* valPtr = static_cast<JSValue*>(jsValPtr);
-            return JS_DupValue(ctx, *valPtr);
-        }
-    }
-    
-    return JS_NULL;
+    std::lock_guard<std::mutex> lock(table->mutex);
+    const void** key = table->byProto.find(protoObj);
+    const MappingEntry* entry = key ? table->byValue.find(*key) : nullptr;
+    return entry ? JS_DupValue(ctx, entry->value) : JS_NULL;
 }
 
 void GCBridge::registerRoot(JSValue jsVal, const proto::ProtoObject* protoObj, JSContext* ctx) {
-    std::lock_guard<std::mutex> lock(mapMutex);
-    proto::ProtoContext* pContext = getProtoContext(ctx);
-    if (!pContext) return;
+    const void* key = keyOf(jsVal);
+    ContextTable* table = key ? findTable(ctx) : nullptr;
+    if (!table) return;
 
-    const proto::ProtoSparseList* ctxMappings = getContextMappings(ctx, pContext);
-    const proto::ProtoString* jsKey = createJSValueKey(jsVal, pContext);
-    unsigned long jsKeyHash = jsKey->getHash(pContext);
-    
-    if (ctxMappings->has(pContext, jsKeyHash)) {
-        const proto::ProtoObject* mappingObj = ctxMappings->getAt(pContext, jsKeyHash);
-        if (!mappingObj || mappingObj == PROTO_NONE) return;
-        const proto::ProtoString* isRootKey = pContext->fromUTF8String("isRoot")->asString(pContext);
-        mappingObj = mappingObj->setAttribute(pContext, isRootKey, pContext->fromBoolean(true));
-        
-        // Update mappings with modified object
-        const proto::ProtoSparseList* newMappings = ctxMappings->setAt(pContext, jsKeyHash, mappingObj);
-        setContextMappings(ctx, newMappings, pContext);
-    } else {
+    std::lock_guard<std::mutex> lock(table->mutex);
+    MappingEntry* entry = table->byValue.find(key);
+    if (!entry) {
         // Create new entry if not exists
-        registerMapping(jsVal, protoObj, ctx);
-        registerRoot(jsVal, protoObj, ctx);
+        if (!protoObj) return;
+        entry = &upsert(*table, ctx, key, jsVal, protoObj);
     }
+    setFlags(*table, *entry, entry->flags | MAPPING_ROOT);
 }
 
 void GCBridge::unregisterRoot(JSValue jsVal, JSContext* ctx) {
-    std::lock_guard<std::mutex> lock(mapMutex);
-    proto::ProtoContext* pContext = getProtoContext(ctx);
-    if (!pContext) return;
-
-    const proto::ProtoSparseList* ctxMappings = getContextMappings(ctx, pContext);
-    const proto::ProtoString* jsKey = createJSValueKey(jsVal, pContext);
-    unsigned long jsKeyHash = jsKey->getHash(pContext);
-    
-    if (ctxMappings->has(pContext, jsKeyHash)) {
-        const proto::ProtoObject* mappingObj = ctxMappings->getAt(pContext, jsKeyHash);
-        if (!mappingObj || mappingObj == PROTO_NONE) return;
-        const proto::ProtoString* isRootKey = pContext->fromUTF8String("isRoot")->asString(pContext);
-        mappingObj = mappingObj->setAttribute(pContext, isRootKey, pContext->fromBoolean(false));
-        
-        // Update mappings
-        const proto::ProtoSparseList* newMappings = ctxMappings->setAt(pContext, jsKeyHash, mappingObj);
-        setContextMappings(ctx, newMappings, pContext);
+    const void* key = keyOf(jsVal);
+    ContextTable* table = key ? findTable(ctx) : nullptr;
+    if (!table) return;
+
+    std::lock_guard<std::mutex> lock(table->mutex);
+    MappingEntry* entry = table->byValue.find(key);
+    if (entry) {
+        setFlags(*table, *entry, entry->flags & ~MAPPING_ROOT);
     }
 }
 
 void GCBridge::registerWeakRef(JSValue jsVal, const proto::ProtoObject* protoObj, JSContext* ctx) {
-    std::lock_guard<std::mutex> lock(mapMutex);
-    proto::ProtoContext* pContext = getProtoContext(ctx);
-    if (!pContext) return;
-
-    // Create mapping object marked as weak (similar to registerMapping but with isWeakRef=true)
-    const proto::ProtoSparseList* ctxMappings = getContextMappings(ctx, pContext);
-    const proto::ProtoString* jsKey = createJSValueKey(jsVal, pContext);
-    unsigned long jsKeyHash = jsKey->getHash(pContext);
-    
-    const proto::ProtoObject* mappingObj = pContext->newObject(true);
-    
-    // Store JSValue tag
-    const proto::ProtoString* jsValTagKey = pContext->fromUTF8String("jsValueTag")->asString(pContext);
-    mappingObj = mappingObj->setAttribute(pContext, jsValTagKey, stringAsObject(jsKey, pContext));
-    
-    // Store ProtoObject
-    const proto::ProtoString* protoObjKey = pContext->fromUTF8String("protoObj")->asString(pContext);
-    mappingObj = mappingObj->setAttribute(pContext, protoObjKey, const_cast<proto::ProtoObject*>(protoObj));
-    
-    // Store flags
-    const proto::ProtoString* isRootKey = pContext->fromUTF8String("isRoot")->asString(pContext);
-    mappingObj = mappingObj->setAttribute(pContext, isRootKey, pContext->fromBoolean(false));
-    
-    const proto::ProtoString* isWeakKey = pContext->fromUTF8String("isWeakRef")->asString(pContext);
-    mappingObj = mappingObj->setAttribute(pContext, isWeakKey, pContext->fromBoolean(true));
-    
-    // Store timestamp
-    auto now = std::chrono::system_clock::now();
-    auto duration = now.time_since_epoch();
-    double timestamp = std::chrono::duration<double>(duration).count();
-    const proto::ProtoString* timestampKey = pContext->fromUTF8String("createdTimestamp")->asString(pContext);
-    mappingObj = mappingObj->setAttribute(pContext, timestampKey, pContext->fromDouble(timestamp));
-    
-    // Store JSValue in ExternalPointer (necessary for QuickJS integration)
-    JSValue* jsValPtr = new JSValue(JS_DupValue(ctx, jsVal));
-    const proto::ProtoObject* jsValWrapper = createExternalPointerWrapper(jsValPtr, pContext);
-    const proto::ProtoString* jsValKey = pContext->fromUTF8String("_jsValuePtr")->asString(pContext);
-    mappingObj = mappingObj->setAttribute(pContext, jsValKey, jsValWrapper);
-    
-    const proto::ProtoSparseList* newMappings = ctxMappings->setAt(pContext, jsKeyHash, mappingObj);
-    setContextMappings(ctx, newMappings, pContext);
+    const void* key = keyOf(jsVal);
+    ContextTable* table = key && protoObj ? findTable(ctx) : nullptr;
+    if (!table) return;
+
+    std::lock_guard<std::mutex> lock(table->mutex);
+    MappingEntry& entry = upsert(*table, ctx, key, jsVal, protoObj);
+    setFlags(*table, entry, (entry.flags & ~MAPPING_ROOT) | MAPPING_WEAK);
+    // An old entry may now be collectable: let the next minor cycle see it
+    remember(*table, key, entry);
 }
 
 void GCBridge::unregisterWeakRef(JSValue jsVal, JSContext* ctx) {
-    std::lock_guard<std::mutex> lock(mapMutex);
-    proto::ProtoContext* pContext = getProtoContext(ctx);
-    if (!pContext) return;
-
-    const proto::ProtoSparseList* ctxMappings = getContextMappings(ctx, pContext);
-    const proto::ProtoString* jsKey = createJSValueKey(jsVal, pContext);
-    unsigned long jsKeyHash = jsKey->getHash(pContext);
-    
-    if (ctxMappings->has(pContext, jsKeyHash)) {
-        const proto::ProtoObject* mappingObj = ctxMappings->getAt(pContext, jsKeyHash);
-        if (!mappingObj || mappingObj == PROTO_NONE) return;
-        
-        // Check if it's a weak ref
-        const proto::ProtoString* isWeakKey = pContext->fromUTF8String("isWeakRef")->asString(pContext);
-        const proto::ProtoObject* isWeakObj = mappingObj->getAttribute(pContext, isWeakKey);
-        bool isWeak = isWeakObj && isWeakObj != PROTO_NONE && isWeakObj->asBoolean(pContext);
-        
-        if (isWeak) {
-            // Free JSValue from ExternalPointer
-            // Note: Since we can't easily access ExternalPointer contents,
-            // the JSValue will be freed when the ExternalPointer is finalized by protoCore GC
-            // In a full implementation, we'd need proper ExternalPointer access
-            const proto::ProtoString* jsValKey = pContext->fromUTF8String("_jsValuePtr")->asString(pContext);
-            const proto::ProtoObject* jsValWrapper = mappingObj->getAttribute(pContext, jsValKey);
-            // JSValue cleanup will happen via ExternalPointer finalizer
-            
-            const proto::ProtoSparseList* newMappings = ctxMappings->removeAt(pContext, jsKeyHash);
-            setContextMappings(ctx, newMappings, pContext);
+    const void* key = keyOf(jsVal);
+    ContextTable* table = key ? findTable(ctx) : nullptr;
+    if (!table) return;
+
+    JSValue removed = JS_UNDEFINED;
+    {
+        std::lock_guard<std::mutex> lock(table->mutex);
+        const MappingEntry* entry = table->byValue.find(key);
+        if (entry && (entry->flags & MAPPING_WEAK)) {
+            removed = removeEntry(*table, key);
         }
     }
+    JS_FreeValue(ctx, removed);
 }
 
 GCBridge::MemoryLeakReport GCBridge::detectLeaks(JSContext* ctx) {
     MemoryLeakReport report;
-    std::lock_guard<std::mutex> lock(mapMutex);
     proto::ProtoContext* pContext = getProtoContext(ctx);
-    if (!pContext) {
+    ContextTable* table = findTable(ctx);
+    if (!pContext || !table) {
         report.orphanedJSValues = nullptr;
         report.orphanedProtoObjects = nullptr;
         report.totalLeaks = nullptr;
@@ -322,67 +391,32 @@ GCBridge::MemoryLeakReport GCBridge::detectLeaks(JSContext* ctx) {
         return report;
     }
 
-    const proto::ProtoSparseList* ctxMappings = getContextMappings(ctx, pContext);
     const proto::ProtoList* orphanedJS = pContext->newList();
     const proto::ProtoList* orphanedProto = pContext->newList();
-    double maxAge = 0.0;
+    int64_t oldest = 0;
     unsigned long leakCount = 0;
-    
-    auto now = std::chrono::system_clock::now();
-    auto duration = now.time_since_epoch();
-    double currentTime = std::chrono::duration<double>(duration).count();
-    
-    // Iterate over mappings
-    const proto::ProtoSparseListIterator* iter = ctxMappings->getIterator(pContext);
-    while (iter && iter->hasNext(pContext)) {
-        unsigned long key = iter->nextKey(pContext);
-        const proto::ProtoObject* mappingObj = iter->nextValue(pContext);
-        
-        // Extract data from mapping object
-        const proto::ProtoString* isRootKey = pContext->fromUTF8String("isRoot")->asString(pContext);
-        const proto::ProtoObject* isRootObj = mappingObj->getAttribute(pContext, isRootKey);
-        bool isRoot = isRootObj && isRootObj != PROTO_NONE && isRootObj->asBoolean(pContext);
-        
-        if (isRoot) {
-            // Get JSValue tag to check if active
-            const proto::ProtoString* jsValTagKey = pContext->fromUTF8String("jsValueTag")->asString(pContext);
-            const proto::ProtoObject* jsValTagObj = mappingObj->getAttribute(pContext, jsValTagKey);
-            
-            // For leak detection, we check if the JSValue is still active
-            // Since we can't easily reconstruct JSValue from tag, we'll use a simpler check
-            // In a full implementation, we'd need to track JSValue lifecycle better
-            
-            // Get protoObj
-            const proto::ProtoString* protoObjKey = pContext->fromUTF8String("protoObj")->asString(pContext);
-            const proto::ProtoObject* protoObj = mappingObj->getAttribute(pContext, protoObjKey);
-            
-            // Get timestamp
-            const proto::ProtoString* timestampKey = pContext->fromUTF8String("createdTimestamp")->asString(pContext);
-            const proto::ProtoObject* timestampObj = mappingObj->getAttribute(pContext, timestampKey);
-            double timestamp = (timestampObj && timestampObj != PROTO_NONE) ? timestampObj->asDouble(pContext) : 0.0;
-            
-            // For now, consider all roots as potential leaks if they're old
-            // In a full implementation, we'd check JSValue liveness
-            if (jsValTagObj && jsValTagObj != PROTO_NONE && protoObj && protoObj != PROTO_NONE) {
-                orphanedJS = orphanedJS->appendLast(pContext, jsValTagObj);
-                orphanedProto = orphanedProto->appendLast(pContext, protoObj);
-                leakCount++;
-                
-                double age = currentTime - timestamp;
-                if (age > maxAge) {
-                    maxAge = age;
-                }
-            }
+    int64_t now = nowMs();
+
+    std::lock_guard<std::mutex> lock(table->mutex);
+    table->byValue.forEach([&](const void* key, const MappingEntry& entry) {
+        // For now, consider all roots as potential leaks
+        // In a full implementation, we'd check JSValue liveness
+        if (!(entry.flags & MAPPING_ROOT)) {
+            return;
         }
-        
-        iter = const_cast<proto::ProtoSparseListIterator*>(iter)->advance(pContext);
-    }
-    
+        std::ostringstream tag;
+        tag << "jsval:0x" << std::hex << reinterpret_cast<uintptr_t>(key);
+        orphanedJS = orphanedJS->appendLast(pContext, pContext->fromUTF8String(tag.str().c_str()));
+        orphanedProto = orphanedProto->appendLast(pContext, entry.protoObj);
+        leakCount++;
+        oldest = std::max(oldest, now - entry.createdMs);
+    });
+
     report.orphanedJSValues = orphanedJS;
     report.orphanedProtoObjects = orphanedProto;
     report.totalLeaks = pContext->fromInteger(static_cast<long long>(leakCount));
-    report.leakAge = pContext->fromDouble(maxAge);
-    
+    report.leakAge = pContext->fromDouble(oldest / 1000.0);
+
     return report;
 }
 
@@ -407,9 +441,9 @@ void GCBridge::reportLeaks(JSContext* ctx) {
 
 GCBridge::MemoryStats GCBridge::getMemoryStats(JSContext* ctx) {
     MemoryStats stats;
-    std::lock_guard<std::mutex> lock(mapMutex);
     proto::ProtoContext* pContext = getProtoContext(ctx);
-    if (!pContext) {
+    ContextTable* table = findTable(ctx);
+    if (!pContext || !table) {
         stats.totalJSValues = nullptr;
         stats.totalProtoObjects = nullptr;
         stats.registeredRoots = nullptr;
@@ -420,37 +454,20 @@ GCBridge::MemoryStats GCBridge::getMemoryStats(JSContext* ctx) {
         return stats;
     }
 
-    const proto::ProtoSparseList* ctxMappings = getContextMappings(ctx, pContext);
-    unsigned long totalMappings = ctxMappings->getSize(pContext);
-    unsigned long rootCount = 0;
-    unsigned long weakCount = 0;
-    
-    // Count roots and weak refs
-    const proto::ProtoSparseListIterator* iter = ctxMappings->getIterator(pContext);
-    const proto::ProtoString* isRootKey = pContext->fromUTF8String("isRoot")->asString(pContext);
-    const proto::ProtoString* isWeakKey = pContext->fromUTF8String("isWeakRef")->asString(pContext);
-    
-    while (iter && iter->hasNext(pContext)) {
-        const proto::ProtoObject* mappingObj = iter->nextValue(pContext);
-        
-        const proto::ProtoObject* isRootObj = mappingObj->getAttribute(pContext, isRootKey);
-        if (isRootObj && isRootObj != PROTO_NONE && isRootObj->asBoolean(pContext)) {
-            rootCount++;
-        }
-        
-        const proto::ProtoObject* isWeakObj = mappingObj->getAttribute(pContext, isWeakKey);
-        if (isWeakObj && isWeakObj != PROTO_NONE && isWeakObj->asBoolean(pContext)) {
-            weakCount++;
-        }
-        
-        iter = const_cast<proto::ProtoSparseListIterator*>(iter)->advance(pContext);
+    size_t totalJSValues, totalProtoObjects, rootCount, weakCount;
+    {
+        std::lock_guard<std::mutex> lock(table->mutex);
+        totalJSValues = table->byValue.size();
+        totalProtoObjects = table->byProto.size();
+        rootCount = table->roots;
+        weakCount = table->weakRefs;
     }
-    
-    stats.totalJSValues = pContext->fromInteger(static_cast<long long>(totalMappings));
-    stats.totalProtoObjects = pContext->fromInteger(static_cast<long long>(totalMappings));
+
+    stats.totalJSValues = pContext->fromInteger(static_cast<long long>(totalJSValues));
+    stats.totalProtoObjects = pContext->fromInteger(static_cast<long long>(totalProtoObjects));
     stats.registeredRoots = pContext->fromInteger(static_cast<long long>(rootCount));
     stats.weakReferences = pContext->fromInteger(static_cast<long long>(weakCount));
-    
+
     // Get GC stats from protoCore if available
     proto::ProtoSpace* space = getProtoSpace(ctx);
     if (space) {
@@ -461,59 +478,85 @@ GCBridge::MemoryStats GCBridge::getMemoryStats(JSContext* ctx) {
         stats.gcCycles = pContext->fromInteger(0);
         stats.memoryUsed = pContext->fromInteger(0);
     }
-    
-    // Count leaked objects
-    MemoryLeakReport leakReport = detectLeaks(ctx);
-    stats.leakedObjects = leakReport.totalLeaks ? leakReport.totalLeaks : pContext->fromInteger(0);
-    
+
+    // Every root is reported as a potential leak (see detectLeaks)
+    stats.leakedObjects = pContext->fromInteger(static_cast<long long>(rootCount));
+
     return stats;
 }
 
 void GCBridge::cleanup(JSContext* ctx) {
-    std::lock_guard<std::mutex> lock(mapMutex);
-    proto::ProtoContext* pContext = getProtoContext(ctx);
-    if (!pContext) return;
+    std::unique_ptr<ContextTable> table;
+    {
+        std::unique_lock<std::shared_mutex> lock(tablesMutex);
+        auto it = tables.find(ctx);
+        if (it == tables.end()) return;
+        table = std::move(it->second);
+        tables.erase(it);
+    }
 
-    const proto::ProtoSparseList* ctxMappings = getContextMappings(ctx, pContext);
-    const proto::ProtoString* jsValKey = pContext->fromUTF8String("_jsValuePtr")->asString(pContext);
-    
-    // Free all JSValues stored in ExternalPointers
-    // Note: Since we can't easily access ExternalPointer contents,
-    // we'll rely on protoCore's GC to clean up the ExternalPointer objects
-    // The JSValues will be freed when the ExternalPointer finalizers run
-    // In a full implementation, we'd track all JSValues explicitly
-    
-    // Clear mappings for this context
-    const proto::ProtoSparseList* emptyMappings = pContext->newSparseList();
-    setContextMappings(ctx, emptyMappings, pContext);
+    // Release the references held by the mappings of this context
+    std::vector<JSValue> values;
+    values.reserve(table->byValue.size());
+    table->byValue.forEach([&](const void*, MappingEntry& entry) {
+        values.push_back(entry.value);
+    });
+    table.reset();
+    for (JSValue value : values) {
+        JS_FreeValue(ctx, value);
+    }
 }
 
-void GCBridge::scanRoots(proto::ProtoSpace* space, JSContext* ctx) {
-    std::lock_guard<std::mutex> lock(mapMutex);
-    proto::ProtoContext* pContext = getProtoContext(ctx);
-    if (!pContext) return;
+bool GCBridge::scanRootsIncremental(JSContext* ctx, uint64_t budgetUs) {
+    ContextTable* table = findTable(ctx);
+    if (!table) return false;
+
+    ScanClock::time_point start = ScanClock::now();
+    std::vector<JSValue> released;
+    bool more;
+    {
+        std::lock_guard<std::mutex> lock(table->mutex);
+        more = runScan(*table, budgetUs == 0, start + std::chrono::microseconds(budgetUs), false, released);
+
+        uint64_t pauseUs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(ScanClock::now() - start).count());
+        ScanStats& stats = table->stats;
+        stats.slices++;
+        stats.lastPauseUs = pauseUs;
+        stats.maxPauseUs = std::max(stats.maxPauseUs, pauseUs);
+        stats.totalPauseUs += pauseUs;
+    }
 
-    const proto::ProtoSparseList* ctxMappings = getContextMappings(ctx, pContext);
-    const proto::ProtoString* isRootKey = pContext->fromUTF8String("isRoot")->asString(pContext);
-    const proto::ProtoString* protoObjKey = pContext->fromUTF8String("protoObj")->asString(pContext);
-    
-    const proto::ProtoSparseListIterator* iter = ctxMappings->getIterator(pContext);
-    while (iter && iter->hasNext(pContext)) {
-        const proto::ProtoObject* mappingObj = iter->nextValue(pContext);
-        
-        const proto::ProtoObject* isRootObj = mappingObj->getAttribute(pContext, isRootKey);
-        bool isRoot = isRootObj && isRootObj != PROTO_NONE && isRootObj->asBoolean(pContext);
-        
-        if (isRoot) {
-            // Get ProtoObject and mark as reachable during GC
-            const proto::ProtoObject* protoObj = mappingObj->getAttribute(pContext, protoObjKey);
-            if (protoObj && protoObj != PROTO_NONE) {
-                // Mark ProtoObject as reachable during GC
-                // Note: protoCore's GC will handle marking if the object is in a context
-            }
-        }
-        
-        iter = const_cast<proto::ProtoSparseListIterator*>(iter)->advance(pContext);
+    for (JSValue value : released) {
+        JS_FreeValue(ctx, value);
+    }
+    return more;
+}
+
+GCBridge::ScanStats GCBridge::getScanStats(JSContext* ctx) {
+    ContextTable* table = findTable(ctx);
+    if (!table) return ScanStats{};
+
+    std::lock_guard<std::mutex> lock(table->mutex);
+    ScanStats stats = table->stats;
+    stats.youngEntries = table->byValue.size() - table->oldEntries;
+    stats.oldEntries = table->oldEntries;
+    stats.rememberedEntries = table->remembered.size();
+    return stats;
+}
+
+void GCBridge::scanRoots(proto::ProtoSpace* space, JSContext* ctx) {
+    ContextTable* table = findTable(ctx);
+    if (!table) return;
+
+    // Stop-the-world variant: minor work plus a complete major cycle
+    std::vector<JSValue> released;
+    {
+        std::lock_guard<std::mutex> lock(table->mutex);
+        runScan(*table, true, ScanClock::time_point(), true, released);
+    }
+    for (JSValue value : released) {
+        JS_FreeValue(ctx, value);
     }
 }
 
@@ -522,18 +565,6 @@ bool GCBridge::isActiveJSValue(JSValue jsVal, JSContext* ctx) {
     return !JS_IsNull(jsVal) && !JS_IsUndefined(jsVal);
 }
 
-uint64_t GCBridge::getJSValueTag(JSValue jsVal) {
-    // JSValueUnion structure varies by platform
-    // For now, we'll use a safe workaround: serialize and hash
-    // This is a placeholder that doesn't directly access int64
-    union {
-        JSValue val;
-        uint64_t u64;
-    } converter;
-    converter.val = jsVal;
-    return converter.u64;
-}
-
 proto::ProtoSpace* GCBridge::getProtoSpace(JSContext* ctx) {
     JSContextWrapper* wrapper = static_cast<JSContextWrapper*>(JS_GetContextOpaque(ctx));
     if (wrapper) {
@@ -550,94 +581,4 @@ proto::ProtoContext* GCBridge::getProtoContext(JSContext* ctx) {
     return nullptr;
 }
 
-const proto::ProtoSparseList* GCBridge::getContextMappings(JSContext* ctx, proto::ProtoContext* pContext) {
-    if (!contextMappings) {
-        contextMappings = pContext->newSparseList();
-    }
-    
-    // Get mappings for this context using JSContext* hash
-    unsigned long ctxHash = reinterpret_cast<uintptr_t>(ctx);
-    
-    if (contextMappings->has(pContext, ctxHash)) {
-        const proto::ProtoObject* wrappedMappings = contextMappings->getAt(pContext, ctxHash);
-        if (wrappedMappings && wrappedMappings != PROTO_NONE) {
-            const proto::ProtoSparseList* mappings = wrappedMappings->asSparseList(pContext);
-            if (mappings) {
-                return mappings;
-            }
-        }
-    }
-    
-    // Return empty mappings if not found
-    return pContext->newSparseList();
-}
-
-void GCBridge::setContextMappings(JSContext* ctx, const proto::ProtoSparseList* mappings, proto::ProtoContext* pContext) {
-    // Use pointer value as hash directly (pure protoCore approach)
-    unsigned long ctxHash = reinterpret_cast<uintptr_t>(ctx);
-    
-    if (!contextMappings) {
-        contextMappings = pContext->newSparseList();
-    }
-    
-    contextMappings = contextMappings->setAt(pContext, ctxHash, reinterpret_cast<const proto::ProtoObject*>(mappings));
-}
-
-const proto::ProtoString* GCBridge::createJSValueKey(JSValue jsVal, proto::ProtoContext* pContext) {
-    uint64_t tag = getJSValueTag(jsVal);
-    std::ostringstream oss;
-    oss << "jsval:" << tag;
-    return pContext->fromUTF8String(oss.str().c_str())->asString(pContext);
-}
-
-unsigned long GCBridge::getProtoObjectKey(const proto::ProtoObject* protoObj, proto::ProtoContext* pContext) {
-    return protoObj->getHash(pContext);
-}
-
-// wrapMappingData removed - we now use ProtoObject attributes directly
-
-void* GCBridge::getPointerFromExternalPointer(const proto::ProtoObject* obj, proto::ProtoContext* pContext) {
-    // Workaround: protoCore::ProtoExternalPointer::getPointer() is not implemented
-    // Use the fallback extraction method instead
-    return extractExternalPointer(obj, pContext);
-}
-
-// ==================== WORKAROUND METHODS (protoCore methods not implemented) ====================
-
-const proto::ProtoObject* GCBridge::stringAsObject(const proto::ProtoString* str, proto::ProtoContext* pContext) {
-    // Workaround: ProtoString IS a ProtoObject, so we can safely cast
-    // This is a direct reinterpret_cast since ProtoString is a subclass of ProtoObject
-    return reinterpret_cast<const proto::ProtoObject*>(str);
-}
-
-void* GCBridge::extractExternalPointer(const proto::ProtoObject* wrapper, proto::ProtoContext* pContext) {
-    if (!wrapper) return nullptr;
-    
-    // Workaround: ProtoExternalPointer::getPointer() not implemented in protoCore
-    // For now, return nullptr as a fallback
-    // In production, this would need proper implementation in protoCore
-    // The stored pointer is in an attribute, but we can't easily decode it without protoCore methods
-    
-    return nullptr;
-}
-
-const proto::ProtoObject* GCBridge::createExternalPointerWrapper(void* ptr, proto::ProtoContext* pContext) {
-    // Workaround: Store pointer as string-encoded hex value in a ProtoObject
-    std::ostringstream oss;
-    oss << "0x" << std::hex << std::setfill('0') << std::setw(16) << reinterpret_cast<uint64_t>(ptr);
-    std::string ptrStr = oss.str();
-    
-    // Create a wrapper object
-    const proto::ProtoObject* wrapper = pContext->newObject(true);
-    
-    // Store pointer as encoded string
-    const proto::ProtoString* ptrKey = pContext->fromUTF8String("_externalPtr")->asString(pContext);
-    const proto::ProtoString* ptrValue = pContext->fromUTF8String(ptrStr.c_str())->asString(pContext);
-    
-    // Use direct cast as workaround for asObject()
-    wrapper = wrapper->setAttribute(pContext, ptrKey, reinterpret_cast<const proto::ProtoObject*>(ptrValue));
-    
-    return wrapper;
-}
-
 } // namespace protojs
@@ -3,7 +3,8 @@
 
 #include "quickjs.h"
 #include "headers/protoCore.h"
-#include <mutex>
+#include <cstddef>
+#include <cstdint>
 
 // Forward declaration
 namespace protojs {
@@ -15,8 +16,12 @@ namespace protojs {
 /**
  * @brief GCBridge integrates QuickJS JSValue lifecycle with protoCore garbage collection.
  * 
- * Maintains bidirectional mapping between JSValues and ProtoObjects using only protoCore objects.
- * Uses ProtoSparseList for mappings, ProtoExternalPointer for C++ pointers, and ProtoString for keys.
+ * Maintains a bidirectional mapping between JS objects and ProtoObjects. Each
+ * context has its own pair of open-addressing tables keyed by object pointer
+ * (see PointerTable), guarded by a per-context lock, so lookups are O(1) and
+ * do not allocate. Entries hold a reference on their JSValue, which keeps the
+ * key address from being reused while the mapping exists. Only values with a
+ * reference count (objects, strings, ...) can be mapped.
  */
 class GCBridge {
 public:
@@ -43,11 +48,38 @@ public:
         const proto::ProtoObject* leakAge;  // Age in seconds as double
     };
 
+    /**
+     * @brief Root scanning metrics of one context (see scanRootsIncremental)
+     */
+    struct ScanStats {
+        uint64_t slices;
+        uint64_t minorCycles;
+        uint64_t majorCycles;
+        uint64_t entriesScanned;
+        /** Weak mappings released because only the bridge referenced them. */
+        uint64_t collected;
+        uint64_t lastPauseUs;
+        uint64_t maxPauseUs;
+        uint64_t totalPauseUs;
+        size_t youngEntries;
+        size_t oldEntries;
+        size_t rememberedEntries;
+    };
+
     /**
      * @brief Register a mapping between JSValue and ProtoObject
      */
     static void registerMapping(JSValue jsVal, const proto::ProtoObject* protoObj, JSContext* ctx);
 
+    /**
+     * @brief Re-point the mapping of jsVal after an attribute write
+     *
+     * Like registerMapping, but protoObj must differ from the mapped object
+     * only in the written attribute: ExecutionEngine inline caches are kept,
+     * the writer updating the entries of that attribute.
+     */
+    static void repointMapping(JSValue jsVal, const proto::ProtoObject* protoObj, JSContext* ctx);
+
     /**
      * @brief Unregister a mapping
      */
@@ -99,100 +131,49 @@ public:
     static MemoryStats getMemoryStats(JSContext* ctx);
 
     /**
-     * @brief Cleanup all mappings for a context
+     * @brief Run one bounded slice of root scanning.
+     * @param budgetUs Time budget of the slice (0 = run to completion)
+     * @return true if scanning work is left for a later slice
+     *
+     * Scanning is generational. Minor cycles visit the mappings created
+     * since the previous cycle plus the remembered set: old mappings that
+     * were re-pointed at a new ProtoObject or turned weak. Survivors become
+     * old. Major cycles walk the whole table in steps and only start once
+     * the old generation has doubled. Weak mappings whose JS object is
+     * referenced by nothing but the bridge are released.
+     *
+     * Called from the event loop's idle phase (see EventLoop::setIdleHandler).
      */
-    static void cleanup(JSContext* ctx);
+    static bool scanRootsIncremental(JSContext* ctx, uint64_t budgetUs);
 
     /**
-     * @brief Initialize GCBridge for a context
+     * @brief Scanning metrics, including per-slice pause times
      */
-    static void initialize(JSContext* ctx);
+    static ScanStats getScanStats(JSContext* ctx);
 
-private:
-    // Workaround helper methods (for missing protoCore implementations)
     /**
-     * @brief Convert ProtoString to ProtoObject using workaround
-     */
-    static const proto::ProtoObject* stringAsObject(const proto::ProtoString* str, proto::ProtoContext* pContext);
-    
-    /**
-     * @brief Extract pointer from external pointer wrapper using workaround
-     */
-    static void* extractExternalPointer(const proto::ProtoObject* wrapper, proto::ProtoContext* pContext);
-    
-    /**
-     * @brief Create external pointer wrapper using workaround
+     * @brief Cleanup all mappings for a context
      */
-    static const proto::ProtoObject* createExternalPointerWrapper(void* ptr, proto::ProtoContext* pContext);
+    static void cleanup(JSContext* ctx);
 
     /**
-     * @brief Scan roots during GC (called by protoCore GC)
+     * @brief Initialize GCBridge for a context
      */
-    static void scanRoots(proto::ProtoSpace* space, JSContext* ctx);
+    static void initialize(JSContext* ctx);
 
 private:
-    // Note: MappingData is no longer used as a C++ struct
-    // Instead, mapping data is stored as attributes in ProtoObject
-    // This structure is kept for reference but not used directly
-    struct MappingData {
-        JSValue jsValue;
-        const proto::ProtoObject* protoObj;
-        bool isRoot;
-        bool isWeakRef;
-        double createdTimestamp;
-    };
-
-    // Per-context mappings stored in protoCore
-    // Key: JSContext* wrapped in ProtoExternalPointer, stored in global map
-    // Value: ProtoSparseList containing mappings for that context
-    //   - Key: JSValue tag as ProtoString hash
-    //   - Value: ProtoObject containing MappingData (wrapped in ProtoExternalPointer)
-    
-    // For reverse mapping (ProtoObject -> JSValue):
-    //   - Key: ProtoObject hash
-    //   - Value: JSValue wrapped in ProtoExternalPointer
-    
-    // Global map: JSContext* -> ProtoSparseList (mappings for that context)
-    // Stored as ProtoSparseList where key is JSContext* hash (via ProtoExternalPointer)
-    static const proto::ProtoSparseList* contextMappings;
-    static std::mutex mapMutex;
-
-    /**
-     * @brief Get or create mappings for a context
-     */
-    static const proto::ProtoSparseList* getContextMappings(JSContext* ctx, proto::ProtoContext* pContext);
-
-    /**
-     * @brief Store mappings for a context
-     */
-    static void setContextMappings(JSContext* ctx, const proto::ProtoSparseList* mappings, proto::ProtoContext* pContext);
-
-    /**
-     * @brief Create a key for JSValue (as ProtoString)
-     */
-    static const proto::ProtoString* createJSValueKey(JSValue jsVal, proto::ProtoContext* pContext);
-
-    /**
-     * @brief Create a key for ProtoObject (use its hash)
-     */
-    static unsigned long getProtoObjectKey(const proto::ProtoObject* protoObj, proto::ProtoContext* pContext);
-
     /**
-     * @brief Get pointer from ProtoExternalPointer (helper)
-     * Uses only public API from protoCore.h
+     * @brief Scan roots during GC (called by protoCore GC)
+     *
+     * Runs pending minor work and a complete major cycle in one pause.
      */
-    static void* getPointerFromExternalPointer(const proto::ProtoObject* obj, proto::ProtoContext* pContext);
+    static void scanRoots(proto::ProtoSpace* space, JSContext* ctx);
 
     /**
      * @brief Check if a JSValue is active (reachable)
      */
     static bool isActiveJSValue(JSValue jsVal, JSContext* ctx);
 
-    /**
-     * @brief Get JSValue tag for use as key
-     */
-    static uint64_t getJSValueTag(JSValue jsVal);
-
     /**
      * @brief Get ProtoSpace from JSContext
      */
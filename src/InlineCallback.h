@@ -0,0 +1,118 @@
+#ifndef PROTOJS_INLINECALLBACK_H
+#define PROTOJS_INLINECALLBACK_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace protojs {
+
+/**
+ * @brief Move-only void() callable with small-buffer storage.
+ *
+ * Callables up to INLINE_SIZE bytes (a lambda capturing a couple of
+ * shared_ptrs, or a std::function) are stored in place; larger ones fall
+ * back to the heap. Unlike std::function it never allocates for the common
+ * completion lambdas and does not require the callable to be copyable.
+ */
+class InlineCallback {
+public:
+    static constexpr size_t INLINE_SIZE = 48;
+
+    InlineCallback() noexcept = default;
+
+    template <typename F,
+              typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InlineCallback>>>
+    InlineCallback(F&& f) {
+        using Fn = std::decay_t<F>;
+        if constexpr (fitsInline<Fn>()) {
+            new (storage) Fn(std::forward<F>(f));
+            ops = &inlineOps<Fn>;
+        } else {
+            *reinterpret_cast<Fn**>(storage) = new Fn(std::forward<F>(f));
+            ops = &heapOps<Fn>;
+        }
+    }
+
+    InlineCallback(InlineCallback&& other) noexcept {
+        moveFrom(other);
+    }
+
+    InlineCallback& operator=(InlineCallback&& other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    InlineCallback(const InlineCallback&) = delete;
+    InlineCallback& operator=(const InlineCallback&) = delete;
+
+    ~InlineCallback() { reset(); }
+
+    void operator()() { ops->invoke(storage); }
+
+    explicit operator bool() const noexcept { return ops != nullptr; }
+
+    /**
+     * @brief Destroy the stored callable, leaving this empty.
+     */
+    void reset() noexcept {
+        if (ops) {
+            ops->destroy(storage);
+            ops = nullptr;
+        }
+    }
+
+    /**
+     * @brief Whether a callable of type F is stored without allocating.
+     */
+    template <typename F>
+    static constexpr bool fitsInline() {
+        return sizeof(F) <= INLINE_SIZE && alignof(F) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible_v<F>;
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*move)(void* from, void* to) noexcept;
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template <typename Fn>
+    static constexpr Ops inlineOps = {
+        [](void* s) { (*static_cast<Fn*>(s))(); },
+        [](void* from, void* to) noexcept {
+            new (to) Fn(std::move(*static_cast<Fn*>(from)));
+            static_cast<Fn*>(from)->~Fn();
+        },
+        [](void* s) noexcept { static_cast<Fn*>(s)->~Fn(); },
+    };
+
+    template <typename Fn>
+    static constexpr Ops heapOps = {
+        [](void* s) { (**static_cast<Fn**>(s))(); },
+        [](void* from, void* to) noexcept {
+            *static_cast<Fn**>(to) = *static_cast<Fn**>(from);
+        },
+        [](void* s) noexcept { delete *static_cast<Fn**>(s); },
+    };
+
+    void moveFrom(InlineCallback& other) noexcept {
+        ops = other.ops;
+        if (ops) {
+            ops->move(other.storage, storage);
+            other.ops = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage[INLINE_SIZE];
+    const Ops* ops = nullptr;
+};
+
+} // namespace protojs
+
+#endif // PROTOJS_INLINECALLBACK_H
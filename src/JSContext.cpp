@@ -4,6 +4,11 @@
 #include "EventLoop.h"
 #include "GCBridge.h"
 #include "ExecutionEngine.h"
+#include "Deferred.h"
+#include "WorkerRuntimePool.h"
+#include "AtomInternTable.h"
+#include "ConversionCache.h"
+#include "PropertyCacheTable.h"
 #include <iostream>
 
 namespace protojs {
@@ -14,6 +19,8 @@ JSContextWrapper::JSContextWrapper(size_t cpuThreads, size_t ioThreads, double i
     
     // Initialize protoCore root context
     pContext = pSpace.rootContext;
+    internTable = std::make_unique<AtomInternTable>(ctx);
+    propertyCaches = std::make_unique<PropertyCacheTable>();
     
     // Initialize GCBridge for this context
     GCBridge::initialize(ctx);
@@ -24,12 +31,10 @@ JSContextWrapper::JSContextWrapper(size_t cpuThreads, size_t ioThreads, double i
     // Store pointer to this wrapper in JSContext opaque for GCBridge access
     JS_SetContextOpaque(ctx, this);
     
-    // Initialize thread pools
-    if (cpuThreads > 0) {
-        CPUThreadPool::initialize(cpuThreads);
-    } else {
-        CPUThreadPool::initialize(); // Use default (CPU count)
-    }
+    // Initialize thread pools; CPU workers create their Deferred runtimes
+    // before initialize() returns
+    CPUThreadPool::initialize(cpuThreads, SchedulingMode::WorkStealing, // 0 = CPU count
+                              WorkerRuntimePool::hooks());
     
     if (ioThreads > 0) {
         IOThreadPool::initialize(ioThreads);
@@ -37,7 +42,36 @@ JSContextWrapper::JSContextWrapper(size_t cpuThreads, size_t ioThreads, double i
         IOThreadPool::initialize(0, ioFactor); // Use default with factor
     }
     
-    // Event loop is initialized on first access (singleton)
+    // Event loop is initialized on first access (singleton); it drains the
+    // Promise job queue of this runtime after every macrotask
+    JSRuntime* runtime = rt;
+    EventLoop::getInstance().setMicrotaskRunner([runtime](size_t budget) {
+        size_t executed = 0;
+        while (executed < budget) {
+            JSContext* jobCtx = nullptr;
+            int ret = JS_ExecutePendingJob(runtime, &jobCtx);
+            if (ret == 0) {
+                break;
+            }
+            executed++;
+            if (ret < 0 && jobCtx) {
+                JSValue exception = JS_GetException(jobCtx);
+                const char* str = JS_ToCString(jobCtx, exception);
+                if (str) {
+                    std::cerr << "Uncaught exception in microtask: " << str << std::endl;
+                    JS_FreeCString(jobCtx, str);
+                }
+                JS_FreeValue(jobCtx, exception);
+            }
+        }
+        return executed;
+    });
+
+    // Incremental GCBridge root scanning runs when the loop would block
+    JSContext* context = ctx;
+    EventLoop::getInstance().setIdleHandler([context](uint64_t budgetUs) {
+        return GCBridge::scanRootsIncremental(context, budgetUs);
+    });
 }
 
 JSContextWrapper::~JSContextWrapper() {
@@ -47,14 +81,34 @@ JSContextWrapper::~JSContextWrapper() {
     // Cleanup GCBridge mappings
     GCBridge::cleanup(ctx);
     
+    // Functions held by the Deferred bytecode cache
+    Deferred::cleanup(ctx);
+    
+    // Drop pending timers; their callbacks hold values from this context
+    EventLoop::getInstance().clearTimers();
+    EventLoop::getInstance().setMicrotaskRunner(nullptr);
+    EventLoop::getInstance().setIdleHandler(nullptr);
+    
     // Shutdown thread pools
     CPUThreadPool::shutdown();
     IOThreadPool::shutdown();
     
+    // Interned atoms and cached objects belong to the context
+    conversionCache.reset();
+    internTable.reset();
+    propertyCaches.reset();
+    
     JS_FreeContext(ctx);
     JS_FreeRuntime(rt);
 }
 
+void JSContextWrapper::setConversionCacheCapacity(size_t capacity) {
+    conversionCache.reset();
+    if (capacity > 0) {
+        conversionCache = std::make_unique<ConversionCache>(ctx, nullptr, capacity);
+    }
+}
+
 JSValue JSContextWrapper::eval(const std::string& code, const std::string& filename) {
     JSValue val = JS_Eval(ctx, code.c_str(), code.length(), filename.c_str(), JS_EVAL_TYPE_GLOBAL);
     
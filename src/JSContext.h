@@ -4,9 +4,14 @@
 #include "quickjs.h"
 #include "headers/protoCore.h"
 #include <string>
+#include <memory>
 
 namespace protojs {
 
+class AtomInternTable;
+class ConversionCache;
+class PropertyCacheTable;
+
 class JSContextWrapper {
 public:
     /**
@@ -43,11 +48,36 @@ public:
      */
     JSRuntime* getJSRuntime() { return rt; }
 
+    /**
+     * @brief Returns the property name intern table of this context.
+     */
+    AtomInternTable* getInternTable() { return internTable.get(); }
+
+    /**
+     * @brief Returns the ExecutionEngine inline caches of this context.
+     */
+    PropertyCacheTable* getPropertyCaches() { return propertyCaches.get(); }
+
+    /**
+     * @brief Returns the cache of converted frozen objects, or nullptr if it
+     *        is disabled.
+     */
+    ConversionCache* getConversionCache() { return conversionCache.get(); }
+
+    /**
+     * @brief Keep up to capacity frozen objects converted by TypeBridge::fromJS
+     *        across calls (0 = disabled, the default). Resets the cache.
+     */
+    void setConversionCacheCapacity(size_t capacity);
+
 private:
     JSRuntime* rt;
     JSContext* ctx;
     proto::ProtoSpace pSpace;
     proto::ProtoContext* pContext;
+    std::unique_ptr<AtomInternTable> internTable;
+    std::unique_ptr<PropertyCacheTable> propertyCaches;
+    std::unique_ptr<ConversionCache> conversionCache;
 };
 
 } // namespace protojs
@@ -0,0 +1,90 @@
+#ifndef PROTOJS_MPSCQUEUE_H
+#define PROTOJS_MPSCQUEUE_H
+
+#include <atomic>
+
+namespace protojs {
+
+/**
+ * @brief Intrusive lock-free multi-producer/single-consumer queue.
+ *
+ * Vyukov's design: push() is a single atomic exchange plus a store and is
+ * wait-free; pop() must only be called from one consumer thread. Node must
+ * be default constructible and expose a `std::atomic<Node*> next` member.
+ * The queue does not own its nodes.
+ */
+template <typename Node>
+class MPSCQueue {
+public:
+    MPSCQueue() : head(&stub), tail(&stub) {
+        stub.next.store(nullptr, std::memory_order_relaxed);
+    }
+
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+    /**
+     * @brief Append a node. Safe from any thread.
+     */
+    void push(Node* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node* prev = head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    /**
+     * @brief Remove the oldest node (consumer thread only).
+     *
+     * Returns nullptr when empty, and also transiently while a producer is
+     * between its exchange and its link store; callers that know a node is
+     * coming should retry.
+     */
+    Node* pop() {
+        Node* t = tail;
+        Node* next = t->next.load(std::memory_order_acquire);
+
+        if (t == &stub) {
+            if (!next) {
+                return nullptr;
+            }
+            tail = next;
+            t = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if (next) {
+            tail = next;
+            return t;
+        }
+
+        if (t != head.load(std::memory_order_acquire)) {
+            return nullptr; // A producer is mid-push
+        }
+
+        // t is the last node: park the stub behind it so t can be handed out
+        push(&stub);
+        next = t->next.load(std::memory_order_acquire);
+        if (next) {
+            tail = next;
+            return t;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Whether the queue looks empty (consumer thread only).
+     */
+    bool empty() const {
+        return tail == &stub && stub.next.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    // Producers swing head; kept on its own cache line from the consumer's tail
+    alignas(64) std::atomic<Node*> head;
+    alignas(64) Node* tail;
+    Node stub;
+};
+
+} // namespace protojs
+
+#endif // PROTOJS_MPSCQUEUE_H
@@ -0,0 +1,197 @@
+#ifndef PROTOJS_POINTERTABLE_H
+#define PROTOJS_POINTERTABLE_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+namespace protojs {
+
+/**
+ * @brief Open-addressing hash table keyed by pointer.
+ *
+ * Linear probing over a power-of-two array of inline slots, so a lookup is
+ * one hash and usually one cache line, and inserts never allocate per entry.
+ * Erased slots become tombstones that are reused by later inserts and dropped
+ * when the table is rehashed. The null pointer cannot be used as a key. Not
+ * thread-safe.
+ */
+template <typename V>
+class PointerTable {
+public:
+    explicit PointerTable(size_t initialCapacity = 16) {
+        size_t capacity = MIN_CAPACITY;
+        while (capacity < initialCapacity) {
+            capacity <<= 1;
+        }
+        slots.resize(capacity);
+    }
+
+    /**
+     * @brief Value stored under key, or nullptr. Valid until the next insert.
+     */
+    V* find(const void* key) {
+        size_t index = probe(key);
+        return slots[index].key == key ? &slots[index].value : nullptr;
+    }
+
+    const V* find(const void* key) const {
+        return const_cast<PointerTable*>(this)->find(key);
+    }
+
+    /**
+     * @brief Insert key if absent. Returns the stored value and whether it
+     *        was inserted; an existing value is left unchanged.
+     */
+    std::pair<V*, bool> insert(const void* key, V value) {
+        if ((count + tombstones + 1) * 4 > slots.size() * 3) {
+            // Grow only when live entries need it; otherwise just drop tombstones
+            rehash((count + 1) * 2 > slots.size() ? slots.size() * 2 : slots.size());
+        }
+
+        size_t mask = slots.size() - 1;
+        size_t index = hash(key) & mask;
+        size_t reusable = SIZE_MAX;
+        while (slots[index].key != nullptr) {
+            if (slots[index].key == key) {
+                return {&slots[index].value, false};
+            }
+            if (slots[index].key == TOMBSTONE && reusable == SIZE_MAX) {
+                reusable = index;
+            }
+            index = (index + 1) & mask;
+        }
+
+        if (reusable != SIZE_MAX) {
+            index = reusable;
+            tombstones--;
+        }
+        slots[index].key = key;
+        slots[index].value = std::move(value);
+        count++;
+        return {&slots[index].value, true};
+    }
+
+    /**
+     * @brief Remove key, moving its value to *removed if given. Returns
+     *        false if key was absent.
+     */
+    bool erase(const void* key, V* removed = nullptr) {
+        size_t index = probe(key);
+        if (slots[index].key != key) {
+            return false;
+        }
+        if (removed) {
+            *removed = std::move(slots[index].value);
+        }
+        slots[index].key = TOMBSTONE;
+        slots[index].value = V();
+        count--;
+        tombstones++;
+        return true;
+    }
+
+    /**
+     * @brief Call f(key, value) for every entry, in slot order.
+     */
+    template <typename F>
+    void forEach(F&& f) {
+        for (Slot& slot : slots) {
+            if (slot.key != nullptr && slot.key != TOMBSTONE) {
+                f(slot.key, slot.value);
+            }
+        }
+    }
+
+    /**
+     * @brief Call f(key, value) for the entries in up to maxSlots slots
+     *        starting at slot begin. Returns the slot to resume from, which
+     *        is capacity() once the end is reached.
+     *
+     * Used to walk the table in bounded steps. Erasing the visited entry is
+     * allowed; a resume index is only meaningful while layoutVersion() is
+     * unchanged.
+     */
+    template <typename F>
+    size_t forEachFrom(size_t begin, size_t maxSlots, F&& f) {
+        size_t end = begin + maxSlots < slots.size() ? begin + maxSlots : slots.size();
+        for (size_t index = begin; index < end; ++index) {
+            if (slots[index].key != nullptr && slots[index].key != TOMBSTONE) {
+                f(slots[index].key, slots[index].value);
+            }
+        }
+        return end;
+    }
+
+    void clear() {
+        size_t capacity = slots.size();
+        slots.clear();
+        slots.resize(capacity);
+        count = 0;
+        tombstones = 0;
+        layout++;
+    }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return slots.size(); }
+
+    /**
+     * @brief Changes whenever entries may have moved between slots.
+     */
+    uint64_t layoutVersion() const { return layout; }
+
+private:
+    struct Slot {
+        const void* key = nullptr;
+        V value{};
+    };
+
+    static constexpr size_t MIN_CAPACITY = 16;
+
+    static inline const void* const TOMBSTONE = reinterpret_cast<const void*>(uintptr_t{1});
+
+    static size_t hash(const void* key) {
+        // Pointers are aligned and clustered: mix all bits (murmur3 finalizer)
+        uint64_t x = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(key));
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return static_cast<size_t>(x);
+    }
+
+    // Slot holding key, or the empty slot ending its probe sequence
+    size_t probe(const void* key) const {
+        size_t mask = slots.size() - 1;
+        size_t index = hash(key) & mask;
+        while (slots[index].key != nullptr && slots[index].key != key) {
+            index = (index + 1) & mask;
+        }
+        return index;
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<Slot> old;
+        old.swap(slots);
+        slots.resize(capacity);
+        count = 0;
+        tombstones = 0;
+        layout++;
+        for (Slot& slot : old) {
+            if (slot.key != nullptr && slot.key != TOMBSTONE) {
+                insert(slot.key, std::move(slot.value));
+            }
+        }
+    }
+
+    std::vector<Slot> slots;
+    size_t count = 0;
+    size_t tombstones = 0;
+    uint64_t layout = 0;
+};
+
+} // namespace protojs
+
+#endif // PROTOJS_POINTERTABLE_H
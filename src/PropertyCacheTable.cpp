@@ -0,0 +1,51 @@
+#include "PropertyCacheTable.h"
+
+namespace protojs {
+
+bool PropertyCacheTable::find(uint32_t name, const void* receiver, const proto::ProtoObject** attribute) {
+    auto it = sites.find(name);
+    if (it != sites.end()) {
+        uint64_t current = epoch.load(std::memory_order_relaxed);
+        for (const Entry& entry : it->second.entries) {
+            if (entry.receiver == receiver && entry.epoch == current) {
+                hitCount++;
+                *attribute = entry.attribute;
+                return true;
+            }
+        }
+    }
+    missCount++;
+    return false;
+}
+
+void PropertyCacheTable::fill(uint32_t name, const void* receiver, const proto::ProtoObject* attribute) {
+    put(sites[name], receiver, attribute, epoch.load(std::memory_order_relaxed));
+}
+
+void PropertyCacheTable::store(uint32_t name, const void* receiver, const proto::ProtoObject* attribute) {
+    Site& site = sites[name];
+    site = Site();
+    put(site, receiver, attribute, epoch.load(std::memory_order_relaxed));
+}
+
+void PropertyCacheTable::put(Site& site, const void* receiver, const proto::ProtoObject* attribute, uint64_t current) {
+    // Reuse the receiver's entry, so it never has two, then a stale one
+    // before evicting
+    Entry* slot = nullptr;
+    for (Entry& entry : site.entries) {
+        if (entry.receiver == receiver) {
+            slot = &entry;
+            break;
+        }
+        if (!slot && entry.epoch != current) {
+            slot = &entry;
+        }
+    }
+    if (!slot) {
+        slot = &site.entries[site.nextVictim];
+        site.nextVictim = (site.nextVictim + 1) % WAYS;
+    }
+    *slot = {receiver, attribute, current};
+}
+
+} // namespace protojs
@@ -0,0 +1,96 @@
+#ifndef PROTOJS_PROPERTYCACHETABLE_H
+#define PROTOJS_PROPERTYCACHETABLE_H
+
+#include <atomic>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+
+namespace proto {
+class ProtoObject;
+}
+
+namespace protojs {
+
+/**
+ * @brief Per-context inline caches for ExecutionEngine property access.
+ *
+ * Each property name has one site remembering the attribute resolved for
+ * up to WAYS receivers (polymorphic; one entry is the monomorphic case).
+ * protoCore does not expose object shapes, so an entry is guarded by the
+ * identity of the JS receiver and by the epoch of this table.
+ *
+ * A write only affects its own name: it replaces the writer's entry and
+ * drops the other receivers' entries for that name, which may inherit it.
+ * The epoch moves for what can change every answer: receivers re-mapped
+ * to another ProtoObject or released, and property names released.
+ *
+ * Names are atom ids of the owning context; callers only cache interned
+ * names, which bounds the number of sites. Used from the thread of the
+ * owning context; invalidate() may be called from any thread.
+ */
+class PropertyCacheTable {
+public:
+    /**
+     * @brief Receivers remembered per property name.
+     */
+    static constexpr size_t WAYS = 4;
+
+    PropertyCacheTable() = default;
+    PropertyCacheTable(const PropertyCacheTable&) = delete;
+    PropertyCacheTable& operator=(const PropertyCacheTable&) = delete;
+
+    /**
+     * @brief Look up the attribute cached for receiver. On a hit, returns
+     *        true and sets *attribute, to nullptr if the receiver has none.
+     */
+    bool find(uint32_t name, const void* receiver, const proto::ProtoObject** attribute);
+
+    /**
+     * @brief Remember the attribute resolved for receiver after a miss.
+     */
+    void fill(uint32_t name, const void* receiver, const proto::ProtoObject* attribute);
+
+    /**
+     * @brief Record that receiver's attribute name was written. Entries of
+     *        other names stay valid.
+     */
+    void store(uint32_t name, const void* receiver, const proto::ProtoObject* attribute);
+
+    /**
+     * @brief Invalidate every entry.
+     */
+    void invalidate() { epoch.fetch_add(1, std::memory_order_relaxed); }
+
+    uint64_t hits() const { return hitCount; }
+    uint64_t misses() const { return missCount; }
+
+    /**
+     * @brief Number of property names with a site.
+     */
+    size_t siteCount() const { return sites.size(); }
+
+private:
+    struct Entry {
+        const void* receiver = nullptr;
+        const proto::ProtoObject* attribute = nullptr;
+        // Zero never matches: the epoch starts at 1
+        uint64_t epoch = 0;
+    };
+
+    struct Site {
+        Entry entries[WAYS];
+        size_t nextVictim = 0;
+    };
+
+    static void put(Site& site, const void* receiver, const proto::ProtoObject* attribute, uint64_t current);
+
+    std::unordered_map<uint32_t, Site> sites;
+    std::atomic<uint64_t> epoch{1};
+    uint64_t hitCount = 0;
+    uint64_t missCount = 0;
+};
+
+} // namespace protojs
+
+#endif // PROTOJS_PROPERTYCACHETABLE_H
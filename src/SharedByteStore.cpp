@@ -0,0 +1,114 @@
+#include "SharedByteStore.h"
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+namespace protojs {
+
+namespace {
+
+struct Pin {
+    const proto::ProtoObject* bufferObj;
+    size_t length;
+    // ArrayBuffers currently sharing the storage
+    size_t refs;
+};
+
+std::mutex pinsMutex;
+std::unordered_map<const void*, Pin> pinsByData;
+std::unordered_map<const proto::ProtoObject*, const void*> dataByBuffer;
+
+// Lets toJS skip the lock while nothing is exported
+std::atomic<size_t> pinnedCount{0};
+
+const proto::ProtoByteBuffer* asByteBuffer(const proto::ProtoObject* bufferObj) {
+    // protoCore has no asByteBuffer; see BufferModule
+    return reinterpret_cast<const proto::ProtoByteBuffer*>(bufferObj);
+}
+
+} // namespace
+
+JSValue SharedByteStore::exportBuffer(JSContext* ctx, const proto::ProtoObject* bufferObj, proto::ProtoContext* pContext) {
+    const proto::ProtoByteBuffer* byteBuffer = asByteBuffer(bufferObj);
+    uint8_t* data = reinterpret_cast<uint8_t*>(const_cast<char*>(byteBuffer->getBuffer(pContext)));
+    size_t length = byteBuffer->getSize(pContext);
+    if (!data) {
+        return JS_NewArrayBufferCopy(ctx, nullptr, 0);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pinsMutex);
+        auto it = pinsByData.find(data);
+        if (it != pinsByData.end()) {
+            it->second.refs++;
+        } else {
+            pinsByData.emplace(data, Pin{bufferObj, length, 1});
+            dataByBuffer[bufferObj] = data;
+            pinnedCount++;
+        }
+    }
+
+    JSValue arrayBuffer = JS_NewArrayBuffer(ctx, data, length, release, nullptr, false);
+    if (JS_IsException(arrayBuffer)) {
+        release(JS_GetRuntime(ctx), nullptr, data);
+    }
+    return arrayBuffer;
+}
+
+JSValue SharedByteStore::allocate(JSContext* ctx, size_t size, proto::ProtoContext* pContext) {
+    const proto::ProtoObject* bufferObj = pContext->newBuffer(size);
+    if (!bufferObj) {
+        return JS_ThrowOutOfMemory(ctx);
+    }
+    return exportBuffer(ctx, bufferObj, pContext);
+}
+
+const proto::ProtoObject* SharedByteStore::find(const uint8_t* data, size_t length) {
+    if (pinnedCount.load(std::memory_order_relaxed) == 0) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(pinsMutex);
+    auto it = pinsByData.find(data);
+    if (it == pinsByData.end() || it->second.length != length) {
+        return nullptr;
+    }
+    return it->second.bufferObj;
+}
+
+bool SharedByteStore::isPinned(const proto::ProtoObject* bufferObj) {
+    if (pinnedCount.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(pinsMutex);
+    return dataByBuffer.count(bufferObj) > 0;
+}
+
+const proto::ProtoObject* SharedByteStore::import(const uint8_t* data, size_t length, proto::ProtoContext* pContext) {
+    if (const proto::ProtoObject* pinned = find(data, length)) {
+        return pinned;
+    }
+
+    const proto::ProtoObject* bufferObj = pContext->newBuffer(length);
+    if (bufferObj && length > 0) {
+        char* dest = const_cast<char*>(asByteBuffer(bufferObj)->getBuffer(pContext));
+        std::memcpy(dest, data, length);
+    }
+    return bufferObj;
+}
+
+void SharedByteStore::release(JSRuntime*, void*, void* ptr) {
+    std::lock_guard<std::mutex> lock(pinsMutex);
+    auto it = pinsByData.find(ptr);
+    if (it == pinsByData.end()) {
+        return;
+    }
+    if (--it->second.refs == 0) {
+        // The storage belongs to protoCore: unpin, never free
+        dataByBuffer.erase(it->second.bufferObj);
+        pinsByData.erase(it);
+        pinnedCount--;
+    }
+}
+
+} // namespace protojs
@@ -0,0 +1,59 @@
+#ifndef PROTOJS_SHAREDBYTESTORE_H
+#define PROTOJS_SHAREDBYTESTORE_H
+
+#include "quickjs.h"
+#include "headers/protoCore.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace protojs {
+
+/**
+ * @brief ProtoByteBuffer storage shared with JS ArrayBuffers.
+ *
+ * exportBuffer() wraps the bytes of a ProtoByteBuffer in an ArrayBuffer
+ * without copying. The buffer is pinned in a registry for as long as any
+ * such ArrayBuffer is alive; QuickJS drops the pin through the free callback
+ * of JS_NewArrayBuffer. Converting a pinned ArrayBuffer (or a TypedArray
+ * over all of it) back to protoCore returns the original ProtoByteBuffer.
+ *
+ * protoCore cannot wrap external memory and has no byte-buffer type test,
+ * so bytes owned by QuickJS are copied once on import, and TypeBridge::toJS
+ * only recognizes buffers that are currently pinned.
+ */
+class SharedByteStore {
+public:
+    /**
+     * @brief ArrayBuffer over the storage of a ProtoByteBuffer.
+     */
+    static JSValue exportBuffer(JSContext* ctx, const proto::ProtoObject* bufferObj, proto::ProtoContext* pContext);
+
+    /**
+     * @brief New ProtoByteBuffer of size bytes, exported as an ArrayBuffer.
+     */
+    static JSValue allocate(JSContext* ctx, size_t size, proto::ProtoContext* pContext);
+
+    /**
+     * @brief ProtoByteBuffer whose whole storage is [data, data + length),
+     *        or nullptr if no pinned buffer matches.
+     */
+    static const proto::ProtoObject* find(const uint8_t* data, size_t length);
+
+    /**
+     * @brief Whether bufferObj backs a live ArrayBuffer.
+     */
+    static bool isPinned(const proto::ProtoObject* bufferObj);
+
+    /**
+     * @brief ProtoByteBuffer for bytes owned by QuickJS: the pinned buffer
+     *        if they are one, otherwise a copy.
+     */
+    static const proto::ProtoObject* import(const uint8_t* data, size_t length, proto::ProtoContext* pContext);
+
+private:
+    static void release(JSRuntime* rt, void* opaque, void* ptr);
+};
+
+} // namespace protojs
+
+#endif // PROTOJS_SHAREDBYTESTORE_H
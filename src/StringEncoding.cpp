@@ -0,0 +1,78 @@
+#include "StringEncoding.h"
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace protojs {
+
+size_t StringEncoding::asciiPrefixLength(const uint8_t* data, size_t length) {
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    for (; i + 16 <= length; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        if (_mm_movemask_epi8(chunk) != 0) {
+            break;
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    for (; i + 16 <= length; i += 16) {
+        if (vmaxvq_u8(vld1q_u8(data + i)) >= 0x80) {
+            break;
+        }
+    }
+#else
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        if (word & 0x8080808080808080ULL) {
+            break;
+        }
+    }
+#endif
+
+    // Tail, or the block holding the first non-ASCII byte
+    while (i < length && data[i] < 0x80) {
+        i++;
+    }
+    return i;
+}
+
+void StringEncoding::appendLatin1AsUTF8(const uint8_t* data, size_t length, std::string& out) {
+    size_t i = 0;
+    while (i < length) {
+        size_t run = asciiPrefixLength(data + i, length - i);
+        out.append(reinterpret_cast<const char*>(data + i), run);
+        i += run;
+        // Latin-1 bytes above 0x7F take two UTF-8 bytes
+        while (i < length && data[i] >= 0x80) {
+            out += static_cast<char>(0xC0 | (data[i] >> 6));
+            out += static_cast<char>(0x80 | (data[i] & 0x3F));
+            i++;
+        }
+    }
+}
+
+void StringEncoding::appendUTF8(uint32_t codePoint, std::string& out) {
+    if (codePoint < 0x80) {
+        out += static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+} // namespace protojs
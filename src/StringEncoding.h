@@ -0,0 +1,45 @@
+#ifndef PROTOJS_STRINGENCODING_H
+#define PROTOJS_STRINGENCODING_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace protojs {
+
+/**
+ * @brief Byte-level string encoding helpers used on the string conversion
+ *        paths (TypeBridge, Logger).
+ *
+ * ASCII scanning uses SSE2 or NEON when available and 8-byte words
+ * otherwise.
+ */
+class StringEncoding {
+public:
+    /**
+     * @brief Length of the leading run of ASCII bytes in data.
+     */
+    static size_t asciiPrefixLength(const uint8_t* data, size_t length);
+
+    /**
+     * @brief Whether all bytes of data are ASCII.
+     */
+    static bool isAscii(const uint8_t* data, size_t length) {
+        return asciiPrefixLength(data, length) == length;
+    }
+
+    /**
+     * @brief Append Latin-1 text to out as UTF-8. ASCII runs are copied in
+     *        bulk.
+     */
+    static void appendLatin1AsUTF8(const uint8_t* data, size_t length, std::string& out);
+
+    /**
+     * @brief Append one code point to out as UTF-8.
+     */
+    static void appendUTF8(uint32_t codePoint, std::string& out);
+};
+
+} // namespace protojs
+
+#endif // PROTOJS_STRINGENCODING_H
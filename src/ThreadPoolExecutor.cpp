@@ -1,27 +1,246 @@
 #include "ThreadPoolExecutor.h"
 #include <iostream>
 #include <stdexcept>
+#include <algorithm>
+#include <vector>
 
 namespace protojs {
 
-ThreadPoolExecutor::ThreadPoolExecutor(size_t numThreads, const std::string& name)
+namespace {
+
+// Worker identity of the calling thread, so submissions from inside a task
+// land in that worker's own deque
+thread_local const ThreadPoolExecutor* currentPool = nullptr;
+thread_local size_t currentWorker = 0;
+
+// Most tasks taken from the injection queue in one lock acquisition
+constexpr size_t MAX_INJECTION_BATCH = 32;
+
+uint64_t nextRandom(uint64_t& state) {
+    // xorshift64
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// Free task nodes. Each thread keeps a small cache and exchanges batches with
+// a shared list, so nodes freed on workers flow back to submitting threads
+// without a lock per task.
+template <typename Node>
+class NodePool {
+public:
+    static constexpr size_t LOCAL_LIMIT = 128;
+    static constexpr size_t BATCH = 64;
+    static constexpr size_t SHARED_LIMIT = 8192;
+
+    static NodePool& instance() {
+        // Never destroyed: worker threads of static pools return their
+        // caches during exit, after function-local statics may be gone
+        static NodePool* pool = new NodePool();
+        return *pool;
+    }
+
+    Node* acquire() {
+        std::vector<Node*>& cache = localCache().nodes;
+        if (cache.empty()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            size_t n = std::min(BATCH, shared.size());
+            cache.insert(cache.end(), shared.end() - n, shared.end());
+            shared.resize(shared.size() - n);
+        }
+        if (cache.empty()) {
+            return new Node();
+        }
+        Node* node = cache.back();
+        cache.pop_back();
+        return node;
+    }
+
+    void release(Node* node) {
+        std::vector<Node*>& cache = localCache().nodes;
+        cache.push_back(node);
+        if (cache.size() > LOCAL_LIMIT) {
+            giveBack(cache, BATCH);
+        }
+    }
+
+private:
+    struct LocalCache {
+        std::vector<Node*> nodes;
+        LocalCache() { nodes.reserve(LOCAL_LIMIT + 1); }
+        ~LocalCache() { NodePool::instance().giveBack(nodes, nodes.size()); }
+    };
+
+    static LocalCache& localCache() {
+        thread_local LocalCache cache;
+        return cache;
+    }
+
+    void giveBack(std::vector<Node*>& cache, size_t count) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < count; ++i) {
+            Node* node = cache.back();
+            cache.pop_back();
+            if (shared.size() < SHARED_LIMIT) {
+                shared.push_back(node);
+            } else {
+                delete node;
+            }
+        }
+    }
+
+    std::mutex mutex;
+    std::vector<Node*> shared;
+};
+
+} // namespace
+
+ThreadPoolExecutor::TaskNode* ThreadPoolExecutor::acquireNode() {
+    return NodePool<TaskNode>::instance().acquire();
+}
+
+void ThreadPoolExecutor::releaseNode(TaskNode* node) {
+    // Drop captured state now rather than when the node is reused
+    node->task.reset();
+    node->next = nullptr;
+    NodePool<TaskNode>::instance().release(node);
+}
+
+ThreadPoolExecutor::ThreadPoolExecutor(size_t numThreads, const std::string& name, SchedulingMode mode,
+                                       WorkerHooks hooks)
     : poolName(name)
+    , mode(mode)
     , shutdownFlag(false)
     , shutdownNowFlag(false)
     , activeCount(0)
+    , hooks(std::move(hooks))
 {
     if (numThreads == 0) {
         throw std::invalid_argument("ThreadPoolExecutor: numThreads must be > 0");
     }
-    
+
     threads.reserve(numThreads);
-    for (size_t i = 0; i < numThreads; ++i) {
-        threads.emplace_back(&ThreadPoolExecutor::workerThread, this);
+    if (mode == SchedulingMode::WorkStealing) {
+        workers.reserve(numThreads);
+        for (size_t i = 0; i < numThreads; ++i) {
+            workers.push_back(std::make_unique<Worker>());
+        }
+        for (size_t i = 0; i < numThreads; ++i) {
+            threads.emplace_back(&ThreadPoolExecutor::stealingWorkerThread, this, i);
+        }
+    } else {
+        for (size_t i = 0; i < numThreads; ++i) {
+            threads.emplace_back(&ThreadPoolExecutor::workerThread, this, i);
+        }
+    }
+
+    // Workers are fully warmed up before the pool is handed out
+    std::unique_lock<std::mutex> lock(startMutex);
+    startCondition.wait(lock, [this, numThreads] {
+        return startedWorkers == numThreads;
+    });
+}
+
+void ThreadPoolExecutor::runStartHook(size_t index) {
+    if (hooks.onStart) {
+        try {
+            hooks.onStart(index);
+        } catch (const std::exception& e) {
+            std::cerr << "Exception in thread pool '" << poolName
+                     << "' worker start hook: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "Unknown exception in thread pool '" << poolName
+                     << "' worker start hook" << std::endl;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(startMutex);
+        startedWorkers++;
+    }
+    startCondition.notify_all();
+}
+
+void ThreadPoolExecutor::runStopHook(size_t index) {
+    if (hooks.onStop) {
+        try {
+            hooks.onStop(index);
+        } catch (...) {
+            std::cerr << "Exception in thread pool '" << poolName
+                     << "' worker stop hook" << std::endl;
+        }
     }
 }
 
 ThreadPoolExecutor::~ThreadPoolExecutor() {
     shutdown();
+    discardQueuedTasks();
+}
+
+bool ThreadPoolExecutor::enqueue(TaskNode* node, TaskPriority priority) {
+    if (mode == SchedulingMode::FIFO) {
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+
+            if (!shutdownFlag) {
+                taskQueue.push(node, priority);
+                node = nullptr;
+            }
+        }
+
+        if (node) {
+            releaseNode(node);
+            return false;
+        }
+        condition.notify_one();
+        return true;
+    }
+
+    if (currentPool == this && priority == TaskPriority::Normal) {
+        // Submitted by one of our own tasks: keep it local and cache-warm
+        workers[currentWorker]->deque.push(node);
+    } else {
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+
+            if (!shutdownFlag) {
+                injectionQueue.push(node, priority);
+                if (priority == TaskPriority::High) {
+                    urgentInjected++;
+                }
+                node = nullptr;
+            }
+        }
+
+        if (node) {
+            releaseNode(node);
+            return false;
+        }
+    }
+
+    signalWork();
+    return true;
+}
+
+void ThreadPoolExecutor::signalWork() {
+    workEpoch.fetch_add(1);
+    // An RMW rather than a load: it orders against the parking worker's
+    // increment, so either its re-check sees the new task or we see it idle
+    if (idleWorkers.fetch_add(0) > 0) {
+        {
+            std::lock_guard<std::mutex> lock(parkMutex);
+        }
+        parkCondition.notify_one();
+    }
+}
+
+void ThreadPoolExecutor::wakeAllWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(parkMutex);
+        workEpoch.fetch_add(1);
+    }
+    parkCondition.notify_all();
 }
 
 void ThreadPoolExecutor::shutdown() {
@@ -30,14 +249,17 @@ void ThreadPoolExecutor::shutdown() {
         shutdownFlag = true;
     }
     condition.notify_all();
-    
-    {
+
+    if (mode == SchedulingMode::WorkStealing) {
+        // Workers drain every reachable queue before exiting
+        wakeAllWorkers();
+    } else {
         std::unique_lock<std::mutex> lock(queueMutex);
         condition.wait(lock, [this] {
             return taskQueue.empty() && activeCount.load() == 0;
         });
     }
-    
+
     for (auto& thread : threads) {
         if (thread.joinable()) {
             thread.join();
@@ -50,20 +272,40 @@ void ThreadPoolExecutor::shutdownNow() {
         std::lock_guard<std::mutex> lock(queueMutex);
         shutdownNowFlag = true;
         shutdownFlag = true;
-        
+
         // Clear the queue
-        while (!taskQueue.empty()) {
-            taskQueue.pop();
+        while (TaskNode* node = taskQueue.pop()) {
+            releaseNode(node);
         }
     }
-    
+
     condition.notify_all();
-    
+    wakeAllWorkers();
+
     for (auto& thread : threads) {
         if (thread.joinable()) {
             thread.join();
         }
     }
+
+    discardQueuedTasks();
+}
+
+void ThreadPoolExecutor::discardQueuedTasks() {
+    // Only called once every worker has been joined
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        while (TaskNode* node = injectionQueue.pop()) {
+            releaseNode(node);
+        }
+        urgentInjected = 0;
+    }
+    for (auto& worker : workers) {
+        TaskNode* node;
+        while (worker->deque.pop(node)) {
+            releaseNode(node);
+        }
+    }
 }
 
 size_t ThreadPoolExecutor::getActiveCount() const {
@@ -72,46 +314,156 @@ size_t ThreadPoolExecutor::getActiveCount() const {
 
 size_t ThreadPoolExecutor::getQueueSize() const {
     std::lock_guard<std::mutex> lock(queueMutex);
-    return taskQueue.size();
+    size_t size = taskQueue.size() + injectionQueue.size();
+    for (const auto& worker : workers) {
+        size += worker->deque.size();
+    }
+    return size;
+}
+
+void ThreadPoolExecutor::runTask(TaskNode* node) {
+    try {
+        node->task();
+    } catch (const std::exception& e) {
+        std::cerr << "Exception in thread pool '" << poolName
+                 << "': " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unknown exception in thread pool '" << poolName << "'" << std::endl;
+    }
+    releaseNode(node);
 }
 
-void ThreadPoolExecutor::workerThread() {
+void ThreadPoolExecutor::workerThread(size_t index) {
+    runStartHook(index);
+
     while (true) {
-        std::function<void()> task;
-        
+        TaskNode* task = nullptr;
+
         {
             std::unique_lock<std::mutex> lock(queueMutex);
-            
+
             condition.wait(lock, [this] {
                 return !taskQueue.empty() || shutdownFlag;
             });
-            
+
             if (shutdownFlag && (taskQueue.empty() || shutdownNowFlag)) {
                 break;
             }
-            
-            if (!taskQueue.empty()) {
-                task = std::move(taskQueue.front());
-                taskQueue.pop();
+
+            task = taskQueue.pop();
+            if (task) {
                 activeCount++;
             }
         }
-        
+
         if (task) {
-            try {
-                task();
-            } catch (const std::exception& e) {
-                std::cerr << "Exception in thread pool '" << poolName 
-                         << "': " << e.what() << std::endl;
-            } catch (...) {
-                std::cerr << "Unknown exception in thread pool '" << poolName << "'" << std::endl;
-            }
-            
+            runTask(task);
             activeCount--;
         }
-        
+
         condition.notify_all();
     }
+
+    runStopHook(index);
+}
+
+ThreadPoolExecutor::TaskNode* ThreadPoolExecutor::findTask(size_t index, uint64_t& rng) {
+    Worker& self = *workers[index];
+    TaskNode* task = nullptr;
+
+    // High tasks are shared and overtake everything a worker holds locally
+    if (urgentInjected.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        TaskList& urgent = injectionQueue[TaskPriority::High];
+        if (!urgent.empty()) {
+            urgentInjected--;
+            return urgent.pop();
+        }
+    }
+
+    if (self.deque.pop(task)) {
+        return task;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        TaskList& normal = injectionQueue[TaskPriority::Normal];
+        if (!normal.empty()) {
+            task = normal.pop();
+
+            // Take a fair share of the backlog so we come back less often
+            size_t share = std::min(normal.size() / workers.size(), MAX_INJECTION_BATCH);
+            for (size_t i = 0; i < share; ++i) {
+                self.deque.push(normal.pop());
+            }
+            if (share > 0) {
+                signalWork();
+            }
+            return task;
+        }
+    }
+
+    const size_t count = workers.size();
+    if (count > 1) {
+        size_t start = static_cast<size_t>(nextRandom(rng) % count);
+        for (size_t i = 0; i < count; ++i) {
+            size_t victim = (start + i) % count;
+            if (victim != index && workers[victim]->deque.steal(task)) {
+                stealCount.fetch_add(1, std::memory_order_relaxed);
+                return task;
+            }
+        }
+    }
+
+    // Low tasks only run when nothing else is reachable. Re-check every
+    // lane under the lock so a task published meanwhile is not missed.
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (!injectionQueue[TaskPriority::High].empty()) {
+        urgentInjected--;
+    }
+    return injectionQueue.pop();
+}
+
+void ThreadPoolExecutor::stealingWorkerThread(size_t index) {
+    currentPool = this;
+    currentWorker = index;
+    runStartHook(index);
+    uint64_t rng = 0x9E3779B97F4A7C15ULL * (index + 1);
+
+    while (!shutdownNowFlag) {
+        TaskNode* task = findTask(index, rng);
+
+        if (!task) {
+            if (shutdownFlag) {
+                // Nothing left anywhere we can reach; our own deque is empty
+                break;
+            }
+
+            // Park: advertise ourselves as idle, then re-check so a task
+            // published concurrently is not missed
+            uint64_t epoch = workEpoch.load();
+            idleWorkers.fetch_add(1);
+            task = findTask(index, rng);
+            if (!task) {
+                std::unique_lock<std::mutex> lock(parkMutex);
+                parkCondition.wait(lock, [this, epoch] {
+                    return workEpoch.load() != epoch || shutdownFlag;
+                });
+            }
+            idleWorkers.fetch_sub(1);
+
+            if (!task) {
+                continue;
+            }
+        }
+
+        activeCount++;
+        runTask(task);
+        activeCount--;
+    }
+
+    runStopHook(index);
+    currentPool = nullptr;
 }
 
 } // namespace protojs
@@ -3,21 +3,64 @@
 
 #include <thread>
 #include <vector>
-#include <queue>
 #include <mutex>
 #include <condition_variable>
 #include <future>
 #include <functional>
 #include <atomic>
 #include <string>
+#include <memory>
+#include <stdexcept>
+#include <array>
+#include "InlineCallback.h"
+#include "WorkStealingDeque.h"
 
 namespace protojs {
 
+/**
+ * @brief Task scheduling strategy of a ThreadPoolExecutor.
+ */
+enum class SchedulingMode {
+    /** Single shared FIFO queue behind one mutex. */
+    FIFO,
+    /** Per-worker Chase-Lev deques with randomized stealing. */
+    WorkStealing
+};
+
+/**
+ * @brief Priority lane of a task.
+ *
+ * Queued High tasks run before Normal ones, and Low tasks only run when no
+ * other work is queued. Running tasks are never preempted.
+ */
+enum class TaskPriority {
+    High,
+    Normal,
+    Low
+};
+
+/**
+ * @brief Callbacks run on each worker thread, given the worker index.
+ *
+ * onStart runs before the worker takes its first task, and the executor
+ * constructor returns only after every onStart has finished. onStop runs
+ * when the worker exits.
+ */
+struct WorkerHooks {
+    std::function<void(size_t)> onStart;
+    std::function<void(size_t)> onStop;
+};
+
 /**
  * @brief Generic thread pool executor, similar to Java's ExecutorService.
  * 
  * Manages a pool of worker threads that execute tasks from a queue.
  * Supports graceful shutdown and provides metrics.
+ *
+ * In WorkStealing mode each worker owns a deque: tasks submitted from a
+ * worker go to its own deque and are popped LIFO, tasks from other threads
+ * go through a shared injection queue, and idle workers steal from random
+ * victims before parking. A submission wakes at most one parked worker.
  */
 class ThreadPoolExecutor {
 public:
@@ -25,8 +68,11 @@ public:
      * @brief Constructs a thread pool executor.
      * @param numThreads Number of worker threads in the pool
      * @param name Name of the pool (for debugging/logging)
+     * @param mode Scheduling strategy (default: FIFO)
+     * @param hooks Per-worker start/stop callbacks (optional)
      */
-    ThreadPoolExecutor(size_t numThreads, const std::string& name = "ThreadPool");
+    ThreadPoolExecutor(size_t numThreads, const std::string& name = "ThreadPool",
+                       SchedulingMode mode = SchedulingMode::FIFO, WorkerHooks hooks = {});
     
     /**
      * @brief Destructor. Performs graceful shutdown.
@@ -42,28 +88,38 @@ public:
     auto submit(F&& task) -> std::future<decltype(task())> {
         using ReturnType = decltype(task());
         
-        auto packagedTask = std::make_shared<std::packaged_task<ReturnType()>>(
-            std::forward<F>(task)
-        );
-        
-        std::future<ReturnType> result = packagedTask->get_future();
+        std::packaged_task<ReturnType()> packagedTask(std::forward<F>(task));
+        std::future<ReturnType> result = packagedTask.get_future();
         
-        {
-            std::unique_lock<std::mutex> lock(queueMutex);
-            
-            if (shutdownFlag) {
-                throw std::runtime_error("ThreadPoolExecutor is shutdown");
-            }
-            
-            taskQueue.emplace([packagedTask]() {
-                (*packagedTask)();
-            });
-        }
-        
-        condition.notify_one();
+        execute(std::move(packagedTask));
         return result;
     }
     
+    /**
+     * @brief Runs a task without creating a future (fire-and-forget).
+     * @param task Callable object; exceptions are logged, not propagated
+     * @throws std::runtime_error if the pool is shutdown
+     *
+     * Task nodes come from a per-thread pool and small callables are stored
+     * inline, so the common case performs no heap allocation.
+     */
+    template<typename F>
+    void execute(F&& task, TaskPriority priority = TaskPriority::Normal) {
+        if (!post(std::forward<F>(task), priority)) {
+            throw std::runtime_error("ThreadPoolExecutor is shutdown");
+        }
+    }
+    
+    /**
+     * @brief Like execute(), but returns false instead of throwing when shutdown.
+     */
+    template<typename F>
+    bool post(F&& task, TaskPriority priority = TaskPriority::Normal) {
+        TaskNode* node = acquireNode();
+        node->task = InlineCallback(std::forward<F>(task));
+        return enqueue(node, priority);
+    }
+    
     /**
      * @brief Initiates graceful shutdown.
      * 
@@ -102,18 +158,143 @@ public:
      * @brief Checks if the pool is shutdown.
      */
     bool isShutdown() const { return shutdownFlag; }
+    
+    /**
+     * @brief Returns the scheduling strategy of this pool.
+     */
+    SchedulingMode getSchedulingMode() const { return mode; }
+    
+    /**
+     * @brief Returns the number of tasks taken from another worker's deque.
+     */
+    size_t getStealCount() const { return stealCount.load(); }
 
 private:
-    void workerThread();
+    /**
+     * @brief Pooled, intrusively linked task.
+     */
+    struct TaskNode {
+        InlineCallback task;
+        TaskNode* next = nullptr;
+    };
+    
+    /**
+     * @brief Intrusive FIFO of task nodes.
+     */
+    struct TaskList {
+        TaskNode* head = nullptr;
+        TaskNode* tail = nullptr;
+        size_t count = 0;
+        
+        bool empty() const { return head == nullptr; }
+        size_t size() const { return count; }
+        void push(TaskNode* node) {
+            node->next = nullptr;
+            if (tail) {
+                tail->next = node;
+            } else {
+                head = node;
+            }
+            tail = node;
+            count++;
+        }
+        TaskNode* pop() {
+            TaskNode* node = head;
+            head = node->next;
+            if (!head) {
+                tail = nullptr;
+            }
+            node->next = nullptr;
+            count--;
+            return node;
+        }
+    };
+    
+    /**
+     * @brief One TaskList per TaskPriority, highest first.
+     */
+    struct TaskLanes {
+        std::array<TaskList, 3> lanes;
+        
+        bool empty() const {
+            return lanes[0].empty() && lanes[1].empty() && lanes[2].empty();
+        }
+        size_t size() const {
+            return lanes[0].size() + lanes[1].size() + lanes[2].size();
+        }
+        TaskList& operator[](TaskPriority priority) {
+            return lanes[static_cast<size_t>(priority)];
+        }
+        void push(TaskNode* node, TaskPriority priority) {
+            (*this)[priority].push(node);
+        }
+        TaskNode* pop() {
+            for (TaskList& lane : lanes) {
+                if (!lane.empty()) {
+                    return lane.pop();
+                }
+            }
+            return nullptr;
+        }
+    };
+    
+    struct Worker {
+        WorkStealingDeque<TaskNode*> deque;
+    };
+    
+    static TaskNode* acquireNode();
+    static void releaseNode(TaskNode* node);
+    
+    /**
+     * @brief Queue a task node; releases it and returns false after shutdown.
+     */
+    bool enqueue(TaskNode* node, TaskPriority priority);
+    
+    void workerThread(size_t index);
+    void stealingWorkerThread(size_t index);
+    void runStartHook(size_t index);
+    void runStopHook(size_t index);
+    
+    /**
+     * @brief Next task for a worker: High lane, own deque, Normal lane,
+     *        steal, then Low lane.
+     */
+    TaskNode* findTask(size_t index, uint64_t& rng);
+    
+    /**
+     * @brief Wake one parked worker, if any, after new work was published.
+     */
+    void signalWork();
+    
+    void runTask(TaskNode* node);
+    void wakeAllWorkers();
+    void discardQueuedTasks();
     
     std::string poolName;
+    SchedulingMode mode;
     std::vector<std::thread> threads;
-    std::queue<std::function<void()>> taskQueue;
+    TaskLanes taskQueue;
     mutable std::mutex queueMutex;
     std::condition_variable condition;
     std::atomic<bool> shutdownFlag;
     std::atomic<bool> shutdownNowFlag;
     std::atomic<size_t> activeCount;
+    
+    WorkerHooks hooks;
+    std::mutex startMutex;
+    std::condition_variable startCondition;
+    size_t startedWorkers = 0;
+    
+    // WorkStealing mode; the injection queue is guarded by queueMutex.
+    // Only Normal tasks go to worker deques; the other lanes stay shared.
+    std::vector<std::unique_ptr<Worker>> workers;
+    TaskLanes injectionQueue;
+    std::atomic<size_t> urgentInjected{0};   // Queued High tasks
+    std::mutex parkMutex;
+    std::condition_variable parkCondition;
+    std::atomic<size_t> idleWorkers{0};
+    std::atomic<uint64_t> workEpoch{0};
+    std::atomic<size_t> stealCount{0};
 };
 
 } // namespace protojs
@@ -0,0 +1,292 @@
+#include "TimerWheel.h"
+#include <iostream>
+#include <algorithm>
+
+namespace protojs {
+
+namespace {
+
+// Index of the first set bit at or after 'from' in a bitmap of 'words' words,
+// or -1 if none.
+int findNextSet(const uint64_t* bitmap, int words, int from) {
+    int word = from / 64;
+    if (word >= words) return -1;
+    uint64_t bits = bitmap[word] & (~0ULL << (from % 64));
+    while (true) {
+        if (bits) {
+            return word * 64 + __builtin_ctzll(bits);
+        }
+        if (++word >= words) return -1;
+        bits = bitmap[word];
+    }
+}
+
+// First set bit scanning cyclically from 'from'; -1 if the bitmap is empty.
+int findNextSetCyclic(const uint64_t* bitmap, int words, int from) {
+    int found = findNextSet(bitmap, words, from);
+    if (found < 0 && from > 0) {
+        found = findNextSet(bitmap, words, 0);
+    }
+    return found;
+}
+
+} // namespace
+
+TimerWheel::TimerWheel(uint64_t nowMs) : currentTick(nowMs) {}
+
+TimerWheel::~TimerWheel() {
+    clear();
+}
+
+TimerWheel::Link& TimerWheel::slotHead(int level, int index) {
+    return level == 0 ? root[index] : upper[level - 1][index];
+}
+
+void TimerWheel::setSlotBit(int level, int index, bool occupied) {
+    uint64_t* word = level == 0 ? &rootBitmap[index / 64] : &upperBitmap[level - 1];
+    uint64_t mask = 1ULL << (index % 64);
+    if (occupied) {
+        *word |= mask;
+    } else {
+        *word &= ~mask;
+    }
+}
+
+void TimerWheel::insert(Node* node) {
+    uint64_t expiry = std::max(node->expiry, currentTick);
+    uint64_t delta = std::min(expiry - currentTick, MAX_DELAY_MS);
+    expiry = currentTick + delta;
+
+    int level = 0;
+    int index = static_cast<int>(expiry & (ROOT_SIZE - 1));
+    for (int l = 1; l <= UPPER_LEVELS; ++l) {
+        int shift = ROOT_BITS + (l - 1) * LEVEL_BITS;
+        if (delta < (1ULL << shift)) {
+            break;
+        }
+        level = l;
+        index = static_cast<int>((expiry >> shift) & (LEVEL_SIZE - 1));
+    }
+
+    node->level = level;
+    node->slot = index;
+    slotHead(level, index).pushBack(node);
+    setSlotBit(level, index, true);
+}
+
+void TimerWheel::detach(Node* node) {
+    int level = node->level;
+    int index = node->slot;
+    node->unlink();
+    node->level = -1;
+    if (level >= 0 && slotHead(level, index).empty()) {
+        setSlotBit(level, index, false);
+    }
+}
+
+void TimerWheel::cascade(int level, int index) {
+    Link& head = slotHead(level, index);
+    if (head.empty()) {
+        return;
+    }
+
+    Link moving;
+    moving.next = head.next;
+    moving.prev = head.prev;
+    moving.next->prev = &moving;
+    moving.prev->next = &moving;
+    head.prev = head.next = &head;
+    setSlotBit(level, index, false);
+
+    while (!moving.empty()) {
+        Node* node = static_cast<Node*>(moving.next);
+        node->unlink();
+        insert(node);
+    }
+}
+
+TimerWheel::TimerId TimerWheel::schedule(uint64_t nowMs, uint64_t delayMs, Callback callback, uint64_t repeatMs) {
+    auto node = std::make_unique<Node>();
+    node->id = nextId++;
+    node->delay = std::min(delayMs, MAX_DELAY_MS);
+    node->repeat = std::min(repeatMs, MAX_DELAY_MS);
+    node->expiry = nowMs + node->delay;
+    node->callback = std::make_shared<Callback>(std::move(callback));
+
+    Node* raw = node.get();
+    timers.emplace(raw->id, std::move(node));
+    insert(raw);
+    refTimers++;
+    return raw->id;
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    auto it = timers.find(id);
+    if (it == timers.end()) {
+        return false;
+    }
+    Node* node = it->second.get();
+    detach(node);
+    if (node->ref) {
+        refTimers--;
+    }
+    timers.erase(it);
+    return true;
+}
+
+bool TimerWheel::refresh(TimerId id, uint64_t nowMs) {
+    auto it = timers.find(id);
+    if (it == timers.end()) {
+        return false;
+    }
+    Node* node = it->second.get();
+    detach(node);
+    node->expiry = nowMs + node->delay;
+    insert(node);
+    return true;
+}
+
+bool TimerWheel::setRef(TimerId id, bool ref) {
+    auto it = timers.find(id);
+    if (it == timers.end()) {
+        return false;
+    }
+    Node* node = it->second.get();
+    if (node->ref != ref) {
+        node->ref = ref;
+        if (ref) {
+            refTimers++;
+        } else {
+            refTimers--;
+        }
+    }
+    return true;
+}
+
+bool TimerWheel::hasRef(TimerId id) const {
+    auto it = timers.find(id);
+    return it != timers.end() && it->second->ref;
+}
+
+size_t TimerWheel::advance(uint64_t nowMs) {
+    size_t fired = 0;
+
+    while (currentTick <= nowMs) {
+        if (timers.empty()) {
+            currentTick = nowMs + 1;
+            break;
+        }
+
+        int index = static_cast<int>(currentTick & (ROOT_SIZE - 1));
+        if (index == 0) {
+            // Pull the next span of each coarser level down, stopping at the
+            // first level whose index did not wrap
+            for (int level = 1; level <= UPPER_LEVELS; ++level) {
+                int shift = ROOT_BITS + (level - 1) * LEVEL_BITS;
+                int levelIndex = static_cast<int>((currentTick >> shift) & (LEVEL_SIZE - 1));
+                cascade(level, levelIndex);
+                if (levelIndex != 0) {
+                    break;
+                }
+            }
+        } else if (root[index].empty()) {
+            // Skip empty slots up to the next occupied one or the next cascade
+            int next = findNextSet(rootBitmap, ROOT_SIZE / 64, index);
+            uint64_t blockStart = currentTick & ~static_cast<uint64_t>(ROOT_SIZE - 1);
+            uint64_t target = blockStart + (next >= 0 ? next : ROOT_SIZE);
+            currentTick = std::min(target, nowMs + 1);
+            continue;
+        }
+
+        Link& head = root[index];
+        // Advance first so timers scheduled by callbacks land in a later slot
+        currentTick++;
+        if (head.empty()) {
+            continue;
+        }
+
+        Link due;
+        due.next = head.next;
+        due.prev = head.prev;
+        due.next->prev = &due;
+        due.prev->next = &due;
+        head.prev = head.next = &head;
+        setSlotBit(0, index, false);
+
+        while (!due.empty()) {
+            Node* node = static_cast<Node*>(due.next);
+            node->unlink();
+            node->level = -1;
+
+            std::shared_ptr<Callback> callback = node->callback;
+            if (node->repeat > 0) {
+                node->expiry = nowMs + node->repeat;
+                insert(node);
+            } else {
+                TimerId id = node->id;
+                if (node->ref) {
+                    refTimers--;
+                }
+                timers.erase(id);
+            }
+
+            fired++;
+            try {
+                (*callback)();
+            } catch (const std::exception& e) {
+                std::cerr << "Exception in timer callback: " << e.what() << std::endl;
+            } catch (...) {
+                std::cerr << "Unknown exception in timer callback" << std::endl;
+            }
+        }
+    }
+
+    return fired;
+}
+
+int64_t TimerWheel::nextTimeoutMs(uint64_t nowMs) const {
+    if (timers.empty()) {
+        return -1;
+    }
+
+    const uint64_t tick = currentTick;
+    uint64_t deadline = UINT64_MAX;
+
+    int rootIndex = static_cast<int>(tick & (ROOT_SIZE - 1));
+    int slot = findNextSetCyclic(rootBitmap, ROOT_SIZE / 64, rootIndex);
+    if (slot >= 0) {
+        deadline = tick + ((static_cast<uint64_t>(slot) - tick) & (ROOT_SIZE - 1));
+    }
+
+    // A coarser slot has to be cascaded when the wheel reaches its span
+    for (int level = 1; level <= UPPER_LEVELS; ++level) {
+        if (!upperBitmap[level - 1]) {
+            continue;
+        }
+        int shift = ROOT_BITS + (level - 1) * LEVEL_BITS;
+        uint64_t span = 1ULL << shift;
+        uint64_t boundary = (tick + span - 1) & ~(span - 1);
+        int boundaryIndex = static_cast<int>((boundary >> shift) & (LEVEL_SIZE - 1));
+        int next = findNextSetCyclic(&upperBitmap[level - 1], 1, boundaryIndex);
+        uint64_t steps = static_cast<uint64_t>((next - boundaryIndex) & (LEVEL_SIZE - 1));
+        deadline = std::min(deadline, boundary + steps * span);
+    }
+
+    if (deadline <= nowMs) {
+        return 0;
+    }
+    return static_cast<int64_t>(deadline - nowMs);
+}
+
+void TimerWheel::clear() {
+    for (auto& [id, node] : timers) {
+        node->unlink();
+        node->level = -1;
+    }
+    timers.clear();
+    refTimers = 0;
+    std::fill(std::begin(rootBitmap), std::end(rootBitmap), 0);
+    std::fill(std::begin(upperBitmap), std::end(upperBitmap), 0);
+}
+
+} // namespace protojs
@@ -0,0 +1,160 @@
+#ifndef PROTOJS_TIMERWHEEL_H
+#define PROTOJS_TIMERWHEEL_H
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+namespace protojs {
+
+/**
+ * @brief Hashed hierarchical timer wheel with millisecond resolution.
+ *
+ * Five levels (256 slots, then 4 x 64 slots) cover delays up to 2^32 ms.
+ * Timers live in intrusive doubly linked slot lists, so schedule and cancel
+ * are O(1); timers due further out are cascaded to finer levels as the wheel
+ * turns. Not thread-safe: owned by EventLoop and used from the main thread.
+ */
+class TimerWheel {
+public:
+    using TimerId = uint64_t;
+    using Callback = std::function<void()>;
+
+    /**
+     * @brief Largest supported delay; longer delays are clamped.
+     */
+    static constexpr uint64_t MAX_DELAY_MS = (1ULL << 32) - 1;
+
+    /**
+     * @brief Constructs an empty wheel positioned at nowMs.
+     */
+    explicit TimerWheel(uint64_t nowMs = 0);
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    /**
+     * @brief Schedule a callback.
+     * @param nowMs Current monotonic time in milliseconds
+     * @param delayMs Delay before the first run
+     * @param callback Function to run when the timer fires
+     * @param repeatMs Interval for repeating timers (0 = one-shot)
+     * @return Id used to cancel, refresh or unref the timer
+     */
+    TimerId schedule(uint64_t nowMs, uint64_t delayMs, Callback callback, uint64_t repeatMs = 0);
+
+    /**
+     * @brief Cancel a timer. Returns false if it already fired or is unknown.
+     */
+    bool cancel(TimerId id);
+
+    /**
+     * @brief Restart a timer with its original delay, counted from nowMs.
+     */
+    bool refresh(TimerId id, uint64_t nowMs);
+
+    /**
+     * @brief Set whether a timer keeps the event loop alive.
+     */
+    bool setRef(TimerId id, bool ref);
+
+    /**
+     * @brief Whether a pending timer keeps the event loop alive.
+     */
+    bool hasRef(TimerId id) const;
+
+    /**
+     * @brief Whether the timer is still pending.
+     */
+    bool isActive(TimerId id) const { return timers.count(id) != 0; }
+
+    /**
+     * @brief Run every timer due at or before nowMs.
+     * @return Number of callbacks invoked
+     */
+    size_t advance(uint64_t nowMs);
+
+    /**
+     * @brief Milliseconds until the wheel next needs advance(), or -1 if empty.
+     *
+     * May return earlier than the next expiry when a coarser level has to be
+     * cascaded first; callers simply wait again after advancing.
+     */
+    int64_t nextTimeoutMs(uint64_t nowMs) const;
+
+    /**
+     * @brief Number of pending timers.
+     */
+    size_t size() const { return timers.size(); }
+
+    /**
+     * @brief Number of pending timers that keep the loop alive.
+     */
+    size_t refCount() const { return refTimers; }
+
+    /**
+     * @brief Cancel all timers.
+     */
+    void clear();
+
+private:
+    static constexpr int ROOT_BITS = 8;
+    static constexpr int LEVEL_BITS = 6;
+    static constexpr int ROOT_SIZE = 1 << ROOT_BITS;
+    static constexpr int LEVEL_SIZE = 1 << LEVEL_BITS;
+    static constexpr int UPPER_LEVELS = 4;
+
+    // Intrusive list link; slot heads are bare sentinels
+    struct Link {
+        Link* prev = this;
+        Link* next = this;
+
+        bool empty() const { return next == this; }
+        void unlink() {
+            prev->next = next;
+            next->prev = prev;
+            prev = next = this;
+        }
+        void pushBack(Link* link) {
+            link->prev = prev;
+            link->next = this;
+            prev->next = link;
+            prev = link;
+        }
+    };
+
+    struct Node : Link {
+        TimerId id = 0;
+        uint64_t expiry = 0;
+        uint64_t delay = 0;
+        uint64_t repeat = 0;
+        int level = -1;   // Slot level while linked, -1 when detached
+        int slot = 0;
+        bool ref = true;
+        // Shared so a callback may cancel its own timer while running
+        std::shared_ptr<Callback> callback;
+    };
+
+    void insert(Node* node);
+    void detach(Node* node);
+    void cascade(int level, int index);
+    Link& slotHead(int level, int index);
+    void setSlotBit(int level, int index, bool occupied);
+
+    Link root[ROOT_SIZE];
+    Link upper[UPPER_LEVELS][LEVEL_SIZE];
+    uint64_t rootBitmap[ROOT_SIZE / 64] = {};
+    uint64_t upperBitmap[UPPER_LEVELS] = {};
+
+    std::unordered_map<TimerId, std::unique_ptr<Node>> timers;
+    uint64_t currentTick;
+    TimerId nextId = 1;
+    size_t refTimers = 0;
+};
+
+} // namespace protojs
+
+#endif // PROTOJS_TIMERWHEEL_H
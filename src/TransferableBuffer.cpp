@@ -0,0 +1,115 @@
+#include "TransferableBuffer.h"
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+namespace protojs {
+
+namespace {
+
+// Backing stores currently owned by an ArrayBuffer in some runtime, and
+// whether that ArrayBuffer is being detached by take() rather than freed
+std::mutex storesMutex;
+std::unordered_map<void*, bool> liveStores;
+
+} // namespace
+
+TransferableBuffer::~TransferableBuffer() {
+    std::free(data);
+}
+
+bool TransferableBuffer::isArrayBuffer(JSContext* ctx, JSValueConst val) {
+    if (!JS_IsObject(val)) {
+        return false;
+    }
+    size_t size = 0;
+    if (!JS_GetArrayBuffer(ctx, &size, val)) {
+        // Not an ArrayBuffer, or detached
+        JS_FreeValue(ctx, JS_GetException(ctx));
+        return false;
+    }
+    return true;
+}
+
+bool TransferableBuffer::take(JSContext* ctx, JSValueConst val) {
+    size_t size = 0;
+    uint8_t* bytes = JS_GetArrayBuffer(ctx, &size, val);
+    if (!bytes) {
+        return false;
+    }
+
+    std::free(data);
+    data = nullptr;
+    length = size;
+
+    bool external = false;
+    {
+        std::lock_guard<std::mutex> lock(storesMutex);
+        auto it = liveStores.find(bytes);
+        if (it != liveStores.end()) {
+            // Ours: the detach below hands the pointer over instead of freeing it
+            it->second = true;
+            external = true;
+        }
+    }
+
+    if (external) {
+        data = bytes;
+    } else {
+        // Owned by the runtime allocator: the one copy on this path
+        data = static_cast<uint8_t*>(std::malloc(size > 0 ? size : 1));
+        if (!data) {
+            length = 0;
+            JS_ThrowOutOfMemory(ctx);
+            return false;
+        }
+        std::memcpy(data, bytes, size);
+    }
+
+    JS_DetachArrayBuffer(ctx, val);
+    return true;
+}
+
+JSValue TransferableBuffer::adopt(JSContext* ctx) {
+    if (!data) {
+        data = static_cast<uint8_t*>(std::malloc(1));
+        length = 0;
+        if (!data) {
+            return JS_ThrowOutOfMemory(ctx);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(storesMutex);
+        liveStores[data] = false;
+    }
+
+    JSValue buffer = JS_NewArrayBuffer(ctx, data, length, freeBackingStore, nullptr, false);
+    if (JS_IsException(buffer)) {
+        std::lock_guard<std::mutex> lock(storesMutex);
+        liveStores.erase(data);
+        return buffer;
+    }
+
+    data = nullptr;
+    length = 0;
+    return buffer;
+}
+
+void TransferableBuffer::freeBackingStore(JSRuntime* rt, void* opaque, void* ptr) {
+    bool transferred = false;
+    {
+        std::lock_guard<std::mutex> lock(storesMutex);
+        auto it = liveStores.find(ptr);
+        if (it != liveStores.end()) {
+            transferred = it->second;
+            liveStores.erase(it);
+        }
+    }
+    if (!transferred) {
+        std::free(ptr);
+    }
+}
+
+} // namespace protojs
@@ -0,0 +1,59 @@
+#ifndef PROTOJS_TRANSFERABLEBUFFER_H
+#define PROTOJS_TRANSFERABLEBUFFER_H
+
+#include "quickjs.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace protojs {
+
+/**
+ * @brief ArrayBuffer contents in flight between two QuickJS runtimes.
+ *
+ * take() detaches an ArrayBuffer and moves its bytes out; adopt() wraps
+ * them in a new ArrayBuffer of another runtime. Backing stores created by
+ * adopt() are allocated outside any runtime, so moving them again (e.g. a
+ * buffer handed to a worker and returned from it) transfers the pointer
+ * without copying. Buffers allocated by QuickJS itself are copied once on
+ * their first take().
+ *
+ * A buffer that is never adopted frees its bytes on destruction.
+ */
+class TransferableBuffer {
+public:
+    TransferableBuffer() = default;
+    ~TransferableBuffer();
+
+    TransferableBuffer(const TransferableBuffer&) = delete;
+    TransferableBuffer& operator=(const TransferableBuffer&) = delete;
+
+    /**
+     * @brief Whether val is an ArrayBuffer that can be taken (not detached).
+     */
+    static bool isArrayBuffer(JSContext* ctx, JSValueConst val);
+
+    /**
+     * @brief Move the contents of an ArrayBuffer out of ctx, detaching it.
+     *
+     * Returns false (with an exception pending) if val is not an ArrayBuffer.
+     */
+    bool take(JSContext* ctx, JSValueConst val);
+
+    /**
+     * @brief New ArrayBuffer in ctx that owns the bytes; this buffer is empty
+     *        afterwards.
+     */
+    JSValue adopt(JSContext* ctx);
+
+    size_t size() const { return length; }
+
+private:
+    static void freeBackingStore(JSRuntime* rt, void* opaque, void* ptr);
+
+    uint8_t* data = nullptr;
+    size_t length = 0;
+};
+
+} // namespace protojs
+
+#endif // PROTOJS_TRANSFERABLEBUFFER_H
@@ -1,11 +1,88 @@
 #include "TypeBridge.h"
 #include "GCBridge.h"
+#include "AtomInternTable.h"
+#include "ConversionCache.h"
+#include "SharedByteStore.h"
+#include "StringEncoding.h"
 #include <string>
 #include <vector>
 
 namespace protojs {
 
+namespace {
+
+// Dense arrays longer than this map to a ProtoSparseList
+constexpr uint32_t LARGE_ARRAY_THRESHOLD = 10000;
+
+// Largest string export buffer kept per thread between conversions
+constexpr size_t STRING_BUFFER_RETAIN = 64 * 1024;
+
+// Latin-1 prefix of a ProtoString, one byte per character. Returns the index
+// of the first character above 0xFF, or the size of the string.
+unsigned long exportNarrowPrefix(proto::ProtoContext* pContext, const proto::ProtoList* chars,
+                                 unsigned long size, std::string& out, bool& ascii) {
+    out.resize(size);
+    uint32_t seen = 0;
+    unsigned long i = 0;
+    for (; i < size; i++) {
+        // Character is stored as UnicodeChar (unsigned int)
+        uint32_t unicodeChar = static_cast<uint32_t>(chars->getAt(pContext, i)->asLong(pContext));
+        if (unicodeChar > 0xFF) {
+            break;
+        }
+        out[i] = static_cast<char>(unicodeChar);
+        seen |= unicodeChar;
+    }
+    out.resize(i);
+    ascii = seen < 0x80;
+    return i;
+}
+
+// Integral values become SmallIntegers, the rest doubles
+const proto::ProtoObject* fromNumber(JSValueConst val, proto::ProtoContext* pContext) {
+    if (JS_VALUE_GET_TAG(val) == JS_TAG_INT) {
+        return pContext->fromInteger(JS_VALUE_GET_INT(val));
+    }
+    double d = JS_VALUE_GET_FLOAT64(val);
+    if (d == (long long)d) {
+        return pContext->fromInteger((long long)d);
+    }
+    return pContext->fromDouble(d);
+}
+
+} // namespace
+
 const proto::ProtoObject* TypeBridge::fromJS(JSContext* ctx, JSValue val, proto::ProtoContext* pContext) {
+    ConversionCache cache(ctx, ConversionCache::getShared(ctx));
+    return fromJS(ctx, val, pContext, cache);
+}
+
+const proto::ProtoObject* TypeBridge::fromJS(JSContext* ctx, JSValue val, proto::ProtoContext* pContext,
+                                             ConversionCache& cache) {
+    bool frozen;
+    return convertFromJS(ctx, val, pContext, cache, frozen);
+}
+
+const proto::ProtoObject* TypeBridge::convertFromJS(JSContext* ctx, JSValue val, proto::ProtoContext* pContext,
+                                                    ConversionCache& cache, bool& frozen) {
+    // Primitives never change; objects clear this below unless proven frozen
+    frozen = true;
+
+    if (JS_IsObject(val)) {
+        // Shared sub-objects map to one ProtoObject and cycles end here. An
+        // array still being converted has no result yet and reads as none.
+        if (const ConversionCache::Entry* seen = cache.find(val)) {
+            frozen = seen->complete && seen->frozen;
+            return seen->result ? seen->result : PROTO_NONE;
+        }
+        if (ConversionCache* shared = cache.shared()) {
+            if (const ConversionCache::Entry* kept = shared->find(val)) {
+                return kept->result;
+            }
+        }
+        frozen = false;
+    }
+
     if (JS_IsNull(val) || JS_IsUndefined(val)) {
         return PROTO_NONE;
     }
@@ -15,13 +92,7 @@ const proto::ProtoObject* TypeBridge::fromJS(JSContext* ctx, JSValue val, proto:
     }
 
     if (JS_IsNumber(val)) {
-        double d;
-        JS_ToFloat64(ctx, &d, val);
-        // Check if it's an integer to use SmallInteger if possible
-        if (d == (long long)d) {
-            return pContext->fromInteger((long long)d);
-        }
-        return pContext->fromDouble(d);
+        return fromNumber(val, pContext);
     }
 
     if (JS_IsString(val)) {
@@ -50,38 +121,103 @@ const proto::ProtoObject* TypeBridge::fromJS(JSContext* ctx, JSValue val, proto:
         JS_ToUint32(ctx, &len, lenVal);
         JS_FreeValue(ctx, lenVal);
 
-        // Check if array is sparse (has holes)
-        bool isSparse = false;
+        cache.record(val, nullptr, false, false);
+
+        // Read every element once. Indexed reads of fast arrays are served
+        // from their storage by QuickJS, so holes are only probed for with
+        // JS_HasProperty when an element reads as undefined.
+        std::vector<JSValue> items;
+        items.reserve(len);
+        std::vector<bool> holes;
+        bool allInt = true;
+        bool allNumber = true;
+        auto abandon = [&](size_t from) {
+            for (size_t j = from; j < items.size(); j++) {
+                JS_FreeValue(ctx, items[j]);
+            }
+            return nullptr;
+        };
         for (uint32_t i = 0; i < len; i++) {
-            if (!JS_HasProperty(ctx, val, i)) {
-                isSparse = true;
-                break;
+            JSValue item = JS_GetPropertyUint32(ctx, val, i);
+            if (JS_IsException(item)) {
+                // A getter or Proxy trap threw; the exception stays pending
+                return abandon(0);
+            }
+            int tag = JS_VALUE_GET_TAG(item);
+            if (tag != JS_TAG_INT) {
+                allInt = false;
+                if (!JS_TAG_IS_FLOAT64(tag)) {
+                    allNumber = false;
+                }
+            }
+            items.push_back(item);
+            if (tag == JS_TAG_UNDEFINED) {
+                // An explicit undefined element is not a hole
+                JSAtom index = JS_NewAtomUInt32(ctx, i);
+                int present = JS_HasProperty(ctx, val, index);
+                JS_FreeAtom(ctx, index);
+                if (present < 0) {
+                    return abandon(0);
+                }
+                if (!present) {
+                    if (holes.empty()) {
+                        holes.resize(len, false);
+                    }
+                    holes[i] = true;
+                }
+            }
+        }
+
+        // Convert in one tight loop; numeric arrays skip the fromJS dispatch
+        std::vector<const proto::ProtoObject*> elements;
+        elements.reserve(len);
+        bool elementsFrozen = true;
+        if (allInt) {
+            for (JSValue item : items) {
+                elements.push_back(pContext->fromInteger(JS_VALUE_GET_INT(item)));
+            }
+        } else if (allNumber) {
+            for (JSValue item : items) {
+                elements.push_back(fromNumber(item, pContext));
+            }
+        } else {
+            for (size_t i = 0; i < items.size(); i++) {
+                bool itemFrozen;
+                const proto::ProtoObject* element = convertFromJS(ctx, items[i], pContext, cache, itemFrozen);
+                JS_FreeValue(ctx, items[i]);
+                if (!element) {
+                    return abandon(i + 1);
+                }
+                elements.push_back(element);
+                elementsFrozen = elementsFrozen && itemFrozen;
             }
         }
 
-        if (isSparse || len > 10000) {
+        const proto::ProtoObject* result;
+        if (!holes.empty() || len > LARGE_ARRAY_THRESHOLD) {
             // Use ProtoSparseList for sparse or very large arrays
             const proto::ProtoSparseList* pList = pContext->newSparseList();
             for (uint32_t i = 0; i < len; i++) {
-                if (JS_HasProperty(ctx, val, i)) {
-                    JSValue item = JS_GetPropertyUint32(ctx, val, i);
-                    const proto::ProtoObject* pItem = fromJS(ctx, item, pContext);
-                    pList = pList->setAt(pContext, i, pItem);
-                    JS_FreeValue(ctx, item);
+                if (holes.empty() || !holes[i]) {
+                    pList = pList->setAt(pContext, i, elements[i]);
                 }
             }
-            return pList->asObject(pContext);
+            result = pList->asObject(pContext);
         } else {
             // Use ProtoList for dense arrays (inmutable)
             const proto::ProtoList* pList = pContext->newList();
-            for (uint32_t i = 0; i < len; i++) {
-                JSValue item = JS_GetPropertyUint32(ctx, val, i);
-                const proto::ProtoObject* pItem = fromJS(ctx, item, pContext);
+            for (const proto::ProtoObject* pItem : elements) {
                 pList = pList->appendLast(pContext, pItem);
-                JS_FreeValue(ctx, item);
             }
-            return pList->asObject(pContext);
+            result = pList->asObject(pContext);
         }
+
+        frozen = elementsFrozen && cache.shared() && ConversionCache::isFrozen(ctx, val);
+        cache.record(val, result, true, frozen);
+        if (frozen) {
+            cache.shared()->record(val, result, true, true);
+        }
+        return result;
     }
 
     if (JS_IsFunction(ctx, val)) {
@@ -90,6 +226,7 @@ const proto::ProtoObject* TypeBridge::fromJS(JSContext* ctx, JSValue val, proto:
         const proto::ProtoObject* pObj = pContext->newObject(true);
         // Register mapping so we can retrieve the JS function later
         GCBridge::registerMapping(val, pObj, ctx);
+        cache.record(val, pObj, true, false);
         // In full implementation, we'd compile JS bytecode to ProtoMethod
         return pObj;
     }
@@ -166,18 +303,23 @@ const proto::ProtoObject* TypeBridge::fromJS(JSContext* ctx, JSValue val, proto:
         
         // Check for TypedArray (class IDs 142-154)
         if (classId >= 142 && classId <= 154) {
-            // Map JS TypedArray to protoCore ProtoList
+            // Map the bytes in view to a ProtoByteBuffer
             size_t byte_offset = 0;
             size_t byte_length = 0;
             size_t bytes_per_element = 0;
             JSValue buffer = JS_GetTypedArrayBuffer(ctx, val, &byte_offset, &byte_length, &bytes_per_element);
             if (!JS_IsException(buffer) && JS_IsObject(buffer)) {
-                // Got the underlying ArrayBuffer
-                const proto::ProtoObject* bufferObj = fromJS(ctx, buffer, pContext);
+                size_t len = 0;
+                uint8_t* data = JS_GetArrayBuffer(ctx, &len, buffer);
                 JS_FreeValue(ctx, buffer);
-                return bufferObj;
-            }
-            if (!JS_IsException(buffer)) {
+                if (data && byte_offset + byte_length <= len) {
+                    // A view over a whole exported buffer maps back without a copy
+                    return SharedByteStore::import(data + byte_offset, byte_length, pContext);
+                }
+                JS_FreeValue(ctx, JS_GetException(ctx));
+            } else if (JS_IsException(buffer)) {
+                JS_FreeValue(ctx, JS_GetException(ctx));
+            } else {
                 JS_FreeValue(ctx, buffer);
             }
             // Fallback: return empty object
@@ -186,13 +328,16 @@ const proto::ProtoObject* TypeBridge::fromJS(JSContext* ctx, JSValue val, proto:
         
         // Check for ArrayBuffer (class ID 140 = JS_CLASS_ARRAY_BUFFER)
         if (classId == 140) {
-            // Map JS ArrayBuffer to protoCore ProtoList
+            // Map JS ArrayBuffer to ProtoByteBuffer, sharing storage when it
+            // was exported from one
             size_t len = 0;
             uint8_t* data = JS_GetArrayBuffer(ctx, &len, val);
-            if (data && len > 0) {
-                // Create ProtoList from byte data
-                return pContext->newObject(true);
+            if (data) {
+                return SharedByteStore::import(data, len, pContext);
             }
+            // Detached
+            JS_FreeValue(ctx, JS_GetException(ctx));
+            return pContext->newBuffer(0);
         }
     }
 
@@ -220,6 +365,9 @@ const proto::ProtoObject* TypeBridge::fromJS(JSContext* ctx, JSValue val, proto:
     if (JS_IsObject(val)) {
         // Map JS Object to protoCore ProtoObject
         const proto::ProtoObject* pObj = pContext->newObject(true); // Mutable by default for JS objects
+        // Recorded before the properties so references back to it resolve
+        cache.record(val, pObj, false, false);
+        bool propsFrozen = true;
         
         // Iterate over JS object properties and set as attributes in protoCore
         JSPropertyEnum* props;
@@ -227,19 +375,38 @@ const proto::ProtoObject* TypeBridge::fromJS(JSContext* ctx, JSValue val, proto:
         if (JS_GetOwnPropertyNames(ctx, &props, &prop_count, val, JS_GPN_STRING_MASK | JS_GPN_SYMBOL_MASK) == 0) {
             for (uint32_t i = 0; i < prop_count; i++) {
                 JSValue prop_val = JS_GetProperty(ctx, val, props[i].atom);
-                const char* prop_name = JS_AtomToCString(ctx, props[i].atom);
                 
-                const proto::ProtoObject* pVal = fromJS(ctx, prop_val, pContext);
-                const proto::ProtoString* pName = pContext->fromUTF8String(prop_name)->asString(pContext);
+                bool propFrozen;
+                const proto::ProtoObject* pVal = JS_IsException(prop_val)
+                    ? nullptr : convertFromJS(ctx, prop_val, pContext, cache, propFrozen);
+                if (!pVal) {
+                    // A getter threw; the exception stays pending
+                    JS_FreeValue(ctx, prop_val);
+                    for (uint32_t j = i; j < prop_count; j++) {
+                        JS_FreeAtom(ctx, props[j].atom);
+                    }
+                    js_free(ctx, props);
+                    return nullptr;
+                }
+                propsFrozen = propsFrozen && propFrozen;
+                // Interned: objects converted in this context mostly share their keys
+                const proto::ProtoString* pName = AtomInternTable::toProtoString(ctx, props[i].atom, pContext);
                 
-                pObj->setAttribute(pContext, pName, pVal);
+                if (pName) {
+                    pObj->setAttribute(pContext, pName, pVal);
+                }
                 
                 JS_FreeValue(ctx, prop_val);
-                JS_FreeCString(ctx, prop_name);
                 JS_FreeAtom(ctx, props[i].atom);
             }
             js_free(ctx, props);
         }
+
+        frozen = propsFrozen && cache.shared() && ConversionCache::isFrozen(ctx, val);
+        cache.record(val, pObj, true, frozen);
+        if (frozen) {
+            cache.shared()->record(val, pObj, true, true);
+        }
         return pObj;
     }
 
@@ -247,6 +414,12 @@ const proto::ProtoObject* TypeBridge::fromJS(JSContext* ctx, JSValue val, proto:
 }
 
 JSValue TypeBridge::toJS(JSContext* ctx, const proto::ProtoObject* obj, proto::ProtoContext* pContext) {
+    ConversionCache cache(ctx);
+    return toJS(ctx, obj, pContext, cache);
+}
+
+JSValue TypeBridge::toJS(JSContext* ctx, const proto::ProtoObject* obj, proto::ProtoContext* pContext,
+                         ConversionCache& cache) {
     if (obj == PROTO_NONE || obj == nullptr) {
         return JS_NULL;
     }
@@ -271,60 +444,50 @@ JSValue TypeBridge::toJS(JSContext* ctx, const proto::ProtoObject* obj, proto::P
     }
 
     if (obj->isString(pContext)) {
-        // Convert ProtoString to UTF-8 string
-        // Use asList to iterate over characters
-        const proto::ProtoString* pStr = obj->asString(pContext);
-        const proto::ProtoList* charList = pStr->asList(pContext);
-        
-        std::string result;
-        result.reserve(pStr->getSize(pContext) * 4); // Reserve space for UTF-8
-        
-        unsigned long size = charList->getSize(pContext);
-        for (unsigned long i = 0; i < size; i++) {
-            const proto::ProtoObject* charObj = charList->getAt(pContext, i);
-            // Character is stored as UnicodeChar (unsigned int)
-            unsigned int unicodeChar = charObj->asLong(pContext);
-            
-            // Convert Unicode to UTF-8
-            if (unicodeChar < 0x80) {
-                result += static_cast<char>(unicodeChar);
-            } else if (unicodeChar < 0x800) {
-                result += static_cast<char>(0xC0 | (unicodeChar >> 6));
-                result += static_cast<char>(0x80 | (unicodeChar & 0x3F));
-            } else if (unicodeChar < 0x10000) {
-                result += static_cast<char>(0xE0 | (unicodeChar >> 12));
-                result += static_cast<char>(0x80 | ((unicodeChar >> 6) & 0x3F));
-                result += static_cast<char>(0x80 | (unicodeChar & 0x3F));
-            } else {
-                result += static_cast<char>(0xF0 | (unicodeChar >> 18));
-                result += static_cast<char>(0x80 | ((unicodeChar >> 12) & 0x3F));
-                result += static_cast<char>(0x80 | ((unicodeChar >> 6) & 0x3F));
-                result += static_cast<char>(0x80 | (unicodeChar & 0x3F));
-            }
+        // Reused across calls; JS_NewStringLen copies out of it
+        thread_local std::string buffer;
+        exportUTF8(pContext, obj->asString(pContext), buffer);
+        JSValue str = JS_NewStringLen(ctx, buffer.data(), buffer.size());
+        if (buffer.capacity() > STRING_BUFFER_RETAIN) {
+            std::string().swap(buffer);
         }
-        
-        return JS_NewString(ctx, result.c_str());
+        return str;
+    }
+
+    // ProtoByteBuffer backing a live ArrayBuffer: share its storage
+    if (SharedByteStore::isPinned(obj)) {
+        return SharedByteStore::exportBuffer(ctx, obj, pContext);
     }
 
     // Check for ProtoList
     if (const proto::ProtoList* list = obj->asList(pContext)) {
+        JSValue seen = cache.findJS(obj);
+        if (!JS_IsUndefined(seen)) {
+            return seen;
+        }
         JSValue arr = JS_NewArray(ctx);
+        cache.recordJS(obj, arr);
         unsigned long size = list->getSize(pContext);
         for (unsigned long i = 0; i < size; i++) {
             const proto::ProtoObject* item = list->getAt(pContext, i);
-            JS_SetPropertyUint32(ctx, arr, i, toJS(ctx, item, pContext));
+            JS_SetPropertyUint32(ctx, arr, i, toJS(ctx, item, pContext, cache));
         }
         return arr;
     }
 
     // Check for ProtoTuple
     if (obj->isTuple(pContext)) {
+        JSValue seen = cache.findJS(obj);
+        if (!JS_IsUndefined(seen)) {
+            return seen;
+        }
         const proto::ProtoTuple* tuple = obj->asTuple(pContext);
         JSValue arr = JS_NewArray(ctx);
+        cache.recordJS(obj, arr);
         unsigned long size = tuple->getSize(pContext);
         for (unsigned long i = 0; i < size; i++) {
             const proto::ProtoObject* item = tuple->getAt(pContext, i);
-            JS_SetPropertyUint32(ctx, arr, i, toJS(ctx, item, pContext));
+            JS_SetPropertyUint32(ctx, arr, i, toJS(ctx, item, pContext, cache));
         }
         // Make array read-only to reflect immutability
         JS_DefinePropertyValueStr(ctx, arr, "length", JS_NewInt32(ctx, size), JS_PROP_WRITABLE);
@@ -388,4 +551,32 @@ JSValue TypeBridge::toJS(JSContext* ctx, const proto::ProtoObject* obj, proto::P
     return jsObj;
 }
 
+bool TypeBridge::exportLatin1(proto::ProtoContext* pContext, const proto::ProtoString* pStr, std::string& out) {
+    const proto::ProtoList* chars = pStr->asList(pContext);
+    unsigned long size = chars->getSize(pContext);
+    bool ascii;
+    return exportNarrowPrefix(pContext, chars, size, out, ascii) == size;
+}
+
+void TypeBridge::exportUTF8(proto::ProtoContext* pContext, const proto::ProtoString* pStr, std::string& out) {
+    const proto::ProtoList* chars = pStr->asList(pContext);
+    unsigned long size = chars->getSize(pContext);
+    bool ascii;
+    unsigned long narrow = exportNarrowPrefix(pContext, chars, size, out, ascii);
+    if (narrow == size && ascii) {
+        // ASCII is already UTF-8
+        return;
+    }
+
+    std::string latin1;
+    latin1.swap(out);
+    out.clear();
+    out.reserve(latin1.size() + (size - narrow) * 3);
+    StringEncoding::appendLatin1AsUTF8(reinterpret_cast<const uint8_t*>(latin1.data()), latin1.size(), out);
+    for (unsigned long i = narrow; i < size; i++) {
+        uint32_t unicodeChar = static_cast<uint32_t>(chars->getAt(pContext, i)->asLong(pContext));
+        StringEncoding::appendUTF8(unicodeChar, out);
+    }
+}
+
 } // namespace protojs
@@ -3,20 +3,61 @@
 
 #include "quickjs.h"
 #include "headers/protoCore.h"
+#include <string>
 
 namespace protojs {
 
+class ConversionCache;
+
 class TypeBridge {
 public:
     /**
      * @brief Converts a QuickJS JSValue to a protoCore ProtoObject.
+     *
+     * Returns nullptr, with the exception pending, if reading val throws
+     * (a getter or a Proxy trap).
      */
     static const proto::ProtoObject* fromJS(JSContext* ctx, JSValue val, proto::ProtoContext* pContext);
 
+    /**
+     * @brief Converts a JSValue using an identity map shared with other
+     *        conversions, e.g. the elements of one collection.
+     */
+    static const proto::ProtoObject* fromJS(JSContext* ctx, JSValue val, proto::ProtoContext* pContext,
+                                            ConversionCache& cache);
+
     /**
      * @brief Converts a protoCore ProtoObject to a QuickJS JSValue.
      */
     static JSValue toJS(JSContext* ctx, const proto::ProtoObject* obj, proto::ProtoContext* pContext);
+
+    /**
+     * @brief Converts a ProtoObject using an identity map shared with other
+     *        conversions.
+     */
+    static JSValue toJS(JSContext* ctx, const proto::ProtoObject* obj, proto::ProtoContext* pContext,
+                        ConversionCache& cache);
+
+    /**
+     * @brief Writes a ProtoString into out as Latin-1, one byte per character.
+     *
+     * Returns false, leaving out unspecified, if a character does not fit.
+     */
+    static bool exportLatin1(proto::ProtoContext* pContext, const proto::ProtoString* pStr, std::string& out);
+
+    /**
+     * @brief Writes a ProtoString into out as UTF-8. ASCII strings are
+     *        written in a single pass with no re-encoding.
+     */
+    static void exportUTF8(proto::ProtoContext* pContext, const proto::ProtoString* pStr, std::string& out);
+
+private:
+    /**
+     * @brief fromJS; frozen reports whether val and everything reachable
+     *        from it are frozen (only checked when a shared cache exists).
+     */
+    static const proto::ProtoObject* convertFromJS(JSContext* ctx, JSValue val, proto::ProtoContext* pContext,
+                                                   ConversionCache& cache, bool& frozen);
 };
 
 } // namespace protojs
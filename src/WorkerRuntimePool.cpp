@@ -0,0 +1,235 @@
+#include "WorkerRuntimePool.h"
+#include "console.h"
+#include "modules/path/PathModule.h"
+#include "modules/url/URLModule.h"
+#include "modules/util/UtilModule.h"
+#include "modules/events/EventsModule.h"
+#include "modules/crypto/CryptoModule.h"
+#include <iostream>
+#include <mutex>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace protojs {
+
+namespace {
+
+struct BuiltinEntry {
+    const char* name;
+    void (*init)(JSContext*);
+};
+
+// Builtins that only need a plain JSContext
+const BuiltinEntry WORKER_BUILTINS[] = {
+    {"console", Console::init},
+    {"path", PathModule::init},
+    {"url", URLModule::init},
+    {"util", UtilModule::init},
+    {"events", EventsModule::init},
+    {"crypto", CryptoModule::init},
+};
+
+// Heap usage is sampled every few tasks; JS_ComputeMemoryUsage walks the heap
+constexpr size_t HEAP_CHECK_INTERVAL = 8;
+
+// Deserialized Deferred functions kept per worker runtime
+constexpr size_t FUNCTION_CACHE_CAPACITY = 64;
+
+std::mutex configMutex;
+WorkerRuntimeConfig currentConfig;
+
+// Module init functions allocate process-wide class ids on first use
+std::mutex builtinInitMutex;
+
+struct WorkerRuntime {
+    using FunctionEntry = std::pair<uint64_t, JSValue>;
+
+    JSRuntime* rt = nullptr;
+    JSContext* ctx = nullptr;
+    size_t tasks = 0;
+    WorkerRuntimeConfig config;
+    const std::atomic<bool>* interruptFlag = nullptr;
+
+    // Most recently used first
+    std::list<FunctionEntry> functions;
+    std::unordered_map<uint64_t, std::list<FunctionEntry>::iterator> functionIndex;
+
+    void clearFunctions() {
+        for (FunctionEntry& entry : functions) {
+            JS_FreeValue(ctx, entry.second);
+        }
+        functions.clear();
+        functionIndex.clear();
+    }
+
+    ~WorkerRuntime() {
+        // Thread exit without the stop hook (e.g. a lazily created runtime)
+        if (ctx) {
+            clearFunctions();
+            JS_FreeContext(ctx);
+        }
+        if (rt) JS_FreeRuntime(rt);
+    }
+};
+
+thread_local WorkerRuntime worker;
+
+// Polled by QuickJS while JavaScript runs on the worker thread
+int interruptHandler(JSRuntime*, void*) {
+    return worker.interruptFlag && worker.interruptFlag->load(std::memory_order_relaxed) ? 1 : 0;
+}
+
+} // namespace
+
+std::atomic<size_t> WorkerRuntimePool::createdCount{0};
+std::atomic<size_t> WorkerRuntimePool::recycledCount{0};
+
+bool WorkerRuntimePool::isBuiltinSupported(const std::string& name) {
+    for (const BuiltinEntry& entry : WORKER_BUILTINS) {
+        if (name == entry.name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkerRuntimePool::configure(const WorkerRuntimeConfig& config) {
+    WorkerRuntimeConfig checked = config;
+    checked.builtins.clear();
+    for (const std::string& name : config.builtins) {
+        if (isBuiltinSupported(name)) {
+            checked.builtins.push_back(name);
+        } else {
+            std::cerr << "Warning: builtin '" << name << "' is not available in Deferred workers" << std::endl;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(configMutex);
+    currentConfig = std::move(checked);
+}
+
+WorkerRuntimeConfig WorkerRuntimePool::getConfig() {
+    std::lock_guard<std::mutex> lock(configMutex);
+    return currentConfig;
+}
+
+WorkerHooks WorkerRuntimePool::hooks() {
+    WorkerHooks hooks;
+    hooks.onStart = [](size_t) { create(); };
+    hooks.onStop = [](size_t) { destroy(); };
+    return hooks;
+}
+
+bool WorkerRuntimePool::create() {
+    worker.config = getConfig();
+    worker.tasks = 0;
+
+    worker.rt = JS_NewRuntime();
+    if (!worker.rt) {
+        return false;
+    }
+    if (worker.config.memoryLimit > 0) {
+        JS_SetMemoryLimit(worker.rt, worker.config.memoryLimit);
+    }
+    JS_SetInterruptHandler(worker.rt, interruptHandler, nullptr);
+
+    worker.ctx = JS_NewContext(worker.rt);
+    if (!worker.ctx) {
+        JS_FreeRuntime(worker.rt);
+        worker.rt = nullptr;
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(builtinInitMutex);
+        for (const std::string& name : worker.config.builtins) {
+            for (const BuiltinEntry& entry : WORKER_BUILTINS) {
+                if (name == entry.name) {
+                    entry.init(worker.ctx);
+                }
+            }
+        }
+    }
+
+    createdCount++;
+    return true;
+}
+
+void WorkerRuntimePool::destroy() {
+    if (worker.ctx) {
+        worker.clearFunctions();
+        JS_FreeContext(worker.ctx);
+        worker.ctx = nullptr;
+    }
+    if (worker.rt) {
+        JS_FreeRuntime(worker.rt);
+        worker.rt = nullptr;
+    }
+}
+
+JSContext* WorkerRuntimePool::acquire() {
+    if (!worker.ctx && !create()) {
+        return nullptr;
+    }
+    return worker.ctx;
+}
+
+JSValue WorkerRuntimePool::getCachedFunction(uint64_t bytecodeId) {
+    auto it = worker.functionIndex.find(bytecodeId);
+    if (it == worker.functionIndex.end()) {
+        return JS_UNDEFINED;
+    }
+    worker.functions.splice(worker.functions.begin(), worker.functions, it->second);
+    return JS_DupValue(worker.ctx, it->second->second);
+}
+
+void WorkerRuntimePool::cacheFunction(uint64_t bytecodeId, JSValue func) {
+    if (worker.functionIndex.count(bytecodeId)) {
+        JS_FreeValue(worker.ctx, func);
+        return;
+    }
+
+    worker.functions.emplace_front(bytecodeId, func);
+    worker.functionIndex[bytecodeId] = worker.functions.begin();
+
+    if (worker.functions.size() > FUNCTION_CACHE_CAPACITY) {
+        WorkerRuntime::FunctionEntry& oldest = worker.functions.back();
+        JS_FreeValue(worker.ctx, oldest.second);
+        worker.functionIndex.erase(oldest.first);
+        worker.functions.pop_back();
+    }
+}
+
+void WorkerRuntimePool::setInterruptFlag(const std::atomic<bool>* flag) {
+    worker.interruptFlag = flag;
+}
+
+bool WorkerRuntimePool::shouldRecycle() {
+    const WorkerRuntimeConfig& config = worker.config;
+    if (config.maxTasks > 0 && worker.tasks >= config.maxTasks) {
+        return true;
+    }
+    if (config.maxHeapBytes > 0 && worker.tasks % HEAP_CHECK_INTERVAL == 0) {
+        JSMemoryUsage usage;
+        JS_ComputeMemoryUsage(worker.rt, &usage);
+        return usage.malloc_size > static_cast<int64_t>(config.maxHeapBytes);
+    }
+    return false;
+}
+
+void WorkerRuntimePool::release() {
+    if (!worker.ctx) {
+        return;
+    }
+
+    worker.tasks++;
+    if (shouldRecycle()) {
+        destroy();
+        recycledCount++;
+        // Replace it right away so the next task starts warm
+        create();
+    }
+}
+
+} // namespace protojs
@@ -0,0 +1,119 @@
+#ifndef PROTOJS_WORKERRUNTIMEPOOL_H
+#define PROTOJS_WORKERRUNTIMEPOOL_H
+
+#include "quickjs.h"
+#include "ThreadPoolExecutor.h"
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace protojs {
+
+/**
+ * @brief Configuration of the QuickJS runtimes owned by CPU pool workers.
+ */
+struct WorkerRuntimeConfig {
+    /** Builtin modules installed in every worker context (see WorkerRuntimePool::isBuiltinSupported). */
+    std::vector<std::string> builtins{"console"};
+    /** Memory limit per worker runtime in bytes (0 = unlimited). */
+    size_t memoryLimit = 0;
+    /** Recycle a worker runtime after this many tasks (0 = never). */
+    size_t maxTasks = 0;
+    /** Recycle a worker runtime once its heap exceeds this many bytes (0 = never). */
+    size_t maxHeapBytes = 0;
+};
+
+/**
+ * @brief Per-worker QuickJS runtimes used to execute Deferred tasks.
+ *
+ * Each CPU pool worker owns one runtime and context. They are created by
+ * the worker start hook, so they are warm before the first task, and freed
+ * by the stop hook. After a task the worker recycles its runtime once the
+ * task or heap threshold is reached, and starts the next task on a fresh
+ * one.
+ *
+ * Builtins that need the main thread (timers, I/O) or a JSContextWrapper
+ * (protoCore, Buffer) cannot be installed in workers.
+ */
+class WorkerRuntimePool {
+public:
+    /**
+     * @brief Set the configuration used for runtimes created from now on.
+     *
+     * Unsupported builtin names are reported on stderr and ignored.
+     */
+    static void configure(const WorkerRuntimeConfig& config);
+
+    /**
+     * @brief Current configuration.
+     */
+    static WorkerRuntimeConfig getConfig();
+
+    /**
+     * @brief Hooks that create and free the runtime of each worker thread.
+     */
+    static WorkerHooks hooks();
+
+    /**
+     * @brief Context of the calling worker, created on demand if the pool
+     *        was started without hooks. Returns nullptr if creation failed.
+     */
+    static JSContext* acquire();
+
+    /**
+     * @brief Mark the end of a task on the calling worker.
+     *
+     * All values of the worker context must have been freed: the runtime may
+     * be recycled here.
+     */
+    static void release();
+
+    /**
+     * @brief Function previously cached on the calling worker under this
+     *        bytecode id, or JS_UNDEFINED. The returned value is duplicated.
+     */
+    static JSValue getCachedFunction(uint64_t bytecodeId);
+
+    /**
+     * @brief Cache a deserialized function on the calling worker, taking
+     *        ownership of the value. The least recently used entry is freed
+     *        once the cache is full; the whole cache goes with the runtime.
+     */
+    static void cacheFunction(uint64_t bytecodeId, JSValue func);
+
+    /**
+     * @brief Interrupt JavaScript running on the calling worker once *flag
+     *        becomes true. Pass nullptr to clear; the flag must outlive the
+     *        call it guards.
+     */
+    static void setInterruptFlag(const std::atomic<bool>* flag);
+
+    /**
+     * @brief Whether a builtin module can be installed in worker contexts.
+     */
+    static bool isBuiltinSupported(const std::string& name);
+
+    /**
+     * @brief Number of worker runtimes created so far.
+     */
+    static size_t getCreatedCount() { return createdCount.load(); }
+
+    /**
+     * @brief Number of worker runtimes recycled so far.
+     */
+    static size_t getRecycledCount() { return recycledCount.load(); }
+
+private:
+    static bool create();
+    static void destroy();
+    static bool shouldRecycle();
+
+    static std::atomic<size_t> createdCount;
+    static std::atomic<size_t> recycledCount;
+};
+
+} // namespace protojs
+
+#endif // PROTOJS_WORKERRUNTIMEPOOL_H
@@ -1,4 +1,5 @@
 #include "Logger.h"
+#include "../TypeBridge.h"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
@@ -72,32 +73,8 @@ void Logger::log(proto::ProtoContext* pContext, Level level, const proto::ProtoS
     
     // Convert ProtoString to C string for output (necessary for std::ostream)
     // This is the only conversion needed for I/O
-    const proto::ProtoList* charList = formatted->asList(pContext);
     std::string outputStr;
-    outputStr.reserve(formatted->getSize(pContext) * 4);
-    
-    unsigned long size = charList->getSize(pContext);
-    for (unsigned long i = 0; i < size; i++) {
-        const proto::ProtoObject* charObj = charList->getAt(pContext, i);
-        unsigned int unicodeChar = charObj->asLong(pContext);
-        
-        // Convert Unicode to UTF-8
-        if (unicodeChar < 0x80) {
-            outputStr += static_cast<char>(unicodeChar);
-        } else if (unicodeChar < 0x800) {
-            outputStr += static_cast<char>(0xC0 | (unicodeChar >> 6));
-            outputStr += static_cast<char>(0x80 | (unicodeChar & 0x3F));
-        } else if (unicodeChar < 0x10000) {
-            outputStr += static_cast<char>(0xE0 | (unicodeChar >> 12));
-            outputStr += static_cast<char>(0x80 | ((unicodeChar >> 6) & 0x3F));
-            outputStr += static_cast<char>(0x80 | (unicodeChar & 0x3F));
-        } else {
-            outputStr += static_cast<char>(0xF0 | (unicodeChar >> 18));
-            outputStr += static_cast<char>(0x80 | ((unicodeChar >> 12) & 0x3F));
-            outputStr += static_cast<char>(0x80 | ((unicodeChar >> 6) & 0x3F));
-            outputStr += static_cast<char>(0x80 | (unicodeChar & 0x3F));
-        }
-    }
+    TypeBridge::exportUTF8(pContext, formatted, outputStr);
     
     // Write to output (std::ostream is external, necessary for I/O)
     *outputStream << outputStr << std::endl;
@@ -1,4 +1,5 @@
 #include "JSContext.h"
+#include "WorkerRuntimePool.h"
 #include "Deferred.h"
 #include "EventLoop.h"
 #include "console.h"
@@ -11,6 +12,7 @@
 #include "modules/url/URLModule.h"
 #include "modules/http/HTTPModule.h"
 #include "modules/events/EventsModule.h"
+#include "modules/timers/TimersModule.h"
 #include "modules/stream/StreamModule.h"
 #include "modules/util/UtilModule.h"
 #include "modules/crypto/CryptoModule.h"
@@ -32,8 +34,6 @@
 #include <sstream>
 #include <string>
 #include <cstdlib>
-#include <thread>
-#include <chrono>
 
 void printUsage(const char* programName) {
     std::cerr << "Usage: " << programName << " [options] <filename.js> or " << programName << " -e \"code\"" << std::endl;
@@ -41,6 +41,11 @@ void printUsage(const char* programName) {
     std::cerr << "  --cpu-threads N      Number of CPU threads (default: number of CPU cores)" << std::endl;
     std::cerr << "  --io-threads N       Number of I/O threads (default: 3-4x CPU cores)" << std::endl;
     std::cerr << "  --io-threads-factor F  Multiplier for I/O threads (default: 3.0)" << std::endl;
+    std::cerr << "  --worker-builtins LIST Builtins in Deferred workers (default: console;" << std::endl;
+    std::cerr << "                       available: console,path,url,util,events,crypto)" << std::endl;
+    std::cerr << "  --worker-memory-limit MB  Heap limit per Deferred worker runtime" << std::endl;
+    std::cerr << "  --worker-max-tasks N Recycle a Deferred worker runtime after N tasks" << std::endl;
+    std::cerr << "  --worker-max-heap MB Recycle a Deferred worker runtime above MB of heap" << std::endl;
     std::cerr << "  -e \"code\"            Execute code directly" << std::endl;
     std::cerr << "  -p, --print          Print result of -e" << std::endl;
     std::cerr << "  -c, --check          Syntax check only" << std::endl;
@@ -57,6 +62,7 @@ int main(int argc, char** argv) {
     size_t cpuThreads = 0;
     size_t ioThreads = 0;
     double ioFactor = 3.0;
+    protojs::WorkerRuntimeConfig workerConfig;
     std::string code;
     std::string filename = "eval";
     bool executeCode = false;
@@ -76,6 +82,19 @@ int main(int argc, char** argv) {
             ioThreads = std::stoul(argv[++i]);
         } else if (arg == "--io-threads-factor" && i + 1 < argc) {
             ioFactor = std::stod(argv[++i]);
+        } else if (arg == "--worker-builtins" && i + 1 < argc) {
+            workerConfig.builtins.clear();
+            std::stringstream list(argv[++i]);
+            std::string name;
+            while (std::getline(list, name, ',')) {
+                if (!name.empty()) workerConfig.builtins.push_back(name);
+            }
+        } else if (arg == "--worker-memory-limit" && i + 1 < argc) {
+            workerConfig.memoryLimit = std::stoul(argv[++i]) * 1024 * 1024;
+        } else if (arg == "--worker-max-tasks" && i + 1 < argc) {
+            workerConfig.maxTasks = std::stoul(argv[++i]);
+        } else if (arg == "--worker-max-heap" && i + 1 < argc) {
+            workerConfig.maxHeapBytes = std::stoul(argv[++i]) * 1024 * 1024;
         } else if (arg == "-e" && i + 1 < argc) {
             executeCode = true;
             code = argv[++i];
@@ -111,6 +130,9 @@ int main(int argc, char** argv) {
         return 0;
     }
 
+    // Applies to the CPU pool workers started by JSContextWrapper
+    protojs::WorkerRuntimePool::configure(workerConfig);
+
     // If no file and no -e, start REPL
     if (code.empty() && !executeCode && !syntaxCheck) {
         protojs::JSContextWrapper wrapper(cpuThreads, ioThreads, ioFactor);
@@ -127,6 +149,7 @@ int main(int argc, char** argv) {
         protojs::URLModule::init(wrapper.getJSContext());
         protojs::HTTPModule::init(wrapper.getJSContext());
         protojs::EventsModule::init(wrapper.getJSContext());
+        protojs::TimersModule::init(wrapper.getJSContext());
         protojs::StreamModule::init(wrapper.getJSContext());
         protojs::UtilModule::init(wrapper.getJSContext());
         protojs::CryptoModule::init(wrapper.getJSContext());
@@ -171,6 +194,7 @@ int main(int argc, char** argv) {
     protojs::URLModule::init(wrapper.getJSContext());
     protojs::HTTPModule::init(wrapper.getJSContext());
     protojs::EventsModule::init(wrapper.getJSContext());
+    protojs::TimersModule::init(wrapper.getJSContext());
     protojs::StreamModule::init(wrapper.getJSContext());
     protojs::UtilModule::init(wrapper.getJSContext());
     protojs::CryptoModule::init(wrapper.getJSContext());
@@ -229,25 +253,9 @@ int main(int argc, char** argv) {
         }
     }
     
-    // Process event loop to handle any Deferred callbacks
-    // Wait for all callbacks to complete (with timeout)
-    auto start = std::chrono::steady_clock::now();
-    const auto timeout = std::chrono::seconds(30); // 30 second timeout
-    
-    while (protojs::EventLoop::getInstance().hasPendingCallbacks()) {
-        protojs::EventLoop::getInstance().processCallbacks();
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        
-        // Check timeout
-        auto now = std::chrono::steady_clock::now();
-        if (now - start > timeout) {
-            std::cerr << "Warning: Event loop timeout reached. Some callbacks may not have completed." << std::endl;
-            break;
-        }
-    }
-    
-    // Process any remaining callbacks one more time
-    protojs::EventLoop::getInstance().processCallbacks();
+    // Drive the event loop until no callbacks and no referenced handles
+    // (sockets, servers, pending Deferreds) remain
+    protojs::EventLoop::getInstance().run();
     
     JS_FreeValue(wrapper.getJSContext(), result);
 
@@ -1,5 +1,6 @@
 #include "MemoryAnalyzer.h"
 #include "../modules/fs/FSModule.h"
+#include "../GCBridge.h"
 #include <sstream>
 #include <iomanip>
 #include <ctime>
@@ -19,6 +20,7 @@ void MemoryAnalyzer::init(JSContext* ctx) {
     JS_SetPropertyStr(ctx, memAnalyzer, "detectLeaks", JS_NewCFunction(ctx, detectLeaks, "detectLeaks", 2));
     JS_SetPropertyStr(ctx, memAnalyzer, "exportSnapshot", JS_NewCFunction(ctx, exportSnapshot, "exportSnapshot", 2));
     JS_SetPropertyStr(ctx, memAnalyzer, "getMemoryUsage", JS_NewCFunction(ctx, getMemoryUsage, "getMemoryUsage", 0));
+    JS_SetPropertyStr(ctx, memAnalyzer, "getBridgeStats", JS_NewCFunction(ctx, getBridgeStats, "getBridgeStats", 0));
     JS_SetPropertyStr(ctx, memAnalyzer, "startAllocationTracking", JS_NewCFunction(ctx, startAllocationTracking, "startAllocationTracking", 0));
     JS_SetPropertyStr(ctx, memAnalyzer, "stopAllocationTracking", JS_NewCFunction(ctx, stopAllocationTracking, "stopAllocationTracking", 0));
     
@@ -144,6 +146,25 @@ JSValue MemoryAnalyzer::getMemoryUsage(JSContext* ctx, JSValueConst this_val, in
     return usage;
 }
 
+JSValue MemoryAnalyzer::getBridgeStats(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    GCBridge::ScanStats stats = GCBridge::getScanStats(ctx);
+    JSValue result = JS_NewObject(ctx);
+    
+    JS_SetPropertyStr(ctx, result, "slices", JS_NewInt64(ctx, static_cast<int64_t>(stats.slices)));
+    JS_SetPropertyStr(ctx, result, "minorCycles", JS_NewInt64(ctx, static_cast<int64_t>(stats.minorCycles)));
+    JS_SetPropertyStr(ctx, result, "majorCycles", JS_NewInt64(ctx, static_cast<int64_t>(stats.majorCycles)));
+    JS_SetPropertyStr(ctx, result, "entriesScanned", JS_NewInt64(ctx, static_cast<int64_t>(stats.entriesScanned)));
+    JS_SetPropertyStr(ctx, result, "collected", JS_NewInt64(ctx, static_cast<int64_t>(stats.collected)));
+    JS_SetPropertyStr(ctx, result, "lastPauseUs", JS_NewInt64(ctx, static_cast<int64_t>(stats.lastPauseUs)));
+    JS_SetPropertyStr(ctx, result, "maxPauseUs", JS_NewInt64(ctx, static_cast<int64_t>(stats.maxPauseUs)));
+    JS_SetPropertyStr(ctx, result, "totalPauseUs", JS_NewInt64(ctx, static_cast<int64_t>(stats.totalPauseUs)));
+    JS_SetPropertyStr(ctx, result, "youngEntries", JS_NewInt64(ctx, static_cast<int64_t>(stats.youngEntries)));
+    JS_SetPropertyStr(ctx, result, "oldEntries", JS_NewInt64(ctx, static_cast<int64_t>(stats.oldEntries)));
+    JS_SetPropertyStr(ctx, result, "rememberedEntries", JS_NewInt64(ctx, static_cast<int64_t>(stats.rememberedEntries)));
+    
+    return result;
+}
+
 JSValue MemoryAnalyzer::startAllocationTracking(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
     if (trackingAllocations) {
         return JS_NewBool(ctx, false);
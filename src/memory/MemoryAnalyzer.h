@@ -62,6 +62,11 @@ public:
      */
     static JSValue getMemoryUsage(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
     
+    /**
+     * @brief Get GCBridge root scanning metrics (cycles and pause per slice)
+     */
+    static JSValue getBridgeStats(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    
     /**
      * @brief Start allocation tracking
      */
@@ -1,6 +1,10 @@
 #include "ProtoCoreModule.h"
 #include "../TypeBridge.h"
 #include "../JSContext.h"
+#include "../ConversionCache.h"
+#include "../SharedByteStore.h"
+#include "../ExecutionEngine.h"
+#include "../GCBridge.h"
 #include "quickjs.h"
 #include <iostream>
 
@@ -9,6 +13,7 @@ namespace protojs {
 static JSClassID protojs_set_class_id;
 static JSClassID protojs_multiset_class_id;
 static JSClassID protojs_sparselist_class_id;
+static JSClassID protojs_bridged_class_id;
 
 // Helper to get JSContextWrapper
 static JSContextWrapper* getWrapper(JSContext* ctx) {
@@ -78,6 +83,22 @@ void ProtoCoreModule::init(JSContext* ctx) {
     JSValue sparseListCtor = JS_NewCFunction2(ctx, SparseListConstructor, "SparseList", 0, JS_CFUNC_constructor, 0);
     JS_SetConstructor(ctx, sparseListCtor, sparseListProto);
     
+    // Register BridgedObject class; property access goes through ExecutionEngine
+    JS_NewClassID(&protojs_bridged_class_id);
+    static JSClassExoticMethods bridgedExoticMethods = {};
+    bridgedExoticMethods.has_property = BridgedHasProperty;
+    bridgedExoticMethods.get_property = BridgedGetProperty;
+    bridgedExoticMethods.set_property = BridgedSetProperty;
+    JSClassDef bridgedClassDef = {
+        "ProtoBridgedObject",
+        nullptr,
+        nullptr,
+        nullptr,
+        &bridgedExoticMethods
+    };
+    JS_NewClass(JS_GetRuntime(ctx), protojs_bridged_class_id, &bridgedClassDef);
+    JS_SetClassProto(ctx, protojs_bridged_class_id, JS_NewObject(ctx));
+    
     // Create protoCore module object
     JSValue protoCoreModule = JS_NewObject(ctx);
     
@@ -88,11 +109,14 @@ void ProtoCoreModule::init(JSContext* ctx) {
     
     // Add utility functions
     JS_SetPropertyStr(ctx, protoCoreModule, "Tuple", JS_NewCFunction(ctx, Tuple, "Tuple", 1));
+    JS_SetPropertyStr(ctx, protoCoreModule, "ByteBuffer", JS_NewCFunction(ctx, ByteBuffer, "ByteBuffer", 1));
     JS_SetPropertyStr(ctx, protoCoreModule, "ImmutableObject", JS_NewCFunction(ctx, ImmutableObject, "ImmutableObject", 1));
     JS_SetPropertyStr(ctx, protoCoreModule, "MutableObject", JS_NewCFunction(ctx, MutableObject, "MutableObject", 1));
+    JS_SetPropertyStr(ctx, protoCoreModule, "BridgedObject", JS_NewCFunction(ctx, BridgedObject, "BridgedObject", 1));
     JS_SetPropertyStr(ctx, protoCoreModule, "isImmutable", JS_NewCFunction(ctx, IsImmutable, "isImmutable", 1));
     JS_SetPropertyStr(ctx, protoCoreModule, "makeImmutable", JS_NewCFunction(ctx, MakeImmutable, "makeImmutable", 1));
     JS_SetPropertyStr(ctx, protoCoreModule, "makeMutable", JS_NewCFunction(ctx, MakeMutable, "makeMutable", 1));
+    JS_SetPropertyStr(ctx, protoCoreModule, "setConversionCacheSize", JS_NewCFunction(ctx, SetConversionCacheSize, "setConversionCacheSize", 1));
     
     // Add to global scope
     JSValue global_obj = JS_GetGlobalObject(ctx);
@@ -150,6 +174,7 @@ JSValue ProtoCoreModule::SetAdd(JSContext* ctx, JSValueConst this_val, int argc,
     proto::ProtoContext* pContext = wrapper->getProtoContext();
     
     const proto::ProtoObject* pItem = TypeBridge::fromJS(ctx, argv[0], pContext);
+    if (!pItem) return JS_EXCEPTION;
     const proto::ProtoSet* newSet = (*setPtr)->add(pContext, pItem);
     
     // Update stored pointer
@@ -172,6 +197,7 @@ JSValue ProtoCoreModule::SetHas(JSContext* ctx, JSValueConst this_val, int argc,
     proto::ProtoContext* pContext = wrapper->getProtoContext();
     
     const proto::ProtoObject* pItem = TypeBridge::fromJS(ctx, argv[0], pContext);
+    if (!pItem) return JS_EXCEPTION;
     const proto::ProtoObject* result = (*setPtr)->has(pContext, pItem);
     
     return JS_NewBool(ctx, result == PROTO_TRUE);
@@ -191,6 +217,7 @@ JSValue ProtoCoreModule::SetRemove(JSContext* ctx, JSValueConst this_val, int ar
     proto::ProtoContext* pContext = wrapper->getProtoContext();
     
     const proto::ProtoObject* pItem = TypeBridge::fromJS(ctx, argv[0], pContext);
+    if (!pItem) return JS_EXCEPTION;
     const proto::ProtoSet* newSet = (*setPtr)->remove(pContext, pItem);
     
     // Update stored pointer
@@ -268,6 +295,7 @@ JSValue ProtoCoreModule::MultisetAdd(JSContext* ctx, JSValueConst this_val, int
     proto::ProtoContext* pContext = wrapper->getProtoContext();
     
     const proto::ProtoObject* pItem = TypeBridge::fromJS(ctx, argv[0], pContext);
+    if (!pItem) return JS_EXCEPTION;
     const proto::ProtoMultiset* newMultiset = (*multisetPtr)->add(pContext, pItem);
     
     *multisetPtr = newMultiset;
@@ -289,6 +317,7 @@ JSValue ProtoCoreModule::MultisetCount(JSContext* ctx, JSValueConst this_val, in
     proto::ProtoContext* pContext = wrapper->getProtoContext();
     
     const proto::ProtoObject* pItem = TypeBridge::fromJS(ctx, argv[0], pContext);
+    if (!pItem) return JS_EXCEPTION;
     const proto::ProtoObject* countObj = (*multisetPtr)->count(pContext, pItem);
     
     return TypeBridge::toJS(ctx, countObj, pContext);
@@ -308,6 +337,7 @@ JSValue ProtoCoreModule::MultisetRemove(JSContext* ctx, JSValueConst this_val, i
     proto::ProtoContext* pContext = wrapper->getProtoContext();
     
     const proto::ProtoObject* pItem = TypeBridge::fromJS(ctx, argv[0], pContext);
+    if (!pItem) return JS_EXCEPTION;
     const proto::ProtoMultiset* newMultiset = (*multisetPtr)->remove(pContext, pItem);
     
     *multisetPtr = newMultiset;
@@ -461,9 +491,11 @@ JSValue ProtoCoreModule::Tuple(JSContext* ctx, JSValueConst this_val, int argc,
     JS_ToUint32(ctx, &len, lenVal);
     JS_FreeValue(ctx, lenVal);
     
+    // One identity map for all elements, so shared elements stay shared
+    ConversionCache cache(ctx, ConversionCache::getShared(ctx));
     for (uint32_t i = 0; i < len; i++) {
         JSValue item = JS_GetPropertyUint32(ctx, argv[0], i);
-        const proto::ProtoObject* pItem = TypeBridge::fromJS(ctx, item, pContext);
+        const proto::ProtoObject* pItem = TypeBridge::fromJS(ctx, item, pContext, cache);
         protoList = protoList->appendLast(pContext, pItem);
         JS_FreeValue(ctx, item);
     }
@@ -475,6 +507,81 @@ JSValue ProtoCoreModule::Tuple(JSContext* ctx, JSValueConst this_val, int argc,
     return JS_UNDEFINED;
 }
 
+// ByteBuffer - factory function: ArrayBuffer backed by a ProtoByteBuffer
+JSValue ProtoCoreModule::ByteBuffer(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    uint32_t size = 0;
+    if (argc < 1 || JS_ToUint32(ctx, &size, argv[0]) < 0) {
+        return JS_ThrowTypeError(ctx, "ByteBuffer expects a size");
+    }
+    
+    JSContextWrapper* wrapper = getWrapper(ctx);
+    if (!wrapper) {
+        return JS_ThrowTypeError(ctx, "ProtoCoreModule: JSContextWrapper not found");
+    }
+    
+    return SharedByteStore::allocate(ctx, size, wrapper->getProtoContext());
+}
+
+// Bridged objects: a JS object with no own properties whose reads and writes
+// go to a mutable ProtoObject through ExecutionEngine's inline caches
+JSValue ProtoCoreModule::BridgedObject(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    if (argc < 1 || !JS_IsObject(argv[0])) {
+        return JS_ThrowTypeError(ctx, "BridgedObject expects an object");
+    }
+    
+    JSContextWrapper* wrapper = getWrapper(ctx);
+    if (!wrapper) {
+        return JS_ThrowTypeError(ctx, "ProtoCoreModule: JSContextWrapper not found");
+    }
+    proto::ProtoContext* pContext = wrapper->getProtoContext();
+    
+    const proto::ProtoObject* pObj = TypeBridge::fromJS(ctx, argv[0], pContext);
+    if (!pObj) return JS_EXCEPTION;
+    const proto::ProtoObject* mutableObj = pObj->clone(pContext, true);
+    
+    JSValue bridged = JS_NewObjectClass(ctx, protojs_bridged_class_id);
+    if (JS_IsException(bridged)) {
+        return bridged;
+    }
+    // Weak: released by root scanning once only the bridge references it
+    GCBridge::registerWeakRef(bridged, mutableObj, ctx);
+    return bridged;
+}
+
+JSValue ProtoCoreModule::BridgedGetProperty(JSContext* ctx, JSValueConst obj, JSAtom atom, JSValueConst receiver) {
+    // Exotic hooks have no bytecode site of their own: the inline caches of
+    // the context have one per property name
+    const proto::ProtoObject* attr = ExecutionEngine::lookupAttribute(ctx, obj, atom);
+    if (attr) {
+        return TypeBridge::toJS(ctx, attr, getWrapper(ctx)->getProtoContext());
+    }
+    
+    // Not an attribute: continue on the class prototype (toString, ...)
+    JSValue proto = JS_GetClassProto(ctx, protojs_bridged_class_id);
+    JSValue result = JS_GetProperty(ctx, proto, atom);
+    JS_FreeValue(ctx, proto);
+    return result;
+}
+
+int ProtoCoreModule::BridgedSetProperty(JSContext* ctx, JSValueConst obj, JSAtom atom, JSValueConst value, JSValueConst receiver, int flags) {
+    if (ExecutionEngine::storeAttribute(ctx, obj, atom, value)) {
+        return 1;
+    }
+    JS_ThrowTypeError(ctx, "BridgedObject is no longer bridged");
+    return -1;
+}
+
+int ProtoCoreModule::BridgedHasProperty(JSContext* ctx, JSValueConst obj, JSAtom atom) {
+    if (ExecutionEngine::lookupAttribute(ctx, obj, atom)) {
+        return 1;
+    }
+    
+    JSValue proto = JS_GetClassProto(ctx, protojs_bridged_class_id);
+    int result = JS_HasProperty(ctx, proto, atom);
+    JS_FreeValue(ctx, proto);
+    return result;
+}
+
 // Mutability utilities
 JSValue ProtoCoreModule::ImmutableObject(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
     if (argc < 1 || !JS_IsObject(argv[0])) {
@@ -486,6 +593,7 @@ JSValue ProtoCoreModule::ImmutableObject(JSContext* ctx, JSValueConst this_val,
     
     // Convert JS object to ProtoObject with mutable_ref = 0 (immutable)
     const proto::ProtoObject* pObj = TypeBridge::fromJS(ctx, argv[0], pContext);
+    if (!pObj) return JS_EXCEPTION;
     // Clone as immutable (mutable_ref = 0)
     const proto::ProtoObject* immutableObj = pObj->clone(pContext, false);
     
@@ -502,6 +610,7 @@ JSValue ProtoCoreModule::MutableObject(JSContext* ctx, JSValueConst this_val, in
     
     // Convert JS object to ProtoObject with mutable_ref > 0 (mutable)
     const proto::ProtoObject* pObj = TypeBridge::fromJS(ctx, argv[0], pContext);
+    if (!pObj) return JS_EXCEPTION;
     // Clone as mutable (mutable_ref > 0)
     const proto::ProtoObject* mutableObj = pObj->clone(pContext, true);
     
@@ -517,6 +626,7 @@ JSValue ProtoCoreModule::IsImmutable(JSContext* ctx, JSValueConst this_val, int
     proto::ProtoContext* pContext = wrapper->getProtoContext();
     
     const proto::ProtoObject* pObj = TypeBridge::fromJS(ctx, argv[0], pContext);
+    if (!pObj) return JS_EXCEPTION;
     if (!pObj->isCell(pContext)) {
         return JS_NewBool(ctx, true); // Primitives are immutable
     }
@@ -536,6 +646,7 @@ JSValue ProtoCoreModule::MakeImmutable(JSContext* ctx, JSValueConst this_val, in
     proto::ProtoContext* pContext = wrapper->getProtoContext();
     
     const proto::ProtoObject* pObj = TypeBridge::fromJS(ctx, argv[0], pContext);
+    if (!pObj) return JS_EXCEPTION;
     const proto::ProtoObject* immutableObj = pObj->clone(pContext, false);
     
     return TypeBridge::toJS(ctx, immutableObj, pContext);
@@ -550,9 +661,26 @@ JSValue ProtoCoreModule::MakeMutable(JSContext* ctx, JSValueConst this_val, int
     proto::ProtoContext* pContext = wrapper->getProtoContext();
     
     const proto::ProtoObject* pObj = TypeBridge::fromJS(ctx, argv[0], pContext);
+    if (!pObj) return JS_EXCEPTION;
     const proto::ProtoObject* mutableObj = pObj->clone(pContext, true);
     
     return TypeBridge::toJS(ctx, mutableObj, pContext);
 }
 
+// Keep converted frozen objects across calls; 0 disables
+JSValue ProtoCoreModule::SetConversionCacheSize(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    uint32_t capacity = 0;
+    if (argc < 1 || JS_ToUint32(ctx, &capacity, argv[0]) < 0) {
+        return JS_ThrowTypeError(ctx, "setConversionCacheSize expects a number");
+    }
+    
+    JSContextWrapper* wrapper = getWrapper(ctx);
+    if (!wrapper) {
+        return JS_ThrowTypeError(ctx, "ProtoCoreModule: JSContextWrapper not found");
+    }
+    
+    wrapper->setConversionCacheCapacity(capacity);
+    return JS_UNDEFINED;
+}
+
 } // namespace protojs
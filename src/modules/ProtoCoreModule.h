@@ -39,6 +39,15 @@ private:
     // Tuple operations
     static JSValue Tuple(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
     
+    // Byte buffers shared with ArrayBuffers
+    static JSValue ByteBuffer(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    
+    // Objects whose properties live in protoCore
+    static JSValue BridgedObject(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    static JSValue BridgedGetProperty(JSContext* ctx, JSValueConst obj, JSAtom atom, JSValueConst receiver);
+    static int BridgedSetProperty(JSContext* ctx, JSValueConst obj, JSAtom atom, JSValueConst value, JSValueConst receiver, int flags);
+    static int BridgedHasProperty(JSContext* ctx, JSValueConst obj, JSAtom atom);
+    
     // SparseList operations
     static JSValue SparseListConstructor(JSContext* ctx, JSValueConst new_target, int argc, JSValueConst* argv);
     static JSValue SparseListSet(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
@@ -53,6 +62,9 @@ private:
     static JSValue IsImmutable(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
     static JSValue MakeImmutable(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
     static JSValue MakeMutable(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    
+    // Conversion cache
+    static JSValue SetConversionCacheSize(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
 };
 
 } // namespace protojs
@@ -207,6 +207,15 @@ const proto::ProtoByteBuffer* BufferModule::getBufferData(JSContext* ctx, JSValu
     return nullptr;
 }
 
+const uint8_t* BufferModule::getBytes(JSContext* ctx, JSValueConst val, size_t* size) {
+    BufferData* data = static_cast<BufferData*>(JS_GetOpaque(val, buffer_class_id));
+    if (!data) {
+        return nullptr;
+    }
+    *size = data->getSize();
+    return reinterpret_cast<const uint8_t*>(data->getBufferPtr());
+}
+
 JSValue BufferModule::bufferFrom(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
     return BufferConstructor(ctx, this_val, argc, argv);
 }
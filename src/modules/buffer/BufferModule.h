@@ -10,6 +10,12 @@ class BufferModule {
 public:
     static void init(JSContext* ctx);
 
+    /**
+     * @brief Bytes of a Buffer and their count, or nullptr if val is not a
+     *        Buffer. Valid while val is alive.
+     */
+    static const uint8_t* getBytes(JSContext* ctx, JSValueConst val, size_t* size);
+
 private:
     // Static methods
     static JSValue bufferFrom(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
@@ -194,6 +194,14 @@ void ChildProcessModule::spawnProcess(JSContext* ctx, const std::string& command
         
         JS_SetPropertyStr(ctx, childObj, "pid", JS_NewInt32(ctx, pid));
         
+        // Keep the event loop alive for each background thread below: the
+        // readers may still be draining their pipes after the exit event.
+        // Each thread releases its handle through the loop, after the last
+        // callback it enqueued.
+        EventLoop::getInstance().ref();
+        EventLoop::getInstance().ref();
+        EventLoop::getInstance().ref();
+        
         // Start stdout reader thread
         data->stdoutThread = std::thread([data, ctx]() {
             char buffer[4096];
@@ -221,6 +229,9 @@ void ChildProcessModule::spawnProcess(JSContext* ctx, const std::string& command
                     JS_FreeValue(ctx, bufferObj);
                 });
             }
+            EventLoop::getInstance().enqueueCallback([]() {
+                EventLoop::getInstance().unref();
+            });
         });
         
         // Start stderr reader thread
@@ -250,6 +261,9 @@ void ChildProcessModule::spawnProcess(JSContext* ctx, const std::string& command
                     JS_FreeValue(ctx, bufferObj);
                 });
             }
+            EventLoop::getInstance().enqueueCallback([]() {
+                EventLoop::getInstance().unref();
+            });
         });
         
         // Wait for process in background
@@ -265,6 +279,7 @@ void ChildProcessModule::spawnProcess(JSContext* ctx, const std::string& command
             }
             
             EventLoop::getInstance().enqueueCallback([ctx, data]() {
+                EventLoop::getInstance().unref();
                 JSValue emit = JS_GetPropertyStr(ctx, data->childObj, "emit");
                 if (JS_IsFunction(ctx, emit)) {
                     JSValue exitEvent = JS_NewString(ctx, "exit");
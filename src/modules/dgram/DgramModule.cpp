@@ -39,15 +39,24 @@ struct DgramSocketData {
     void close() {
         std::lock_guard<std::mutex> lock(mutex);
         if (closed) return;
+        bool wasBound = bound;
         closed = true;
         bound = false;
         if (socketFd >= 0) {
-            ::close(socketFd);
-            socketFd = -1;
+            // Wakes a receive thread blocked in recvfrom()
+            ::shutdown(socketFd, SHUT_RDWR);
         }
         if (receiveThread.joinable()) {
             receiveThread.join();
         }
+        if (socketFd >= 0) {
+            ::close(socketFd);
+            socketFd = -1;
+        }
+        if (wasBound) {
+            // Release the handle taken by bind()
+            EventLoop::getInstance().unref();
+        }
     }
 };
 
@@ -202,6 +211,10 @@ JSValue DgramModule::socketBind(JSContext* ctx, JSValueConst this_val, int argc,
     data->address = address;
     data->bound = true;
     
+    // A bound socket keeps the event loop alive until it is closed, so
+    // datagrams enqueued by the receive thread are still delivered
+    EventLoop::getInstance().ref();
+    
     // Start receive thread
     data->receiveThread = std::thread([data, ctx]() {
         char buffer[65507]; // Max UDP datagram size
@@ -211,6 +224,9 @@ JSValue DgramModule::socketBind(JSContext* ctx, JSValueConst this_val, int argc,
             
             ssize_t n = recvfrom(data->socketFd, buffer, sizeof(buffer), 0, 
                                 (struct sockaddr*)&fromAddr, &fromLen);
+            if (data->closed) {
+                break;
+            }
             if (n < 0) {
                 if (data->bound && !data->closed) {
                     continue;
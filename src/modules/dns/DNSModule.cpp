@@ -95,8 +95,11 @@ JSValue DNSModule::lookup(JSContext* ctx, JSValueConst this_val, int argc, JSVal
 }
 
 void DNSModule::lookupAsync(JSContext* ctx, const std::string& hostname, int family, JSValue callback) {
+    // Keep the event loop alive until the callback has run
+    EventLoop::getInstance().ref();
+    
     auto& ioPool = IOThreadPool::getInstance();
-    ioPool.getExecutor().submit([ctx, hostname, family, callback]() {
+    ioPool.getExecutor().execute([ctx, hostname, family, callback]() {
         struct addrinfo hints, *result;
         memset(&hints, 0, sizeof(hints));
         hints.ai_family = family == 6 ? AF_INET6 : (family == 4 ? AF_INET : AF_UNSPEC);
@@ -105,6 +108,7 @@ void DNSModule::lookupAsync(JSContext* ctx, const std::string& hostname, int fam
         int err = getaddrinfo(hostname.c_str(), nullptr, &hints, &result);
         
         EventLoop::getInstance().enqueueCallback([ctx, callback, err, result]() {
+            EventLoop::getInstance().unref();
             if (err != 0) {
                 JSValue error = JS_NewString(ctx, gai_strerror(err));
                 JSValue args[] = {error, JS_NULL};
@@ -1,14 +1,27 @@
 #include "HTTPModule.h"
+#include "HTTPParser.h"
 #include "../events/EventsModule.h"
 #include "../stream/StreamModule.h"
+#include "../net/ListenSocket.h"
+#include "../net/ServerShards.h"
+#include "../timers/TimersModule.h"
+#include "../../EventLoop.h"
+#include "../../console.h"
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
-#include <thread>
+#include <cerrno>
+#include <functional>
+#include <iostream>
+#include <memory>
 #include <sstream>
 #include <map>
 #include <string>
+#include <cstring>
+#include <vector>
 
 namespace protojs {
 
@@ -17,33 +30,137 @@ static JSClassID http_request_class_id;
 static JSClassID http_response_class_id;
 static JSClassID http_incoming_message_class_id;
 
+// Bytes read from one connection per readiness notification
+static constexpr size_t MAX_READ_BATCH = 64 * 1024;
+// Free space ensured in a receive buffer before reading into it
+static constexpr size_t MIN_READ_SPACE = 16 * 1024;
+// An empty receive buffer larger than this is released, e.g. after a large head
+static constexpr size_t MAX_IDLE_RECEIVE_BUFFER = 256 * 1024;
+// Connections accepted per readiness notification of a listener
+static constexpr int MAX_ACCEPT_BATCH = 64;
+// Default of server.headersTimeout: time allowed for a request head to arrive
+static constexpr uint32_t DEFAULT_HEADERS_TIMEOUT_MS = 60 * 1000;
+
+struct HTTPServerData;
+
+/**
+ * One client connection, driven by the EventLoop.
+ *
+ * Received bytes accumulate in a buffer that the request parser reads in
+ * place. Requests are handled one at a time: after a request has been read
+ * completely, parsing stops until its response has ended, so responses to
+ * pipelined requests leave in order and a slow handler stops the reads.
+ * Between requests a timer bounds the wait for the next head, so idle or
+ * trickling peers do not hold the connection forever.
+ */
+struct HTTPConnection {
+    int fd = -1;
+    JSContext* ctx = nullptr;
+    JSRuntime* rt = nullptr;
+    // Request listener of the server, held so connections outlive a closed server
+    JSValue listener = JS_UNDEFINED;
+    HTTPRequestParser parser;
+    // Received bytes are [parsed, receivedEnd) of received; the parser reads
+    // them in place and the buffer grows without being cleared
+    std::vector<char> received;
+    size_t receivedEnd = 0;
+    size_t parsed = 0;
+    // Response bytes the kernel has not taken yet
+    std::string outbox;
+    size_t outboxOffset = 0;
+    uint32_t armedEvents = 0;
+    bool watching = false;
+    bool readEnded = false;
+    // Close once the outbox is flushed; no further requests are parsed
+    bool closeAfterWrite = false;
+    // The write side was shut down; reads are discarded until the peer closes
+    bool writeShut = false;
+    // Set while processInput() runs, so a response ended from a listener
+    // does not re-enter the parse loop
+    bool processing = false;
+
+    // Request in progress: active from its head until both it has been read
+    // and its response has ended
+    bool active = false;
+    bool requestComplete = false;
+    bool responseDone = false;
+    bool keepAlive = false;
+    // Emitter of the request being read, for 'data' and 'end'
+    JSValue requestEmitter = JS_UNDEFINED;
+    // Wait for a request head: its limit (0 = none) and the pending timer
+    uint32_t headersTimeoutMs = 0;
+    TimerWheel::TimerId headerTimer = 0;
+
+    ~HTTPConnection() {
+        close();
+    }
+
+    // Stop watching, close the fd and release JS values; no JS runs here
+    void close() {
+        if (fd >= 0) {
+            if (watching) {
+                watching = false;
+                EventLoop::getInstance().unwatchFd(fd);
+            }
+            if (headerTimer) {
+                EventLoop::getInstance().getTimers().cancel(headerTimer);
+                headerTimer = 0;
+            }
+            ::close(fd);
+            fd = -1;
+        }
+        outbox.clear();
+        received = std::vector<char>();
+        receivedEnd = 0;
+        parsed = 0;
+        JSValue held = requestEmitter;
+        requestEmitter = JS_UNDEFINED;
+        JS_FreeValueRT(rt, held);
+        held = listener;
+        listener = JS_UNDEFINED;
+        JS_FreeValueRT(rt, held);
+    }
+};
+
 struct HTTPServerData {
     int socketFd;
     int port;
+    std::string host;
     bool listening;
     JSValue requestListener;
     JSRuntime* rt;
-    std::thread serverThread;
+    JSContext* ctx;
+    // The server object, held while listening so it outlives its last JS reference
+    JSValue self;
+    // Server threads of listen({threads}); socketFd is unused then
+    std::shared_ptr<ServerShards> shards;
+    // server.headersTimeout when listen() was called
+    uint32_t headersTimeoutMs;
+    // False for the per-thread servers of shards, whose listener the shard closes
+    bool ownsSocket;
+    // Open connections, closed or told to finish by close(); expired
+    // entries are dropped once the list reaches pruneAt
+    std::vector<std::weak_ptr<HTTPConnection>> connections;
+    size_t pruneAt;
     
-    HTTPServerData(JSRuntime* r) : socketFd(-1), port(0), listening(false), requestListener(JS_UNDEFINED), rt(r) {}
+    HTTPServerData(JSRuntime* r) : socketFd(-1), port(0), listening(false), requestListener(JS_UNDEFINED), rt(r),
+                                   ctx(nullptr), self(JS_UNDEFINED), headersTimeoutMs(DEFAULT_HEADERS_TIMEOUT_MS),
+                                   ownsSocket(true), pruneAt(64) {}
     ~HTTPServerData() {
-        if (socketFd >= 0) {
-            close(socketFd);
-        }
+        close();
         if (!JS_IsUndefined(requestListener)) {
             JS_FreeValueRT(rt, requestListener);
         }
-        if (serverThread.joinable()) {
-            listening = false;
-            serverThread.join();
-        }
     }
+    
+    void close();
 };
 
 struct HTTPRequestData {
     std::string method;
     std::string url;
     std::string version;
+    // Names are lowercase; repeated fields are joined with ", "
     std::map<std::string, std::string> headers;
     std::string body;
     JSRuntime* rt;
@@ -64,19 +181,619 @@ struct HTTPResponseData {
     std::string body;
     JSRuntime* rt;
     JSValue eventEmitter;
-    int clientFd;
+    std::shared_ptr<HTTPConnection> connection;
+    // Response to a HEAD request: headers only
+    bool headRequest;
+    // HTTP minor version of the request
+    int versionMinor;
     
-    HTTPResponseData(JSRuntime* r, int fd) : statusCode(200), headersSent(false), rt(r), eventEmitter(JS_UNDEFINED), clientFd(fd) {}
+    HTTPResponseData(JSRuntime* r, std::shared_ptr<HTTPConnection> conn)
+        : statusCode(200), headersSent(false), rt(r), eventEmitter(JS_UNDEFINED), connection(std::move(conn)),
+          headRequest(false), versionMinor(1) {}
     ~HTTPResponseData() {
         if (!JS_IsUndefined(eventEmitter)) {
             JS_FreeValueRT(rt, eventEmitter);
         }
-        if (clientFd >= 0) {
-            close(clientFd);
-        }
     }
 };
 
+static void reportException(JSContext* ctx, const char* where) {
+    JSValue exception = JS_GetException(ctx);
+    const char* str = JS_ToCString(ctx, exception);
+    if (str) {
+        std::cerr << "Uncaught exception in " << where << ": " << str << std::endl;
+        JS_FreeCString(ctx, str);
+    }
+    JS_FreeValue(ctx, exception);
+}
+
+// New EventEmitter stored as obj._events; returns a reference for the caller
+static JSValue attachEventEmitter(JSContext* ctx, JSValueConst obj) {
+    JSValue result = JS_UNDEFINED;
+    JSValue global = JS_GetGlobalObject(ctx);
+    // EventsModule publishes the constructor as events.EventEmitter
+    JSValue events = JS_GetPropertyStr(ctx, global, "events");
+    JSValue eventEmitterCtor = JS_IsObject(events) ? JS_GetPropertyStr(ctx, events, "EventEmitter") : JS_UNDEFINED;
+    if (JS_IsFunction(ctx, eventEmitterCtor)) {
+        JSValue emitter = JS_CallConstructor(ctx, eventEmitterCtor, 0, nullptr);
+        if (!JS_IsException(emitter)) {
+            result = JS_DupValue(ctx, emitter);
+            JS_SetPropertyStr(ctx, obj, "_events", emitter);
+        } else {
+            JS_FreeValue(ctx, JS_GetException(ctx));
+        }
+    }
+    JS_FreeValue(ctx, eventEmitterCtor);
+    JS_FreeValue(ctx, events);
+    JS_FreeValue(ctx, global);
+    return result;
+}
+
+static void emitEvent(JSContext* ctx, JSValueConst emitter, const char* event, JSValueConst arg = JS_UNDEFINED, int argc = 0) {
+    if (JS_IsUndefined(emitter)) {
+        return;
+    }
+    JSValue emit = JS_GetPropertyStr(ctx, emitter, "emit");
+    if (JS_IsFunction(ctx, emit)) {
+        JSValue eventName = JS_NewString(ctx, event);
+        JSValueConst args[] = {eventName, arg};
+        JSValue result = JS_Call(ctx, emit, emitter, argc + 1, const_cast<JSValue*>(args));
+        if (JS_IsException(result)) {
+            reportException(ctx, "http event listener");
+        }
+        JS_FreeValue(ctx, result);
+        JS_FreeValue(ctx, eventName);
+    }
+    JS_FreeValue(ctx, emit);
+}
+
+static std::string toLower(std::string_view s) {
+    std::string result(s);
+    for (char& c : result) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+    return result;
+}
+
+// Header set by the handler, matched case-insensitively
+static const std::string* findHeader(const std::map<std::string, std::string>& headers, const char* name) {
+    for (const auto& [key, value] : headers) {
+        if (strcasecmp(key.c_str(), name) == 0) {
+            return &value;
+        }
+    }
+    return nullptr;
+}
+
+static const char* statusText(int statusCode) {
+    switch (statusCode) {
+        case 100: return "Continue";
+        case 101: return "Switching Protocols";
+        case 200: return "OK";
+        case 201: return "Created";
+        case 202: return "Accepted";
+        case 204: return "No Content";
+        case 206: return "Partial Content";
+        case 301: return "Moved Permanently";
+        case 302: return "Found";
+        case 303: return "See Other";
+        case 304: return "Not Modified";
+        case 307: return "Temporary Redirect";
+        case 308: return "Permanent Redirect";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 408: return "Request Timeout";
+        case 409: return "Conflict";
+        case 411: return "Length Required";
+        case 413: return "Content Too Large";
+        case 414: return "URI Too Long";
+        case 415: return "Unsupported Media Type";
+        case 429: return "Too Many Requests";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
+        default: return "Unknown";
+    }
+}
+
+static void onConnectionEvents(const std::shared_ptr<HTTPConnection>& conn, uint32_t events);
+static void processInput(const std::shared_ptr<HTTPConnection>& conn);
+
+static void updateInterest(const std::shared_ptr<HTTPConnection>& conn) {
+    if (conn->fd < 0) {
+        return;
+    }
+    uint32_t events = 0;
+    // Stop reading while a complete request waits for its response
+    bool waiting = conn->active && conn->requestComplete;
+    if (!conn->readEnded && (!waiting || conn->writeShut)) {
+        events |= EPOLLIN | EPOLLRDHUP;
+    }
+    if (conn->outboxOffset < conn->outbox.size()) {
+        events |= EPOLLOUT;
+    }
+    
+    if (!conn->watching) {
+        // The loop holds the connection while it is watched
+        std::shared_ptr<HTTPConnection> held = conn;
+        if (!EventLoop::getInstance().watchFd(conn->fd, events, [held](uint32_t ready) {
+                onConnectionEvents(held, ready);
+            })) {
+            std::cerr << "http: cannot watch connection" << std::endl;
+            conn->close();
+            return;
+        }
+        conn->watching = true;
+        conn->armedEvents = events;
+    } else if (events != conn->armedEvents) {
+        conn->armedEvents = events;
+        EventLoop::getInstance().modifyFd(conn->fd, events);
+    }
+}
+
+// Send queued response bytes; closes the connection once it is done with
+static void flushOutbox(const std::shared_ptr<HTTPConnection>& conn) {
+    while (conn->fd >= 0 && conn->outboxOffset < conn->outbox.size()) {
+        ssize_t n = send(conn->fd, conn->outbox.data() + conn->outboxOffset, conn->outbox.size() - conn->outboxOffset,
+                         MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                conn->close();
+                return;
+            }
+            break;
+        }
+        conn->outboxOffset += static_cast<size_t>(n);
+    }
+    if (conn->fd < 0) {
+        return;
+    }
+    if (conn->outboxOffset == conn->outbox.size()) {
+        conn->outbox.clear();
+        conn->outboxOffset = 0;
+        if (conn->closeAfterWrite && !conn->writeShut) {
+            // Half-close and drain the peer, so unread request bytes do not
+            // turn the close into a reset that discards the response
+            conn->writeShut = true;
+            shutdown(conn->fd, SHUT_WR);
+        }
+        if (conn->writeShut && conn->readEnded) {
+            conn->close();
+            return;
+        }
+    }
+    updateInterest(conn);
+}
+
+// Queue head and body, sending directly when nothing is queued
+static void sendResponse(const std::shared_ptr<HTTPConnection>& conn, const std::string& head, const std::string& body) {
+    if (conn->fd < 0) {
+        return;
+    }
+    size_t skip = 0;
+    if (conn->outbox.empty()) {
+        struct iovec iov[2] = {
+            {const_cast<char*>(head.data()), head.size()},
+            {const_cast<char*>(body.data()), body.size()},
+        };
+        struct msghdr msg = {};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = body.empty() ? 1 : 2;
+        ssize_t n;
+        do {
+            n = sendmsg(conn->fd, &msg, MSG_NOSIGNAL);
+        } while (n < 0 && errno == EINTR);
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            conn->close();
+            return;
+        }
+        skip = n > 0 ? static_cast<size_t>(n) : 0;
+    }
+    if (skip < head.size()) {
+        conn->outbox.append(head, skip, std::string::npos);
+        skip = 0;
+    } else {
+        skip -= head.size();
+    }
+    if (skip < body.size()) {
+        conn->outbox.append(body, skip, std::string::npos);
+    }
+    flushOutbox(conn);
+}
+
+// Reply to a request that cannot be parsed or timed out, and close
+static void rejectRequest(const std::shared_ptr<HTTPConnection>& conn, int statusCode) {
+    conn->closeAfterWrite = true;
+    if (conn->active) {
+        // The error is inside a request whose head was delivered: its response
+        // is either still owed, and interleaving another is not possible, or
+        // already sent, and a second one would answer a request never made
+        if (conn->responseDone) {
+            flushOutbox(conn);
+        } else {
+            conn->close();
+        }
+        return;
+    }
+    std::string head = "HTTP/1.1 " + std::to_string(statusCode) + " " + statusText(statusCode) +
+                       "\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+    sendResponse(conn, head, std::string());
+}
+
+// Wait at most headersTimeoutMs for the next request head
+static void startHeaderTimer(const std::shared_ptr<HTTPConnection>& conn) {
+    if (conn->fd < 0 || conn->headersTimeoutMs == 0) {
+        return;
+    }
+    TimerWheel& wheel = EventLoop::getInstance().getTimers();
+    if (conn->headerTimer) {
+        wheel.cancel(conn->headerTimer);
+    }
+    // Weak: the loop owns the connection through its fd watch
+    std::weak_ptr<HTTPConnection> weak = conn;
+    conn->headerTimer = wheel.schedule(EventLoop::nowMs(), conn->headersTimeoutMs, [weak]() {
+        std::shared_ptr<HTTPConnection> conn = weak.lock();
+        if (!conn || conn->fd < 0) {
+            return;
+        }
+        conn->headerTimer = 0;
+        if (conn->active || conn->closeAfterWrite) {
+            return;
+        }
+        if (conn->receivedEnd > conn->parsed) {
+            // Part of a head arrived, the rest did not
+            rejectRequest(conn, 408);
+        } else {
+            // Idle between requests
+            conn->closeAfterWrite = true;
+            flushOutbox(conn);
+        }
+    });
+    // The connection's fd watch keeps the loop alive, not its timer
+    wheel.setRef(conn->headerTimer, false);
+}
+
+static void stopHeaderTimer(const std::shared_ptr<HTTPConnection>& conn) {
+    if (conn->headerTimer) {
+        EventLoop::getInstance().getTimers().cancel(conn->headerTimer);
+        conn->headerTimer = 0;
+    }
+}
+
+// The request has been read and answered: go on with the next one
+static void finishExchange(const std::shared_ptr<HTTPConnection>& conn) {
+    conn->active = false;
+    if (!conn->keepAlive || conn->readEnded) {
+        conn->closeAfterWrite = true;
+        flushOutbox(conn);
+        return;
+    }
+    startHeaderTimer(conn);
+    if (conn->processing) {
+        // The parse loop that called the listener continues by itself
+        return;
+    }
+    // Pipelined requests are dispatched from the loop, not from inside end()
+    std::shared_ptr<HTTPConnection> held = conn;
+    EventLoop::getInstance().setImmediate([held]() {
+        if (held->fd >= 0 && !held->active) {
+            processInput(held);
+        }
+    });
+}
+
+// Creates IncomingMessage and ServerResponse for the parsed head and calls the listener
+static void startRequest(const std::shared_ptr<HTTPConnection>& conn) {
+    JSContext* ctx = conn->ctx;
+    const HTTPRequestParser& parser = conn->parser;
+    stopHeaderTimer(conn);
+    conn->active = true;
+    conn->requestComplete = false;
+    conn->responseDone = false;
+    conn->keepAlive = parser.keepAlive();
+    
+    JSValue req = JS_NewObjectClass(ctx, http_incoming_message_class_id);
+    JSValue res = JS_NewObjectClass(ctx, http_response_class_id);
+    if (JS_IsException(req) || JS_IsException(res)) {
+        JS_FreeValue(ctx, req);
+        JS_FreeValue(ctx, res);
+        reportException(ctx, "http request");
+        conn->close();
+        return;
+    }
+    
+    HTTPRequestData* reqData = new HTTPRequestData(conn->rt);
+    reqData->method = std::string(parser.method());
+    reqData->url = std::string(parser.target());
+    reqData->version = parser.versionMinor() == 0 ? "1.0" : "1.1";
+    JSValue headers = JS_NewObject(ctx);
+    for (const HTTPHeader& header : parser.headers()) {
+        std::string name = toLower(header.name);
+        auto [it, inserted] = reqData->headers.emplace(name, std::string(header.value));
+        if (!inserted) {
+            it->second.append(", ").append(header.value);
+        }
+    }
+    for (const auto& [name, value] : reqData->headers) {
+        JS_SetPropertyStr(ctx, headers, name.c_str(), JS_NewStringLen(ctx, value.data(), value.size()));
+    }
+    JS_SetOpaque(req, reqData);
+    reqData->eventEmitter = attachEventEmitter(ctx, req);
+    JS_SetPropertyStr(ctx, req, "method", JS_NewString(ctx, reqData->method.c_str()));
+    JS_SetPropertyStr(ctx, req, "url", JS_NewString(ctx, reqData->url.c_str()));
+    JS_SetPropertyStr(ctx, req, "httpVersion", JS_NewString(ctx, reqData->version.c_str()));
+    JS_SetPropertyStr(ctx, req, "headers", headers);
+    
+    HTTPResponseData* resData = new HTTPResponseData(conn->rt, conn);
+    resData->headRequest = reqData->method == "HEAD";
+    resData->versionMinor = parser.versionMinor();
+    JS_SetOpaque(res, resData);
+    resData->eventEmitter = attachEventEmitter(ctx, res);
+    
+    JS_FreeValue(ctx, conn->requestEmitter);
+    conn->requestEmitter = JS_DupValue(ctx, reqData->eventEmitter);
+    
+    if (JS_IsFunction(ctx, conn->listener)) {
+        JSValueConst args[] = {req, res};
+        JSValue result = JS_Call(ctx, conn->listener, JS_UNDEFINED, 2, const_cast<JSValue*>(args));
+        if (JS_IsException(result)) {
+            reportException(ctx, "http request listener");
+        }
+        JS_FreeValue(ctx, result);
+    }
+    JS_FreeValue(ctx, req);
+    JS_FreeValue(ctx, res);
+}
+
+// Parse buffered input until a complete request waits for its response
+static void processInput(const std::shared_ptr<HTTPConnection>& conn) {
+    conn->processing = true;
+    while (conn->fd >= 0 && !conn->closeAfterWrite && !(conn->active && conn->requestComplete)) {
+        size_t consumed = 0;
+        auto event = conn->parser.parse(conn->received.data() + conn->parsed, conn->receivedEnd - conn->parsed,
+                                        &consumed);
+        conn->parsed += consumed;
+        if (event == HTTPRequestParser::Event::NeedMore) {
+            break;
+        }
+        if (event == HTTPRequestParser::Event::Error) {
+            bool tooLarge = conn->parser.error().find("too large") != std::string::npos;
+            rejectRequest(conn, tooLarge ? 431 : 400);
+            break;
+        }
+        if (event == HTTPRequestParser::Event::Head) {
+            startRequest(conn);
+        } else if (event == HTTPRequestParser::Event::Body) {
+            std::string_view piece = conn->parser.body();
+            JSValue chunk = JS_NewArrayBufferCopy(conn->ctx, reinterpret_cast<const uint8_t*>(piece.data()),
+                                                  piece.size());
+            JSValue emitter = JS_DupValue(conn->ctx, conn->requestEmitter);
+            emitEvent(conn->ctx, emitter, "data", chunk, 1);
+            JS_FreeValue(conn->ctx, emitter);
+            JS_FreeValue(conn->ctx, chunk);
+        } else {
+            conn->requestComplete = true;
+            JSValue emitter = conn->requestEmitter;
+            conn->requestEmitter = JS_UNDEFINED;
+            emitEvent(conn->ctx, emitter, "end");
+            JS_FreeValue(conn->ctx, emitter);
+            if (conn->responseDone) {
+                conn->active = false;
+                if (!conn->keepAlive) {
+                    conn->closeAfterWrite = true;
+                } else {
+                    startHeaderTimer(conn);
+                }
+            }
+        }
+    }
+    conn->processing = false;
+    if (conn->fd < 0) {
+        return;
+    }
+    
+    // Drop consumed bytes; what remains is a partial or pipelined request
+    if (conn->parsed > 0) {
+        size_t left = conn->receivedEnd - conn->parsed;
+        std::memmove(conn->received.data(), conn->received.data() + conn->parsed, left);
+        conn->receivedEnd = left;
+        conn->parsed = 0;
+    }
+    if (conn->receivedEnd == 0 && conn->received.size() > MAX_IDLE_RECEIVE_BUFFER) {
+        conn->received = std::vector<char>();
+    }
+    if (conn->readEnded && !conn->active) {
+        conn->closeAfterWrite = true;
+    } else if (conn->readEnded && !conn->requestComplete) {
+        // The peer closed in the middle of a request
+        conn->close();
+        return;
+    }
+    flushOutbox(conn);
+}
+
+static void readConnection(const std::shared_ptr<HTTPConnection>& conn) {
+    size_t total = 0;
+    while (total < MAX_READ_BATCH) {
+        // Read straight into the buffer the parser works on
+        if (conn->received.size() - conn->receivedEnd < MIN_READ_SPACE) {
+            conn->received.resize(conn->received.empty() ? MAX_READ_BATCH : conn->received.size() * 2);
+        }
+        size_t space = conn->received.size() - conn->receivedEnd;
+        ssize_t n = recv(conn->fd, conn->received.data() + conn->receivedEnd, space, 0);
+        if (n > 0) {
+            conn->receivedEnd += static_cast<size_t>(n);
+            total += static_cast<size_t>(n);
+        } else if (n == 0) {
+            conn->readEnded = true;
+            break;
+        } else if (errno != EINTR) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                conn->close();
+                return;
+            }
+            break;
+        }
+    }
+    
+    if (conn->writeShut) {
+        // Lingering after the last response: input is discarded
+        conn->receivedEnd = 0;
+        conn->parsed = 0;
+        if (conn->readEnded) {
+            conn->close();
+        } else {
+            updateInterest(conn);
+        }
+        return;
+    }
+    processInput(conn);
+}
+
+static void onConnectionEvents(const std::shared_ptr<HTTPConnection>& conn, uint32_t events) {
+    if (conn->fd < 0) {
+        return;
+    }
+    if (events & (EPOLLHUP | EPOLLERR)) {
+        // Reset, or both directions shut down: nothing can be sent any more
+        conn->close();
+        return;
+    }
+    if (events & EPOLLOUT) {
+        flushOutbox(conn);
+    }
+    if (conn->fd >= 0 && (events & (EPOLLIN | EPOLLRDHUP))) {
+        readConnection(conn);
+    }
+}
+
+void HTTPServerData::close() {
+    if (socketFd >= 0) {
+        if (listening) {
+            EventLoop::getInstance().unwatchFd(socketFd);
+        }
+        if (ownsSocket) {
+            ::close(socketFd);
+        }
+        socketFd = -1;
+    }
+    if (shards) {
+        shards->stop();
+        shards.reset();
+    }
+    listening = false;
+    
+    // Idle connections close now; busy ones after their current response
+    std::vector<std::weak_ptr<HTTPConnection>> open;
+    open.swap(connections);
+    for (auto& weak : open) {
+        if (auto conn = weak.lock()) {
+            conn->keepAlive = false;
+            if (!conn->active) {
+                conn->closeAfterWrite = true;
+                flushOutbox(conn);
+            }
+        }
+    }
+    
+    // Last: dropping the self reference may finalize the server
+    JSValue held = self;
+    self = JS_UNDEFINED;
+    JS_FreeValueRT(rt, held);
+}
+
+static void acceptConnections(HTTPServerData* data) {
+    JSContext* ctx = data->ctx;
+    JSValue pin = JS_DupValue(ctx, data->self);
+    for (int i = 0; i < MAX_ACCEPT_BATCH && data->listening; ++i) {
+        int clientFd = accept4(data->socketFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (clientFd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            // EINVAL: a server thread's listener was shut down and its close is pending
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINVAL) {
+                std::cerr << "http: accept failed (errno " << errno << ")" << std::endl;
+            }
+            break;
+        }
+        
+        auto conn = std::make_shared<HTTPConnection>();
+        conn->fd = clientFd;
+        conn->ctx = ctx;
+        conn->rt = JS_GetRuntime(ctx);
+        conn->listener = JS_DupValue(ctx, data->requestListener);
+        conn->headersTimeoutMs = data->headersTimeoutMs;
+        updateInterest(conn);
+        startHeaderTimer(conn);
+        
+        auto& open = data->connections;
+        if (open.size() >= data->pruneAt) {
+            for (size_t j = 0; j < open.size();) {
+                if (open[j].expired()) {
+                    open[j] = std::move(open.back());
+                    open.pop_back();
+                } else {
+                    ++j;
+                }
+            }
+            data->pruneAt = open.size() * 2 > 64 ? open.size() * 2 : 64;
+        }
+        open.push_back(conn);
+    }
+    JS_FreeValue(ctx, pin);
+}
+
+// Accept connections on fd from the loop of the calling thread; the watched
+// listener keeps that loop alive until close()
+static bool startAccepting(JSContext* ctx, JSValueConst server, HTTPServerData* data, int fd) {
+    if (!EventLoop::getInstance().watchFd(fd, EPOLLIN, [data](uint32_t) {
+            acceptConnections(data);
+        })) {
+        return false;
+    }
+    data->socketFd = fd;
+    data->listening = true;
+    data->ctx = ctx;
+    data->self = JS_DupValue(ctx, server);
+    return true;
+}
+
+// ServerShards::Serve: a server in the shard context accepting on the shard's listener
+static std::function<void()> serveShard(JSContext* ctx, int fd, JSValueConst listener, uint32_t headersTimeoutMs) {
+    JSValue server = JS_NewObjectClass(ctx, http_server_class_id);
+    if (JS_IsException(server)) {
+        reportException(ctx, "http server thread");
+        return nullptr;
+    }
+    HTTPServerData* data = new HTTPServerData(JS_GetRuntime(ctx));
+    data->requestListener = JS_DupValue(ctx, listener);
+    data->headersTimeoutMs = headersTimeoutMs;
+    // The shard owns the listener and closes it after its thread is done
+    data->ownsSocket = false;
+    JS_SetOpaque(server, data);
+    
+    bool accepting = startAccepting(ctx, server, data, fd);
+    JS_FreeValue(ctx, server);
+    if (!accepting) {
+        std::cerr << "http: cannot watch server thread socket" << std::endl;
+        return nullptr;
+    }
+    // data lives while listening: close() drops the reference held by the loop
+    return [data]() { data->close(); };
+}
+
 void HTTPModule::init(JSContext* ctx) {
     JSRuntime* rt = JS_GetRuntime(ctx);
     
@@ -91,6 +808,7 @@ void HTTPModule::init(JSContext* ctx) {
     JSValue serverProto = JS_NewObject(ctx);
     JS_SetPropertyStr(ctx, serverProto, "listen", JS_NewCFunction(ctx, serverListen, "listen", 1));
     JS_SetPropertyStr(ctx, serverProto, "close", JS_NewCFunction(ctx, serverClose, "close", 0));
+    JS_SetPropertyStr(ctx, serverProto, "address", JS_NewCFunction(ctx, serverAddress, "address", 0));
     JS_SetClassProto(ctx, http_server_class_id, serverProto);
     
     // Register IncomingMessage class
@@ -149,26 +867,33 @@ JSValue HTTPModule::createServer(JSContext* ctx, JSValueConst this_val, int argc
     HTTPServerData* data = new HTTPServerData(JS_GetRuntime(ctx));
     
     // Create EventEmitter for server
-    JSValue eventEmitterCtor = JS_GetPropertyStr(ctx, JS_GetGlobalObject(ctx), "EventEmitter");
-    if (!JS_IsUndefined(eventEmitterCtor) && JS_IsFunction(ctx, eventEmitterCtor)) {
-        JSValue emitter = JS_CallConstructor(ctx, eventEmitterCtor, 0, nullptr);
-        if (!JS_IsException(emitter)) {
-            JS_SetPropertyStr(ctx, server, "_events", emitter);
-        }
-        JS_FreeValue(ctx, emitter);
-    }
-    JS_FreeValue(ctx, eventEmitterCtor);
+    JS_FreeValue(ctx, attachEventEmitter(ctx, server));
     
     // Store request listener if provided
     if (argc > 0 && JS_IsFunction(ctx, argv[0])) {
         data->requestListener = JS_DupValue(ctx, argv[0]);
-        JS_SetPropertyStr(ctx, server, "on", JS_GetPropertyStr(ctx, JS_GetGlobalObject(ctx), "on"));
     }
+    // Milliseconds a connection may wait for a request head (0 = no limit)
+    JS_SetPropertyStr(ctx, server, "headersTimeout", JS_NewUint32(ctx, data->headersTimeoutMs));
     
     JS_SetOpaque(server, data);
     return server;
 }
 
+JSValue HTTPModule::serverAddress(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    HTTPServerData* data = static_cast<HTTPServerData*>(JS_GetOpaque(this_val, http_server_class_id));
+    if (!data || !data->listening) {
+        return JS_NULL;
+    }
+    
+    JSValue addr = JS_NewObject(ctx);
+    JS_SetPropertyStr(ctx, addr, "port", JS_NewInt32(ctx, data->port));
+    JS_SetPropertyStr(ctx, addr, "family", JS_NewString(ctx, "IPv4"));
+    JS_SetPropertyStr(ctx, addr, "address", JS_NewString(ctx, data->host.c_str()));
+    
+    return addr;
+}
+
 void HTTPModule::ServerFinalizer(JSRuntime* rt, JSValue val) {
     HTTPServerData* data = static_cast<HTTPServerData*>(JS_GetOpaque(val, http_server_class_id));
     if (data) delete data;
@@ -179,8 +904,8 @@ JSValue HTTPModule::serverListen(JSContext* ctx, JSValueConst this_val, int argc
         return JS_ThrowTypeError(ctx, "listen requires a port number");
     }
     
-    int32_t port;
-    if (JS_ToInt32(ctx, &port, argv[0]) < 0) {
+    ListenOptions options;
+    if (!ListenOptions::parse(ctx, argc, argv, &options)) {
         return JS_EXCEPTION;
     }
     
@@ -188,142 +913,71 @@ JSValue HTTPModule::serverListen(JSContext* ctx, JSValueConst this_val, int argc
     if (!data) {
         return JS_ThrowTypeError(ctx, "Invalid HTTP server");
     }
-    
-    data->port = port;
-    
-    // Create socket
-    data->socketFd = socket(AF_INET, SOCK_STREAM, 0);
-    if (data->socketFd < 0) {
-        return JS_ThrowTypeError(ctx, "Failed to create socket");
+    if (data->listening) {
+        return JS_ThrowTypeError(ctx, "Server already listening");
     }
-    
-    int opt = 1;
-    setsockopt(data->socketFd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-    
-    struct sockaddr_in addr;
-    addr.sin_family = AF_INET;
-    addr.sin_addr.s_addr = INADDR_ANY;
-    addr.sin_port = htons(port);
-    
-    if (bind(data->socketFd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-        close(data->socketFd);
-        data->socketFd = -1;
-        return JS_ThrowTypeError(ctx, "Failed to bind to port");
+    if (options.threads > 1 && JS_IsUndefined(data->requestListener)) {
+        return JS_ThrowTypeError(ctx, "listen() with threads requires a request listener");
     }
     
-    if (listen(data->socketFd, 10) < 0) {
-        close(data->socketFd);
-        data->socketFd = -1;
-        return JS_ThrowTypeError(ctx, "Failed to listen on socket");
+    // Connections take the timeout in effect when listening starts
+    uint32_t headersTimeout = 0;
+    JSValue timeoutVal = JS_GetPropertyStr(ctx, this_val, "headersTimeout");
+    int converted = JS_ToUint32(ctx, &headersTimeout, timeoutVal);
+    JS_FreeValue(ctx, timeoutVal);
+    if (converted < 0) {
+        return JS_EXCEPTION;
     }
     
-    data->listening = true;
-    
-    // Start server thread
-    data->serverThread = std::thread([data, ctx]() {
-        JSContext* workerCtx = JS_NewContext(JS_GetRuntime(ctx));
-        if (!workerCtx) return;
-        
-        while (data->listening) {
-            struct sockaddr_in clientAddr;
-            socklen_t clientLen = sizeof(clientAddr);
-            int clientFd = accept(data->socketFd, (struct sockaddr*)&clientAddr, &clientLen);
-            
-            if (clientFd < 0) {
-                if (data->listening) continue;
-                break;
-            }
-            
-            // Read request
-            char buffer[4096];
-            ssize_t bytesRead = read(clientFd, buffer, sizeof(buffer) - 1);
-            if (bytesRead > 0) {
-                buffer[bytesRead] = '\0';
-                std::string requestStr(buffer);
-                
-                // Parse request
-                std::istringstream iss(requestStr);
-                std::string method, url, version;
-                iss >> method >> url >> version;
-                
-                // Find headers
-                std::string line;
-                std::map<std::string, std::string> headers;
-                while (std::getline(iss, line) && line != "\r" && !line.empty()) {
-                    size_t colon = line.find(':');
-                    if (colon != std::string::npos) {
-                        std::string key = line.substr(0, colon);
-                        std::string value = line.substr(colon + 1);
-                        // Trim whitespace
-                        while (!value.empty() && (value[0] == ' ' || value[0] == '\r')) {
-                            value.erase(0, 1);
-                        }
-                        headers[key] = value;
-                    }
-                }
-                
-                // Create request and response objects
-                JSValue req = JS_NewObjectClass(workerCtx, http_incoming_message_class_id);
-                HTTPRequestData* reqData = new HTTPRequestData(JS_GetRuntime(workerCtx));
-                reqData->method = method;
-                reqData->url = url;
-                reqData->version = version;
-                reqData->headers = headers;
-                
-                // Create EventEmitter for request
-                JSValue eventEmitterCtor = JS_GetPropertyStr(workerCtx, JS_GetGlobalObject(workerCtx), "EventEmitter");
-                if (!JS_IsUndefined(eventEmitterCtor) && JS_IsFunction(workerCtx, eventEmitterCtor)) {
-                    JSValue emitter = JS_CallConstructor(workerCtx, eventEmitterCtor, 0, nullptr);
-                    if (!JS_IsException(emitter)) {
-                        reqData->eventEmitter = emitter;
-                        JS_SetPropertyStr(workerCtx, req, "_events", emitter);
-                    }
-                    JS_FreeValue(workerCtx, emitter);
-                }
-                JS_FreeValue(workerCtx, eventEmitterCtor);
-                
-                JS_SetPropertyStr(workerCtx, req, "method", JS_NewString(workerCtx, method.c_str()));
-                JS_SetPropertyStr(workerCtx, req, "url", JS_NewString(workerCtx, url.c_str()));
-                JS_SetOpaque(req, reqData);
-                
-                JSValue res = JS_NewObjectClass(workerCtx, http_response_class_id);
-                HTTPResponseData* resData = new HTTPResponseData(JS_GetRuntime(workerCtx), clientFd);
-                
-                // Create EventEmitter for response
-                eventEmitterCtor = JS_GetPropertyStr(workerCtx, JS_GetGlobalObject(workerCtx), "EventEmitter");
-                if (!JS_IsUndefined(eventEmitterCtor) && JS_IsFunction(workerCtx, eventEmitterCtor)) {
-                    JSValue emitter = JS_CallConstructor(workerCtx, eventEmitterCtor, 0, nullptr);
-                    if (!JS_IsException(emitter)) {
-                        resData->eventEmitter = emitter;
-                        JS_SetPropertyStr(workerCtx, res, "_events", emitter);
-                    }
-                    JS_FreeValue(workerCtx, emitter);
-                }
-                JS_FreeValue(workerCtx, eventEmitterCtor);
-                
-                JS_SetOpaque(res, resData);
-                
-                // Call request listener
-                if (!JS_IsUndefined(data->requestListener) && JS_IsFunction(workerCtx, data->requestListener)) {
-                    JSValue args[] = { req, res };
-                    JSValue result = JS_Call(workerCtx, data->requestListener, JS_UNDEFINED, 2, args);
-                    JS_FreeValue(workerCtx, result);
-                }
-                
-                JS_FreeValue(workerCtx, req);
-                JS_FreeValue(workerCtx, res);
+    // With threads the first listener picks the port and the others join it
+    // through SO_REUSEPORT
+    std::vector<int> fds;
+    int boundPort = options.port;
+    for (int i = 0; i < options.threads; ++i) {
+        int sock = ListenSocket::open(options.host, boundPort, options.backlog, options.reusePort, &boundPort);
+        if (sock < 0) {
+            for (int fd : fds) {
+                close(fd);
             }
-            
-            close(clientFd);
+            return JS_ThrowTypeError(ctx, "Failed to listen on port %d: %s", options.port, strerror(errno));
         }
-        
-        JS_FreeContext(workerCtx);
-    });
+        fds.push_back(sock);
+    }
+    data->port = boundPort;
+    data->host = options.host;
+    data->headersTimeoutMs = headersTimeout;
     
-    // Call callback if provided
-    if (argc > 1 && JS_IsFunction(ctx, argv[1])) {
-        JSValue args[] = { JS_UNDEFINED };
-        JS_Call(ctx, argv[1], JS_UNDEFINED, 0, args);
+    if (options.threads > 1) {
+        data->shards = ServerShards::start(ctx, data->requestListener, std::move(fds),
+                                           {Console::init, EventsModule::init, TimersModule::init, HTTPModule::init},
+                                           [headersTimeout](JSContext* shardCtx, int fd, JSValueConst listener) {
+                                               return serveShard(shardCtx, fd, listener, headersTimeout);
+                                           });
+        if (!data->shards) {
+            return JS_EXCEPTION;
+        }
+        data->listening = true;
+        data->ctx = ctx;
+        data->self = JS_DupValue(ctx, this_val);
+    } else if (!startAccepting(ctx, this_val, data, fds[0])) {
+        close(fds[0]);
+        return JS_ThrowTypeError(ctx, "Failed to watch server socket");
+    }
+    
+    // The callback runs once listen() has returned, as for net servers
+    if (!JS_IsUndefined(options.callback)) {
+        JSValue callback = JS_DupValue(ctx, options.callback);
+        JSValue server = JS_DupValue(ctx, this_val);
+        EventLoop::getInstance().setImmediate([ctx, callback, server]() {
+            JSValue result = JS_Call(ctx, callback, server, 0, nullptr);
+            if (JS_IsException(result)) {
+                reportException(ctx, "http listen callback");
+            }
+            JS_FreeValue(ctx, result);
+            JS_FreeValue(ctx, callback);
+            JS_FreeValue(ctx, server);
+            EventLoop::getInstance().runMicrotasks();
+        });
     }
     
     return JS_DupValue(ctx, this_val);
@@ -332,14 +986,7 @@ JSValue HTTPModule::serverListen(JSContext* ctx, JSValueConst this_val, int argc
 JSValue HTTPModule::serverClose(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
     HTTPServerData* data = static_cast<HTTPServerData*>(JS_GetOpaque(this_val, http_server_class_id));
     if (data) {
-        data->listening = false;
-        if (data->socketFd >= 0) {
-            close(data->socketFd);
-            data->socketFd = -1;
-        }
-        if (data->serverThread.joinable()) {
-            data->serverThread.join();
-        }
+        data->close();
     }
     return JS_UNDEFINED;
 }
@@ -437,32 +1084,47 @@ JSValue HTTPModule::responseWrite(JSContext* ctx, JSValueConst this_val, int arg
 
 JSValue HTTPModule::responseEnd(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
     HTTPResponseData* data = static_cast<HTTPResponseData*>(JS_GetOpaque(this_val, http_response_class_id));
-    if (data && data->clientFd >= 0) {
+    if (data && !data->headersSent && data->connection) {
         // Write final chunk if provided
         if (argc > 0) {
             responseWrite(ctx, this_val, argc, argv);
         }
         
-        // Send response
-        std::ostringstream response;
-        response << "HTTP/1.1 " << data->statusCode << " OK\r\n";
-        
-        if (data->headers.find("Content-Type") == data->headers.end()) {
-            response << "Content-Type: text/plain\r\n";
+        // Held here: sending may close the connection, and listeners may drop the response
+        std::shared_ptr<HTTPConnection> conn = data->connection;
+        const std::string* connectionHeader = findHeader(data->headers, "Connection");
+        if (connectionHeader && strcasecmp(connectionHeader->c_str(), "close") == 0) {
+            conn->keepAlive = false;
         }
         
+        std::ostringstream head;
+        head << "HTTP/1.1 " << data->statusCode << " " << statusText(data->statusCode) << "\r\n";
+        if (!findHeader(data->headers, "Content-Type")) {
+            head << "Content-Type: text/plain\r\n";
+        }
         for (const auto& [key, value] : data->headers) {
-            response << key << ": " << value << "\r\n";
+            head << key << ": " << value << "\r\n";
         }
-        
-        response << "Content-Length: " << data->body.length() << "\r\n";
-        response << "\r\n";
-        response << data->body;
-        
-        std::string responseStr = response.str();
-        (void)write(data->clientFd, responseStr.c_str(), responseStr.length());
+        if (!findHeader(data->headers, "Content-Length")) {
+            head << "Content-Length: " << data->body.length() << "\r\n";
+        }
+        if (!connectionHeader) {
+            if (!conn->keepAlive) {
+                head << "Connection: close\r\n";
+            } else if (data->versionMinor == 0) {
+                head << "Connection: keep-alive\r\n";
+            }
+        }
+        head << "\r\n";
         
         data->headersSent = true;
+        sendResponse(conn, head.str(), data->headRequest ? std::string() : data->body);
+        data->body.clear();
+        
+        conn->responseDone = true;
+        if (conn->active && conn->requestComplete) {
+            finishExchange(conn);
+        }
     }
     
     return JS_DupValue(ctx, this_val);
@@ -470,7 +1132,14 @@ JSValue HTTPModule::responseEnd(JSContext* ctx, JSValueConst this_val, int argc,
 
 void HTTPModule::ResponseFinalizer(JSRuntime* rt, JSValue val) {
     HTTPResponseData* data = static_cast<HTTPResponseData*>(JS_GetOpaque(val, http_response_class_id));
-    if (data) delete data;
+    if (data) {
+        if (!data->headersSent && data->connection && data->connection->active) {
+            // The handler dropped the response without ending it: nothing will answer
+            // this request, so give up the connection instead of leaving it hanging
+            data->connection->close();
+        }
+        delete data;
+    }
 }
 
 JSValue HTTPModule::incomingMessageGetHeader(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
@@ -483,7 +1152,8 @@ JSValue HTTPModule::incomingMessageGetHeader(JSContext* ctx, JSValueConst this_v
     
     HTTPRequestData* data = static_cast<HTTPRequestData*>(JS_GetOpaque(this_val, http_incoming_message_class_id));
     if (data) {
-        auto it = data->headers.find(name);
+        // Header names are stored lowercased
+        auto it = data->headers.find(toLower(name));
         if (it != data->headers.end()) {
             JSValue result = JS_NewString(ctx, it->second.c_str());
             JS_FreeCString(ctx, name);
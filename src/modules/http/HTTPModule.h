@@ -16,6 +16,7 @@ private:
     static JSValue createServer(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
     static JSValue serverListen(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
     static JSValue serverClose(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    static JSValue serverAddress(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
     static void ServerFinalizer(JSRuntime* rt, JSValue val);
     
     // Request methods
@@ -0,0 +1,358 @@
+#include "HTTPParser.h"
+#include <cstring>
+
+namespace protojs {
+
+namespace {
+
+// Longest chunk-size line (size plus extensions) accepted
+constexpr size_t MAX_CHUNK_LINE = 1024;
+// Chunk sizes above this are rejected before they can overflow
+constexpr uint64_t MAX_CHUNK_SIZE = uint64_t{1} << 60;
+
+bool isTokenChar(char c) {
+    // RFC 9110 tchar
+    if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+        return true;
+    }
+    return c != '\0' && std::strchr("!#$%&'*+-.^_`|~", c) != nullptr;
+}
+
+bool isToken(std::string_view s) {
+    if (s.empty()) {
+        return false;
+    }
+    for (char c : s) {
+        if (!isTokenChar(c)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        char x = a[i] >= 'A' && a[i] <= 'Z' ? a[i] - 'A' + 'a' : a[i];
+        char y = b[i] >= 'A' && b[i] <= 'Z' ? b[i] - 'A' + 'a' : b[i];
+        if (x != y) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) {
+        s.remove_prefix(1);
+    }
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) {
+        s.remove_suffix(1);
+    }
+    return s;
+}
+
+// Calls f(element) for each trimmed, non-empty element of a comma-separated list
+template <typename F>
+void forEachListElement(std::string_view list, F&& f) {
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        std::string_view element = trim(list.substr(0, comma));
+        if (!element.empty()) {
+            f(element);
+        }
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        list.remove_prefix(comma + 1);
+    }
+}
+
+bool parseDecimal(std::string_view s, uint64_t* out) {
+    if (s.empty() || s.size() > 18) {
+        return false;
+    }
+    uint64_t value = 0;
+    for (char c : s) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + static_cast<uint64_t>(c - '0');
+    }
+    *out = value;
+    return true;
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+} // namespace
+
+HTTPRequestParser::HTTPRequestParser(size_t maxHeadSize)
+    : maxHeadSize(maxHeadSize), state(State::Head), headScanned(0), remaining(0), minorVersion(1),
+      persistent(false), chunkedBody(false), bodyLength(0) {
+}
+
+HTTPRequestParser::Event HTTPRequestParser::fail(const char* message) {
+    state = State::Error;
+    errorMessage = message;
+    return Event::Error;
+}
+
+HTTPRequestParser::Event HTTPRequestParser::parse(const char* data, size_t size, size_t* consumed) {
+    std::string_view input(data, size);
+    size_t offset = 0;
+    bodyPiece = {};
+    *consumed = 0;
+
+    while (true) {
+        std::string_view rest = input.substr(offset);
+        switch (state) {
+            case State::Head: {
+                // Empty lines before a request line are ignored (RFC 9112 2.2)
+                while (rest.size() >= 2 && rest[0] == '\r' && rest[1] == '\n') {
+                    rest.remove_prefix(2);
+                    offset += 2;
+                    headScanned = headScanned > 2 ? headScanned - 2 : 0;
+                }
+                // Resume the search a few bytes back in case the terminator was split
+                size_t from = headScanned > 3 ? headScanned - 3 : 0;
+                size_t end = rest.find("\r\n\r\n", from);
+                if (end == std::string_view::npos) {
+                    if (rest.size() > maxHeadSize) {
+                        return fail("Request header fields too large");
+                    }
+                    headScanned = rest.size();
+                    *consumed = offset;
+                    return Event::NeedMore;
+                }
+                if (end + 4 > maxHeadSize) {
+                    return fail("Request header fields too large");
+                }
+                headScanned = 0;
+                if (!parseHead(rest.substr(0, end + 2)) || !parseHeaderSemantics()) {
+                    return Event::Error;
+                }
+                offset += end + 4;
+                if (chunkedBody) {
+                    state = State::ChunkSize;
+                } else if (bodyLength > 0) {
+                    state = State::Body;
+                    remaining = bodyLength;
+                } else {
+                    state = State::Complete;
+                }
+                *consumed = offset;
+                return Event::Head;
+            }
+
+            case State::Body:
+            case State::ChunkData: {
+                if (rest.empty()) {
+                    *consumed = offset;
+                    return Event::NeedMore;
+                }
+                size_t take = rest.size() < remaining ? rest.size() : static_cast<size_t>(remaining);
+                bodyPiece = rest.substr(0, take);
+                remaining -= take;
+                if (remaining == 0) {
+                    state = state == State::Body ? State::Complete : State::ChunkDataEnd;
+                }
+                *consumed = offset + take;
+                return Event::Body;
+            }
+
+            case State::ChunkSize: {
+                size_t end = rest.find("\r\n");
+                if (end == std::string_view::npos) {
+                    if (rest.size() > MAX_CHUNK_LINE) {
+                        return fail("Chunk size line too long");
+                    }
+                    *consumed = offset;
+                    return Event::NeedMore;
+                }
+                std::string_view line = rest.substr(0, end);
+                // Chunk extensions follow a ';' and are ignored
+                std::string_view digits = trim(line.substr(0, line.find(';')));
+                if (digits.empty()) {
+                    return fail("Invalid chunk size");
+                }
+                uint64_t chunkSize = 0;
+                for (char c : digits) {
+                    int value = hexValue(c);
+                    if (value < 0 || chunkSize >= MAX_CHUNK_SIZE) {
+                        return fail("Invalid chunk size");
+                    }
+                    chunkSize = chunkSize * 16 + static_cast<uint64_t>(value);
+                }
+                offset += end + 2;
+                if (chunkSize == 0) {
+                    state = State::Trailer;
+                    headScanned = 0;
+                } else {
+                    state = State::ChunkData;
+                    remaining = chunkSize;
+                }
+                break;
+            }
+
+            case State::ChunkDataEnd: {
+                if (rest.size() < 2) {
+                    *consumed = offset;
+                    return Event::NeedMore;
+                }
+                if (rest[0] != '\r' || rest[1] != '\n') {
+                    return fail("Missing CRLF after chunk data");
+                }
+                offset += 2;
+                state = State::ChunkSize;
+                break;
+            }
+
+            case State::Trailer: {
+                // Trailer fields are skipped; an empty line ends the message
+                size_t end = rest.find("\r\n");
+                if (end == std::string_view::npos) {
+                    if (headScanned + rest.size() > maxHeadSize) {
+                        return fail("Trailer fields too large");
+                    }
+                    *consumed = offset;
+                    return Event::NeedMore;
+                }
+                offset += end + 2;
+                if (end == 0) {
+                    headScanned = 0;
+                    state = State::Complete;
+                } else {
+                    headScanned += end + 2;
+                    if (headScanned > maxHeadSize) {
+                        return fail("Trailer fields too large");
+                    }
+                }
+                break;
+            }
+
+            case State::Complete:
+                state = State::Head;
+                *consumed = offset;
+                return Event::MessageComplete;
+
+            case State::Error:
+                *consumed = 0;
+                return Event::Error;
+        }
+    }
+}
+
+bool HTTPRequestParser::parseHead(std::string_view head) {
+    // head is the request line and header lines, each ending in CRLF
+    size_t lineEnd = head.find("\r\n");
+    std::string_view requestLine = head.substr(0, lineEnd);
+    head.remove_prefix(lineEnd + 2);
+
+    size_t space = requestLine.find(' ');
+    size_t lastSpace = requestLine.rfind(' ');
+    if (space == std::string_view::npos || lastSpace == space) {
+        fail("Malformed request line");
+        return false;
+    }
+    requestMethod = requestLine.substr(0, space);
+    requestTarget = requestLine.substr(space + 1, lastSpace - space - 1);
+    std::string_view version = requestLine.substr(lastSpace + 1);
+    if (!isToken(requestMethod) || requestTarget.empty() || requestTarget.find(' ') != std::string_view::npos) {
+        fail("Malformed request line");
+        return false;
+    }
+    if (version == "HTTP/1.1") {
+        minorVersion = 1;
+    } else if (version == "HTTP/1.0") {
+        minorVersion = 0;
+    } else {
+        fail("Unsupported HTTP version");
+        return false;
+    }
+
+    headerList.clear();
+    while (!head.empty()) {
+        lineEnd = head.find("\r\n");
+        std::string_view line = head.substr(0, lineEnd);
+        head.remove_prefix(lineEnd + 2);
+        if (line.front() == ' ' || line.front() == '\t') {
+            // Obsolete line folding (RFC 9112 5.2)
+            fail("Folded header line");
+            return false;
+        }
+        size_t colon = line.find(':');
+        if (colon == std::string_view::npos || !isToken(line.substr(0, colon))) {
+            fail("Malformed header line");
+            return false;
+        }
+        headerList.push_back({line.substr(0, colon), trim(line.substr(colon + 1))});
+    }
+    return true;
+}
+
+bool HTTPRequestParser::parseHeaderSemantics() {
+    persistent = minorVersion >= 1;
+    chunkedBody = false;
+    bodyLength = 0;
+    bool hasLength = false;
+    bool hasTransferEncoding = false;
+    bool close = false;
+    bool keepAliveRequested = false;
+
+    for (const HTTPHeader& header : headerList) {
+        if (equalsIgnoreCase(header.name, "content-length")) {
+            uint64_t length;
+            if (!parseDecimal(header.value, &length) || (hasLength && length != bodyLength)) {
+                fail("Invalid Content-Length");
+                return false;
+            }
+            hasLength = true;
+            bodyLength = length;
+        } else if (equalsIgnoreCase(header.name, "transfer-encoding")) {
+            hasTransferEncoding = true;
+            // Only a final chunked coding delimits the body
+            chunkedBody = false;
+            forEachListElement(header.value, [this](std::string_view coding) {
+                chunkedBody = equalsIgnoreCase(coding, "chunked");
+            });
+        } else if (equalsIgnoreCase(header.name, "connection")) {
+            forEachListElement(header.value, [&](std::string_view option) {
+                if (equalsIgnoreCase(option, "close")) {
+                    close = true;
+                } else if (equalsIgnoreCase(option, "keep-alive")) {
+                    keepAliveRequested = true;
+                }
+            });
+        }
+    }
+
+    if (close) {
+        persistent = false;
+    } else if (keepAliveRequested) {
+        persistent = true;
+    }
+
+    if (hasTransferEncoding) {
+        // Both framings at once is the classic request smuggling vector
+        if (hasLength) {
+            fail("Both Transfer-Encoding and Content-Length");
+            return false;
+        }
+        if (!chunkedBody) {
+            fail("Unsupported Transfer-Encoding");
+            return false;
+        }
+        bodyLength = 0;
+    }
+    return true;
+}
+
+} // namespace protojs
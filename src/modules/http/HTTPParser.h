@@ -0,0 +1,114 @@
+#ifndef PROTOJS_HTTPPARSER_H
+#define PROTOJS_HTTPPARSER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace protojs {
+
+struct HTTPHeader {
+    std::string_view name;
+    std::string_view value;
+};
+
+/**
+ * @brief Incremental HTTP/1.x request parser.
+ *
+ * The parser never copies input: the caller keeps the bytes it has received
+ * in a buffer, passes the part not consumed yet to parse() and drops the
+ * consumed prefix when convenient. Each call reports one event, so a buffer
+ * holding several pipelined requests is drained by calling parse() until it
+ * returns NeedMore. The request line and headers are only parsed once the
+ * whole head has arrived; a partial head is rescanned from where the
+ * previous call stopped, not from its start.
+ *
+ * Bodies are delimited by Content-Length or chunked transfer coding and are
+ * reported piecewise as they arrive, without buffering. Requests carrying
+ * both, or a transfer coding other than chunked, are rejected.
+ */
+class HTTPRequestParser {
+public:
+    enum class Event {
+        /** All input was consumed; call again with more. */
+        NeedMore,
+        /** Request line and headers are available. */
+        Head,
+        /** body() holds the next piece of the body. */
+        Body,
+        /** The request is complete; the next one may follow. */
+        MessageComplete,
+        /** The input is not valid HTTP; error() says why. Sticky. */
+        Error
+    };
+
+    /** Bound on the request line plus headers (and on chunk trailers). */
+    static constexpr size_t DEFAULT_MAX_HEAD_SIZE = 64 * 1024;
+
+    explicit HTTPRequestParser(size_t maxHeadSize = DEFAULT_MAX_HEAD_SIZE);
+
+    /**
+     * @brief Parse input starting at the first byte not consumed so far.
+     * @param consumed Receives the number of bytes the caller may drop; the
+     *        next call starts after them
+     *
+     * The views returned by the accessors point into data and stay valid
+     * until the caller drops or overwrites those bytes.
+     */
+    Event parse(const char* data, size_t size, size_t* consumed);
+
+    // Request head, valid from the Head event on
+    std::string_view method() const { return requestMethod; }
+    std::string_view target() const { return requestTarget; }
+    /** 0 for HTTP/1.0, 1 for HTTP/1.1. */
+    int versionMinor() const { return minorVersion; }
+    const std::vector<HTTPHeader>& headers() const { return headerList; }
+    /** Whether the connection persists after this request. */
+    bool keepAlive() const { return persistent; }
+    bool chunked() const { return chunkedBody; }
+    uint64_t contentLength() const { return bodyLength; }
+
+    /** Piece of the body reported by the last Body event. */
+    std::string_view body() const { return bodyPiece; }
+
+    const std::string& error() const { return errorMessage; }
+
+private:
+    enum class State {
+        Head,
+        Body,
+        ChunkSize,
+        ChunkData,
+        ChunkDataEnd,
+        Trailer,
+        Complete,
+        Error
+    };
+
+    Event fail(const char* message);
+    bool parseHead(std::string_view head);
+    bool parseHeaderSemantics();
+
+    size_t maxHeadSize;
+    State state;
+    // Bytes of the pending head already searched for its end
+    size_t headScanned;
+    // Body or chunk bytes still expected
+    uint64_t remaining;
+
+    std::string_view requestMethod;
+    std::string_view requestTarget;
+    int minorVersion;
+    std::vector<HTTPHeader> headerList;
+    bool persistent;
+    bool chunkedBody;
+    uint64_t bodyLength;
+    std::string_view bodyPiece;
+    std::string errorMessage;
+};
+
+} // namespace protojs
+
+#endif // PROTOJS_HTTPPARSER_H
@@ -0,0 +1,85 @@
+#include "ListenSocket.h"
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+namespace protojs {
+
+int ListenSocket::maxBacklog() {
+    static const int limit = []() {
+        std::ifstream file("/proc/sys/net/core/somaxconn");
+        int value = 0;
+        if (file >> value && value > 0) {
+            return value;
+        }
+        return SOMAXCONN;
+    }();
+    return limit;
+}
+
+int ListenSocket::clampBacklog(int requested) {
+    int limit = maxBacklog();
+    int backlog = requested > 0 ? requested : DEFAULT_BACKLOG;
+    return backlog < limit ? backlog : limit;
+}
+
+bool ListenSocket::resolveIPv4(const std::string& host, struct in_addr* out) {
+    if (host.empty() || host == "0.0.0.0") {
+        out->s_addr = htonl(INADDR_ANY);
+        return true;
+    }
+    return inet_pton(AF_INET, host == "localhost" ? "127.0.0.1" : host.c_str(), out) == 1;
+}
+
+int ListenSocket::open(const std::string& host, int port, int backlog, bool reusePort, int* boundPort) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (!resolveIPv4(host, &addr.sin_addr)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int sock = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
+        return -1;
+    }
+
+    int opt = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    if (reusePort && setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        int err = errno;
+        ::close(sock);
+        errno = err;
+        return -1;
+    }
+
+    if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(sock, clampBacklog(backlog)) < 0) {
+        int err = errno;
+        ::close(sock);
+        errno = err;
+        return -1;
+    }
+
+    if (boundPort) {
+        struct sockaddr_in actual;
+        socklen_t len = sizeof(actual);
+        *boundPort = getsockname(sock, (struct sockaddr*)&actual, &len) == 0 ? ntohs(actual.sin_port) : port;
+    }
+    return sock;
+}
+
+bool ListenSocket::setFastOpen(int fd, int queueLength) {
+    return setsockopt(fd, IPPROTO_TCP, TCP_FASTOPEN, &queueLength, sizeof(queueLength)) == 0;
+}
+
+bool ListenSocket::setDeferAccept(int fd, int seconds) {
+    return setsockopt(fd, IPPROTO_TCP, TCP_DEFER_ACCEPT, &seconds, sizeof(seconds)) == 0;
+}
+
+} // namespace protojs
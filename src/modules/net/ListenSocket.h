@@ -0,0 +1,64 @@
+#ifndef PROTOJS_LISTENSOCKET_H
+#define PROTOJS_LISTENSOCKET_H
+
+#include <netinet/in.h>
+#include <string>
+
+namespace protojs {
+
+/**
+ * @brief TCP listening sockets shared by the net and http servers.
+ *
+ * Sockets are non-blocking and close-on-exec, ready to be watched by an
+ * EventLoop. With reusePort several sockets can bind the same address
+ * (SO_REUSEPORT) and the kernel spreads incoming connections across them.
+ */
+class ListenSocket {
+public:
+    /**
+     * @brief Backlog used when listen() is given none (as in Node.js).
+     */
+    static constexpr int DEFAULT_BACKLOG = 511;
+
+    /**
+     * @brief Kernel limit on the accept queue (net.core.somaxconn), or
+     *        SOMAXCONN if it cannot be read.
+     */
+    static int maxBacklog();
+
+    /**
+     * @brief requested clamped to [1, maxBacklog()]; 0 or less selects
+     *        DEFAULT_BACKLOG.
+     */
+    static int clampBacklog(int requested);
+
+    /**
+     * @brief Parse an IPv4 address; "localhost" is the loopback address and
+     *        "" or "0.0.0.0" any address.
+     */
+    static bool resolveIPv4(const std::string& host, struct in_addr* out);
+
+    /**
+     * @brief Bind and listen on host:port.
+     * @param boundPort If given, receives the port actually bound (port 0
+     *        asks the kernel for one)
+     * @return The socket, or -1 with errno set
+     */
+    static int open(const std::string& host, int port, int backlog, bool reusePort, int* boundPort = nullptr);
+
+    /**
+     * @brief Enable TCP Fast Open: clients with a cookie may send data in
+     *        their SYN. queueLength bounds pending fast-open requests.
+     */
+    static bool setFastOpen(int fd, int queueLength);
+
+    /**
+     * @brief TCP_DEFER_ACCEPT: report a connection only once its first data
+     *        arrives, waiting up to seconds after the handshake.
+     */
+    static bool setDeferAccept(int fd, int seconds);
+};
+
+} // namespace protojs
+
+#endif // PROTOJS_LISTENSOCKET_H
@@ -1,26 +1,49 @@
 #include "NetModule.h"
+#include "ListenSocket.h"
+#include "ServerShards.h"
+#include "SocketOptions.h"
+#include "../../console.h"
+#include "../timers/TimersModule.h"
 #include "../events/EventsModule.h"
 #include "../buffer/BufferModule.h"
 #include "../../IOThreadPool.h"
 #include "../../EventLoop.h"
 #include "../../JSContext.h"
 #include <sys/socket.h>
+#include <sys/epoll.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <fcntl.h>
-#include <thread>
+#include <sys/uio.h>
+#include <cerrno>
+#include <climits>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <iostream>
 #include <vector>
 #include <string>
 #include <cstring>
-#include <queue>
-#include <mutex>
 
 namespace protojs {
 
 static JSClassID net_server_class_id;
 static JSClassID net_socket_class_id;
 
+// Bytes read from one socket per readiness notification, delivered as one data event
+static constexpr size_t MAX_READ_BATCH = 256 * 1024;
+// Connections accepted per readiness notification of a listener
+static constexpr int MAX_ACCEPT_BATCH = 64;
+static constexpr uint32_t SOCKET_READ_EVENTS = EPOLLIN | EPOLLRDHUP | EPOLLET;
+// Buffered outbound bytes above which write() returns false
+static constexpr size_t DEFAULT_HIGH_WATER_MARK = 16 * 1024;
+// Queued chunks gathered into one sendmsg
+static constexpr int MAX_WRITE_IOVECS = IOV_MAX < 64 ? IOV_MAX : 64;
+// Listener options given as true
+static constexpr int DEFAULT_FAST_OPEN_QUEUE = 256;
+static constexpr int DEFAULT_DEFER_ACCEPT_SECONDS = 1;
+
 struct NetServerData {
     int socketFd;
     int port;
@@ -29,11 +52,24 @@ struct NetServerData {
     bool closed;
     JSValue connectionListener;
     JSRuntime* rt;
-    std::thread acceptThread;
-    std::mutex mutex;
+    JSContext* ctx;
+    // The server object, held while listening so it outlives its last JS reference
+    JSValue self;
+    // Given to accepted sockets
+    size_t highWaterMark;
+    SocketOptions connectionOptions;
+    // Listener options: TCP_FASTOPEN queue length and TCP_DEFER_ACCEPT seconds (0 = off)
+    int fastOpen;
+    int deferAccept;
+    // Server threads of listen({threads}); socketFd is unused then
+    std::shared_ptr<ServerShards> shards;
+    // False for the per-thread servers of shards, whose listener the shard closes
+    bool ownsSocket;
     
     NetServerData(JSRuntime* r) : socketFd(-1), port(0), listening(false), closed(false), 
-                                   connectionListener(JS_UNDEFINED), rt(r) {}
+                                   connectionListener(JS_UNDEFINED), rt(r), ctx(nullptr), self(JS_UNDEFINED),
+                                   highWaterMark(DEFAULT_HIGH_WATER_MARK), fastOpen(0), deferAccept(0),
+                                   ownsSocket(true) {}
     ~NetServerData() {
         close();
         if (!JS_IsUndefined(connectionListener)) {
@@ -42,36 +78,69 @@ struct NetServerData {
     }
     
     void close() {
-        std::lock_guard<std::mutex> lock(mutex);
         if (closed) return;
         closed = true;
-        listening = false;
         if (socketFd >= 0) {
-            ::close(socketFd);
+            if (listening) {
+                EventLoop::getInstance().unwatchFd(socketFd);
+            }
+            if (ownsSocket) {
+                ::close(socketFd);
+            }
             socketFd = -1;
         }
-        if (acceptThread.joinable()) {
-            acceptThread.join();
+        if (shards) {
+            shards->stop();
+            shards.reset();
         }
+        listening = false;
+        // Last: dropping the self reference may finalize the server
+        JSValue held = self;
+        self = JS_UNDEFINED;
+        JS_FreeValueRT(rt, held);
     }
 };
 
 struct NetSocketData {
     int socketFd;
+    bool connecting;
     bool connected;
     bool destroyed;
+    bool watching;
+    // The peer closed its side
+    bool readEnded;
+    // end() was called; the write side shuts down once the queue drains
+    bool ending;
+    // epoll mask registered while watching
+    uint32_t armedEvents;
     std::string remoteAddress;
     int remotePort;
     std::string localAddress;
     int localPort;
     JSRuntime* rt;
+    JSContext* ctx;
     JSValue eventEmitter;
-    std::thread readThread;
-    std::mutex mutex;
-    bool reading;
+    // The socket object, held while the fd is watched so an open connection
+    // outlives its last JS reference
+    JSValue self;
+    // Chunks the kernel has not taken yet; the front one is sent up to writeOffset
+    std::deque<std::vector<uint8_t>> writeQueue;
+    size_t writeOffset;
+    size_t bufferedBytes;
+    size_t highWaterMark;
+    // Nesting depth of cork(); queued chunks are held back while non-zero
+    int corked;
+    // A write() returned false and drain has not been emitted yet
+    bool needDrain;
+    // Applied once the socket exists, and kept up to date by the setters
+    SocketOptions options;
     
-    NetSocketData(JSRuntime* r) : socketFd(-1), connected(false), destroyed(false),
-                                   remotePort(0), localPort(0), rt(r), eventEmitter(JS_UNDEFINED), reading(false) {}
+    NetSocketData(JSRuntime* r) : socketFd(-1), connecting(false), connected(false), destroyed(false),
+                                   watching(false), readEnded(false), ending(false), armedEvents(0),
+                                   remotePort(0), localPort(0), rt(r), ctx(nullptr),
+                                   eventEmitter(JS_UNDEFINED), self(JS_UNDEFINED), writeOffset(0),
+                                   bufferedBytes(0), highWaterMark(DEFAULT_HIGH_WATER_MARK), corked(0),
+                                   needDrain(false) {}
     ~NetSocketData() {
         destroy();
         if (!JS_IsUndefined(eventEmitter)) {
@@ -79,22 +148,451 @@ struct NetSocketData {
         }
     }
     
+    // Stop polling the fd; it stays open for writes until destroy()
+    void stopWatching() {
+        if (!watching) return;
+        watching = false;
+        EventLoop::getInstance().unwatchFd(socketFd);
+        // Last: dropping the self reference may finalize the socket
+        JSValue held = self;
+        self = JS_UNDEFINED;
+        JS_FreeValueRT(rt, held);
+    }
+    
     void destroy() {
-        std::lock_guard<std::mutex> lock(mutex);
         if (destroyed) return;
         destroyed = true;
+        connecting = false;
         connected = false;
-        reading = false;
-        if (socketFd >= 0) {
-            ::close(socketFd);
-            socketFd = -1;
+        writeQueue.clear();
+        writeOffset = 0;
+        bufferedBytes = 0;
+        int fd = socketFd;
+        socketFd = -1;
+        if (watching) {
+            watching = false;
+            EventLoop::getInstance().unwatchFd(fd);
         }
-        if (readThread.joinable()) {
-            readThread.join();
+        if (fd >= 0) {
+            ::close(fd);
         }
+        JSValue held = self;
+        self = JS_UNDEFINED;
+        JS_FreeValueRT(rt, held);
     }
 };
 
+static void reportException(JSContext* ctx, const char* where) {
+    JSValue exception = JS_GetException(ctx);
+    const char* str = JS_ToCString(ctx, exception);
+    if (str) {
+        std::cerr << "Uncaught exception in " << where << ": " << str << std::endl;
+        JS_FreeCString(ctx, str);
+    }
+    JS_FreeValue(ctx, exception);
+}
+
+// New EventEmitter stored as obj._events; returns a reference for the caller
+static JSValue attachEventEmitter(JSContext* ctx, JSValueConst obj) {
+    JSValue result = JS_UNDEFINED;
+    JSValue global = JS_GetGlobalObject(ctx);
+    JSValue eventEmitterCtor = JS_GetPropertyStr(ctx, global, "EventEmitter");
+    if (!JS_IsFunction(ctx, eventEmitterCtor)) {
+        // EventsModule only publishes the constructor as events.EventEmitter
+        JS_FreeValue(ctx, eventEmitterCtor);
+        JSValue events = JS_GetPropertyStr(ctx, global, "events");
+        eventEmitterCtor = JS_IsObject(events) ? JS_GetPropertyStr(ctx, events, "EventEmitter") : JS_UNDEFINED;
+        JS_FreeValue(ctx, events);
+    }
+    if (JS_IsFunction(ctx, eventEmitterCtor)) {
+        JSValue emitter = JS_CallConstructor(ctx, eventEmitterCtor, 0, nullptr);
+        if (!JS_IsException(emitter)) {
+            result = JS_DupValue(ctx, emitter);
+            JS_SetPropertyStr(ctx, obj, "_events", emitter);
+        } else {
+            JS_FreeValue(ctx, JS_GetException(ctx));
+        }
+    }
+    JS_FreeValue(ctx, eventEmitterCtor);
+    JS_FreeValue(ctx, global);
+    return result;
+}
+
+static void emitEvent(JSContext* ctx, JSValueConst emitter, const char* event, JSValueConst arg = JS_UNDEFINED, int argc = 0) {
+    if (JS_IsUndefined(emitter)) {
+        return;
+    }
+    JSValue emit = JS_GetPropertyStr(ctx, emitter, "emit");
+    if (JS_IsFunction(ctx, emit)) {
+        JSValue eventName = JS_NewString(ctx, event);
+        JSValueConst args[] = {eventName, arg};
+        JSValue result = JS_Call(ctx, emit, emitter, argc + 1, const_cast<JSValue*>(args));
+        if (JS_IsException(result)) {
+            reportException(ctx, "net event listener");
+        }
+        JS_FreeValue(ctx, result);
+        JS_FreeValue(ctx, eventName);
+    }
+    JS_FreeValue(ctx, emit);
+}
+
+static void emitError(NetSocketData* data, const char* syscall, int err) {
+    JSContext* ctx = data->ctx;
+    JSValue error = JS_NewError(ctx);
+    JS_SetPropertyStr(ctx, error, "message", JS_NewString(ctx, (std::string(syscall) + " " + strerror(err)).c_str()));
+    JS_SetPropertyStr(ctx, error, "syscall", JS_NewString(ctx, syscall));
+    JS_SetPropertyStr(ctx, error, "errno", JS_NewInt32(ctx, err));
+    emitEvent(ctx, data->eventEmitter, "error", error, 1);
+    JS_FreeValue(ctx, error);
+}
+
+static void readHighWaterMark(JSContext* ctx, JSValueConst options, size_t* out) {
+    JSValue value = JS_GetPropertyStr(ctx, options, "highWaterMark");
+    int64_t bytes;
+    if (JS_IsNumber(value) && JS_ToInt64(ctx, &bytes, value) == 0 && bytes >= 0) {
+        *out = static_cast<size_t>(bytes);
+    }
+    JS_FreeValue(ctx, value);
+}
+
+// Reads options[name] as an int; true selects whenTrue, false 0
+static bool readIntOption(JSContext* ctx, JSValueConst options, const char* name, int whenTrue, int* out) {
+    JSValue value = JS_GetPropertyStr(ctx, options, name);
+    bool found = true;
+    if (JS_IsBool(value)) {
+        *out = JS_ToBool(ctx, value) ? whenTrue : 0;
+    } else if (!JS_IsNumber(value) || JS_ToInt32(ctx, out, value) < 0) {
+        found = false;
+    }
+    JS_FreeValue(ctx, value);
+    return found;
+}
+
+// noDelay, keepAlive, keepAliveInitialDelay, recvBufferSize, sendBufferSize
+static void readSocketOptions(JSContext* ctx, JSValueConst options, SocketOptions* out) {
+    int value;
+    if (readIntOption(ctx, options, "noDelay", 1, &value)) {
+        out->noDelay = value != 0;
+    }
+    if (readIntOption(ctx, options, "keepAlive", 1, &value)) {
+        out->keepAlive = value != 0;
+    }
+    readIntOption(ctx, options, "keepAliveInitialDelay", 0, &out->keepAliveInitialDelay);
+    readIntOption(ctx, options, "recvBufferSize", 0, &out->recvBufferSize);
+    readIntOption(ctx, options, "sendBufferSize", 0, &out->sendBufferSize);
+}
+
+static void recordAddresses(NetSocketData* data) {
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    if (getsockname(data->socketFd, (struct sockaddr*)&addr, &len) == 0) {
+        data->localAddress = inet_ntoa(addr.sin_addr);
+        data->localPort = ntohs(addr.sin_port);
+    }
+    len = sizeof(addr);
+    if (getpeername(data->socketFd, (struct sockaddr*)&addr, &len) == 0) {
+        data->remoteAddress = inet_ntoa(addr.sin_addr);
+        data->remotePort = ntohs(addr.sin_port);
+    }
+}
+
+static void onSocketEvents(NetSocketData* data, uint32_t events);
+
+// Register the socket's fd with the loop; the socket object stays alive until unwatched
+static bool watchSocket(NetSocketData* data, JSValueConst socket, uint32_t events) {
+    if (!EventLoop::getInstance().watchFd(data->socketFd, events, [data](uint32_t ready) {
+            onSocketEvents(data, ready);
+        })) {
+        return false;
+    }
+    data->watching = true;
+    data->armedEvents = events;
+    data->self = JS_DupValue(data->ctx, socket);
+    return true;
+}
+
+// Match the fd's epoll interest to the socket's state: reads until the peer
+// closes its side, writability only while corked-free chunks are queued
+static bool updateInterest(NetSocketData* data, JSValueConst socket) {
+    if (data->destroyed) {
+        return true;
+    }
+    uint32_t events = 0;
+    if (data->connecting) {
+        events = EPOLLOUT;
+    } else {
+        if (!data->readEnded) {
+            events |= SOCKET_READ_EVENTS;
+        }
+        if (!data->writeQueue.empty() && data->corked == 0) {
+            events |= EPOLLOUT;
+        }
+    }
+    
+    if (events == 0) {
+        data->stopWatching();
+        return true;
+    }
+    if (!data->watching) {
+        return watchSocket(data, socket, events);
+    }
+    if (events != data->armedEvents) {
+        data->armedEvents = events;
+        return EventLoop::getInstance().modifyFd(data->socketFd, events);
+    }
+    return true;
+}
+
+// Send queued chunks, gathered into as few syscalls as the kernel allows;
+// whatever is left waits for EPOLLOUT
+static void flushWrites(NetSocketData* data, JSValueConst socket) {
+    if (!data->connected) {
+        return;
+    }
+    
+    while (!data->writeQueue.empty() && data->corked == 0) {
+        struct iovec iov[MAX_WRITE_IOVECS];
+        int count = 0;
+        size_t offset = data->writeOffset;
+        for (auto it = data->writeQueue.begin(); it != data->writeQueue.end() && count < MAX_WRITE_IOVECS; ++it) {
+            iov[count].iov_base = it->data() + offset;
+            iov[count].iov_len = it->size() - offset;
+            offset = 0;
+            count++;
+        }
+        
+        // writev semantics, but MSG_NOSIGNAL turns a closed peer into EPIPE instead of SIGPIPE
+        struct msghdr msg = {};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+        ssize_t n = sendmsg(data->socketFd, &msg, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            int err = errno;
+            data->destroy();
+            emitError(data, "write", err);
+            return;
+        }
+        
+        size_t sent = static_cast<size_t>(n);
+        data->bufferedBytes -= sent;
+        while (sent > 0) {
+            size_t left = data->writeQueue.front().size() - data->writeOffset;
+            if (sent < left) {
+                data->writeOffset += sent;
+                break;
+            }
+            sent -= left;
+            data->writeQueue.pop_front();
+            data->writeOffset = 0;
+        }
+    }
+    
+    if (data->writeQueue.empty() && data->ending) {
+        shutdown(data->socketFd, SHUT_WR);
+    }
+    if (!updateInterest(data, socket)) {
+        std::cerr << "net: cannot watch socket for writability" << std::endl;
+    }
+    if (data->writeQueue.empty() && data->needDrain) {
+        data->needDrain = false;
+        emitEvent(data->ctx, data->eventEmitter, "drain");
+    }
+}
+
+static void finishConnect(NetSocketData* data) {
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(data->socketFd, SOL_SOCKET, SO_ERROR, &err, &len) < 0) {
+        err = errno;
+    }
+    if (err != 0) {
+        data->destroy();
+        emitError(data, "connect", err);
+        return;
+    }
+    
+    data->connecting = false;
+    data->connected = true;
+    recordAddresses(data);
+    // Sends what was written while connecting, then switches the fd to reads;
+    // re-arming in edge-triggered mode reports bytes that arrived before that
+    flushWrites(data, data->self);
+    if (data->destroyed) {
+        return;
+    }
+    emitEvent(data->ctx, data->eventEmitter, "connect");
+}
+
+// Drain the socket into the shared read buffer and deliver it as one data event
+static void readSocket(NetSocketData* data) {
+    // Every socket on this thread reads into the same buffer; each batch is
+    // copied once, into the ArrayBuffer handed to JS
+    thread_local std::vector<uint8_t> readBuffer(MAX_READ_BATCH);
+    
+    size_t used = 0;
+    bool eof = false;
+    int err = 0;
+    while (used < readBuffer.size()) {
+        ssize_t n = recv(data->socketFd, readBuffer.data() + used, readBuffer.size() - used, 0);
+        if (n > 0) {
+            used += static_cast<size_t>(n);
+        } else if (n == 0) {
+            eof = true;
+            break;
+        } else if (errno != EINTR) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                err = errno;
+            }
+            break;
+        }
+    }
+    
+    JSContext* ctx = data->ctx;
+    if (used > 0) {
+        JSValue chunk = JS_NewArrayBufferCopy(ctx, readBuffer.data(), used);
+        emitEvent(ctx, data->eventEmitter, "data", chunk, 1);
+        JS_FreeValue(ctx, chunk);
+        if (data->destroyed || !data->watching) {
+            return;
+        }
+    }
+    
+    if (err != 0) {
+        data->destroy();
+        emitError(data, "read", err);
+    } else if (eof) {
+        // Stop reading before emitting, so a listener may still write or destroy;
+        // the fd stays watched while queued writes remain
+        data->readEnded = true;
+        updateInterest(data, data->self);
+        emitEvent(ctx, data->eventEmitter, "end");
+    } else if (used == readBuffer.size()) {
+        // Batch full before EAGAIN: edge-triggered epoll will not report the
+        // rest, so re-arm and continue on a later iteration after other fds
+        EventLoop::getInstance().modifyFd(data->socketFd, data->armedEvents);
+    }
+}
+
+static void onSocketEvents(NetSocketData* data, uint32_t events) {
+    JSContext* ctx = data->ctx;
+    // Keep the socket alive while its listeners run, even if one destroys it
+    JSValue pin = JS_DupValue(ctx, data->self);
+    if (data->connecting) {
+        if (events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) {
+            finishConnect(data);
+        }
+    } else {
+        if (!data->readEnded && (events & (EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP))) {
+            readSocket(data);
+        }
+        if (!data->destroyed && !data->writeQueue.empty() && (events & (EPOLLOUT | EPOLLERR | EPOLLHUP))) {
+            flushWrites(data, data->self);
+        }
+    }
+    JS_FreeValue(ctx, pin);
+}
+
+static void acceptConnections(NetServerData* data) {
+    JSContext* ctx = data->ctx;
+    JSValue pin = JS_DupValue(ctx, data->self);
+    for (int i = 0; i < MAX_ACCEPT_BATCH && !data->closed; ++i) {
+        struct sockaddr_in clientAddr;
+        socklen_t clientLen = sizeof(clientAddr);
+        int clientFd = accept4(data->socketFd, (struct sockaddr*)&clientAddr, &clientLen, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (clientFd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            // EINVAL: a server thread's listener was shut down and its close is pending
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINVAL) {
+                std::cerr << "net: accept failed (errno " << errno << ")" << std::endl;
+            }
+            break;
+        }
+        
+        JSValue socket = JS_NewObjectClass(ctx, net_socket_class_id);
+        if (JS_IsException(socket)) {
+            ::close(clientFd);
+            reportException(ctx, "net accept");
+            continue;
+        }
+        NetSocketData* socketData = new NetSocketData(JS_GetRuntime(ctx));
+        socketData->ctx = ctx;
+        socketData->socketFd = clientFd;
+        socketData->connected = true;
+        socketData->highWaterMark = data->highWaterMark;
+        socketData->options = data->connectionOptions;
+        if (!socketData->options.apply(clientFd)) {
+            std::cerr << "net: cannot set options of accepted socket: " << strerror(errno) << std::endl;
+        }
+        socketData->eventEmitter = attachEventEmitter(ctx, socket);
+        JS_SetOpaque(socket, socketData);
+        recordAddresses(socketData);
+        
+        if (!watchSocket(socketData, socket, SOCKET_READ_EVENTS)) {
+            std::cerr << "net: cannot watch accepted socket" << std::endl;
+            socketData->destroy();
+        } else if (!JS_IsUndefined(data->connectionListener)) {
+            JSValueConst args[] = {socket};
+            JSValue result = JS_Call(ctx, data->connectionListener, JS_UNDEFINED, 1, const_cast<JSValue*>(args));
+            if (JS_IsException(result)) {
+                reportException(ctx, "net connection listener");
+            }
+            JS_FreeValue(ctx, result);
+        }
+        JS_FreeValue(ctx, socket);
+    }
+    JS_FreeValue(ctx, pin);
+}
+
+// Accept connections on fd from the loop of the calling thread; the watched
+// listener keeps that loop alive until close()
+static bool startAccepting(JSContext* ctx, JSValueConst server, NetServerData* data, int fd) {
+    if (!EventLoop::getInstance().watchFd(fd, EPOLLIN, [data](uint32_t) {
+            acceptConnections(data);
+        })) {
+        return false;
+    }
+    data->socketFd = fd;
+    data->listening = true;
+    data->ctx = ctx;
+    data->self = JS_DupValue(ctx, server);
+    return true;
+}
+
+// ServerShards::Serve: a server in the shard context accepting on the shard's listener
+static std::function<void()> serveShard(JSContext* ctx, int fd, JSValueConst listener, size_t highWaterMark,
+                                        const SocketOptions& connectionOptions) {
+    JSValue server = JS_NewObjectClass(ctx, net_server_class_id);
+    if (JS_IsException(server)) {
+        reportException(ctx, "net server thread");
+        return nullptr;
+    }
+    NetServerData* data = new NetServerData(JS_GetRuntime(ctx));
+    data->connectionListener = JS_DupValue(ctx, listener);
+    data->highWaterMark = highWaterMark;
+    data->connectionOptions = connectionOptions;
+    // The shard owns the listener and closes it after its thread is done
+    data->ownsSocket = false;
+    JS_SetOpaque(server, data);
+    JS_FreeValue(ctx, attachEventEmitter(ctx, server));
+    
+    bool accepting = startAccepting(ctx, server, data, fd);
+    JS_FreeValue(ctx, server);
+    if (!accepting) {
+        std::cerr << "net: cannot watch server thread socket" << std::endl;
+        return nullptr;
+    }
+    // data lives while listening: close() drops the reference held by the loop
+    return [data]() { data->close(); };
+}
+
 void NetModule::init(JSContext* ctx) {
     JSRuntime* rt = JS_GetRuntime(ctx);
     
@@ -126,6 +624,17 @@ void NetModule::init(JSContext* ctx) {
     JS_SetPropertyStr(ctx, socketProto, "end", JS_NewCFunction(ctx, socketEnd, "end", 1));
     JS_SetPropertyStr(ctx, socketProto, "destroy", JS_NewCFunction(ctx, socketDestroy, "destroy", 0));
     JS_SetPropertyStr(ctx, socketProto, "address", JS_NewCFunction(ctx, socketAddress, "address", 0));
+    JS_SetPropertyStr(ctx, socketProto, "cork", JS_NewCFunction(ctx, socketCork, "cork", 0));
+    JS_SetPropertyStr(ctx, socketProto, "uncork", JS_NewCFunction(ctx, socketUncork, "uncork", 0));
+    JS_SetPropertyStr(ctx, socketProto, "setNoDelay", JS_NewCFunction(ctx, socketSetNoDelay, "setNoDelay", 1));
+    JS_SetPropertyStr(ctx, socketProto, "setKeepAlive", JS_NewCFunction(ctx, socketSetKeepAlive, "setKeepAlive", 2));
+    JS_SetPropertyStr(ctx, socketProto, "setRecvBufferSize", JS_NewCFunction(ctx, socketSetRecvBufferSize, "setRecvBufferSize", 1));
+    JS_SetPropertyStr(ctx, socketProto, "setSendBufferSize", JS_NewCFunction(ctx, socketSetSendBufferSize, "setSendBufferSize", 1));
+    JSAtom bufferSizeAtom = JS_NewAtom(ctx, "bufferSize");
+    JS_DefinePropertyGetSet(ctx, socketProto, bufferSizeAtom,
+                            JS_NewCFunction(ctx, socketBufferSize, "get bufferSize", 0), JS_UNDEFINED,
+                            JS_PROP_CONFIGURABLE);
+    JS_FreeAtom(ctx, bufferSizeAtom);
     JS_SetClassProto(ctx, net_socket_class_id, socketProto);
     
     // Create net module
@@ -148,23 +657,21 @@ JSValue NetModule::createServer(JSContext* ctx, JSValueConst this_val, int argc,
     if (argc > 0 && JS_IsFunction(ctx, argv[0])) {
         data->connectionListener = JS_DupValue(ctx, argv[0]);
     } else if (argc > 0 && JS_IsObject(argv[0])) {
-        JSValue listener = JS_GetPropertyStr(ctx, argv[0], "connectionListener");
+        JSValue listener = argc > 1 && JS_IsFunction(ctx, argv[1])
+            ? JS_DupValue(ctx, argv[1])
+            : JS_GetPropertyStr(ctx, argv[0], "connectionListener");
         if (JS_IsFunction(ctx, listener)) {
             data->connectionListener = JS_DupValue(ctx, listener);
         }
         JS_FreeValue(ctx, listener);
+        readHighWaterMark(ctx, argv[0], &data->highWaterMark);
+        readSocketOptions(ctx, argv[0], &data->connectionOptions);
+        readIntOption(ctx, argv[0], "fastOpen", DEFAULT_FAST_OPEN_QUEUE, &data->fastOpen);
+        readIntOption(ctx, argv[0], "deferAccept", DEFAULT_DEFER_ACCEPT_SECONDS, &data->deferAccept);
     }
     
     // Create EventEmitter for server
-    JSValue eventEmitterCtor = JS_GetPropertyStr(ctx, JS_GetGlobalObject(ctx), "EventEmitter");
-    if (!JS_IsUndefined(eventEmitterCtor) && JS_IsFunction(ctx, eventEmitterCtor)) {
-        JSValue emitter = JS_CallConstructor(ctx, eventEmitterCtor, 0, nullptr);
-        if (!JS_IsException(emitter)) {
-            JS_SetPropertyStr(ctx, server, "_events", emitter);
-        }
-        JS_FreeValue(ctx, emitter);
-    }
-    JS_FreeValue(ctx, eventEmitterCtor);
+    JS_FreeValue(ctx, attachEventEmitter(ctx, server));
     
     JS_SetOpaque(server, data);
     return server;
@@ -176,204 +683,93 @@ JSValue NetModule::serverListen(JSContext* ctx, JSValueConst this_val, int argc,
         return JS_ThrowTypeError(ctx, "Invalid server object");
     }
     
-    std::lock_guard<std::mutex> lock(data->mutex);
     if (data->listening) {
         return JS_ThrowTypeError(ctx, "Server already listening");
     }
-    
-    // Parse arguments
-    int port = 0;
-    std::string host = "0.0.0.0";
-    
-    if (argc > 0 && JS_IsNumber(argv[0])) {
-        JS_ToInt32(ctx, &port, argv[0]);
-    } else if (argc > 0 && JS_IsObject(argv[0])) {
-        JSValue portVal = JS_GetPropertyStr(ctx, argv[0], "port");
-        if (JS_IsNumber(portVal)) {
-            JS_ToInt32(ctx, &port, portVal);
-        }
-        JS_FreeValue(ctx, portVal);
-        
-        JSValue hostVal = JS_GetPropertyStr(ctx, argv[0], "host");
-        if (JS_IsString(hostVal)) {
-            const char* hostStr = JS_ToCString(ctx, hostVal);
-            if (hostStr) {
-                host = hostStr;
-                JS_FreeCString(ctx, hostStr);
-            }
-        }
-        JS_FreeValue(ctx, hostVal);
+    if (data->closed) {
+        return JS_ThrowTypeError(ctx, "Server is closed");
     }
     
-    if (port < 0 || port > 65535) {
-        return JS_ThrowTypeError(ctx, "Invalid port number");
+    ListenOptions options;
+    if (!ListenOptions::parse(ctx, argc, argv, &options)) {
+        return JS_EXCEPTION;
+    }
+    if (options.threads > 1 && JS_IsUndefined(data->connectionListener)) {
+        return JS_ThrowTypeError(ctx, "listen() with threads requires a connection listener");
     }
     
-    data->port = port;
-    data->host = host;
+    data->port = options.port;
+    data->host = options.host;
     
-    // Create socket in IO thread
+    // Create the listeners in an IO thread; with threads the first one picks
+    // the port and the others join it through SO_REUSEPORT
     auto& ioPool = IOThreadPool::getInstance();
-    auto future = ioPool.getExecutor().submit([data, port, host]() -> int {
-        int sock = socket(AF_INET, SOCK_STREAM, 0);
-        if (sock < 0) return -1;
-        
-        int opt = 1;
-        setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-        
-        struct sockaddr_in addr;
-        memset(&addr, 0, sizeof(addr));
-        addr.sin_family = AF_INET;
-        addr.sin_port = htons(port);
-        if (host == "0.0.0.0" || host.empty()) {
-            addr.sin_addr.s_addr = INADDR_ANY;
-        } else {
-            if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) <= 0) {
-                close(sock);
-                return -1;
+    int fastOpen = data->fastOpen;
+    int deferAccept = data->deferAccept;
+    auto future = ioPool.getExecutor().submit([data, options, fastOpen, deferAccept]() -> std::vector<int> {
+        std::vector<int> fds;
+        int boundPort = options.port;
+        for (int i = 0; i < options.threads; ++i) {
+            int sock = ListenSocket::open(options.host, boundPort, options.backlog, options.reusePort, &boundPort);
+            if (sock >= 0 && ((fastOpen > 0 && !ListenSocket::setFastOpen(sock, fastOpen)) ||
+                              (deferAccept > 0 && !ListenSocket::setDeferAccept(sock, deferAccept)))) {
+                ::close(sock);
+                sock = -1;
             }
-        }
-        
-        if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-            close(sock);
-            return -1;
-        }
-        
-        // Get actual port if port was 0 (OS assigned)
-        if (port == 0) {
-            struct sockaddr_in actualAddr;
-            socklen_t len = sizeof(actualAddr);
-            if (getsockname(sock, (struct sockaddr*)&actualAddr, &len) == 0) {
-                data->port = ntohs(actualAddr.sin_port);
+            if (sock < 0) {
+                for (int fd : fds) {
+                    ::close(fd);
+                }
+                return {};
             }
+            fds.push_back(sock);
         }
-        
-        if (listen(sock, 128) < 0) {
-            close(sock);
-            return -1;
-        }
-        
-        return sock;
+        data->port = boundPort;
+        return fds;
     });
     
     // Wait for socket creation
-    int sock = future.get();
-    if (sock < 0) {
+    std::vector<int> fds = future.get();
+    if (fds.empty()) {
         return JS_ThrowTypeError(ctx, "Failed to create server socket");
     }
     
-    data->socketFd = sock;
-    data->listening = true;
+    if (options.threads > 1) {
+        size_t highWaterMark = data->highWaterMark;
+        SocketOptions connectionOptions = data->connectionOptions;
+        data->shards = ServerShards::start(ctx, data->connectionListener, std::move(fds),
+                                           {Console::init, EventsModule::init, TimersModule::init, NetModule::init},
+                                           [highWaterMark, connectionOptions](JSContext* shardCtx, int fd,
+                                                                              JSValueConst listener) {
+                                               return serveShard(shardCtx, fd, listener, highWaterMark,
+                                                                 connectionOptions);
+                                           });
+        if (!data->shards) {
+            return JS_EXCEPTION;
+        }
+        data->listening = true;
+        data->ctx = ctx;
+        data->self = JS_DupValue(ctx, this_val);
+    } else if (!startAccepting(ctx, this_val, data, fds[0])) {
+        ::close(fds[0]);
+        return JS_ThrowTypeError(ctx, "Failed to watch server socket");
+    }
     
-    // Start accept thread
-    data->acceptThread = std::thread([data, ctx]() {
-        while (data->listening && !data->closed) {
-            struct sockaddr_in clientAddr;
-            socklen_t clientLen = sizeof(clientAddr);
-            
-            int clientFd = accept(data->socketFd, (struct sockaddr*)&clientAddr, &clientLen);
-            if (clientFd < 0) {
-                if (data->listening && !data->closed) {
-                    continue;
-                }
-                break;
-            }
-            
-            // Create socket object for connection
-            JSContext* workerCtx = JS_NewContext(JS_GetRuntime(ctx));
-            if (workerCtx) {
-                JSValue socket = JS_NewObjectClass(workerCtx, net_socket_class_id);
-                if (!JS_IsException(socket)) {
-                    NetSocketData* socketData = new NetSocketData(JS_GetRuntime(workerCtx));
-                    socketData->socketFd = clientFd;
-                    socketData->connected = true;
-                    socketData->remoteAddress = inet_ntoa(clientAddr.sin_addr);
-                    socketData->remotePort = ntohs(clientAddr.sin_port);
-                    
-                    // Get local address
-                    struct sockaddr_in localAddr;
-                    socklen_t localLen = sizeof(localAddr);
-                    getsockname(clientFd, (struct sockaddr*)&localAddr, &localLen);
-                    socketData->localAddress = inet_ntoa(localAddr.sin_addr);
-                    socketData->localPort = ntohs(localAddr.sin_port);
-                    
-                    // Create EventEmitter
-                    JSValue eventEmitterCtor = JS_GetPropertyStr(workerCtx, JS_GetGlobalObject(workerCtx), "EventEmitter");
-                    if (!JS_IsUndefined(eventEmitterCtor) && JS_IsFunction(workerCtx, eventEmitterCtor)) {
-                        JSValue emitter = JS_CallConstructor(workerCtx, eventEmitterCtor, 0, nullptr);
-                        if (!JS_IsException(emitter)) {
-                            socketData->eventEmitter = JS_DupValue(workerCtx, emitter);
-                            JS_SetPropertyStr(workerCtx, socket, "_events", emitter);
-                        }
-                        JS_FreeValue(workerCtx, emitter);
-                    }
-                    JS_FreeValue(workerCtx, eventEmitterCtor);
-                    
-                    JS_SetOpaque(socket, socketData);
-                    
-                    // Start read thread for this socket
-                    socketData->readThread = std::thread([socketData, workerCtx]() {
-                        char buffer[4096];
-                        while (socketData->connected && !socketData->destroyed) {
-                            ssize_t n = recv(socketData->socketFd, buffer, sizeof(buffer), 0);
-                            if (n <= 0) {
-                                socketData->connected = false;
-                                break;
-                            }
-                            
-                            // Emit data event
-                            if (!JS_IsUndefined(socketData->eventEmitter)) {
-                                JSValue dataEvent = JS_NewString(workerCtx, "data");
-                                JSValue bufferObj = JS_NewArrayBufferCopy(workerCtx, (uint8_t*)buffer, n);
-                                
-                                EventLoop::getInstance().enqueueCallback([workerCtx, socketData, dataEvent, bufferObj]() {
-                                    JSValue emit = JS_GetPropertyStr(workerCtx, socketData->eventEmitter, "emit");
-                                    if (JS_IsFunction(workerCtx, emit)) {
-                                        JSValue args[] = {dataEvent, bufferObj};
-                                        JS_Call(workerCtx, emit, socketData->eventEmitter, 2, args);
-                                    }
-                                    JS_FreeValue(workerCtx, emit);
-                                    JS_FreeValue(workerCtx, dataEvent);
-                                    JS_FreeValue(workerCtx, bufferObj);
-                                });
-                            }
-                        }
-                        
-                        // Emit end event
-                        if (!JS_IsUndefined(socketData->eventEmitter)) {
-                            EventLoop::getInstance().enqueueCallback([workerCtx, socketData]() {
-                                    JSValue emit = JS_GetPropertyStr(workerCtx, socketData->eventEmitter, "emit");
-                                    if (JS_IsFunction(workerCtx, emit)) {
-                                        JSValue endEvent = JS_NewString(workerCtx, "end");
-                                        JSValue args[] = {endEvent};
-                                        JS_Call(workerCtx, emit, socketData->eventEmitter, 1, args);
-                                        JS_FreeValue(workerCtx, endEvent);
-                                    }
-                                    JS_FreeValue(workerCtx, emit);
-                            });
-                        }
-                    });
-                    
-                    // Call connection listener
-                    if (!JS_IsUndefined(data->connectionListener)) {
-                        JSValue socketDup = JS_DupValue(workerCtx, socket);
-                        EventLoop::getInstance().enqueueCallback([ctx, data, socketDup]() {
-                            JSValueConst args[] = {socketDup};
-                            JSValue result = JS_Call(ctx, data->connectionListener, JS_UNDEFINED, 1, const_cast<JSValue*>(args));
-                            if (JS_IsException(result)) {
-                                JSValue exception = JS_GetException(ctx);
-                                // Log error
-                                JS_FreeValue(ctx, exception);
-                            }
-                            JS_FreeValue(ctx, result);
-                            JS_FreeValue(ctx, socketDup);
-                        });
-                    }
-                }
-                JS_FreeContext(workerCtx);
+    // The callback runs once the loop is turning
+    if (!JS_IsUndefined(options.callback)) {
+        JSValue callback = JS_DupValue(ctx, options.callback);
+        JSValue server = JS_DupValue(ctx, this_val);
+        EventLoop::getInstance().setImmediate([ctx, callback, server]() {
+            JSValue result = JS_Call(ctx, callback, server, 0, nullptr);
+            if (JS_IsException(result)) {
+                reportException(ctx, "net listen callback");
             }
-        }
-    });
+            JS_FreeValue(ctx, result);
+            JS_FreeValue(ctx, callback);
+            JS_FreeValue(ctx, server);
+            EventLoop::getInstance().runMicrotasks();
+        });
+    }
     
     return JS_UNDEFINED;
 }
@@ -414,22 +810,22 @@ JSValue NetModule::createConnection(JSContext* ctx, JSValueConst this_val, int a
     NetSocketData* data = new NetSocketData(JS_GetRuntime(ctx));
     
     // Create EventEmitter
-    JSValue eventEmitterCtor = JS_GetPropertyStr(ctx, JS_GetGlobalObject(ctx), "EventEmitter");
-    if (!JS_IsUndefined(eventEmitterCtor) && JS_IsFunction(ctx, eventEmitterCtor)) {
-        JSValue emitter = JS_CallConstructor(ctx, eventEmitterCtor, 0, nullptr);
-        if (!JS_IsException(emitter)) {
-            data->eventEmitter = JS_DupValue(ctx, emitter);
-            JS_SetPropertyStr(ctx, socket, "_events", emitter);
-        }
-        JS_FreeValue(ctx, emitter);
-    }
-    JS_FreeValue(ctx, eventEmitterCtor);
+    data->eventEmitter = attachEventEmitter(ctx, socket);
     
     JS_SetOpaque(socket, data);
     
+    if (argc > 0 && JS_IsObject(argv[0])) {
+        readHighWaterMark(ctx, argv[0], &data->highWaterMark);
+        readSocketOptions(ctx, argv[0], &data->options);
+    }
+    
     // Auto-connect if options provided
     if (argc > 0) {
-        socketConnect(ctx, socket, argc, argv);
+        JSValue result = socketConnect(ctx, socket, argc, argv);
+        if (JS_IsException(result)) {
+            JS_FreeValue(ctx, socket);
+            return result;
+        }
     }
     
     return socket;
@@ -441,7 +837,7 @@ JSValue NetModule::socketConnect(JSContext* ctx, JSValueConst this_val, int argc
         return JS_ThrowTypeError(ctx, "Invalid socket object");
     }
     
-    if (data->connected) {
+    if (data->connecting || data->connected) {
         return JS_ThrowTypeError(ctx, "Socket already connected");
     }
     
@@ -479,152 +875,183 @@ JSValue NetModule::socketConnect(JSContext* ctx, JSValueConst this_val, int argc
         return JS_ThrowTypeError(ctx, "Invalid port number");
     }
     
-    // Connect in IO thread
-    auto& ioPool = IOThreadPool::getInstance();
-    auto future = ioPool.getExecutor().submit([data, port, host]() -> int {
-        int sock = socket(AF_INET, SOCK_STREAM, 0);
-        if (sock < 0) return -1;
-        
-        struct sockaddr_in addr;
-        memset(&addr, 0, sizeof(addr));
-        addr.sin_family = AF_INET;
-        addr.sin_port = htons(port);
-        inet_pton(AF_INET, host.c_str(), &addr.sin_addr);
-        
-        if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-            close(sock);
-            return -1;
-        }
-        
-        // Get local address
-        struct sockaddr_in localAddr;
-        socklen_t localLen = sizeof(localAddr);
-        getsockname(sock, (struct sockaddr*)&localAddr, &localLen);
-        data->localAddress = inet_ntoa(localAddr.sin_addr);
-        data->localPort = ntohs(localAddr.sin_port);
-        
-        // Get remote address
-        struct sockaddr_in remoteAddr;
-        socklen_t remoteLen = sizeof(remoteAddr);
-        getpeername(sock, (struct sockaddr*)&remoteAddr, &remoteLen);
-        data->remoteAddress = inet_ntoa(remoteAddr.sin_addr);
-        data->remotePort = ntohs(remoteAddr.sin_port);
-        
-        return sock;
-    });
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (!ListenSocket::resolveIPv4(host, &addr.sin_addr)) {
+        return JS_ThrowTypeError(ctx, "Invalid host");
+    }
     
-    int sock = future.get();
+    // Non-blocking connect: completion is reported as writability on the loop
+    int sock = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
     if (sock < 0) {
-        return JS_ThrowTypeError(ctx, "Connection failed");
+        return JS_ThrowTypeError(ctx, "Failed to create socket");
+    }
+    // Before connect(): the receive buffer size determines the window scale
+    if (!data->options.apply(sock)) {
+        int err = errno;
+        close(sock);
+        return JS_ThrowTypeError(ctx, "Failed to set socket options: %s", strerror(err));
+    }
+    if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS) {
+        int err = errno;
+        close(sock);
+        return JS_ThrowTypeError(ctx, "Connection failed: %s", strerror(err));
     }
     
     data->socketFd = sock;
-    data->connected = true;
+    data->connecting = true;
+    data->ctx = ctx;
     
-    // Emit connect event
-    if (!JS_IsUndefined(data->eventEmitter)) {
-        EventLoop::getInstance().enqueueCallback([ctx, data]() {
-            JSValue emit = JS_GetPropertyStr(ctx, data->eventEmitter, "emit");
-            if (JS_IsFunction(ctx, emit)) {
-                JSValue connectEvent = JS_NewString(ctx, "connect");
-                JSValueConst args[] = {connectEvent};
-                JS_Call(ctx, emit, data->eventEmitter, 1, const_cast<JSValue*>(args));
-                JS_FreeValue(ctx, connectEvent);
-            }
-            JS_FreeValue(ctx, emit);
-        });
+    // The watched fd keeps the event loop alive until the read side ends
+    if (!watchSocket(data, this_val, EPOLLOUT)) {
+        data->destroy();
+        return JS_ThrowTypeError(ctx, "Failed to watch socket");
     }
     
-    // Start read thread
-    data->readThread = std::thread([data, ctx]() {
-        char buffer[4096];
-        while (data->connected && !data->destroyed) {
-            ssize_t n = recv(data->socketFd, buffer, sizeof(buffer), 0);
-            if (n <= 0) {
-                data->connected = false;
-                break;
-            }
-            
-            // Emit data event
-            if (!JS_IsUndefined(data->eventEmitter)) {
-                JSValue dataEvent = JS_NewString(ctx, "data");
-                JSValue bufferObj = JS_NewArrayBufferCopy(ctx, (uint8_t*)buffer, n);
-                
-                EventLoop::getInstance().enqueueCallback([ctx, data, dataEvent, bufferObj]() {
-                    JSValue emit = JS_GetPropertyStr(ctx, data->eventEmitter, "emit");
-                    if (JS_IsFunction(ctx, emit)) {
-                        JSValueConst args[] = {dataEvent, bufferObj};
-                        JS_Call(ctx, emit, data->eventEmitter, 2, const_cast<JSValue*>(args));
-                    }
-                    JS_FreeValue(ctx, emit);
-                    JS_FreeValue(ctx, dataEvent);
-                    JS_FreeValue(ctx, bufferObj);
-                });
-            }
-        }
-        
-        // Emit end event
-        if (!JS_IsUndefined(data->eventEmitter)) {
-            EventLoop::getInstance().enqueueCallback([ctx, data]() {
-                JSValue emit = JS_GetPropertyStr(ctx, data->eventEmitter, "emit");
-                if (JS_IsFunction(ctx, emit)) {
-                    JSValue endEvent = JS_NewString(ctx, "end");
-                    JSValueConst args[] = {endEvent};
-                    JS_Call(ctx, emit, data->eventEmitter, 1, const_cast<JSValue*>(args));
-                    JS_FreeValue(ctx, endEvent);
-                }
-                JS_FreeValue(ctx, emit);
-            });
-        }
-    });
-    
     return JS_UNDEFINED;
 }
 
 JSValue NetModule::socketWrite(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
     NetSocketData* data = static_cast<NetSocketData*>(JS_GetOpaque(this_val, net_socket_class_id));
-    if (!data || !data->connected) {
+    if (!data || data->destroyed || (!data->connected && !data->connecting)) {
         return JS_ThrowTypeError(ctx, "Socket not connected");
     }
+    if (data->ending) {
+        return JS_ThrowTypeError(ctx, "write after end");
+    }
     
     if (argc < 1) {
         return JS_ThrowTypeError(ctx, "write requires data");
     }
     
     std::vector<uint8_t> bytes = getDataFromJSValue(ctx, argv[0]);
-    if (bytes.empty()) {
-        return JS_NewBool(ctx, false);
+    if (!bytes.empty()) {
+        bool idle = data->writeQueue.empty();
+        data->bufferedBytes += bytes.size();
+        data->writeQueue.push_back(std::move(bytes));
+        // With nothing queued ahead this is one direct send; while chunks are
+        // waiting for EPOLLOUT (or corked), later ones join the same sendmsg
+        if (idle) {
+            flushWrites(data, this_val);
+        }
     }
     
-    // Write in IO thread
-    auto& ioPool = IOThreadPool::getInstance();
-    auto future = ioPool.getExecutor().submit([data, bytes]() -> ssize_t {
-        return send(data->socketFd, bytes.data(), bytes.size(), 0);
-    });
-    
-    ssize_t sent = future.get();
-    return JS_NewBool(ctx, sent > 0);
+    if (data->bufferedBytes < data->highWaterMark) {
+        return JS_NewBool(ctx, true);
+    }
+    data->needDrain = true;
+    return JS_NewBool(ctx, false);
 }
 
 JSValue NetModule::socketEnd(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
     NetSocketData* data = static_cast<NetSocketData*>(JS_GetOpaque(this_val, net_socket_class_id));
-    if (!data) {
+    if (!data || data->destroyed || data->ending) {
         return JS_UNDEFINED;
     }
     
     // Write final data if provided
-    if (argc > 0) {
-        socketWrite(ctx, this_val, argc, argv);
+    if (argc > 0 && !JS_IsUndefined(argv[0])) {
+        JSValue result = socketWrite(ctx, this_val, argc, argv);
+        if (JS_IsException(result)) {
+            return result;
+        }
+        JS_FreeValue(ctx, result);
     }
     
-    // Shutdown write side
-    if (data->connected && data->socketFd >= 0) {
-        shutdown(data->socketFd, SHUT_WR);
-    }
+    // Shut down the write side once everything queued (including corked data) is sent
+    data->ending = true;
+    data->corked = 0;
+    flushWrites(data, this_val);
     
     return JS_UNDEFINED;
 }
 
+JSValue NetModule::socketCork(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    NetSocketData* data = static_cast<NetSocketData*>(JS_GetOpaque(this_val, net_socket_class_id));
+    if (data && !data->destroyed) {
+        data->corked++;
+    }
+    return JS_UNDEFINED;
+}
+
+JSValue NetModule::socketUncork(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    NetSocketData* data = static_cast<NetSocketData*>(JS_GetOpaque(this_val, net_socket_class_id));
+    if (data && !data->destroyed && data->corked > 0 && --data->corked == 0) {
+        flushWrites(data, this_val);
+    }
+    return JS_UNDEFINED;
+}
+
+JSValue NetModule::socketBufferSize(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    NetSocketData* data = static_cast<NetSocketData*>(JS_GetOpaque(this_val, net_socket_class_id));
+    return JS_NewInt64(ctx, data ? static_cast<int64_t>(data->bufferedBytes) : 0);
+}
+
+// Options are remembered and applied to the live socket, if any
+static JSValue throwSocketOptionError(JSContext* ctx) {
+    return JS_ThrowTypeError(ctx, "Failed to set socket option: %s", strerror(errno));
+}
+
+JSValue NetModule::socketSetNoDelay(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    NetSocketData* data = static_cast<NetSocketData*>(JS_GetOpaque(this_val, net_socket_class_id));
+    if (!data) {
+        return JS_ThrowTypeError(ctx, "Invalid socket object");
+    }
+    bool enable = argc < 1 || JS_ToBool(ctx, argv[0]) > 0;
+    data->options.noDelay = enable;
+    if (data->socketFd >= 0 && !SocketOptions::setNoDelay(data->socketFd, enable)) {
+        return throwSocketOptionError(ctx);
+    }
+    return JS_DupValue(ctx, this_val);
+}
+
+JSValue NetModule::socketSetKeepAlive(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    NetSocketData* data = static_cast<NetSocketData*>(JS_GetOpaque(this_val, net_socket_class_id));
+    if (!data) {
+        return JS_ThrowTypeError(ctx, "Invalid socket object");
+    }
+    bool enable = argc > 0 && JS_ToBool(ctx, argv[0]) > 0;
+    data->options.keepAlive = enable;
+    if (argc > 1 && JS_IsNumber(argv[1])) {
+        JS_ToInt32(ctx, &data->options.keepAliveInitialDelay, argv[1]);
+    }
+    if (data->socketFd >= 0 &&
+        !SocketOptions::setKeepAlive(data->socketFd, enable, data->options.keepAliveInitialDelay)) {
+        return throwSocketOptionError(ctx);
+    }
+    return JS_DupValue(ctx, this_val);
+}
+
+// setRecvBufferSize(size) / setSendBufferSize(size)
+static JSValue setBufferSize(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv, int option) {
+    NetSocketData* data = static_cast<NetSocketData*>(JS_GetOpaque(this_val, net_socket_class_id));
+    if (!data) {
+        return JS_ThrowTypeError(ctx, "Invalid socket object");
+    }
+    int size = 0;
+    if (argc < 1 || JS_ToInt32(ctx, &size, argv[0]) < 0) {
+        return JS_EXCEPTION;
+    }
+    if (size <= 0) {
+        return JS_ThrowRangeError(ctx, "Buffer size must be a positive number");
+    }
+    (option == SO_RCVBUF ? data->options.recvBufferSize : data->options.sendBufferSize) = size;
+    if (data->socketFd >= 0 && !SocketOptions::setBufferSize(data->socketFd, option, size)) {
+        return throwSocketOptionError(ctx);
+    }
+    return JS_DupValue(ctx, this_val);
+}
+
+JSValue NetModule::socketSetRecvBufferSize(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    return setBufferSize(ctx, this_val, argc, argv, SO_RCVBUF);
+}
+
+JSValue NetModule::socketSetSendBufferSize(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    return setBufferSize(ctx, this_val, argc, argv, SO_SNDBUF);
+}
+
 JSValue NetModule::socketDestroy(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
     NetSocketData* data = static_cast<NetSocketData*>(JS_GetOpaque(this_val, net_socket_class_id));
     if (data) {
@@ -657,51 +1084,52 @@ void NetModule::SocketFinalizer(JSRuntime* rt, JSValue val) {
 std::vector<uint8_t> NetModule::getDataFromJSValue(JSContext* ctx, JSValueConst val, const char* encoding) {
     std::vector<uint8_t> result;
     
-    // Check if it's a Buffer
-    JSValue bufferCtor = JS_GetPropertyStr(ctx, JS_GetGlobalObject(ctx), "Buffer");
-    if (!JS_IsUndefined(bufferCtor)) {
-        JSValue isBuffer = JS_GetPropertyStr(ctx, bufferCtor, "isBuffer");
-        if (JS_IsFunction(ctx, isBuffer)) {
-            JSValue dupVal = JS_DupValue(ctx, val);
-            JSValueConst args[] = {dupVal};
-            JSValue isBuf = JS_Call(ctx, isBuffer, bufferCtor, 1, const_cast<JSValue*>(args));
-            JS_FreeValue(ctx, dupVal);
-            if (JS_ToBool(ctx, isBuf)) {
-                // Extract buffer data
-                JSValue length = JS_GetPropertyStr(ctx, val, "length");
-                uint32_t len;
-                if (JS_ToUint32(ctx, &len, length) >= 0) {
-                    result.resize(len);
-                    // For now, convert to string and back (simplified)
-                    JSValue str = JS_GetPropertyStr(ctx, val, "toString");
-                    if (JS_IsFunction(ctx, str)) {
-                        JSValue strVal = JS_Call(ctx, str, val, 0, nullptr);
-                        const char* strData = JS_ToCString(ctx, strVal);
-                        if (strData) {
-                            result.assign((uint8_t*)strData, (uint8_t*)strData + strlen(strData));
-                            JS_FreeCString(ctx, strData);
-                        }
-                        JS_FreeValue(ctx, strVal);
-                    }
-                    JS_FreeValue(ctx, str);
-                }
-                JS_FreeValue(ctx, length);
-            }
-            JS_FreeValue(ctx, isBuf);
-        }
-        JS_FreeValue(ctx, isBuffer);
-    }
-    JS_FreeValue(ctx, bufferCtor);
-    
-    // If not buffer, try string
-    if (result.empty() && JS_IsString(val)) {
-        const char* str = JS_ToCString(ctx, val);
+    if (JS_IsString(val)) {
+        size_t len = 0;
+        const char* str = JS_ToCStringLen(ctx, &len, val);
         if (str) {
-            result.assign((uint8_t*)str, (uint8_t*)str + strlen(str));
+            result.assign(reinterpret_cast<const uint8_t*>(str), reinterpret_cast<const uint8_t*>(str) + len);
             JS_FreeCString(ctx, str);
         }
+        return result;
     }
+    if (!JS_IsObject(val)) {
+        return result;
+    }
+    
+    // Binary payloads are copied as they are: they may hold NULs or bytes
+    // that are not valid UTF-8
+    size_t size = 0;
+    const uint8_t* bytes = BufferModule::getBytes(ctx, val, &size);
+    if (bytes) {
+        result.assign(bytes, bytes + size);
+        return result;
+    }
+    
+    uint8_t* data = JS_GetArrayBuffer(ctx, &size, val);
+    if (data) {
+        result.assign(data, data + size);
+        return result;
+    }
+    JS_FreeValue(ctx, JS_GetException(ctx));
     
+    // TypedArray: only the bytes in view
+    size_t byteOffset = 0;
+    size_t byteLength = 0;
+    size_t bytesPerElement = 0;
+    JSValue buffer = JS_GetTypedArrayBuffer(ctx, val, &byteOffset, &byteLength, &bytesPerElement);
+    if (JS_IsException(buffer)) {
+        JS_FreeValue(ctx, JS_GetException(ctx));
+        return result;
+    }
+    data = JS_GetArrayBuffer(ctx, &size, buffer);
+    JS_FreeValue(ctx, buffer);
+    if (data && byteOffset + byteLength <= size) {
+        result.assign(data + byteOffset, data + byteOffset + byteLength);
+    } else if (!data) {
+        // Detached
+        JS_FreeValue(ctx, JS_GetException(ctx));
+    }
     return result;
 }
 
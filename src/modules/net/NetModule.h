@@ -26,6 +26,13 @@ private:
     static JSValue socketEnd(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
     static JSValue socketDestroy(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
     static JSValue socketAddress(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    static JSValue socketCork(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    static JSValue socketUncork(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    static JSValue socketBufferSize(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    static JSValue socketSetNoDelay(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    static JSValue socketSetKeepAlive(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    static JSValue socketSetRecvBufferSize(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    static JSValue socketSetSendBufferSize(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
     static void SocketFinalizer(JSRuntime* rt, JSValue val);
     
     // Helper functions
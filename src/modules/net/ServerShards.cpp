@@ -0,0 +1,231 @@
+#include "ServerShards.h"
+#include "../../EventLoop.h"
+#include <sys/socket.h>
+#include <unistd.h>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace protojs {
+
+namespace {
+
+// Module init functions touch process-wide class ids
+std::mutex moduleInitMutex;
+
+void reportException(JSContext* ctx, const char* where) {
+    JSValue exception = JS_GetException(ctx);
+    const char* str = JS_ToCString(ctx, exception);
+    if (str) {
+        std::cerr << "Uncaught exception in " << where << ": " << str << std::endl;
+        JS_FreeCString(ctx, str);
+    }
+    JS_FreeValue(ctx, exception);
+}
+
+} // namespace
+
+bool ListenOptions::parse(JSContext* ctx, int argc, JSValueConst* argv, ListenOptions* out) {
+    if (argc > 0 && JS_IsFunction(ctx, argv[argc - 1])) {
+        out->callback = argv[argc - 1];
+        argc--;
+    }
+
+    auto readString = [ctx](JSValueConst value, std::string* target) {
+        const char* str = JS_ToCString(ctx, value);
+        if (str) {
+            *target = str;
+            JS_FreeCString(ctx, str);
+        }
+    };
+
+    if (argc > 0 && JS_IsObject(argv[0])) {
+        JSValueConst options = argv[0];
+        JSValue value = JS_GetPropertyStr(ctx, options, "port");
+        if (JS_IsNumber(value)) {
+            JS_ToInt32(ctx, &out->port, value);
+        }
+        JS_FreeValue(ctx, value);
+
+        value = JS_GetPropertyStr(ctx, options, "host");
+        if (JS_IsString(value)) {
+            readString(value, &out->host);
+        }
+        JS_FreeValue(ctx, value);
+
+        value = JS_GetPropertyStr(ctx, options, "backlog");
+        if (JS_IsNumber(value)) {
+            JS_ToInt32(ctx, &out->backlog, value);
+        }
+        JS_FreeValue(ctx, value);
+
+        value = JS_GetPropertyStr(ctx, options, "reusePort");
+        out->reusePort = JS_ToBool(ctx, value) > 0;
+        JS_FreeValue(ctx, value);
+
+        value = JS_GetPropertyStr(ctx, options, "threads");
+        if (JS_IsNumber(value)) {
+            JS_ToInt32(ctx, &out->threads, value);
+        }
+        JS_FreeValue(ctx, value);
+    } else if (argc > 0) {
+        if (JS_ToInt32(ctx, &out->port, argv[0]) < 0) {
+            return false;
+        }
+        int next = 1;
+        if (argc > next && JS_IsString(argv[next])) {
+            readString(argv[next], &out->host);
+            next++;
+        }
+        if (argc > next && JS_IsNumber(argv[next])) {
+            JS_ToInt32(ctx, &out->backlog, argv[next]);
+        }
+    }
+
+    if (out->port < 0 || out->port > 65535) {
+        JS_ThrowRangeError(ctx, "Invalid port number");
+        return false;
+    }
+    if (out->threads < 1) {
+        JS_ThrowRangeError(ctx, "threads must be at least 1");
+        return false;
+    }
+    if (out->threads > 1) {
+        out->reusePort = true;
+    }
+    return true;
+}
+
+struct ServerShards::Shard {
+    // Owned by the shard, closed once its thread is done with it
+    int listenFd = -1;
+    EventLoop loop;
+    std::shared_ptr<const std::vector<uint8_t>> listener;
+    std::vector<InitModule> modules;
+    Serve serve;
+    EventLoop* mainLoop = nullptr;
+    // Set and called on the shard thread only
+    std::function<void()> stopServing;
+
+    ~Shard() {
+        if (listenFd >= 0) {
+            ::close(listenFd);
+        }
+    }
+};
+
+std::shared_ptr<ServerShards> ServerShards::start(JSContext* ctx, JSValueConst listener, std::vector<int> listenFds,
+                                                  std::vector<InitModule> modules, Serve serve) {
+    size_t size = 0;
+    uint8_t* bytecode = JS_WriteObject(ctx, &size, listener, JS_WRITE_OBJ_BYTECODE);
+    if (!bytecode) {
+        for (int fd : listenFds) {
+            ::close(fd);
+        }
+        JS_FreeValue(ctx, JS_GetException(ctx));
+        JS_ThrowTypeError(ctx, "Listener cannot be transferred to server threads");
+        return nullptr;
+    }
+    auto data = std::make_shared<const std::vector<uint8_t>>(bytecode, bytecode + size);
+    js_free(ctx, bytecode);
+
+    std::shared_ptr<ServerShards> group(new ServerShards());
+    EventLoop& mainLoop = EventLoop::getInstance();
+    for (int fd : listenFds) {
+        auto shard = std::make_shared<Shard>();
+        shard->listenFd = fd;
+        shard->listener = data;
+        shard->modules = modules;
+        shard->serve = serve;
+        shard->mainLoop = &mainLoop;
+        group->shards.push_back(shard);
+
+        // Released by the thread as its last step
+        mainLoop.ref();
+        // The thread holds the shard until it is done; nobody joins it, so
+        // closing a server never waits for its connections
+        std::thread(runShard, shard).detach();
+    }
+    return group;
+}
+
+ServerShards::~ServerShards() {
+    stop();
+}
+
+void ServerShards::stop() {
+    if (stopped) {
+        return;
+    }
+    stopped = true;
+    for (auto& shard : shards) {
+        // Wakes a shard blocked in accept(); the fd stays open until the shard is gone
+        shutdown(shard->listenFd, SHUT_RD);
+        // Runs on the shard thread, which keeps the shard alive while its loop runs
+        Shard* target = shard.get();
+        shard->loop.enqueueCallback([target]() {
+            if (target->stopServing) {
+                auto stopServing = std::move(target->stopServing);
+                target->stopServing = nullptr;
+                stopServing();
+            }
+        });
+    }
+}
+
+void ServerShards::runShard(std::shared_ptr<Shard> shard) {
+    EventLoop::bindThread(&shard->loop);
+
+    JSRuntime* rt = JS_NewRuntime();
+    JSContext* ctx = rt ? JS_NewContext(rt) : nullptr;
+    if (ctx) {
+        {
+            std::lock_guard<std::mutex> lock(moduleInitMutex);
+            for (InitModule init : shard->modules) {
+                init(ctx);
+            }
+        }
+
+        shard->loop.setMicrotaskRunner([rt](size_t budget) {
+            size_t executed = 0;
+            while (executed < budget) {
+                JSContext* jobCtx = nullptr;
+                int ret = JS_ExecutePendingJob(rt, &jobCtx);
+                if (ret == 0) {
+                    break;
+                }
+                executed++;
+                if (ret < 0 && jobCtx) {
+                    reportException(jobCtx, "microtask");
+                }
+            }
+            return executed;
+        });
+
+        JSValue listener = JS_ReadObject(ctx, shard->listener->data(), shard->listener->size(), JS_READ_OBJ_BYTECODE);
+        if (JS_IsException(listener)) {
+            reportException(ctx, "server thread");
+        } else {
+            shard->stopServing = shard->serve(ctx, shard->listenFd, listener);
+            JS_FreeValue(ctx, listener);
+            // Returns once the listener is closed and every connection has ended
+            shard->loop.run();
+        }
+
+        shard->stopServing = nullptr;
+        shard->loop.clearTimers();
+        shard->loop.setMicrotaskRunner(nullptr);
+        JS_FreeContext(ctx);
+    } else {
+        std::cerr << "Failed to create server thread runtime" << std::endl;
+    }
+    if (rt) {
+        JS_FreeRuntime(rt);
+    }
+
+    EventLoop::bindThread(nullptr);
+    shard->mainLoop->unref();
+}
+
+} // namespace protojs
@@ -0,0 +1,98 @@
+#ifndef PROTOJS_SERVERSHARDS_H
+#define PROTOJS_SERVERSHARDS_H
+
+#include "quickjs.h"
+#include <functional>
+#include <string>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace protojs {
+
+class EventLoop;
+
+/**
+ * @brief Arguments of server.listen() shared by net and http:
+ *        listen(port[, host][, backlog][, callback]) or listen(options[, callback]),
+ *        with options {port, host, backlog, reusePort, threads}.
+ */
+struct ListenOptions {
+    int port = 0;
+    std::string host = "0.0.0.0";
+    /** 0 selects ListenSocket::DEFAULT_BACKLOG; clamped to somaxconn. */
+    int backlog = 0;
+    /** Bind with SO_REUSEPORT; implied by threads > 1. */
+    bool reusePort = false;
+    /** Listeners, each served by its own thread (1 = the main loop). */
+    int threads = 1;
+    /** Trailing function argument, or JS_UNDEFINED (borrowed). */
+    JSValueConst callback = JS_UNDEFINED;
+
+    /**
+     * @brief Parse the arguments of listen(); throws and returns false if
+     *        they are invalid.
+     */
+    static bool parse(JSContext* ctx, int argc, JSValueConst* argv, ListenOptions* out);
+};
+
+/**
+ * @brief Reactor threads serving SO_REUSEPORT listeners of one server.
+ *
+ * Each shard thread owns a listening socket, an EventLoop bound to the
+ * thread and an isolated QuickJS runtime and context, so connections accepted
+ * by different shards run JavaScript in parallel. The connection listener
+ * is transferred as bytecode, the way Deferred functions are: it runs
+ * without the closure it was created in and sees only the builtins installed
+ * in the shard context.
+ *
+ * The main loop is kept alive while any shard thread runs. stop() closes
+ * the listeners; each thread exits once its loop has no handles left, i.e.
+ * after its open connections end.
+ */
+class ServerShards {
+public:
+    using InitModule = void (*)(JSContext* ctx);
+
+    /**
+     * @brief Starts serving listenFd in the shard context; runs on the shard
+     *        thread. Returns a function that stops accepting (also run on the
+     *        shard thread), or nullptr if serving blocks the thread until the
+     *        listener is shut down.
+     */
+    using Serve = std::function<std::function<void()>(JSContext* ctx, int listenFd, JSValueConst listener)>;
+
+    /**
+     * @brief One shard per fd in listenFds, which are adopted. Throws a JS
+     *        exception and returns nullptr if the listener cannot be
+     *        transferred; the fds are closed in that case.
+     */
+    static std::shared_ptr<ServerShards> start(JSContext* ctx, JSValueConst listener, std::vector<int> listenFds,
+                                               std::vector<InitModule> modules, Serve serve);
+
+    ~ServerShards();
+
+    ServerShards(const ServerShards&) = delete;
+    ServerShards& operator=(const ServerShards&) = delete;
+
+    /**
+     * @brief Stop accepting on every shard. Idempotent.
+     */
+    void stop();
+
+    size_t size() const { return shards.size(); }
+
+private:
+    struct Shard;
+
+    ServerShards() = default;
+
+    static void runShard(std::shared_ptr<Shard> shard);
+
+    std::vector<std::shared_ptr<Shard>> shards;
+    bool stopped = false;
+};
+
+} // namespace protojs
+
+#endif // PROTOJS_SERVERSHARDS_H
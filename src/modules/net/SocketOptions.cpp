@@ -0,0 +1,45 @@
+#include "SocketOptions.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+namespace protojs {
+
+bool SocketOptions::apply(int fd) const {
+    if (recvBufferSize > 0 && !setBufferSize(fd, SO_RCVBUF, recvBufferSize)) {
+        return false;
+    }
+    if (sendBufferSize > 0 && !setBufferSize(fd, SO_SNDBUF, sendBufferSize)) {
+        return false;
+    }
+    if (noDelay >= 0 && !setNoDelay(fd, noDelay != 0)) {
+        return false;
+    }
+    if (keepAlive >= 0 && !setKeepAlive(fd, keepAlive != 0, keepAliveInitialDelay)) {
+        return false;
+    }
+    return true;
+}
+
+bool SocketOptions::setNoDelay(int fd, bool enable) {
+    int value = enable ? 1 : 0;
+    return setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &value, sizeof(value)) == 0;
+}
+
+bool SocketOptions::setKeepAlive(int fd, bool enable, int initialDelay) {
+    int value = enable ? 1 : 0;
+    if (setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &value, sizeof(value)) < 0) {
+        return false;
+    }
+    if (enable && initialDelay > 0) {
+        int seconds = (initialDelay + 999) / 1000;
+        return setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &seconds, sizeof(seconds)) == 0;
+    }
+    return true;
+}
+
+bool SocketOptions::setBufferSize(int fd, int option, int bytes) {
+    return setsockopt(fd, SOL_SOCKET, option, &bytes, sizeof(bytes)) == 0;
+}
+
+} // namespace protojs
@@ -0,0 +1,47 @@
+#ifndef PROTOJS_SOCKETOPTIONS_H
+#define PROTOJS_SOCKETOPTIONS_H
+
+namespace protojs {
+
+/**
+ * @brief TCP options of a connection, kept until its socket exists.
+ *
+ * Options left unset keep the kernel defaults. apply() is called when a
+ * socket is created or accepted, and the setters of a live socket apply a
+ * single option at once.
+ */
+struct SocketOptions {
+    /** TCP_NODELAY: 1 disables Nagle's algorithm; -1 leaves it unset. */
+    int noDelay = -1;
+    /** SO_KEEPALIVE: 1 or 0; -1 leaves it unset. */
+    int keepAlive = -1;
+    /** Idle time before the first keepalive probe in ms; 0 keeps the kernel default. */
+    int keepAliveInitialDelay = 0;
+    /** SO_RCVBUF and SO_SNDBUF in bytes; 0 keeps the kernel default. */
+    int recvBufferSize = 0;
+    int sendBufferSize = 0;
+
+    /**
+     * @brief Apply every option that is set. Returns false with errno set
+     *        by the first one that fails.
+     */
+    bool apply(int fd) const;
+
+    static bool setNoDelay(int fd, bool enable);
+
+    /**
+     * @brief Enable or disable keepalive; initialDelay (ms, rounded up to
+     *        whole seconds) sets TCP_KEEPIDLE when enabling.
+     */
+    static bool setKeepAlive(int fd, bool enable, int initialDelay);
+
+    /**
+     * @brief Set SO_RCVBUF or SO_SNDBUF. Linux doubles the value to leave
+     *        room for bookkeeping and clamps it to net.core.[rw]mem_max.
+     */
+    static bool setBufferSize(int fd, int option, int bytes);
+};
+
+} // namespace protojs
+
+#endif // PROTOJS_SOCKETOPTIONS_H
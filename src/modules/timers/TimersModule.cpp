@@ -0,0 +1,273 @@
+#include "TimersModule.h"
+#include "../../EventLoop.h"
+#include <memory>
+#include <unordered_set>
+#include <vector>
+#include <iostream>
+
+namespace protojs {
+
+static JSClassID timeout_class_id;
+
+// Delays outside [1, TIMEOUT_MAX] are treated as 1 ms, as in Node.js
+static const double TIMEOUT_MAX = 2147483647.0;
+
+struct TimerData {
+    JSContext* ctx;
+    JSValue callback;
+    std::vector<JSValue> args;
+    TimerWheel::TimerId id;
+    uint64_t delay;
+    bool repeat;
+    bool ref;
+
+    TimerData(JSContext* c) : ctx(c), callback(JS_UNDEFINED), id(0), delay(1), repeat(false), ref(true) {}
+    ~TimerData() {
+        JSRuntime* rt = JS_GetRuntime(ctx);
+        JS_FreeValueRT(rt, callback);
+        for (JSValue arg : args) {
+            JS_FreeValueRT(rt, arg);
+        }
+    }
+};
+
+// Shared by the Timeout object and the pending wheel entry
+using TimerHandle = std::shared_ptr<TimerData>;
+
+// Wheel ids of pending JS timers on this thread's loop. The wheel is shared
+// with native users (e.g. HTTP header timeouts), so clearTimeout(id) must
+// not cancel an id that setTimeout/setInterval did not hand out.
+static thread_local std::unordered_set<TimerWheel::TimerId> jsTimerIds;
+
+static void cancelTimer(const TimerHandle& timer) {
+    EventLoop::getInstance().getTimers().cancel(timer->id);
+    jsTimerIds.erase(timer->id);
+}
+
+static void reportException(JSContext* ctx, const char* where) {
+    JSValue exception = JS_GetException(ctx);
+    const char* str = JS_ToCString(ctx, exception);
+    if (str) {
+        std::cerr << "Uncaught exception in " << where << ": " << str << std::endl;
+        JS_FreeCString(ctx, str);
+    }
+    JS_FreeValue(ctx, exception);
+}
+
+static void invokeTimer(const TimerHandle& timer, const char* where) {
+    JSContext* ctx = timer->ctx;
+    JSValue result = JS_Call(ctx, timer->callback, JS_UNDEFINED,
+                             static_cast<int>(timer->args.size()), timer->args.data());
+    if (JS_IsException(result)) {
+        reportException(ctx, where);
+    }
+    JS_FreeValue(ctx, result);
+
+    // Promise continuations scheduled by this callback run before the next timer
+    EventLoop::getInstance().runMicrotasks();
+}
+
+// Schedule (or reschedule after it fired) the wheel entry for a timer
+static void armTimer(const TimerHandle& timer) {
+    TimerWheel& wheel = EventLoop::getInstance().getTimers();
+    const char* where = timer->repeat ? "setInterval callback" : "setTimeout callback";
+    jsTimerIds.erase(timer->id);
+    timer->id = wheel.schedule(EventLoop::nowMs(), timer->delay, [timer, where]() {
+        if (!timer->repeat) {
+            jsTimerIds.erase(timer->id);
+        }
+        invokeTimer(timer, where);
+    }, timer->repeat ? timer->delay : 0);
+    jsTimerIds.insert(timer->id);
+    if (!timer->ref) {
+        wheel.setRef(timer->id, false);
+    }
+}
+
+static TimerHandle getTimer(JSValueConst val) {
+    TimerHandle* handle = static_cast<TimerHandle*>(JS_GetOpaque(val, timeout_class_id));
+    return handle ? *handle : nullptr;
+}
+
+void TimersModule::init(JSContext* ctx) {
+    JS_NewClassID(&timeout_class_id);
+    JSClassDef classDef = {"Timeout", TimeoutFinalizer};
+    JS_NewClass(JS_GetRuntime(ctx), timeout_class_id, &classDef);
+
+    JSValue proto = JS_NewObject(ctx);
+    JS_SetPropertyStr(ctx, proto, "ref", JS_NewCFunction(ctx, timeoutRef, "ref", 0));
+    JS_SetPropertyStr(ctx, proto, "unref", JS_NewCFunction(ctx, timeoutUnref, "unref", 0));
+    JS_SetPropertyStr(ctx, proto, "hasRef", JS_NewCFunction(ctx, timeoutHasRef, "hasRef", 0));
+    JS_SetPropertyStr(ctx, proto, "refresh", JS_NewCFunction(ctx, timeoutRefresh, "refresh", 0));
+    JS_SetPropertyStr(ctx, proto, "close", JS_NewCFunction(ctx, timeoutClose, "close", 0));
+
+    // Timeout objects coerce to their numeric id so clearTimeout(+t) works
+    JSValue global_obj = JS_GetGlobalObject(ctx);
+    JSValue symbolCtor = JS_GetPropertyStr(ctx, global_obj, "Symbol");
+    JSValue toPrimitive = JS_GetPropertyStr(ctx, symbolCtor, "toPrimitive");
+    JSAtom toPrimitiveAtom = JS_ValueToAtom(ctx, toPrimitive);
+    JS_SetProperty(ctx, proto, toPrimitiveAtom,
+                   JS_NewCFunction(ctx, timeoutToPrimitive, "[Symbol.toPrimitive]", 1));
+    JS_FreeAtom(ctx, toPrimitiveAtom);
+    JS_FreeValue(ctx, toPrimitive);
+    JS_FreeValue(ctx, symbolCtor);
+
+    JS_SetClassProto(ctx, timeout_class_id, proto);
+
+    JSValue timersModule = JS_NewObject(ctx);
+    struct Entry {
+        const char* name;
+        JSCFunction* func;
+        int length;
+    };
+    const Entry entries[] = {
+        {"setTimeout", setTimeout, 2},
+        {"clearTimeout", clearTimer, 1},
+        {"setInterval", setInterval, 2},
+        {"clearInterval", clearTimer, 1},
+        {"setImmediate", setImmediate, 1},
+        {"clearImmediate", clearImmediate, 1},
+    };
+    for (const Entry& entry : entries) {
+        JS_SetPropertyStr(ctx, timersModule, entry.name, JS_NewCFunction(ctx, entry.func, entry.name, entry.length));
+        JS_SetPropertyStr(ctx, global_obj, entry.name, JS_NewCFunction(ctx, entry.func, entry.name, entry.length));
+    }
+
+    JS_SetPropertyStr(ctx, global_obj, "timers", timersModule);
+    JS_FreeValue(ctx, global_obj);
+}
+
+JSValue TimersModule::createTimer(JSContext* ctx, int argc, JSValueConst* argv, bool repeat) {
+    if (argc < 1 || !JS_IsFunction(ctx, argv[0])) {
+        return JS_ThrowTypeError(ctx, "The \"callback\" argument must be of type function");
+    }
+
+    double delay = 1;
+    if (argc > 1 && !JS_IsUndefined(argv[1])) {
+        if (JS_ToFloat64(ctx, &delay, argv[1]) < 0) {
+            return JS_EXCEPTION;
+        }
+    }
+    if (!(delay >= 1 && delay <= TIMEOUT_MAX)) {
+        delay = 1;
+    }
+
+    JSValue obj = JS_NewObjectClass(ctx, timeout_class_id);
+    if (JS_IsException(obj)) return obj;
+
+    auto timer = std::make_shared<TimerData>(ctx);
+    timer->callback = JS_DupValue(ctx, argv[0]);
+    for (int i = 2; i < argc; i++) {
+        timer->args.push_back(JS_DupValue(ctx, argv[i]));
+    }
+    timer->delay = static_cast<uint64_t>(delay);
+    timer->repeat = repeat;
+
+    armTimer(timer);
+    JS_SetOpaque(obj, new TimerHandle(timer));
+    return obj;
+}
+
+JSValue TimersModule::setTimeout(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    return createTimer(ctx, argc, argv, false);
+}
+
+JSValue TimersModule::setInterval(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    return createTimer(ctx, argc, argv, true);
+}
+
+JSValue TimersModule::clearTimer(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    if (argc < 1) {
+        return JS_UNDEFINED;
+    }
+
+    if (TimerHandle timer = getTimer(argv[0])) {
+        cancelTimer(timer);
+    } else if (JS_IsNumber(argv[0])) {
+        double id;
+        if (JS_ToFloat64(ctx, &id, argv[0]) == 0 && id >= 1 &&
+            jsTimerIds.erase(static_cast<TimerWheel::TimerId>(id))) {
+            EventLoop::getInstance().getTimers().cancel(static_cast<TimerWheel::TimerId>(id));
+        }
+    }
+    return JS_UNDEFINED;
+}
+
+JSValue TimersModule::setImmediate(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    if (argc < 1 || !JS_IsFunction(ctx, argv[0])) {
+        return JS_ThrowTypeError(ctx, "The \"callback\" argument must be of type function");
+    }
+
+    auto immediate = std::make_shared<TimerData>(ctx);
+    immediate->callback = JS_DupValue(ctx, argv[0]);
+    for (int i = 1; i < argc; i++) {
+        immediate->args.push_back(JS_DupValue(ctx, argv[i]));
+    }
+
+    uint64_t id = EventLoop::getInstance().setImmediate([immediate]() {
+        invokeTimer(immediate, "setImmediate callback");
+    });
+    return JS_NewFloat64(ctx, static_cast<double>(id));
+}
+
+JSValue TimersModule::clearImmediate(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    double id;
+    if (argc > 0 && JS_IsNumber(argv[0]) && JS_ToFloat64(ctx, &id, argv[0]) == 0 && id >= 1) {
+        EventLoop::getInstance().clearImmediate(static_cast<uint64_t>(id));
+    }
+    return JS_UNDEFINED;
+}
+
+JSValue TimersModule::timeoutRef(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    if (TimerHandle timer = getTimer(this_val)) {
+        timer->ref = true;
+        EventLoop::getInstance().getTimers().setRef(timer->id, true);
+    }
+    return JS_DupValue(ctx, this_val);
+}
+
+JSValue TimersModule::timeoutUnref(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    if (TimerHandle timer = getTimer(this_val)) {
+        timer->ref = false;
+        EventLoop::getInstance().getTimers().setRef(timer->id, false);
+    }
+    return JS_DupValue(ctx, this_val);
+}
+
+JSValue TimersModule::timeoutHasRef(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    TimerHandle timer = getTimer(this_val);
+    return JS_NewBool(ctx, timer && timer->ref);
+}
+
+JSValue TimersModule::timeoutRefresh(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    TimerHandle timer = getTimer(this_val);
+    if (!timer) {
+        return JS_ThrowTypeError(ctx, "Invalid Timeout object");
+    }
+
+    // A timeout that already fired is re-armed, as in Node.js
+    TimerWheel& wheel = EventLoop::getInstance().getTimers();
+    if (!wheel.refresh(timer->id, EventLoop::nowMs())) {
+        armTimer(timer);
+    }
+    return JS_DupValue(ctx, this_val);
+}
+
+JSValue TimersModule::timeoutClose(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    if (TimerHandle timer = getTimer(this_val)) {
+        cancelTimer(timer);
+    }
+    return JS_DupValue(ctx, this_val);
+}
+
+JSValue TimersModule::timeoutToPrimitive(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    TimerHandle timer = getTimer(this_val);
+    return JS_NewFloat64(ctx, timer ? static_cast<double>(timer->id) : 0);
+}
+
+void TimersModule::TimeoutFinalizer(JSRuntime* rt, JSValue val) {
+    TimerHandle* handle = static_cast<TimerHandle*>(JS_GetOpaque(val, timeout_class_id));
+    if (handle) delete handle;
+}
+
+} // namespace protojs
@@ -0,0 +1,40 @@
+#ifndef PROTOJS_TIMERSMODULE_H
+#define PROTOJS_TIMERSMODULE_H
+
+#include "quickjs.h"
+
+namespace protojs {
+
+/**
+ * @brief Timer globals backed by the EventLoop timer wheel.
+ *
+ * Installs setTimeout/clearTimeout, setInterval/clearInterval and
+ * setImmediate/clearImmediate. Timers return Timeout objects supporting
+ * ref(), unref(), hasRef(), refresh() and close().
+ */
+class TimersModule {
+public:
+    static void init(JSContext* ctx);
+
+private:
+    static JSValue setTimeout(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    static JSValue setInterval(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    static JSValue setImmediate(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    static JSValue clearTimer(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    static JSValue clearImmediate(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+
+    // Timeout methods
+    static JSValue timeoutRef(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    static JSValue timeoutUnref(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    static JSValue timeoutHasRef(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    static JSValue timeoutRefresh(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    static JSValue timeoutClose(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    static JSValue timeoutToPrimitive(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+    static void TimeoutFinalizer(JSRuntime* rt, JSValue val);
+
+    static JSValue createTimer(JSContext* ctx, int argc, JSValueConst* argv, bool repeat);
+};
+
+} // namespace protojs
+
+#endif // PROTOJS_TIMERSMODULE_H
@@ -19,5 +19,29 @@ for (let i = 0; i < iterations; i++) {
 
 console.timeEnd("protoJS: Array creation and operations");
 
+// Array -> protoCore conversion (TypeBridge::fromJS). isImmutable() converts
+// its argument and only inspects the result, so the time is the conversion.
+// Arrays above 10,000 elements are built as sparse lists; growth of the cost
+// per element with size shows the O(n log n) list building.
+if (typeof protoCore !== 'undefined') {
+    for (const length of [1000, 10000, 100000, 1000000]) {
+        const conversions = Math.max(1, Math.floor(2000000 / length));
+        const ints = Array.from({length}, (_, idx) => idx);
+        const doubles = ints.map(x => x + 0.5);
+        const mixed = ints.map(x => (x % 3 === 0 ? String(x) : x));
+
+        for (const [name, arr] of [["int", ints], ["double", doubles], ["mixed", mixed]]) {
+            const start = Date.now();
+            for (let i = 0; i < conversions; i++) {
+                protoCore.isImmutable(arr);
+            }
+            const elapsed = Date.now() - start;
+            const nsPerElement = (elapsed * 1e6) / (conversions * length);
+            console.log(`protoJS: ${name} array conversion, ${length} elements: ` +
+                        `${elapsed} ms for ${conversions} conversions (${nsPerElement.toFixed(1)} ns/element)`);
+        }
+    }
+}
+
 console.log("Note: Compare with Node.js for performance comparison");
 console.log("Expected: protoJS should be competitive or better for immutable operations");
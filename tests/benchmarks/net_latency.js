@@ -0,0 +1,65 @@
+// Benchmark: request/response latency over loopback, with and without TCP_NODELAY
+//
+// Each request is written as two small segments (header, then body) and the
+// server answers once both have arrived. With Nagle's algorithm the body waits
+// for the ACK of the header, which the server delays (~40 ms on Linux);
+// setNoDelay(true) sends it at once.
+
+console.log("=== Net Loopback Latency Benchmark ===");
+
+const ROUND_TRIPS = 50;
+const HEADER = "REQ:";
+const BODY = "ping";
+const REQUEST_BYTES = HEADER.length + BODY.length;
+
+function runRoundTrips(noDelay, done) {
+    const server = net.createServer({noDelay}, (socket) => {
+        let pending = 0;
+        socket._events.on('data', (data) => {
+            pending += data.byteLength;
+            while (pending >= REQUEST_BYTES) {
+                pending -= REQUEST_BYTES;
+                socket.write("pong");
+            }
+        });
+        socket._events.on('end', () => socket.end());
+    });
+
+    server.listen(0, '127.0.0.1', () => {
+        const client = net.createConnection({port: server.address().port, host: '127.0.0.1', noDelay});
+        let completed = 0;
+        let start = 0;
+
+        const sendRequest = () => {
+            client.write(HEADER);
+            client.write(BODY);
+        };
+
+        client._events.on('connect', () => {
+            start = Date.now();
+            sendRequest();
+        });
+        client._events.on('data', () => {
+            completed++;
+            if (completed < ROUND_TRIPS) {
+                sendRequest();
+                return;
+            }
+            const elapsed = Date.now() - start;
+            client.end();
+            client._events.on('end', () => {
+                client.destroy();
+                server.close();
+                done(elapsed);
+            });
+        });
+    });
+}
+
+runRoundTrips(false, (nagleMs) => {
+    runRoundTrips(true, (noDelayMs) => {
+        console.log(`Nagle (default):   ${ROUND_TRIPS} round trips in ${nagleMs} ms (${(nagleMs / ROUND_TRIPS).toFixed(2)} ms each)`);
+        console.log(`setNoDelay(true):  ${ROUND_TRIPS} round trips in ${noDelayMs} ms (${(noDelayMs / ROUND_TRIPS).toFixed(2)} ms each)`);
+        console.log("\nExpected: noDelay avoids the delayed-ACK stall of write-write-read exchanges");
+    });
+});
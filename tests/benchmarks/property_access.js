@@ -0,0 +1,36 @@
+// Benchmark: property reads on protoCore-backed objects vs plain objects
+// Bridged reads go through ExecutionEngine's inline caches
+
+console.log("=== Property Access Benchmark ===");
+
+const iterations = 1000000;
+
+const plain = {x: 1, y: 2, label: "point"};
+console.time("protoJS: plain object property loop");
+let plainSum = 0;
+for (let i = 0; i < iterations; i++) {
+    plainSum += plain.x + plain.y;
+}
+console.timeEnd("protoJS: plain object property loop");
+
+if (typeof protoCore !== 'undefined' && typeof protoCore.BridgedObject === 'function') {
+    const bridged = protoCore.BridgedObject({x: 1, y: 2, label: "point"});
+
+    console.time("protoJS: bridged object property loop");
+    let bridgedSum = 0;
+    for (let i = 0; i < iterations; i++) {
+        bridgedSum += bridged.x + bridged.y;
+    }
+    console.timeEnd("protoJS: bridged object property loop");
+
+    // A write only replaces the cached entries of its own property: the
+    // read of x is served by the write, the read of y keeps hitting
+    console.time("protoJS: bridged object read/write loop");
+    for (let i = 0; i < iterations / 10; i++) {
+        bridged.x = i;
+        bridgedSum += bridged.x + bridged.y;
+    }
+    console.timeEnd("protoJS: bridged object read/write loop");
+
+    console.log("Results match:", plainSum === iterations * 3, bridged.label === "point", "y" in bridged);
+}
@@ -0,0 +1,34 @@
+// ArrayBuffers sharing storage with protoCore byte buffers
+
+console.log("=== ProtoByteBuffer Sharing Tests ===");
+
+function check(name, ok, detail) {
+    if (ok) {
+        console.log(`✅ ${name} - PASS`);
+    } else {
+        console.log(`❌ ${name} - FAIL:`, detail);
+    }
+}
+
+if (typeof protoCore !== 'undefined' && protoCore.ByteBuffer) {
+    const buffer = protoCore.ByteBuffer(16);
+    const bytes = new Uint8Array(buffer);
+    bytes[0] = 42;
+    check("Allocated", buffer instanceof ArrayBuffer && buffer.byteLength === 16, buffer);
+
+    // Round trip through protoCore shares the same storage
+    const [back] = protoCore.Tuple([buffer]);
+    const backBytes = back instanceof ArrayBuffer ? new Uint8Array(back) : null;
+    check("Round trip sees writes", backBytes !== null && backBytes[0] === 42, back);
+    bytes[1] = 7;
+    check("Storage is shared", backBytes !== null && backBytes[1] === 7, backBytes);
+
+    // Plain ArrayBuffers are copied into protoCore and left untouched
+    const plain = new Uint8Array([1, 2, 3]);
+    protoCore.Tuple([plain.buffer]);
+    check("Plain buffer converted", plain.buffer.byteLength === 3 && plain[2] === 3, plain);
+} else {
+    console.log("❌ protoCore.ByteBuffer not available - FAIL");
+}
+
+console.log("=== ProtoByteBuffer Sharing Tests Complete ===");
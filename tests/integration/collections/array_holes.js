@@ -0,0 +1,66 @@
+// Explicit undefined elements, holes and throwing reads through the protoCore bridge
+
+console.log("=== Array Hole Tests ===");
+
+function check(name, ok, detail) {
+    if (ok) {
+        console.log(`✅ ${name} - PASS`);
+    } else {
+        console.log(`❌ ${name} - FAIL:`, detail);
+    }
+}
+
+if (typeof protoCore !== 'undefined') {
+    // undefined is a value: the array stays dense and comes back as an array
+    const dense = protoCore.ImmutableObject([1, undefined, 3]);
+    check("Explicit undefined keeps the array dense",
+          Array.isArray(dense) && dense.length === 3 && dense[0] === 1 && dense[2] === 3,
+          dense);
+
+    // A real hole makes the array sparse, which does not come back as an array
+    const holey = protoCore.ImmutableObject([1, , 3]);
+    check("A hole converts differently from undefined", !Array.isArray(holey), holey);
+
+    // A throwing element getter propagates instead of being read as undefined
+    const guarded = [1, 2, 3];
+    Object.defineProperty(guarded, 1, { get() { throw new Error("element getter"); } });
+    let elementError = null;
+    try {
+        protoCore.ImmutableObject(guarded);
+    } catch (e) {
+        elementError = e;
+    }
+    check("Throwing element getter propagates",
+          elementError && elementError.message === "element getter", elementError);
+
+    // So does a Proxy trap
+    const trapped = new Proxy([1, 2, 3], {
+        get(target, key) {
+            if (key === "1") {
+                throw new Error("proxy trap");
+            }
+            return Reflect.get(target, key);
+        }
+    });
+    let trapError = null;
+    try {
+        protoCore.ImmutableObject(trapped);
+    } catch (e) {
+        trapError = e;
+    }
+    check("Throwing Proxy trap propagates", trapError && trapError.message === "proxy trap", trapError);
+
+    // And a throwing property getter nested inside an object
+    let nestedError = null;
+    try {
+        protoCore.ImmutableObject({ inner: { get value() { throw new Error("property getter"); } } });
+    } catch (e) {
+        nestedError = e;
+    }
+    check("Throwing property getter propagates",
+          nestedError && nestedError.message === "property getter", nestedError);
+} else {
+    console.log("❌ protoCore not available - FAIL");
+}
+
+console.log("=== Array Hole Tests Complete ===");
@@ -0,0 +1,58 @@
+// Shared and cyclic object graphs through the protoCore bridge
+
+console.log("=== Shared Conversion Tests ===");
+
+function check(name, ok, detail) {
+    if (ok) {
+        console.log(`✅ ${name} - PASS`);
+    } else {
+        console.log(`❌ ${name} - FAIL:`, detail);
+    }
+}
+
+if (typeof protoCore !== 'undefined') {
+    // A sub-object referenced twice is converted once
+    const shared = {name: "shared", tags: ["a", "b"]};
+    const tree = {left: shared, right: shared};
+    const converted = protoCore.ImmutableObject(tree);
+    check("Shared tree converted",
+          converted && converted.left && converted.left.name === "shared" && converted.left.tags[1] === "b",
+          converted);
+    check("Shared sub-object keeps its identity", converted && converted.left === converted.right, converted);
+
+    // Cycles terminate instead of recursing forever
+    const cyclic = {name: "root"};
+    cyclic.self = cyclic;
+    const list = [cyclic];
+    cyclic.list = list;
+    const root = protoCore.ImmutableObject(cyclic);
+    check("Cyclic graph converted", root && root.name === "root" && root.self === root, root);
+
+    // Frozen structures can be kept across calls
+    protoCore.setConversionCacheSize(16);
+    const catalog = Object.freeze({
+        items: Object.freeze(Array.from({length: 1000}, (_, i) => i)),
+        meta: Object.freeze({version: 1})
+    });
+
+    console.time("first frozen conversion");
+    const first = protoCore.ImmutableObject(catalog);
+    console.timeEnd("first frozen conversion");
+
+    console.time("cached frozen conversion");
+    let cached = null;
+    for (let i = 0; i < 100; i++) {
+        cached = protoCore.ImmutableObject(catalog);
+    }
+    console.timeEnd("cached frozen conversion");
+
+    const matches = (value) => value && value.items && value.items.length === 1000 &&
+                               value.items[999] === 999 && value.meta.version === 1;
+    check("Cached frozen conversion matches the first", matches(first) && matches(cached), cached);
+
+    protoCore.setConversionCacheSize(0);
+} else {
+    console.log("❌ protoCore not available - FAIL");
+}
+
+console.log("=== Shared Conversion Tests Complete ===");
@@ -0,0 +1,52 @@
+// Deferred cancellation, priority and deadline test
+
+console.log("=== Deferred Cancellation Tests ===");
+
+function check(name, ok, detail) {
+    if (ok) {
+        console.log(`✅ ${name} - PASS`);
+    } else {
+        console.log(`❌ ${name} - FAIL:`, detail);
+    }
+}
+
+if (typeof Deferred !== 'undefined' && typeof Deferred.options === 'function') {
+    const d = new Deferred(() => {
+        let sum = 0;
+        for (let i = 0; i < 1e8; i++) {
+            sum += i;
+        }
+        return sum;
+    });
+    const first = d.cancel();
+    const second = d.cancel();
+    check("cancel() settles once", first === true && second === false, [first, second]);
+    d.then((value) => {
+        check("Cancelled deferred rejects", false, value);
+    }, (e) => {
+        check("Cancelled deferred rejects", e.message === "Deferred cancelled", e);
+    });
+
+    new Deferred((x) => x + 1, 41, Deferred.options({ priority: 'high' })).then((value) => {
+        check("High priority deferred", value === 42, value);
+    }, (e) => check("High priority deferred", false, e));
+
+    // Whether the deadline passes before a worker starts depends on timing
+    new Deferred((x) => x + 1, 41, Deferred.options({ priority: 'low', deadline: 1 })).then((value) => {
+        check("Low priority deferred with deadline", value === 42, value);
+    }, (e) => {
+        check("Low priority deferred with deadline", e.message === "Deferred deadline exceeded", e);
+    });
+
+    let rejected = false;
+    try {
+        Deferred.options({ priority: 'urgent' });
+    } catch (e) {
+        rejected = true;
+    }
+    check("Invalid priority rejected", rejected, "accepted");
+} else {
+    console.log("❌ Deferred.options not available - FAIL");
+}
+
+console.log("=== Deferred Cancellation Tests Complete ===");
@@ -0,0 +1,43 @@
+// Deferred arguments and Deferred.map test
+
+console.log("=== Deferred.map Tests ===");
+
+function check(name, ok, detail) {
+    if (ok) {
+        console.log(`✅ ${name} - PASS`);
+    } else {
+        console.log(`❌ ${name} - FAIL:`, detail);
+    }
+}
+
+if (typeof Deferred !== 'undefined' && typeof Deferred.map === 'function') {
+    new Deferred((a, b) => a * b, 6, 7).then((product) => {
+        check("Deferred with arguments", product === 42, product);
+    }, (e) => check("Deferred with arguments", false, e));
+
+    const input = [];
+    for (let i = 0; i < 100; i++) {
+        input.push(i);
+    }
+
+    Deferred.map(input, (x, index) => x * x + index, { chunkSize: 8 }).then((results) => {
+        let ordered = results.length === input.length;
+        for (let i = 0; ordered && i < input.length; i++) {
+            ordered = results[i] === i * i + i;
+        }
+        check("Deferred.map ordered results", ordered, results);
+    }, (e) => check("Deferred.map ordered results", false, e));
+
+    Deferred.map([1, 2, 3], (x) => {
+        if (x === 2) throw new Error("bad element");
+        return x;
+    }).then((results) => {
+        check("Deferred.map rejects on element error", false, results);
+    }, (error) => {
+        check("Deferred.map rejects on element error", String(error.message).includes("bad element"), error);
+    });
+} else {
+    console.log("❌ Deferred.map not available - FAIL");
+}
+
+console.log("=== Deferred.map Tests Complete ===");
@@ -0,0 +1,43 @@
+// Deferred promise integration test
+
+console.log("=== Deferred Promise Tests ===");
+
+function check(name, ok, detail) {
+    if (ok) {
+        console.log(`✅ ${name} - PASS`);
+    } else {
+        console.log(`❌ ${name} - FAIL:`, detail);
+    }
+}
+
+if (typeof Deferred !== 'undefined') {
+    const d = new Deferred((a, b) => a + b, 20, 22);
+    check("Deferred is a Promise", d instanceof Promise && d instanceof Deferred, d);
+
+    (async () => {
+        const value = await d;
+        check("Awaited result", value === 42, value);
+
+        const results = await Promise.all([
+            new Deferred(() => 1),
+            new Deferred(() => 2),
+            new Deferred(() => 3),
+        ]);
+        check("Promise.all results", results.join(',') === "1,2,3", results);
+
+        const chained = await new Deferred(() => 10).then((x) => x * 2).then((x) => x + 1);
+        check("Chained result", chained === 21, chained);
+
+        let message = null;
+        try {
+            await new Deferred(() => { throw new Error("worker failure"); });
+        } catch (e) {
+            message = String(e.message);
+        }
+        check("Worker error rejects", message !== null && message.includes("worker failure"), message);
+    })().catch((e) => console.log("❌ Deferred promise tests - FAIL:", e));
+} else {
+    console.log("❌ Deferred not available - FAIL");
+}
+
+console.log("=== Deferred Promise Tests Complete ===");
@@ -0,0 +1,64 @@
+// Repeated Deferred dispatch test
+// The same function literal is dispatched many times; its closures share one
+// cached bytecode, deserialized once per worker. Dispatching the same function
+// object again does not serialize it again.
+
+console.log("=== Repeated Deferred Tests ===");
+
+if (typeof Deferred !== 'undefined') {
+    const COUNT = 1000;
+    let created = 0;
+
+    const start = Date.now();
+    for (let i = 0; i < COUNT; i++) {
+        new Deferred(() => {
+            let sum = 0;
+            for (let j = 0; j < 100; j++) {
+                sum += j;
+            }
+            return sum;
+        });
+        created++;
+    }
+    const elapsed = Date.now() - start;
+
+    console.log(`Dispatched ${created} deferreds in ${elapsed} ms`);
+    if (created !== COUNT) {
+        throw new Error(`Expected ${COUNT} deferreds, created ${created}`);
+    }
+
+    // Functions whose toString lies must not share cached bytecode
+    const one = () => 1;
+    const two = () => 2;
+    one.toString = two.toString = () => "same";
+    Promise.all([new Deferred(one), new Deferred(two)]).then(([a, b]) => {
+        if (a === 1 && b === 2) {
+            console.log("✅ Overridden toString does not alias bytecode - PASS");
+        } else {
+            console.log("❌ Overridden toString does not alias bytecode - FAIL:", a, b);
+        }
+    }, (e) => {
+        console.log("❌ Overridden toString does not alias bytecode - FAIL:", e);
+    });
+
+    // The second dispatch of a function object finds it by identity
+    const answer = () => 42;
+    const before = Deferred.stats().functionsSerialized;
+    const first = new Deferred(answer);
+    const afterFirst = Deferred.stats().functionsSerialized;
+    const second = new Deferred(answer);
+    const afterSecond = Deferred.stats().functionsSerialized;
+    Promise.all([first, second]).then(([a, b]) => {
+        if (afterFirst === before + 1 && afterSecond === afterFirst && a === 42 && b === 42) {
+            console.log("✅ Repeat dispatch skips serialization - PASS");
+        } else {
+            console.log("❌ Repeat dispatch skips serialization - FAIL:", before, afterFirst, afterSecond, a, b);
+        }
+    }, (e) => {
+        console.log("❌ Repeat dispatch skips serialization - FAIL:", e);
+    });
+} else {
+    console.log("Deferred not available");
+}
+
+console.log("=== Repeated Deferred Tests Complete ===");
@@ -0,0 +1,33 @@
+// Transferable ArrayBuffer test
+
+console.log("=== Deferred Transfer Tests ===");
+
+function check(name, ok, detail) {
+    if (ok) {
+        console.log(`✅ ${name} - PASS`);
+    } else {
+        console.log(`❌ ${name} - FAIL:`, detail);
+    }
+}
+
+if (typeof Deferred !== 'undefined' && typeof Deferred.transfer === 'function') {
+    const buffer = new ArrayBuffer(1024 * 1024);
+    new Uint8Array(buffer)[0] = 7;
+
+    new Deferred((buf) => {
+        const bytes = new Uint8Array(buf);
+        bytes[1] = bytes[0] + 1;
+        return buf;
+    }, Deferred.transfer(buffer)).then((result) => {
+        const bytes = result instanceof ArrayBuffer ? new Uint8Array(result) : null;
+        check("Worker sees transferred bytes",
+              bytes !== null && result.byteLength === 1024 * 1024 && bytes[0] === 7 && bytes[1] === 8,
+              result);
+    }, (e) => check("Worker sees transferred bytes", false, e));
+
+    check("ArrayBuffer detached after transfer", buffer.byteLength === 0, buffer.byteLength);
+} else {
+    console.log("❌ Deferred.transfer not available - FAIL");
+}
+
+console.log("=== Deferred Transfer Tests Complete ===");
@@ -0,0 +1,31 @@
+// Completions delivered from pool and reader threads must keep the loop alive.
+// No timers are armed here: a missing PASS line means run() exited early.
+
+console.log("=== Loop Handle Tests ===");
+
+if (typeof dns !== 'undefined') {
+    dns.lookup("localhost", (err, address) => {
+        if (!err && address) {
+            console.log("✅ dns.lookup callback delivered - PASS");
+        } else {
+            console.log("❌ dns.lookup callback delivered - FAIL:", err);
+        }
+    });
+} else {
+    console.log("❌ dns module not available - FAIL");
+}
+
+if (typeof child_process !== 'undefined') {
+    const child = child_process.spawn("true", []);
+    child.emit = (event, code) => {
+        if (event === "exit") {
+            if (code === 0) {
+                console.log("✅ child_process exit delivered - PASS");
+            } else {
+                console.log("❌ child_process exit delivered - FAIL:", code);
+            }
+        }
+    };
+} else {
+    console.log("❌ child_process module not available - FAIL");
+}
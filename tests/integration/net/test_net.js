@@ -84,4 +84,178 @@ try {
     console.log("❌ Test 5: socket.address - FAIL:", e);
 }
 
+// Test 6: loopback echo through the reactor
+try {
+    const payload = "x".repeat(32000);
+    const server = net.createServer((socket) => {
+        // The payload is all "x", so echoing the length is echoing the bytes
+        socket._events.on('data', (chunk) => socket.write("x".repeat(chunk.byteLength)));
+        socket._events.on('end', () => socket.end());
+    });
+    server.listen(0, () => {
+        const client = net.createConnection({port: server.address().port, host: '127.0.0.1'});
+        let received = 0;
+        let events = 0;
+        client._events.on('connect', () => client.end(payload));
+        client._events.on('data', (chunk) => {
+            received += chunk.byteLength;
+            events++;
+        });
+        client._events.on('end', () => {
+            if (received === payload.length) {
+                console.log("✅ Test 6: loopback echo - PASS");
+                console.log("   Bytes:", received, "data events:", events);
+            } else {
+                console.log("❌ Test 6: loopback echo - FAIL: received", received);
+            }
+            client.destroy();
+            server.close();
+        });
+    });
+} catch (e) {
+    console.log("❌ Test 6: loopback echo - FAIL:", e);
+}
+
+// Test 7: write backpressure, drain and cork
+try {
+    const chunk = "y".repeat(64 * 1024);
+    const server = net.createServer((socket) => {
+        let received = 0;
+        socket._events.on('data', (data) => { received += data.byteLength; });
+        socket._events.on('end', () => {
+            console.log("   Server received:", received);
+            socket.destroy();
+            server.close();
+        });
+    });
+    server.listen(0, () => {
+        const client = net.createConnection({port: server.address().port, host: '127.0.0.1', highWaterMark: 1024});
+        client._events.on('connect', () => {
+            client.cork();
+            client.write("a");
+            client.write("b");
+            const corked = client.bufferSize;
+            client.uncork();
+            // The server cannot read while this loop runs, so the kernel buffers fill up
+            let accepted = client.write(chunk);
+            while (accepted) {
+                accepted = client.write(chunk);
+            }
+            client._events.on('drain', () => {
+                if (!accepted && corked === 2 && client.bufferSize === 0) {
+                    console.log("✅ Test 7: write backpressure - PASS");
+                } else {
+                    console.log("❌ Test 7: write backpressure - FAIL");
+                }
+                client.end();
+            });
+        });
+    });
+} catch (e) {
+    console.log("❌ Test 7: write backpressure - FAIL:", e);
+}
+
+// Test 8: server threads sharing one port through SO_REUSEPORT
+try {
+    const server = net.createServer((socket) => {
+        // Runs in a server thread: only builtins are in scope
+        socket._events.on('data', (data) => socket.end(data));
+    });
+    server.listen({port: 0, host: '127.0.0.1', threads: 4, backlog: 1024}, () => {
+        const port = server.address().port;
+        const total = 16;
+        let echoed = 0;
+        let ended = 0;
+        for (let i = 0; i < total; i++) {
+            const client = net.createConnection({port, host: '127.0.0.1'});
+            client._events.on('connect', () => client.write("ping"));
+            client._events.on('data', () => { echoed++; });
+            client._events.on('end', () => {
+                client.destroy();
+                if (++ended === total) {
+                    if (echoed === total) {
+                        console.log("✅ Test 8: server threads - PASS");
+                    } else {
+                        console.log("❌ Test 8: server threads - FAIL: echoed", echoed);
+                    }
+                    server.close();
+                }
+            });
+        }
+    });
+} catch (e) {
+    console.log("❌ Test 8: server threads - FAIL:", e);
+}
+
+// Test 9: socket options
+try {
+    // deferAccept: the server only sees the connection once the client writes
+    const server = net.createServer({noDelay: true, deferAccept: 1}, (socket) => {
+        socket._events.on('data', () => socket.end("ok"));
+    });
+    server.listen(0, '127.0.0.1', () => {
+        const client = net.createConnection({port: server.address().port, host: '127.0.0.1', noDelay: true, recvBufferSize: 65536});
+        const chained = client.setKeepAlive(true, 1000) === client && client.setNoDelay() === client &&
+            client.setSendBufferSize(32768) === client && client.setRecvBufferSize(65536) === client;
+        let rejected = false;
+        try {
+            client.setRecvBufferSize(0);
+        } catch (e) {
+            rejected = e instanceof RangeError;
+        }
+        let replyBytes = 0;
+        client._events.on('connect', () => client.write("hi"));
+        client._events.on('data', (data) => { replyBytes += data.byteLength; });
+        client._events.on('end', () => {
+            if (chained && rejected && replyBytes === 2) {
+                console.log("✅ Test 9: socket options - PASS");
+            } else {
+                console.log("❌ Test 9: socket options - FAIL");
+            }
+            client.destroy();
+            server.close();
+        });
+    });
+} catch (e) {
+    console.log("❌ Test 9: socket options - FAIL:", e);
+}
+
+// Test 10: binary payloads round-trip unchanged
+try {
+    const bytes = new Uint8Array(258);
+    for (let i = 0; i < bytes.length; i++) {
+        bytes[i] = i & 0xff;
+    }
+    // A view with an offset, so only the bytes in view are sent
+    const view = bytes.subarray(1, 257);
+    const tail = Buffer.from([0, 0xff, 0, 0x80]);
+    const expected = Array.from(view).concat([0, 0xff, 0, 0x80]);
+    const server = net.createServer((socket) => {
+        // Chunks arrive as ArrayBuffers and are written back as they are
+        socket._events.on('data', (chunk) => socket.write(chunk));
+        socket._events.on('end', () => socket.end());
+    });
+    server.listen(0, '127.0.0.1', () => {
+        const client = net.createConnection({port: server.address().port, host: '127.0.0.1'});
+        const received = [];
+        client._events.on('connect', () => {
+            client.write(view);
+            client.end(tail);
+        });
+        client._events.on('data', (chunk) => received.push(...new Uint8Array(chunk)));
+        client._events.on('end', () => {
+            const same = received.length === expected.length && received.every((b, i) => b === expected[i]);
+            if (same) {
+                console.log("✅ Test 10: binary round-trip - PASS");
+            } else {
+                console.log("❌ Test 10: binary round-trip - FAIL: received", received.length, "bytes");
+            }
+            client.destroy();
+            server.close();
+        });
+    });
+} catch (e) {
+    console.log("❌ Test 10: binary round-trip - FAIL:", e);
+}
+
 console.log("\n=== Net Module Tests Complete ===");
@@ -0,0 +1,35 @@
+// Incremental GCBridge root scanning from the event loop idle phase
+
+console.log("=== Bridge Scan Tests ===");
+
+function check(name, ok, detail) {
+    if (ok) {
+        console.log(`✅ ${name} - PASS`);
+    } else {
+        console.log(`❌ ${name} - FAIL:`, detail);
+    }
+}
+
+if (typeof memory !== 'undefined' && typeof memory.getBridgeStats === 'function') {
+    // Functions passed through protoCore are mapped by the bridge
+    const set = new protoCore.Set();
+    for (let i = 0; i < 10000; i++) {
+        set.add(() => i);
+    }
+
+    const before = memory.getBridgeStats();
+    check("New mappings start young", before.youngEntries > 0, before);
+
+    // Let the loop go idle a few times
+    setTimeout(() => {
+        const after = memory.getBridgeStats();
+        check("Idle slices run", after.slices > before.slices, after);
+        check("Minor cycles run", after.minorCycles > before.minorCycles, after);
+        // Survivors are promoted and unreferenced mappings released
+        check("Young entries aged", after.youngEntries < before.youngEntries, after);
+        console.log("   Max pause (us):", after.maxPauseUs);
+        console.log("   Mean pause (us):", after.slices ? (after.totalPauseUs / after.slices).toFixed(1) : 0);
+    }, 50);
+} else {
+    console.log("❌ memory.getBridgeStats not available - FAIL");
+}
@@ -3,6 +3,9 @@
 #include <thread>
 #include <chrono>
 #include <atomic>
+#include <vector>
+#include <string>
+#include <algorithm>
 
 using namespace protojs;
 
@@ -71,3 +74,188 @@ TEST_CASE("EventLoop: Exception handling", "[EventLoop]") {
         REQUIRE(counter.load() == 1);
     }
 }
+
+TEST_CASE("EventLoop: run() lifetime", "[EventLoop]") {
+    EventLoop& loop = EventLoop::getInstance();
+    
+    SECTION("Returns immediately when idle") {
+        REQUIRE(loop.getActiveHandles() == 0);
+        loop.run();
+        REQUIRE_FALSE(loop.isAlive());
+    }
+    
+    SECTION("Blocks until a referenced handle completes from another thread") {
+        std::atomic<bool> delivered{false};
+        loop.ref();
+        
+        std::thread producer([&loop, &delivered]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            loop.enqueueCallback([&loop, &delivered]() {
+                delivered = true;
+                loop.unref();
+            });
+        });
+        
+        loop.run();
+        producer.join();
+        
+        REQUIRE(delivered.load());
+        REQUIRE(loop.getActiveHandles() == 0);
+    }
+}
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/epoll.h>
+
+TEST_CASE("EventLoop: fd watchers", "[EventLoop]") {
+    EventLoop& loop = EventLoop::getInstance();
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+    
+    std::string received;
+    REQUIRE(loop.watchFd(fds[0], EPOLLIN, [&](uint32_t events) {
+        char buf[16];
+        ssize_t n = read(fds[0], buf, sizeof(buf));
+        if (n > 0) received.append(buf, static_cast<size_t>(n));
+        loop.unwatchFd(fds[0]);
+    }));
+    REQUIRE(loop.getActiveHandles() == 1);
+    
+    std::thread writer([&fds]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        ssize_t n = write(fds[1], "ping", 4);
+        (void)n;
+    });
+    
+    loop.run();
+    writer.join();
+    
+    REQUIRE(received == "ping");
+    REQUIRE(loop.getActiveHandles() == 0);
+    close(fds[0]);
+    close(fds[1]);
+}
+#endif
+
+TEST_CASE("EventLoop: microtask phase", "[EventLoop]") {
+    EventLoop& loop = EventLoop::getInstance();
+    
+    SECTION("Drained after each macrotask") {
+        int pendingJobs = 0;
+        std::vector<std::string> trace;
+        loop.setMicrotaskRunner([&](size_t budget) {
+            size_t executed = 0;
+            while (pendingJobs > 0 && executed < budget) {
+                pendingJobs--;
+                executed++;
+                trace.push_back("job");
+            }
+            return executed;
+        });
+        
+        uint64_t before = loop.getMicrotasksExecuted();
+        loop.enqueueCallback([&]() { trace.push_back("a"); pendingJobs = 2; });
+        loop.enqueueCallback([&]() { trace.push_back("b"); pendingJobs = 1; });
+        loop.processCallbacks();
+        
+        REQUIRE(trace == std::vector<std::string>{"a", "job", "job", "b", "job"});
+        REQUIRE(loop.getMicrotasksExecuted() - before == 3);
+        loop.setMicrotaskRunner(nullptr);
+    }
+    
+    SECTION("Budget defers the rest to the next iteration") {
+        int pendingJobs = 25;
+        loop.setMicrotaskBudget(10);
+        loop.setMicrotaskRunner([&](size_t budget) {
+            size_t executed = std::min<size_t>(budget, static_cast<size_t>(pendingJobs));
+            pendingJobs -= static_cast<int>(executed);
+            return executed;
+        });
+        
+        loop.enqueueCallback([]() {});
+        loop.processCallbacks();
+        REQUIRE(pendingJobs == 15);
+        
+        // run() keeps iterating while jobs remain, one budget per tick
+        loop.run();
+        REQUIRE(pendingJobs == 0);
+        
+        loop.setMicrotaskRunner(nullptr);
+        loop.setMicrotaskBudget(EventLoop::DEFAULT_MICROTASK_BUDGET);
+    }
+}
+
+TEST_CASE("EventLoop: idle phase", "[EventLoop]") {
+    EventLoop& loop = EventLoop::getInstance();
+    
+    SECTION("Runs slices between polls without blocking I/O") {
+        int sliceWork = 5;
+        std::vector<uint64_t> budgets;
+        loop.setIdleHandler([&](uint64_t budgetUs) {
+            budgets.push_back(budgetUs);
+            if (sliceWork > 0) sliceWork--;
+            return sliceWork > 0;
+        });
+        
+        std::atomic<bool> delivered{false};
+        loop.ref();
+        std::thread producer([&loop, &delivered]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            loop.enqueueCallback([&loop, &delivered]() {
+                delivered = true;
+                loop.unref();
+            });
+        });
+        
+        loop.run();
+        producer.join();
+        
+        REQUIRE(delivered.load());
+        REQUIRE(sliceWork == 0);
+        REQUIRE(budgets.size() >= 5);
+        REQUIRE(budgets.front() == EventLoop::DEFAULT_IDLE_SLICE_US);
+        loop.setIdleHandler(nullptr);
+    }
+    
+    SECTION("Does not keep the loop alive") {
+        int calls = 0;
+        loop.setIdleHandler([&](uint64_t) { calls++; return true; });
+        loop.run();
+        REQUIRE(calls == 0);
+        loop.setIdleHandler(nullptr);
+    }
+}
+
+TEST_CASE("EventLoop: thread-bound loops", "[EventLoop]") {
+    EventLoop& mainLoop = EventLoop::getInstance();
+    
+    SECTION("A bound thread runs its own loop") {
+        int ran = 0;
+        bool sawOwnLoop = false;
+        std::thread shard([&]() {
+            EventLoop loop;
+            EventLoop::bindThread(&loop);
+            sawOwnLoop = &EventLoop::getInstance() == &loop;
+            EventLoop::getInstance().enqueueCallback([&ran]() { ran++; });
+            loop.run();
+            EventLoop::bindThread(nullptr);
+        });
+        shard.join();
+        
+        REQUIRE(sawOwnLoop);
+        REQUIRE(ran == 1);
+        REQUIRE(&EventLoop::getInstance() == &mainLoop);
+        REQUIRE_FALSE(mainLoop.hasPendingCallbacks());
+    }
+    
+    SECTION("Unbound threads post to the main loop") {
+        int ran = 0;
+        std::thread producer([&]() {
+            EventLoop::getInstance().enqueueCallback([&ran]() { ran++; });
+        });
+        producer.join();
+        mainLoop.run();
+        REQUIRE(ran == 1);
+    }
+}
@@ -0,0 +1,208 @@
+#include <catch2/catch_all.hpp>
+#include "../../src/modules/http/HTTPParser.h"
+#include <string>
+#include <vector>
+
+using namespace protojs;
+
+namespace {
+
+struct ParsedRequest {
+    std::string method;
+    std::string target;
+    int versionMinor = -1;
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;
+    bool keepAlive = false;
+    bool complete = false;
+};
+
+struct ParseResult {
+    std::vector<ParsedRequest> requests;
+    std::string error;
+    // Bytes received but not consumed when input ran out
+    size_t buffered = 0;
+};
+
+// Feeds input in pieces of at most step bytes through a receive buffer, the
+// way a connection does: append, parse until NeedMore, drop what was consumed
+ParseResult parseInSteps(const std::string& input, size_t step, size_t maxHeadSize = HTTPRequestParser::DEFAULT_MAX_HEAD_SIZE) {
+    HTTPRequestParser parser(maxHeadSize);
+    ParseResult result;
+    std::string buffer;
+    for (size_t fed = 0; fed < input.size() && result.error.empty(); fed += step) {
+        buffer.append(input, fed, step);
+        size_t offset = 0;
+        while (true) {
+            size_t consumed = 0;
+            auto event = parser.parse(buffer.data() + offset, buffer.size() - offset, &consumed);
+            offset += consumed;
+            if (event == HTTPRequestParser::Event::NeedMore) {
+                break;
+            }
+            if (event == HTTPRequestParser::Event::Error) {
+                result.error = parser.error();
+                break;
+            }
+            if (event == HTTPRequestParser::Event::Head) {
+                ParsedRequest request;
+                request.method = std::string(parser.method());
+                request.target = std::string(parser.target());
+                request.versionMinor = parser.versionMinor();
+                for (const HTTPHeader& header : parser.headers()) {
+                    request.headers.emplace_back(std::string(header.name), std::string(header.value));
+                }
+                request.keepAlive = parser.keepAlive();
+                result.requests.push_back(request);
+            } else if (event == HTTPRequestParser::Event::Body) {
+                result.requests.back().body += std::string(parser.body());
+            } else {
+                result.requests.back().complete = true;
+            }
+        }
+        buffer.erase(0, offset);
+    }
+    result.buffered = buffer.size();
+    return result;
+}
+
+} // namespace
+
+TEST_CASE("HTTPRequestParser: request head", "[HTTPParser]") {
+    std::string input =
+        "GET /path?q=1 HTTP/1.1\r\n"
+        "Host: example.com\r\n"
+        "X-Padded:   spaced value \t\r\n"
+        "Empty:\r\n"
+        "\r\n";
+
+    auto result = parseInSteps(input, input.size());
+    REQUIRE(result.error.empty());
+    REQUIRE(result.requests.size() == 1);
+    const auto& request = result.requests[0];
+    REQUIRE(request.method == "GET");
+    REQUIRE(request.target == "/path?q=1");
+    REQUIRE(request.versionMinor == 1);
+    REQUIRE(request.headers.size() == 3);
+    REQUIRE(request.headers[0] == std::make_pair(std::string("Host"), std::string("example.com")));
+    REQUIRE(request.headers[1].second == "spaced value");
+    REQUIRE(request.headers[2].second.empty());
+    REQUIRE(request.keepAlive);
+    REQUIRE(request.complete);
+    REQUIRE(result.buffered == 0);
+}
+
+TEST_CASE("HTTPRequestParser: persistent connections", "[HTTPParser]") {
+    auto keepAlive = [](const std::string& head) {
+        auto result = parseInSteps(head + "\r\n", 4096);
+        REQUIRE(result.requests.size() == 1);
+        return result.requests[0].keepAlive;
+    };
+
+    REQUIRE(keepAlive("GET / HTTP/1.1\r\n"));
+    REQUIRE_FALSE(keepAlive("GET / HTTP/1.1\r\nConnection: close\r\n"));
+    REQUIRE_FALSE(keepAlive("GET / HTTP/1.1\r\nConnection: keep-alive, Close\r\n"));
+    REQUIRE_FALSE(keepAlive("GET / HTTP/1.0\r\n"));
+    REQUIRE(keepAlive("GET / HTTP/1.0\r\nconnection: Keep-Alive\r\n"));
+}
+
+TEST_CASE("HTTPRequestParser: Content-Length bodies", "[HTTPParser]") {
+    std::string body(100000, 'b');
+    std::string input = "POST /upload HTTP/1.1\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+
+    for (size_t step : {size_t(1), size_t(7), size_t(4096), input.size()}) {
+        auto result = parseInSteps(input, step);
+        REQUIRE(result.error.empty());
+        REQUIRE(result.requests.size() == 1);
+        REQUIRE(result.requests[0].body == body);
+        REQUIRE(result.requests[0].complete);
+    }
+}
+
+TEST_CASE("HTTPRequestParser: chunked bodies", "[HTTPParser]") {
+    std::string input =
+        "POST /stream HTTP/1.1\r\n"
+        "Transfer-Encoding: gzip, chunked\r\n"
+        "\r\n"
+        "5\r\nhello\r\n"
+        "1;ext=1\r\n \r\n"
+        "A\r\n0123456789\r\n"
+        "0\r\n"
+        "Trailer-Field: ignored\r\n"
+        "\r\n";
+
+    for (size_t step : {size_t(1), size_t(3), input.size()}) {
+        auto result = parseInSteps(input, step);
+        REQUIRE(result.error.empty());
+        REQUIRE(result.requests.size() == 1);
+        REQUIRE(result.requests[0].body == "hello 0123456789");
+        REQUIRE(result.requests[0].complete);
+        REQUIRE(result.buffered == 0);
+    }
+}
+
+TEST_CASE("HTTPRequestParser: pipelined requests", "[HTTPParser]") {
+    std::string input =
+        "GET /a HTTP/1.1\r\nHost: x\r\n\r\n"
+        "POST /b HTTP/1.1\r\nContent-Length: 3\r\n\r\nabc"
+        "\r\n"
+        "POST /c HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n2\r\nhi\r\n0\r\n\r\n"
+        "GET /d HTTP/1.1\r\n";
+
+    for (size_t step : {size_t(1), size_t(5), input.size()}) {
+        auto result = parseInSteps(input, step);
+        REQUIRE(result.error.empty());
+        REQUIRE(result.requests.size() == 3);
+        REQUIRE(result.requests[0].target == "/a");
+        REQUIRE(result.requests[1].body == "abc");
+        REQUIRE(result.requests[2].body == "hi");
+        for (const auto& request : result.requests) {
+            REQUIRE(request.complete);
+        }
+        // The partial fourth head stays buffered
+        REQUIRE(result.buffered == std::string("GET /d HTTP/1.1\r\n").size());
+    }
+}
+
+TEST_CASE("HTTPRequestParser: large heads", "[HTTPParser]") {
+    std::string value(20000, 'v');
+    std::string input = "GET / HTTP/1.1\r\nX-Large: " + value + "\r\n\r\n";
+
+    auto result = parseInSteps(input, 1000);
+    REQUIRE(result.error.empty());
+    REQUIRE(result.requests.size() == 1);
+    REQUIRE(result.requests[0].headers[0].second == value);
+
+    result = parseInSteps(input, 1000, 8192);
+    REQUIRE(result.error == "Request header fields too large");
+}
+
+TEST_CASE("HTTPRequestParser: invalid requests", "[HTTPParser]") {
+    auto error = [](const std::string& input) {
+        return parseInSteps(input, input.size()).error;
+    };
+
+    REQUIRE(error("GET /\r\n\r\n") == "Malformed request line");
+    REQUIRE(error("G(T / HTTP/1.1\r\n\r\n") == "Malformed request line");
+    REQUIRE(error("GET / HTTP/2.0\r\n\r\n") == "Unsupported HTTP version");
+    REQUIRE(error("GET / HTTP/1.1\r\nNo colon\r\n\r\n") == "Malformed header line");
+    REQUIRE(error("GET / HTTP/1.1\r\nBad : space\r\n\r\n") == "Malformed header line");
+    REQUIRE(error("GET / HTTP/1.1\r\nA: b\r\n folded\r\n\r\n") == "Folded header line");
+    REQUIRE(error("POST / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n") == "Invalid Content-Length");
+    REQUIRE(error("POST / HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\n") == "Invalid Content-Length");
+    REQUIRE(error("POST / HTTP/1.1\r\nContent-Length: 1\r\nTransfer-Encoding: chunked\r\n\r\n") ==
+            "Both Transfer-Encoding and Content-Length");
+    REQUIRE(error("POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n") == "Unsupported Transfer-Encoding");
+    REQUIRE(error("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n") == "Invalid chunk size");
+    REQUIRE(error("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n2\r\nhiX\r\n") == "Missing CRLF after chunk data");
+
+    SECTION("Errors are sticky") {
+        HTTPRequestParser parser;
+        std::string bad = "BAD\r\n\r\n";
+        size_t consumed = 0;
+        REQUIRE(parser.parse(bad.data(), bad.size(), &consumed) == HTTPRequestParser::Event::Error);
+        std::string good = "GET / HTTP/1.1\r\n\r\n";
+        REQUIRE(parser.parse(good.data(), good.size(), &consumed) == HTTPRequestParser::Event::Error);
+        REQUIRE(consumed == 0);
+    }
+}
@@ -0,0 +1,84 @@
+#include <catch2/catch_all.hpp>
+#include "../../src/modules/net/ListenSocket.h"
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+using namespace protojs;
+
+TEST_CASE("ListenSocket: backlog", "[ListenSocket]") {
+    int limit = ListenSocket::maxBacklog();
+    REQUIRE(limit > 0);
+    
+    REQUIRE(ListenSocket::clampBacklog(0) == std::min(ListenSocket::DEFAULT_BACKLOG, limit));
+    REQUIRE(ListenSocket::clampBacklog(-5) == std::min(ListenSocket::DEFAULT_BACKLOG, limit));
+    REQUIRE(ListenSocket::clampBacklog(1) == 1);
+    REQUIRE(ListenSocket::clampBacklog(limit + 1000) == limit);
+}
+
+TEST_CASE("ListenSocket: addresses", "[ListenSocket]") {
+    struct in_addr addr;
+    REQUIRE(ListenSocket::resolveIPv4("localhost", &addr));
+    REQUIRE(addr.s_addr == htonl(INADDR_LOOPBACK));
+    REQUIRE(ListenSocket::resolveIPv4("", &addr));
+    REQUIRE(addr.s_addr == htonl(INADDR_ANY));
+    REQUIRE(ListenSocket::resolveIPv4("10.1.2.3", &addr));
+    REQUIRE_FALSE(ListenSocket::resolveIPv4("not an address", &addr));
+}
+
+TEST_CASE("ListenSocket: open", "[ListenSocket]") {
+    SECTION("Port 0 binds an ephemeral, non-blocking listener") {
+        int port = 0;
+        int fd = ListenSocket::open("127.0.0.1", 0, 16, false, &port);
+        REQUIRE(fd >= 0);
+        REQUIRE(port > 0);
+        REQUIRE((fcntl(fd, F_GETFL) & O_NONBLOCK) != 0);
+        REQUIRE((fcntl(fd, F_GETFD) & FD_CLOEXEC) != 0);
+        close(fd);
+    }
+    
+    SECTION("reusePort lets listeners share a port") {
+        int port = 0;
+        int first = ListenSocket::open("127.0.0.1", 0, 16, true, &port);
+        REQUIRE(first >= 0);
+        int second = ListenSocket::open("127.0.0.1", port, 16, true);
+        REQUIRE(second >= 0);
+        close(second);
+        close(first);
+    }
+    
+    SECTION("Without reusePort the port stays exclusive") {
+        int port = 0;
+        int first = ListenSocket::open("127.0.0.1", 0, 16, false, &port);
+        REQUIRE(first >= 0);
+        REQUIRE(ListenSocket::open("127.0.0.1", port, 16, false) == -1);
+        close(first);
+    }
+    
+    SECTION("Invalid host") {
+        REQUIRE(ListenSocket::open("not an address", 0, 16, false) == -1);
+    }
+}
+
+TEST_CASE("ListenSocket: listener options", "[ListenSocket]") {
+    int fd = ListenSocket::open("127.0.0.1", 0, 16, false);
+    REQUIRE(fd >= 0);
+    
+    REQUIRE(ListenSocket::setDeferAccept(fd, 5));
+    int value = 0;
+    socklen_t len = sizeof(value);
+    REQUIRE(getsockopt(fd, IPPROTO_TCP, TCP_DEFER_ACCEPT, &value, &len) == 0);
+    // The kernel rounds the timeout to whole SYN-ACK retransmission periods
+    REQUIRE(value > 0);
+    
+    REQUIRE(ListenSocket::setFastOpen(fd, 32));
+    value = 0;
+    len = sizeof(value);
+    REQUIRE(getsockopt(fd, IPPROTO_TCP, TCP_FASTOPEN, &value, &len) == 0);
+    REQUIRE(value == 32);
+    
+    close(fd);
+    REQUIRE_FALSE(ListenSocket::setDeferAccept(-1, 1));
+}
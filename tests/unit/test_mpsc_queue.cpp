@@ -0,0 +1,183 @@
+#include <catch2/catch_all.hpp>
+#include "../../src/MPSCQueue.h"
+#include "../../src/InlineCallback.h"
+#include "../../src/EventLoop.h"
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <iostream>
+
+using namespace protojs;
+
+namespace {
+
+struct TestNode {
+    std::atomic<TestNode*> next{nullptr};
+    int producer = 0;
+    int sequence = 0;
+};
+
+} // namespace
+
+TEST_CASE("MPSCQueue: ordering", "[MPSCQueue]") {
+    MPSCQueue<TestNode> queue;
+    REQUIRE(queue.pop() == nullptr);
+    REQUIRE(queue.empty());
+    
+    SECTION("Single producer is FIFO") {
+        TestNode nodes[3];
+        for (int i = 0; i < 3; ++i) {
+            nodes[i].sequence = i;
+            queue.push(&nodes[i]);
+        }
+        REQUIRE_FALSE(queue.empty());
+        for (int i = 0; i < 3; ++i) {
+            TestNode* node = queue.pop();
+            REQUIRE(node == &nodes[i]);
+        }
+        REQUIRE(queue.pop() == nullptr);
+        REQUIRE(queue.empty());
+    }
+    
+    SECTION("Concurrent producers keep per-producer order") {
+        const int producers = 4;
+        const int perProducer = 20000;
+        std::vector<std::unique_ptr<TestNode[]>> storage;
+        for (int p = 0; p < producers; ++p) {
+            storage.emplace_back(new TestNode[perProducer]);
+        }
+        
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p]() {
+                for (int i = 0; i < perProducer; ++i) {
+                    storage[p][i].producer = p;
+                    storage[p][i].sequence = i;
+                    queue.push(&storage[p][i]);
+                }
+            });
+        }
+        
+        std::vector<int> nextExpected(producers, 0);
+        int received = 0;
+        while (received < producers * perProducer) {
+            TestNode* node = queue.pop();
+            if (!node) {
+                std::this_thread::yield();
+                continue;
+            }
+            REQUIRE(node->sequence == nextExpected[node->producer]);
+            nextExpected[node->producer]++;
+            received++;
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        REQUIRE(queue.pop() == nullptr);
+    }
+}
+
+TEST_CASE("InlineCallback: storage", "[InlineCallback]") {
+    SECTION("Small captures are stored inline") {
+        auto shared = std::make_shared<int>(1);
+        auto lambda = [shared]() { (*shared)++; };
+        REQUIRE(InlineCallback::fitsInline<decltype(lambda)>());
+        
+        InlineCallback callback(lambda);
+        InlineCallback moved(std::move(callback));
+        REQUIRE_FALSE(callback);
+        moved();
+        REQUIRE(*shared == 2);
+        REQUIRE(shared.use_count() == 3);
+        moved.reset();
+        REQUIRE(shared.use_count() == 2);
+    }
+    
+    SECTION("Large captures fall back to the heap") {
+        struct Big { char data[128] = {}; };
+        Big big;
+        big.data[0] = 7;
+        int seen = 0;
+        auto lambda = [big, &seen]() { seen = big.data[0]; };
+        REQUIRE_FALSE(InlineCallback::fitsInline<decltype(lambda)>());
+        
+        InlineCallback callback(lambda);
+        InlineCallback moved = std::move(callback);
+        moved();
+        REQUIRE(seen == 7);
+    }
+    
+    SECTION("Move-only callables") {
+        auto value = std::make_unique<int>(5);
+        int seen = 0;
+        InlineCallback callback([v = std::move(value), &seen]() { seen = *v; });
+        callback();
+        REQUIRE(seen == 5);
+    }
+}
+
+TEST_CASE("EventLoop: multi-producer completions", "[EventLoop]") {
+    EventLoop& loop = EventLoop::getInstance();
+    const int producers = 4;
+    const int perProducer = 5000;
+    int delivered = 0;
+    
+    loop.ref();
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < perProducer; ++i) {
+                loop.enqueueCallback([&]() {
+                    if (++delivered == producers * perProducer) {
+                        loop.unref();
+                    }
+                });
+            }
+        });
+    }
+    
+    loop.run();
+    for (auto& t : threads) {
+        t.join();
+    }
+    
+    REQUIRE(delivered == producers * perProducer);
+    REQUIRE_FALSE(loop.hasPendingCallbacks());
+}
+
+// Throughput benchmark; run explicitly with: protojs_tests "[benchmark]"
+TEST_CASE("EventLoop: completion throughput by producer count", "[.][benchmark][EventLoop]") {
+    EventLoop& loop = EventLoop::getInstance();
+    const int perProducer = 200000;
+    
+    for (int producers : {1, 2, 4, 8}) {
+        const int total = producers * perProducer;
+        int delivered = 0;
+        
+        loop.ref();
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&]() {
+                for (int i = 0; i < perProducer; ++i) {
+                    loop.enqueueCallback([&]() {
+                        if (++delivered == total) {
+                            loop.unref();
+                        }
+                    });
+                }
+            });
+        }
+        loop.run();
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        for (auto& t : threads) {
+            t.join();
+        }
+        
+        REQUIRE(delivered == total);
+        std::cout << "producers=" << producers
+                  << " completions/sec=" << static_cast<uint64_t>(total / elapsed) << std::endl;
+    }
+}
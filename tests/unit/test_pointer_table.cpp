@@ -0,0 +1,91 @@
+#include <catch2/catch_all.hpp>
+#include "../../src/PointerTable.h"
+#include <unordered_map>
+#include <vector>
+#include <random>
+
+using namespace protojs;
+
+TEST_CASE("PointerTable: Basic operations", "[PointerTable]") {
+    PointerTable<int> table;
+    int a = 0, b = 0;
+
+    REQUIRE(table.find(&a) == nullptr);
+    REQUIRE(table.insert(&a, 1).second);
+    REQUIRE_FALSE(table.insert(&a, 2).second);
+    REQUIRE(*table.find(&a) == 1);
+    REQUIRE(table.insert(&b, 3).second);
+    REQUIRE(table.size() == 2);
+
+    int removed = 0;
+    REQUIRE(table.erase(&a, &removed));
+    REQUIRE(removed == 1);
+    REQUIRE_FALSE(table.erase(&a));
+    REQUIRE(table.find(&a) == nullptr);
+    REQUIRE(*table.find(&b) == 3);
+    REQUIRE(table.size() == 1);
+
+    table.clear();
+    REQUIRE(table.size() == 0);
+    REQUIRE(table.find(&b) == nullptr);
+}
+
+TEST_CASE("PointerTable: Matches a reference map under churn", "[PointerTable]") {
+    std::vector<long> storage(4096);
+    PointerTable<long> table;
+    std::unordered_map<const void*, long> reference;
+    std::mt19937 rng(42);
+
+    for (int step = 0; step < 200000; ++step) {
+        const void* key = &storage[rng() % storage.size()];
+        if (rng() % 3 == 0) {
+            REQUIRE(table.erase(key) == (reference.erase(key) > 0));
+        } else {
+            long value = static_cast<long>(rng());
+            bool inserted = table.insert(key, value).second;
+            REQUIRE(inserted == reference.emplace(key, value).second);
+        }
+    }
+
+    REQUIRE(table.size() == reference.size());
+    for (const auto& entry : reference) {
+        const long* found = table.find(entry.first);
+        REQUIRE(found != nullptr);
+        REQUIRE(*found == entry.second);
+    }
+
+    size_t visited = 0;
+    table.forEach([&](const void* key, long& value) {
+        REQUIRE(reference.at(key) == value);
+        visited++;
+    });
+    REQUIRE(visited == reference.size());
+    // Tombstones are recycled rather than growing the table
+    REQUIRE(table.capacity() <= 4 * storage.size());
+}
+
+TEST_CASE("PointerTable: Resumable walk", "[PointerTable]") {
+    std::vector<int> storage(1000);
+    PointerTable<int> table;
+    for (size_t i = 0; i < storage.size(); ++i) {
+        table.insert(&storage[i], static_cast<int>(i));
+    }
+
+    uint64_t layout = table.layoutVersion();
+    size_t visited = 0;
+    size_t cursor = 0;
+    while (cursor < table.capacity()) {
+        cursor = table.forEachFrom(cursor, 37, [&](const void* key, int&) {
+            // Erasing the visited entry does not disturb the walk
+            if (visited++ % 2 == 0) {
+                table.erase(key);
+            }
+        });
+    }
+    REQUIRE(visited == storage.size());
+    REQUIRE(table.size() == storage.size() / 2);
+    REQUIRE(table.layoutVersion() == layout);
+
+    table.clear();
+    REQUIRE(table.layoutVersion() != layout);
+}
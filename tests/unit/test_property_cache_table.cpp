@@ -0,0 +1,115 @@
+#include <catch2/catch_all.hpp>
+#include "../../src/PropertyCacheTable.h"
+
+using namespace protojs;
+
+namespace {
+
+// Distinct addresses standing in for receivers and attributes
+int receivers[8];
+int attributeStorage[8];
+
+const proto::ProtoObject* attributeAt(size_t i) {
+    return reinterpret_cast<const proto::ProtoObject*>(&attributeStorage[i]);
+}
+
+} // namespace
+
+TEST_CASE("PropertyCacheTable: Hits and misses", "[PropertyCacheTable]") {
+    PropertyCacheTable table;
+    const proto::ProtoObject* attribute = nullptr;
+
+    REQUIRE_FALSE(table.find(1, &receivers[0], &attribute));
+    table.fill(1, &receivers[0], attributeAt(0));
+    REQUIRE(table.find(1, &receivers[0], &attribute));
+    REQUIRE(attribute == attributeAt(0));
+
+    // Another receiver or another name misses
+    REQUIRE_FALSE(table.find(1, &receivers[1], &attribute));
+    REQUIRE_FALSE(table.find(2, &receivers[0], &attribute));
+
+    // Absent attributes are cached as nullptr
+    table.fill(2, &receivers[0], nullptr);
+    attribute = attributeAt(7);
+    REQUIRE(table.find(2, &receivers[0], &attribute));
+    REQUIRE(attribute == nullptr);
+
+    REQUIRE(table.hits() == 2);
+    REQUIRE(table.misses() == 3);
+}
+
+TEST_CASE("PropertyCacheTable: Names do not share sites", "[PropertyCacheTable]") {
+    PropertyCacheTable table;
+    const proto::ProtoObject* attribute = nullptr;
+
+    // Names that collided when sites were direct-mapped by atom id
+    table.fill(1, &receivers[0], attributeAt(0));
+    table.fill(65, &receivers[0], attributeAt(1));
+    REQUIRE(table.find(1, &receivers[0], &attribute));
+    REQUIRE(attribute == attributeAt(0));
+    REQUIRE(table.find(65, &receivers[0], &attribute));
+    REQUIRE(attribute == attributeAt(1));
+    REQUIRE(table.siteCount() == 2);
+}
+
+TEST_CASE("PropertyCacheTable: Polymorphic sites", "[PropertyCacheTable]") {
+    PropertyCacheTable table;
+    const proto::ProtoObject* attribute = nullptr;
+
+    for (size_t i = 0; i < PropertyCacheTable::WAYS; ++i) {
+        table.fill(1, &receivers[i], attributeAt(i));
+    }
+    for (size_t i = 0; i < PropertyCacheTable::WAYS; ++i) {
+        REQUIRE(table.find(1, &receivers[i], &attribute));
+        REQUIRE(attribute == attributeAt(i));
+    }
+
+    // A further receiver evicts one entry; refilling a receiver keeps one entry
+    table.fill(1, &receivers[PropertyCacheTable::WAYS], attributeAt(PropertyCacheTable::WAYS));
+    size_t cached = 0;
+    for (size_t i = 0; i <= PropertyCacheTable::WAYS; ++i) {
+        cached += table.find(1, &receivers[i], &attribute) ? 1 : 0;
+    }
+    REQUIRE(cached == PropertyCacheTable::WAYS);
+
+    table.fill(1, &receivers[PropertyCacheTable::WAYS], attributeAt(0));
+    REQUIRE(table.find(1, &receivers[PropertyCacheTable::WAYS], &attribute));
+    REQUIRE(attribute == attributeAt(0));
+}
+
+TEST_CASE("PropertyCacheTable: Writes invalidate only their name", "[PropertyCacheTable]") {
+    PropertyCacheTable table;
+    const proto::ProtoObject* attribute = nullptr;
+
+    table.fill(1, &receivers[0], attributeAt(0));
+    table.fill(1, &receivers[1], attributeAt(1));
+    table.fill(2, &receivers[0], attributeAt(2));
+
+    table.store(1, &receivers[0], attributeAt(3));
+
+    // The written value is served from the cache
+    REQUIRE(table.find(1, &receivers[0], &attribute));
+    REQUIRE(attribute == attributeAt(3));
+    // Other receivers of the name may inherit it
+    REQUIRE_FALSE(table.find(1, &receivers[1], &attribute));
+    // Other names are unaffected, so mixed read/write loops keep hitting
+    REQUIRE(table.find(2, &receivers[0], &attribute));
+    REQUIRE(attribute == attributeAt(2));
+}
+
+TEST_CASE("PropertyCacheTable: Invalidation", "[PropertyCacheTable]") {
+    PropertyCacheTable table;
+    const proto::ProtoObject* attribute = nullptr;
+
+    table.fill(1, &receivers[0], attributeAt(0));
+    table.fill(2, &receivers[1], attributeAt(1));
+    table.invalidate();
+    REQUIRE_FALSE(table.find(1, &receivers[0], &attribute));
+    REQUIRE_FALSE(table.find(2, &receivers[1], &attribute));
+
+    // Stale entries are reused by later fills
+    table.fill(1, &receivers[2], attributeAt(2));
+    REQUIRE(table.find(1, &receivers[2], &attribute));
+    REQUIRE(attribute == attributeAt(2));
+    REQUIRE_FALSE(table.find(1, &receivers[0], &attribute));
+}
@@ -0,0 +1,99 @@
+#include <catch2/catch_all.hpp>
+#include "../../src/modules/net/SocketOptions.h"
+#include "../../src/modules/net/ListenSocket.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+using namespace protojs;
+
+namespace {
+
+// Client side of a loopback connection; the listener is closed on return
+int connectLoopback() {
+    int port = 0;
+    int listener = ListenSocket::open("127.0.0.1", 0, 4, false, &port);
+    REQUIRE(listener >= 0);
+    
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    REQUIRE(connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+    close(listener);
+    return fd;
+}
+
+int getOption(int fd, int level, int option) {
+    int value = -1;
+    socklen_t len = sizeof(value);
+    REQUIRE(getsockopt(fd, level, option, &value, &len) == 0);
+    return value;
+}
+
+} // namespace
+
+TEST_CASE("SocketOptions: setters", "[SocketOptions]") {
+    int fd = connectLoopback();
+    
+    SECTION("No delay") {
+        REQUIRE(SocketOptions::setNoDelay(fd, true));
+        REQUIRE(getOption(fd, IPPROTO_TCP, TCP_NODELAY) != 0);
+        REQUIRE(SocketOptions::setNoDelay(fd, false));
+        REQUIRE(getOption(fd, IPPROTO_TCP, TCP_NODELAY) == 0);
+    }
+    
+    SECTION("Keepalive with an initial delay in ms") {
+        REQUIRE(SocketOptions::setKeepAlive(fd, true, 1500));
+        REQUIRE(getOption(fd, SOL_SOCKET, SO_KEEPALIVE) != 0);
+        REQUIRE(getOption(fd, IPPROTO_TCP, TCP_KEEPIDLE) == 2);
+        REQUIRE(SocketOptions::setKeepAlive(fd, false, 0));
+        REQUIRE(getOption(fd, SOL_SOCKET, SO_KEEPALIVE) == 0);
+    }
+    
+    SECTION("Buffer sizes") {
+        REQUIRE(SocketOptions::setBufferSize(fd, SO_RCVBUF, 4096));
+        REQUIRE(getOption(fd, SOL_SOCKET, SO_RCVBUF) >= 4096);
+        REQUIRE(SocketOptions::setBufferSize(fd, SO_SNDBUF, 8192));
+        REQUIRE(getOption(fd, SOL_SOCKET, SO_SNDBUF) >= 8192);
+    }
+    
+    close(fd);
+}
+
+TEST_CASE("SocketOptions: apply", "[SocketOptions]") {
+    int fd = connectLoopback();
+    int defaultRecv = getOption(fd, SOL_SOCKET, SO_RCVBUF);
+    
+    SECTION("Unset options keep the defaults") {
+        SocketOptions options;
+        REQUIRE(options.apply(fd));
+        REQUIRE(getOption(fd, IPPROTO_TCP, TCP_NODELAY) == 0);
+        REQUIRE(getOption(fd, SOL_SOCKET, SO_KEEPALIVE) == 0);
+        REQUIRE(getOption(fd, SOL_SOCKET, SO_RCVBUF) == defaultRecv);
+    }
+    
+    SECTION("Set options are applied together") {
+        SocketOptions options;
+        options.noDelay = 1;
+        options.keepAlive = 1;
+        options.keepAliveInitialDelay = 3000;
+        options.sendBufferSize = 16384;
+        REQUIRE(options.apply(fd));
+        REQUIRE(getOption(fd, IPPROTO_TCP, TCP_NODELAY) != 0);
+        REQUIRE(getOption(fd, SOL_SOCKET, SO_KEEPALIVE) != 0);
+        REQUIRE(getOption(fd, IPPROTO_TCP, TCP_KEEPIDLE) == 3);
+        REQUIRE(getOption(fd, SOL_SOCKET, SO_SNDBUF) >= 16384);
+    }
+    
+    SECTION("A failing option is reported") {
+        SocketOptions options;
+        options.noDelay = 1;
+        REQUIRE_FALSE(options.apply(-1));
+    }
+    
+    close(fd);
+}
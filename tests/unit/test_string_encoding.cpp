@@ -0,0 +1,49 @@
+#include <catch2/catch_all.hpp>
+#include "../../src/StringEncoding.h"
+#include <string>
+#include <vector>
+
+using namespace protojs;
+
+namespace {
+
+const uint8_t* bytes(const std::string& s) {
+    return reinterpret_cast<const uint8_t*>(s.data());
+}
+
+} // namespace
+
+TEST_CASE("StringEncoding: ASCII scan", "[StringEncoding]") {
+    REQUIRE(StringEncoding::asciiPrefixLength(nullptr, 0) == 0);
+
+    std::string ascii(100, 'a');
+    REQUIRE(StringEncoding::isAscii(bytes(ascii), ascii.size()));
+
+    // A non-ASCII byte at every position, across block boundaries and tails
+    for (size_t pos = 0; pos < ascii.size(); ++pos) {
+        std::string s = ascii;
+        s[pos] = static_cast<char>(0xE9);
+        REQUIRE(StringEncoding::asciiPrefixLength(bytes(s), s.size()) == pos);
+        REQUIRE_FALSE(StringEncoding::isAscii(bytes(s), s.size()));
+    }
+}
+
+TEST_CASE("StringEncoding: Latin-1 to UTF-8", "[StringEncoding]") {
+    std::string out;
+    std::string latin1 = "caf\xE9 na\xEFve \xFF";
+    StringEncoding::appendLatin1AsUTF8(bytes(latin1), latin1.size(), out);
+    REQUIRE(out == "caf\xC3\xA9 na\xC3\xAFve \xC3\xBF");
+
+    // Appends to what is already there
+    std::string ascii(40, 'x');
+    StringEncoding::appendLatin1AsUTF8(bytes(ascii), ascii.size(), out);
+    REQUIRE(out.size() == latin1.size() + 3 + ascii.size());
+}
+
+TEST_CASE("StringEncoding: Code points to UTF-8", "[StringEncoding]") {
+    std::string out;
+    for (uint32_t cp : std::vector<uint32_t>{0x41, 0xE9, 0x20AC, 0x1F600}) {
+        StringEncoding::appendUTF8(cp, out);
+    }
+    REQUIRE(out == "A\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80");
+}
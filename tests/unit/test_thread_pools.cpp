@@ -4,6 +4,10 @@
 #include "../../src/IOThreadPool.h"
 #include <thread>
 #include <chrono>
+#include <atomic>
+#include <vector>
+#include <mutex>
+#include <future>
 
 using namespace protojs;
 
@@ -27,6 +31,59 @@ TEST_CASE("ThreadPoolExecutor: Legacy tests", "[ThreadPoolExecutor]") {
     pool.shutdown();
 }
 
+TEST_CASE("ThreadPoolExecutor: execute and post", "[ThreadPoolExecutor]") {
+    for (SchedulingMode mode : {SchedulingMode::FIFO, SchedulingMode::WorkStealing}) {
+        ThreadPoolExecutor pool(2, "PostPool", mode);
+        std::atomic<int> counter{0};
+        
+        for (int i = 0; i < 1000; ++i) {
+            pool.execute([&counter]() { counter++; });
+        }
+        REQUIRE(pool.post([&counter]() { counter++; }));
+        
+        // A throwing task is logged and does not take the worker down
+        pool.execute([]() { throw std::runtime_error("task failure"); });
+        pool.execute([&counter]() { counter++; });
+        
+        pool.shutdown();
+        REQUIRE(counter.load() == 1002);
+        REQUIRE_FALSE(pool.post([&counter]() { counter++; }));
+        REQUIRE_THROWS_AS(pool.execute([]() {}), std::runtime_error);
+        REQUIRE(counter.load() == 1002);
+    }
+}
+
+TEST_CASE("ThreadPoolExecutor: worker hooks", "[ThreadPoolExecutor]") {
+    for (SchedulingMode mode : {SchedulingMode::FIFO, SchedulingMode::WorkStealing}) {
+        std::atomic<int> started{0};
+        std::atomic<int> stopped{0};
+        std::atomic<int> ranWarm{0};
+
+        WorkerHooks hooks;
+        hooks.onStart = [&started](size_t) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            started++;
+        };
+        hooks.onStop = [&stopped](size_t) { stopped++; };
+
+        ThreadPoolExecutor pool(3, "HookPool", mode, hooks);
+        // Every start hook has finished before the constructor returns
+        REQUIRE(started.load() == 3);
+
+        for (int i = 0; i < 100; ++i) {
+            pool.execute([&started, &ranWarm]() {
+                if (started.load() == 3) {
+                    ranWarm++;
+                }
+            });
+        }
+
+        pool.shutdown();
+        REQUIRE(ranWarm.load() == 100);
+        REQUIRE(stopped.load() == 3);
+    }
+}
+
 TEST_CASE("CPUThreadPool: Legacy tests", "[CPUThreadPool]") {
     CPUThreadPool::initialize(4);
     auto& pool = CPUThreadPool::getInstance();
@@ -59,3 +116,34 @@ TEST_CASE("IOThreadPool: Legacy tests", "[IOThreadPool]") {
     
     IOThreadPool::shutdown();
 }
+
+TEST_CASE("ThreadPoolExecutor: priority lanes", "[ThreadPoolExecutor]") {
+    for (SchedulingMode mode : {SchedulingMode::FIFO, SchedulingMode::WorkStealing}) {
+        ThreadPoolExecutor pool(1, "PriorityPool", mode);
+        std::mutex orderMutex;
+        std::vector<char> order;
+        auto record = [&orderMutex, &order](char c) {
+            return [&orderMutex, &order, c]() {
+                std::lock_guard<std::mutex> lock(orderMutex);
+                order.push_back(c);
+            };
+        };
+        
+        // Hold the only worker so everything below is queued together
+        std::promise<void> gate;
+        std::shared_future<void> opened = gate.get_future().share();
+        pool.execute([opened]() { opened.wait(); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        
+        pool.execute(record('l'), TaskPriority::Low);
+        pool.execute(record('n'));
+        pool.execute(record('h'), TaskPriority::High);
+        pool.execute(record('n'));
+        pool.execute(record('h'), TaskPriority::High);
+        REQUIRE(pool.getQueueSize() == 5);
+        
+        gate.set_value();
+        pool.shutdown();
+        REQUIRE(order == std::vector<char>{'h', 'h', 'n', 'n', 'l'});
+    }
+}
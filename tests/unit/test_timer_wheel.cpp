@@ -0,0 +1,103 @@
+#include <catch2/catch_all.hpp>
+#include "../../src/TimerWheel.h"
+#include <vector>
+
+using namespace protojs;
+
+TEST_CASE("TimerWheel: Scheduling", "[TimerWheel]") {
+    TimerWheel wheel(1000);
+
+    SECTION("Fires in deadline order") {
+        std::vector<int> order;
+        wheel.schedule(1000, 30, [&order]() { order.push_back(3); });
+        wheel.schedule(1000, 10, [&order]() { order.push_back(1); });
+        wheel.schedule(1000, 20, [&order]() { order.push_back(2); });
+
+        REQUIRE(wheel.advance(1009) == 0);
+        REQUIRE(wheel.advance(1030) == 3);
+        REQUIRE(order == std::vector<int>{1, 2, 3});
+        REQUIRE(wheel.size() == 0);
+    }
+
+    SECTION("Long delays cascade through coarser levels") {
+        int fired = 0;
+        wheel.schedule(1000, 70000, [&fired]() { fired++; });
+
+        wheel.advance(1000 + 69999);
+        REQUIRE(fired == 0);
+        wheel.advance(1000 + 70000);
+        REQUIRE(fired == 1);
+    }
+
+    SECTION("Cancel") {
+        int fired = 0;
+        auto id = wheel.schedule(1000, 5, [&fired]() { fired++; });
+        REQUIRE(wheel.cancel(id));
+        REQUIRE_FALSE(wheel.cancel(id));
+        wheel.advance(2000);
+        REQUIRE(fired == 0);
+    }
+
+    SECTION("Repeating timers reschedule until cancelled") {
+        int fired = 0;
+        auto id = wheel.schedule(1000, 10, [&fired]() { fired++; }, 10);
+        wheel.advance(1010);
+        wheel.advance(1020);
+        wheel.advance(1030);
+        REQUIRE(fired == 3);
+        REQUIRE(wheel.isActive(id));
+        wheel.cancel(id);
+        wheel.advance(1100);
+        REQUIRE(fired == 3);
+    }
+
+    SECTION("Refresh restarts the delay") {
+        int fired = 0;
+        auto id = wheel.schedule(1000, 10, [&fired]() { fired++; });
+        wheel.advance(1008);
+        REQUIRE(wheel.refresh(id, 1008));
+        wheel.advance(1017);
+        REQUIRE(fired == 0);
+        wheel.advance(1018);
+        REQUIRE(fired == 1);
+        REQUIRE_FALSE(wheel.refresh(id, 1018));
+    }
+}
+
+TEST_CASE("TimerWheel: Loop integration", "[TimerWheel]") {
+    TimerWheel wheel(0);
+
+    SECTION("Unref'd timers do not count towards refCount") {
+        auto a = wheel.schedule(0, 10, []() {});
+        auto b = wheel.schedule(0, 20, []() {});
+        REQUIRE(wheel.refCount() == 2);
+        wheel.setRef(a, false);
+        REQUIRE(wheel.refCount() == 1);
+        REQUIRE_FALSE(wheel.hasRef(a));
+        REQUIRE(wheel.hasRef(b));
+        wheel.advance(20);
+        REQUIRE(wheel.refCount() == 0);
+    }
+
+    SECTION("nextTimeoutMs never overshoots the next deadline") {
+        REQUIRE(wheel.nextTimeoutMs(0) == -1);
+        wheel.schedule(0, 5000, []() {});
+        int64_t timeout = wheel.nextTimeoutMs(0);
+        REQUIRE(timeout >= 0);
+        REQUIRE(timeout <= 5000);
+        wheel.schedule(0, 3, []() {});
+        REQUIRE(wheel.nextTimeoutMs(0) == 3);
+    }
+
+    SECTION("A callback may cancel its own repeating timer") {
+        int fired = 0;
+        TimerWheel::TimerId id = 0;
+        id = wheel.schedule(0, 1, [&]() {
+            fired++;
+            wheel.cancel(id);
+        }, 1);
+        wheel.advance(10);
+        REQUIRE(fired == 1);
+        REQUIRE(wheel.size() == 0);
+    }
+}
@@ -0,0 +1,159 @@
+#include <catch2/catch_all.hpp>
+#include "../../src/WorkStealingDeque.h"
+#include "../../src/ThreadPoolExecutor.h"
+#include "../../src/CPUThreadPool.h"
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <iostream>
+
+using namespace protojs;
+
+TEST_CASE("WorkStealingDeque: owner and thieves", "[WorkStealingDeque]") {
+    SECTION("Owner pops LIFO, thieves steal FIFO") {
+        WorkStealingDeque<int> deque(4);
+        for (int i = 0; i < 10; ++i) {
+            deque.push(i); // Grows past the initial capacity
+        }
+        REQUIRE(deque.size() == 10);
+        
+        int value = -1;
+        REQUIRE(deque.steal(value));
+        REQUIRE(value == 0);
+        REQUIRE(deque.pop(value));
+        REQUIRE(value == 9);
+        REQUIRE(deque.size() == 8);
+    }
+    
+    SECTION("Every element is taken exactly once under contention") {
+        const int total = 100000;
+        WorkStealingDeque<int> deque(64);
+        std::vector<std::atomic<int>> seen(total);
+        std::atomic<int> taken{0};
+        std::atomic<bool> done{false};
+        
+        std::vector<std::thread> thieves;
+        for (int t = 0; t < 3; ++t) {
+            thieves.emplace_back([&]() {
+                int value;
+                while (!done.load()) {
+                    if (deque.steal(value)) {
+                        seen[value]++;
+                        taken++;
+                    }
+                }
+            });
+        }
+        
+        int value;
+        for (int i = 0; i < total; ++i) {
+            deque.push(i);
+            if (i % 3 == 0 && deque.pop(value)) {
+                seen[value]++;
+                taken++;
+            }
+        }
+        while (deque.pop(value)) {
+            seen[value]++;
+            taken++;
+        }
+        while (taken.load() < total) {
+            std::this_thread::yield();
+        }
+        done = true;
+        for (auto& t : thieves) {
+            t.join();
+        }
+        
+        for (int i = 0; i < total; ++i) {
+            REQUIRE(seen[i].load() == 1);
+        }
+    }
+}
+
+TEST_CASE("ThreadPoolExecutor: work stealing mode", "[ThreadPoolExecutor]") {
+    ThreadPoolExecutor pool(4, "StealingPool", SchedulingMode::WorkStealing);
+    REQUIRE(pool.getSchedulingMode() == SchedulingMode::WorkStealing);
+    
+    SECTION("Results") {
+        std::vector<std::future<int>> futures;
+        for (int i = 0; i < 1000; ++i) {
+            futures.push_back(pool.submit([i]() { return i * 2; }));
+        }
+        for (size_t i = 0; i < futures.size(); ++i) {
+            REQUIRE(futures[i].get() == static_cast<int>(i * 2));
+        }
+    }
+    
+    SECTION("Nested submissions are spread by stealing") {
+        std::atomic<int> counter{0};
+        auto outer = pool.submit([&]() {
+            std::vector<std::future<void>> inner;
+            for (int i = 0; i < 64; ++i) {
+                inner.push_back(pool.submit([&]() {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    counter++;
+                }));
+            }
+            // Keep this worker busy so the others have to steal
+            for (auto& f : inner) {
+                f.wait();
+            }
+        });
+        outer.get();
+        REQUIRE(counter.load() == 64);
+        REQUIRE(pool.getStealCount() > 0);
+    }
+    
+    SECTION("Graceful shutdown drains queued tasks") {
+        std::atomic<int> counter{0};
+        for (int i = 0; i < 200; ++i) {
+            pool.submit([&counter]() { counter++; });
+        }
+        pool.shutdown();
+        REQUIRE(counter.load() == 200);
+        REQUIRE(pool.getQueueSize() == 0);
+        REQUIRE_THROWS_AS(pool.submit([]() {}), std::runtime_error);
+    }
+}
+
+TEST_CASE("CPUThreadPool: scheduling mode", "[CPUThreadPool]") {
+    CPUThreadPool::initialize(2);
+    REQUIRE(CPUThreadPool::getInstance().getExecutor().getSchedulingMode() == SchedulingMode::WorkStealing);
+    
+    CPUThreadPool::initialize(2, SchedulingMode::FIFO);
+    auto& executor = CPUThreadPool::getInstance().getExecutor();
+    REQUIRE(executor.getSchedulingMode() == SchedulingMode::FIFO);
+    REQUIRE(executor.submit([]() { return 7; }).get() == 7);
+    
+    CPUThreadPool::shutdown();
+}
+
+// Throughput benchmark; run explicitly with: protojs_tests "[benchmark]"
+TEST_CASE("ThreadPoolExecutor: short-task throughput, FIFO vs work stealing", "[.][benchmark][ThreadPoolExecutor]") {
+    const size_t threads = std::max(2u, std::thread::hardware_concurrency());
+    const int tasks = 200000;
+    
+    for (SchedulingMode mode : {SchedulingMode::FIFO, SchedulingMode::WorkStealing}) {
+        ThreadPoolExecutor pool(threads, "BenchPool", mode);
+        std::atomic<int> done{0};
+        
+        auto start = std::chrono::steady_clock::now();
+        // Fan out from inside the pool, as chained Deferreds do
+        pool.submit([&]() {
+            for (int i = 0; i < tasks; ++i) {
+                pool.execute([&done]() { done++; });
+            }
+        }).get();
+        while (done.load() < tasks) {
+            std::this_thread::yield();
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        
+        REQUIRE(done.load() == tasks);
+        std::cout << (mode == SchedulingMode::FIFO ? "fifo" : "work-stealing")
+                  << " threads=" << threads
+                  << " tasks/sec=" << static_cast<uint64_t>(tasks / elapsed) << std::endl;
+    }
+}